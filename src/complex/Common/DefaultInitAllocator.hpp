@@ -0,0 +1,61 @@
+#pragma once
+
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace complex
+{
+/**
+ * @class DefaultInitAllocator
+ * @brief The DefaultInitAllocator class is a std::allocator that
+ * default-initializes values instead of value-initializing them. Containers
+ * of trivial types using it skip zero-filling memory that is overwritten
+ * right away, e.g. by a bulk copy. Values that need a defined initial value
+ * must be constructed explicitly, e.g. std::vector::resize(count, value).
+ * @tparam T
+ */
+template <class T>
+class DefaultInitAllocator : public std::allocator<T>
+{
+public:
+  template <class U>
+  struct rebind
+  {
+    using other = DefaultInitAllocator<U>;
+  };
+
+  DefaultInitAllocator() noexcept = default;
+
+  template <class U>
+  DefaultInitAllocator(const DefaultInitAllocator<U>& other) noexcept
+  : std::allocator<T>(other)
+  {
+  }
+
+  /**
+   * @brief Default-initializes the value at the specified address.
+   * @tparam U
+   * @param ptr
+   */
+  template <class U>
+  void construct(U* ptr) noexcept(std::is_nothrow_default_constructible_v<U>)
+  {
+    ::new(static_cast<void*>(ptr)) U;
+  }
+
+  /**
+   * @brief Constructs the value at the specified address from the provided arguments.
+   * @tparam U
+   * @tparam ArgsT
+   * @param ptr
+   * @param args
+   */
+  template <class U, class... ArgsT>
+  void construct(U* ptr, ArgsT&&... args)
+  {
+    ::new(static_cast<void*>(ptr)) U(std::forward<ArgsT>(args)...);
+  }
+};
+} // namespace complex
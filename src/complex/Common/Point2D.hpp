@@ -153,6 +153,16 @@ public:
     return m_Pos[index];
   }
 
+  /**
+   * @brief Returns a const reference to the target position index.
+   * @param index
+   * @return const ValueType&
+   */
+  const ValueType& operator[](size_t index) const
+  {
+    return m_Pos[index];
+  }
+
   /**
    * @brief Copy assignment operator
    * @param other
@@ -161,6 +171,7 @@ public:
   Point2D& operator=(const Point2D& other)
   {
     m_Pos = other.m_Pos;
+    return *this;
   }
 
   /**
@@ -171,6 +182,7 @@ public:
   Point2D& operator=(Point2D&& other)
   {
     m_Pos = std::move(other.m_Pos);
+    return *this;
   }
 
   /**
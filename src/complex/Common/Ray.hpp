@@ -1,7 +1,5 @@
 #pragma once
 
-#include <stdexcept>
-
 #include "complex/Common/EulerAngle.hpp"
 #include "complex/Common/Point3D.hpp"
 
@@ -127,11 +125,12 @@ public:
 
   /**
    * @brief Returns the end point determined by the origin point, Euler angle, and length.
+   * The angle is treated as the direction of the ray and need not be normalized.
    * @return PointType
    */
   PointType getEndPoint() const
   {
-    throw std::runtime_error("");
+    return getPointAtDist(m_Length);
   }
 
   /**
@@ -141,7 +140,8 @@ public:
    */
   PointType getPointAtDist(LengthType length) const
   {
-    throw std::runtime_error("");
+    const ZXZEulerType direction = m_Angle.normalized();
+    return PointType(m_Origin[0] + length * static_cast<T>(direction[0]), m_Origin[1] + length * static_cast<T>(direction[1]), m_Origin[2] + length * static_cast<T>(direction[2]));
   }
 
   /**
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <stdexcept>
+#include <type_traits>
+
+#include "complex/Common/Types.hpp"
+
+namespace complex
+{
+/**
+ * @class Span
+ * @brief The Span class is a non-owning view over a contiguous sequence of
+ * values. It is a minimal stand-in for C++20's std::span and is used to hand
+ * out raw access to contiguous DataStores without going through virtual
+ * per-element accessors.
+ * @tparam T
+ */
+template <class T>
+class Span
+{
+public:
+  using element_type = T;
+  using value_type = std::remove_cv_t<T>;
+  using size_type = usize;
+  using difference_type = std::ptrdiff_t;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using reference = T&;
+  using const_reference = const T&;
+  using iterator = T*;
+  using const_iterator = const T*;
+
+  constexpr Span() noexcept = default;
+
+  constexpr Span(pointer data, size_type size) noexcept
+  : m_Data(data)
+  , m_Size(size)
+  {
+  }
+
+  /**
+   * @brief Allows implicit conversion from Span<T> to Span<const T>.
+   * @param other
+   */
+  template <class U, class = std::enable_if_t<std::is_convertible_v<U (*)[], T (*)[]>>>
+  constexpr Span(const Span<U>& other) noexcept
+  : m_Data(other.data())
+  , m_Size(other.size())
+  {
+  }
+
+  constexpr Span(const Span&) noexcept = default;
+  constexpr Span& operator=(const Span&) noexcept = default;
+
+  ~Span() noexcept = default;
+
+  [[nodiscard]] constexpr pointer data() const noexcept
+  {
+    return m_Data;
+  }
+
+  [[nodiscard]] constexpr size_type size() const noexcept
+  {
+    return m_Size;
+  }
+
+  [[nodiscard]] constexpr size_type size_bytes() const noexcept
+  {
+    return m_Size * sizeof(T);
+  }
+
+  [[nodiscard]] constexpr bool empty() const noexcept
+  {
+    return m_Size == 0;
+  }
+
+  [[nodiscard]] constexpr reference operator[](size_type index) const noexcept
+  {
+    return m_Data[index];
+  }
+
+  [[nodiscard]] reference at(size_type index) const
+  {
+    if(index >= m_Size)
+    {
+      throw std::out_of_range("Span index out of range");
+    }
+    return m_Data[index];
+  }
+
+  [[nodiscard]] constexpr reference front() const noexcept
+  {
+    return m_Data[0];
+  }
+
+  [[nodiscard]] constexpr reference back() const noexcept
+  {
+    return m_Data[m_Size - 1];
+  }
+
+  /**
+   * @brief Returns a view over count values starting at offset.
+   * @param offset
+   * @param count
+   * @return Span
+   */
+  [[nodiscard]] constexpr Span subspan(size_type offset, size_type count) const noexcept
+  {
+    return Span(m_Data + offset, count);
+  }
+
+  [[nodiscard]] constexpr iterator begin() const noexcept
+  {
+    return m_Data;
+  }
+
+  [[nodiscard]] constexpr iterator end() const noexcept
+  {
+    return m_Data + m_Size;
+  }
+
+private:
+  pointer m_Data = nullptr;
+  size_type m_Size = 0;
+};
+} // namespace complex
@@ -0,0 +1,156 @@
+#include "AccessRegistry.hpp"
+
+#include <algorithm>
+
+using namespace complex;
+
+AccessRegistry::Token::Token() = default;
+
+AccessRegistry::Token::Token(Token&& other) noexcept
+: m_Registry(other.m_Registry)
+, m_ReadIds(std::move(other.m_ReadIds))
+, m_WriteIds(std::move(other.m_WriteIds))
+{
+  other.m_Registry = nullptr;
+}
+
+AccessRegistry::Token::~Token() noexcept
+{
+  release();
+}
+
+AccessRegistry::Token& AccessRegistry::Token::operator=(Token&& other) noexcept
+{
+  if(this != &other)
+  {
+    release();
+    m_Registry = other.m_Registry;
+    m_ReadIds = std::move(other.m_ReadIds);
+    m_WriteIds = std::move(other.m_WriteIds);
+    other.m_Registry = nullptr;
+  }
+  return *this;
+}
+
+bool AccessRegistry::Token::isValid() const
+{
+  return m_Registry != nullptr;
+}
+
+const std::vector<AccessRegistry::IdType>& AccessRegistry::Token::getReadIds() const
+{
+  return m_ReadIds;
+}
+
+const std::vector<AccessRegistry::IdType>& AccessRegistry::Token::getWriteIds() const
+{
+  return m_WriteIds;
+}
+
+void AccessRegistry::Token::release()
+{
+  if(m_Registry != nullptr)
+  {
+    m_Registry->release(*this);
+    m_Registry = nullptr;
+  }
+}
+
+AccessRegistry::AccessRegistry() = default;
+
+AccessRegistry::~AccessRegistry() noexcept = default;
+
+AccessRegistry::Token AccessRegistry::createToken(const std::vector<IdType>& readIds, const std::vector<IdType>& writeIds)
+{
+  Token token;
+  token.m_WriteIds = writeIds;
+  std::sort(token.m_WriteIds.begin(), token.m_WriteIds.end());
+  token.m_WriteIds.erase(std::unique(token.m_WriteIds.begin(), token.m_WriteIds.end()), token.m_WriteIds.end());
+
+  token.m_ReadIds = readIds;
+  std::sort(token.m_ReadIds.begin(), token.m_ReadIds.end());
+  token.m_ReadIds.erase(std::unique(token.m_ReadIds.begin(), token.m_ReadIds.end()), token.m_ReadIds.end());
+  auto isWritten = [&token](IdType id) { return std::binary_search(token.m_WriteIds.begin(), token.m_WriteIds.end(), id); };
+  token.m_ReadIds.erase(std::remove_if(token.m_ReadIds.begin(), token.m_ReadIds.end(), isWritten), token.m_ReadIds.end());
+  return token;
+}
+
+bool AccessRegistry::canGrant(const Token& token) const
+{
+  for(IdType id : token.m_ReadIds)
+  {
+    auto iter = m_Entries.find(id);
+    if(iter != m_Entries.end() && iter->second.writer)
+    {
+      return false;
+    }
+  }
+  for(IdType id : token.m_WriteIds)
+  {
+    if(m_Entries.count(id) != 0)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+void AccessRegistry::grant(Token& token)
+{
+  for(IdType id : token.m_ReadIds)
+  {
+    m_Entries[id].readers++;
+  }
+  for(IdType id : token.m_WriteIds)
+  {
+    m_Entries[id].writer = true;
+  }
+  token.m_Registry = this;
+}
+
+void AccessRegistry::release(Token& token)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    for(IdType id : token.m_ReadIds)
+    {
+      auto iter = m_Entries.find(id);
+      if(--iter->second.readers == 0)
+      {
+        m_Entries.erase(iter);
+      }
+    }
+    for(IdType id : token.m_WriteIds)
+    {
+      m_Entries.erase(id);
+    }
+  }
+  m_Released.notify_all();
+}
+
+AccessRegistry::Token AccessRegistry::acquire(const std::vector<IdType>& readIds, const std::vector<IdType>& writeIds)
+{
+  Token token = createToken(readIds, writeIds);
+  std::unique_lock<std::mutex> lock(m_Mutex);
+  m_Released.wait(lock, [this, &token]() { return canGrant(token); });
+  grant(token);
+  return token;
+}
+
+std::optional<AccessRegistry::Token> AccessRegistry::tryAcquire(const std::vector<IdType>& readIds, const std::vector<IdType>& writeIds)
+{
+  Token token = createToken(readIds, writeIds);
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  if(!canGrant(token))
+  {
+    return {};
+  }
+  grant(token);
+  return token;
+}
+
+bool AccessRegistry::isAccessed(IdType id) const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  return m_Entries.count(id) != 0;
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "complex/Common/Types.hpp"
+#include "complex/DataStructure/DataObject.hpp"
+
+#include "complex/complex_export.hpp"
+
+namespace complex
+{
+/**
+ * @class AccessRegistry
+ * @brief The AccessRegistry class tracks which DataObjects are being read or
+ * written, so that tasks touching disjoint parts of a DataStructure, such as
+ * independent filters, can run at the same time. A task declares the IDs it
+ * reads and writes up front and holds the returned Token while it runs. Any
+ * number of tokens may read an object, but a token writing it excludes all
+ * others.
+ *
+ * Declarations are granted all at once or not at all, so tasks that wait for
+ * each other cannot deadlock. The registry does not check accesses; it only
+ * orders tasks that declare them. A thread must not wait for a declaration
+ * that conflicts with a token it holds itself.
+ */
+class COMPLEX_EXPORT AccessRegistry
+{
+public:
+  using IdType = DataObject::IdType;
+
+  /**
+   * @class Token
+   * @brief Holds the accesses granted by the registry until it is destroyed
+   * or released. The registry must outlive its tokens.
+   */
+  class COMPLEX_EXPORT Token
+  {
+  public:
+    friend class AccessRegistry;
+
+    Token();
+
+    Token(const Token&) = delete;
+
+    /**
+     * @brief Move constructor. other no longer holds the accesses.
+     * @param other
+     */
+    Token(Token&& other) noexcept;
+
+    ~Token() noexcept;
+
+    Token& operator=(const Token&) = delete;
+
+    /**
+     * @brief Move assignment. The accesses held by this token are released.
+     * @param other
+     * @return Token&
+     */
+    Token& operator=(Token&& other) noexcept;
+
+    /**
+     * @brief Returns true if the token holds accesses.
+     * @return bool
+     */
+    bool isValid() const;
+
+    /**
+     * @brief Returns the IDs the token reads but does not write.
+     * @return const std::vector<IdType>&
+     */
+    const std::vector<IdType>& getReadIds() const;
+
+    /**
+     * @brief Returns the IDs the token writes.
+     * @return const std::vector<IdType>&
+     */
+    const std::vector<IdType>& getWriteIds() const;
+
+    /**
+     * @brief Returns the accesses to the registry.
+     */
+    void release();
+
+  private:
+    AccessRegistry* m_Registry = nullptr;
+    std::vector<IdType> m_ReadIds;
+    std::vector<IdType> m_WriteIds;
+  };
+
+  AccessRegistry();
+
+  AccessRegistry(const AccessRegistry&) = delete;
+  AccessRegistry(AccessRegistry&&) = delete;
+
+  ~AccessRegistry() noexcept;
+
+  AccessRegistry& operator=(const AccessRegistry&) = delete;
+  AccessRegistry& operator=(AccessRegistry&&) = delete;
+
+  /**
+   * @brief Declares read access to readIds and write access to writeIds,
+   * blocking until no other token writes any of them or reads any of
+   * writeIds. An ID in both lists is written.
+   * @param readIds
+   * @param writeIds
+   * @return Token
+   */
+  Token acquire(const std::vector<IdType>& readIds, const std::vector<IdType>& writeIds);
+
+  /**
+   * @brief Declares the accesses like acquire() if that would not block.
+   * Returns an empty optional otherwise.
+   * @param readIds
+   * @param writeIds
+   * @return std::optional<Token>
+   */
+  std::optional<Token> tryAcquire(const std::vector<IdType>& readIds, const std::vector<IdType>& writeIds);
+
+  /**
+   * @brief Returns true if a token reads or writes the ID.
+   * @param id
+   * @return bool
+   */
+  bool isAccessed(IdType id) const;
+
+private:
+  struct Entry
+  {
+    u32 readers = 0;
+    bool writer = false;
+  };
+
+  /**
+   * @brief Returns a token holding the normalized declarations, not yet
+   * granted.
+   * @param readIds
+   * @param writeIds
+   * @return Token
+   */
+  Token createToken(const std::vector<IdType>& readIds, const std::vector<IdType>& writeIds);
+
+  /**
+   * @brief Returns true if the token's accesses can be granted. Requires the
+   * mutex.
+   * @param token
+   * @return bool
+   */
+  bool canGrant(const Token& token) const;
+
+  /**
+   * @brief Records the token's accesses. Requires the mutex.
+   * @param token
+   */
+  void grant(Token& token);
+
+  /**
+   * @brief Removes the token's accesses and wakes waiting threads.
+   * @param token
+   */
+  void release(Token& token);
+
+  mutable std::mutex m_Mutex;
+  std::condition_variable m_Released;
+  std::unordered_map<IdType, Entry> m_Entries;
+};
+} // namespace complex
@@ -84,6 +84,7 @@ BaseGroup::ConstIterator BaseGroup::find(const std::string& name) const
 
 bool BaseGroup::insert(const std::weak_ptr<DataObject>& obj)
 {
+  auto lock = lockHierarchy();
   auto ptr = obj.lock();
   if(!canInsert(ptr.get()))
   {
@@ -98,14 +99,18 @@ bool BaseGroup::insert(const std::weak_ptr<DataObject>& obj)
 }
 bool BaseGroup::remove(DataObject* obj)
 {
-  if(obj == nullptr)
+  auto lock = lockHierarchy();
+  if(obj == nullptr || !m_DataMap.contains(obj->getId()))
   {
     return false;
   }
+  // Update the parents first, since removing the last reference destroys obj
+  obj->removeParent(this);
   return m_DataMap.remove(obj->getId());
 }
 bool BaseGroup::remove(const std::string& name)
 {
+  auto lock = lockHierarchy();
   for(auto iter = m_DataMap.begin(); iter != m_DataMap.end(); iter++)
   {
     if((*iter).second->getName() == name)
@@ -21,6 +21,8 @@ namespace complex
 class COMPLEX_EXPORT BaseGroup : public DataObject
 {
 public:
+  friend class DataObject;
+
   using Iterator = typename DataMap::Iterator;
   using ConstIterator = typename DataMap::ConstIterator;
 
@@ -0,0 +1,267 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace complex
+{
+/**
+ * @class BlockCache
+ * @brief The BlockCache class keeps a bounded number of fixed-size blocks of
+ * values in memory for IDataStores that hold their values somewhere else,
+ * such as ChunkedDataStore and CompressedDataStore. Resident blocks are
+ * tracked in a least recently used list and repeated access to the same
+ * block skips the LRU bookkeeping.
+ *
+ * The owning store provides two functions:
+ * - load fills a newly allocated, zero-initialized block from the store's
+ *   backing data,
+ * - evict saves a modified block before it is released. Returning false keeps
+ *   the block resident.
+ *
+ * Even reads change which blocks are resident, so every call must be made
+ * while holding getMutex(). Block pointers are only valid while the mutex is
+ * held and no other block is accessed.
+ * @tparam T
+ */
+template <typename T>
+class BlockCache
+{
+public:
+  using LoadFunction = std::function<void(size_t, T*)>;
+  using EvictFunction = std::function<bool(size_t, const T*)>;
+
+  /**
+   * @brief Constructs an empty BlockCache for blocks of valuesPerBlock values
+   * that keeps at most maxResident blocks in memory. Call resize() to set the
+   * number of blocks.
+   * @param valuesPerBlock
+   * @param maxResident
+   * @param load
+   * @param evict
+   */
+  BlockCache(size_t valuesPerBlock, size_t maxResident, LoadFunction load, EvictFunction evict)
+  : m_ValuesPerBlock(valuesPerBlock)
+  , m_MaxResident(maxResident)
+  , m_Load(std::move(load))
+  , m_Evict(std::move(evict))
+  {
+  }
+
+  BlockCache(const BlockCache& other) = delete;
+  BlockCache(BlockCache&& other) = delete;
+
+  ~BlockCache() = default;
+
+  BlockCache& operator=(const BlockCache& rhs) = delete;
+  BlockCache& operator=(BlockCache&& rhs) = delete;
+
+  /**
+   * @brief Returns the mutex that guards the cache.
+   * @return std::mutex&
+   */
+  std::mutex& getMutex() const
+  {
+    return m_Mutex;
+  }
+
+  /**
+   * @brief Returns the number of blocks covered by the cache.
+   * @return size_t
+   */
+  size_t getBlockCount() const
+  {
+    return m_Blocks.size();
+  }
+
+  /**
+   * @brief Returns the number of blocks currently held in memory.
+   * @return size_t
+   */
+  size_t getResidentCount() const
+  {
+    return m_Lru.size();
+  }
+
+  /**
+   * @brief Returns the block's values if it is resident or nullptr otherwise.
+   * The LRU order is not changed.
+   * @param blockIndex
+   * @return const T*
+   */
+  const T* residentValues(size_t blockIndex) const
+  {
+    return m_Blocks[blockIndex].values.get();
+  }
+
+  /**
+   * @brief Returns true if the block is resident and was modified since it
+   * was loaded or last evicted.
+   * @param blockIndex
+   * @return bool
+   */
+  bool isDirty(size_t blockIndex) const
+  {
+    return m_Blocks[blockIndex].isDirty;
+  }
+
+  /**
+   * @brief Returns the values of the specified block, loading it and evicting
+   * another block if required.
+   * @param blockIndex
+   * @param markDirty
+   * @return T*
+   */
+  T* values(size_t blockIndex, bool markDirty)
+  {
+    if(m_LastValues != nullptr && blockIndex == m_LastIndex)
+    {
+      if(markDirty)
+      {
+        m_Blocks[blockIndex].isDirty = true;
+      }
+      return m_LastValues;
+    }
+
+    Block& block = m_Blocks[blockIndex];
+    if(block.values != nullptr)
+    {
+      m_Lru.splice(m_Lru.begin(), m_Lru, block.lruPosition);
+    }
+    else
+    {
+      evict(m_MaxResident - 1);
+      auto values = std::make_unique<T[]>(m_ValuesPerBlock);
+      m_Load(blockIndex, values.get());
+      block.values = std::move(values);
+      m_Lru.push_front(blockIndex);
+      block.lruPosition = m_Lru.begin();
+    }
+    if(markDirty)
+    {
+      block.isDirty = true;
+    }
+    m_LastIndex = blockIndex;
+    m_LastValues = block.values.get();
+    return m_LastValues;
+  }
+
+  /**
+   * @brief Evicts least recently used blocks until at most maxResident blocks
+   * remain in memory. Dirty blocks the evict function refuses are skipped.
+   * @param maxResident
+   */
+  void evict(size_t maxResident)
+  {
+    auto iter = m_Lru.end();
+    while(m_Lru.size() > maxResident && iter != m_Lru.begin())
+    {
+      --iter;
+      const size_t blockIndex = *iter;
+      Block& block = m_Blocks[blockIndex];
+      if(block.isDirty && !m_Evict(blockIndex, block.values.get()))
+      {
+        continue;
+      }
+      block.values.reset();
+      block.isDirty = false;
+      iter = m_Lru.erase(iter);
+      if(blockIndex == m_LastIndex)
+      {
+        invalidateLast();
+      }
+    }
+  }
+
+  /**
+   * @brief Drops the block from memory without calling the evict function.
+   * @param blockIndex
+   */
+  void release(size_t blockIndex)
+  {
+    Block& block = m_Blocks[blockIndex];
+    if(block.values != nullptr)
+    {
+      m_Lru.erase(block.lruPosition);
+      block.values.reset();
+    }
+    block.isDirty = false;
+    if(blockIndex == m_LastIndex)
+    {
+      invalidateLast();
+    }
+  }
+
+  /**
+   * @brief Drops every block from memory without calling the evict function.
+   */
+  void clear()
+  {
+    for(size_t i = 0; i < m_Blocks.size(); i++)
+    {
+      release(i);
+    }
+  }
+
+  /**
+   * @brief Changes the number of blocks, which hold valueCount values in
+   * total. Blocks past the end are dropped. If zeroTail is true, the unused
+   * values at the end of the last block are set to zero so growing again
+   * reads zeros.
+   * @param blockCount
+   * @param valueCount
+   * @param zeroTail
+   */
+  void resize(size_t blockCount, size_t valueCount, bool zeroTail)
+  {
+    for(size_t i = blockCount; i < m_Blocks.size(); i++)
+    {
+      release(i);
+    }
+    m_Blocks.resize(blockCount);
+    invalidateLast();
+
+    if(!zeroTail || blockCount == 0)
+    {
+      return;
+    }
+    const size_t usedValues = valueCount - (blockCount - 1) * m_ValuesPerBlock;
+    if(usedValues < m_ValuesPerBlock)
+    {
+      T* lastValues = values(blockCount - 1, true);
+      std::fill(lastValues + usedValues, lastValues + m_ValuesPerBlock, T{});
+    }
+  }
+
+private:
+  struct Block
+  {
+    std::unique_ptr<T[]> values;
+    typename std::list<size_t>::iterator lruPosition;
+    bool isDirty = false;
+  };
+
+  /**
+   * @brief Clears the cached pointer to the most recently accessed block.
+   */
+  void invalidateLast()
+  {
+    m_LastIndex = 0;
+    m_LastValues = nullptr;
+  }
+
+  size_t m_ValuesPerBlock;
+  size_t m_MaxResident;
+  LoadFunction m_Load;
+  EvictFunction m_Evict;
+  std::vector<Block> m_Blocks;
+  std::list<size_t> m_Lru;
+  size_t m_LastIndex = 0;
+  T* m_LastValues = nullptr;
+  mutable std::mutex m_Mutex;
+};
+} // namespace complex
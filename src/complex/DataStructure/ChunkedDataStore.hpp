@@ -0,0 +1,432 @@
+#pragma once
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "complex/DataStructure/BlockCache.hpp"
+#include "complex/DataStructure/IDataStore.hpp"
+#include "complex/Utilities/BulkCopy.hpp"
+
+namespace complex
+{
+/**
+ * @class ChunkedDataStore
+ * @brief The ChunkedDataStore class is an IDataStore that splits its tuples
+ * into fixed-size chunks and only keeps a bounded number of them in memory.
+ * Chunks are allocated on first use, so values that are never touched cost
+ * no memory and read as zero. Resident chunks are tracked in a least recently
+ * used list. When more than the maximum number of chunks are resident, the
+ * least recently used chunk is evicted:
+ * - clean chunks are simply released,
+ * - dirty chunks are written to a scratch file when a scratch directory was
+ *   provided and reloaded from it on the next access. Without a scratch
+ *   directory, dirty chunks cannot be evicted and stay resident.
+ *
+ * References returned by operator[] point into a resident chunk and are only
+ * valid until another chunk is accessed. Writing through the non-const
+ * operator[] marks the chunk as dirty.
+ *
+ * Even reads change which chunks are resident, so the chunk cache (see
+ * BlockCache) is guarded by a mutex. getValue() and setValue() may be called from several threads at
+ * once. References returned by operator[] and at() may be invalidated by
+ * any other thread's access, so concurrent readers must use getValue().
+ * @tparam T
+ */
+template <typename T>
+class ChunkedDataStore : public IDataStore<T>
+{
+public:
+  static_assert(std::is_trivially_copyable_v<T>, "ChunkedDataStore requires a trivially copyable value type");
+
+  using value_type = typename IDataStore<T>::value_type;
+  using reference = typename IDataStore<T>::reference;
+  using const_reference = typename IDataStore<T>::const_reference;
+
+  /**
+   * @brief Constructs a ChunkedDataStore with the specified tuple size and
+   * count. Tuples are grouped into chunks of tuplesPerChunk tuples and at most
+   * maxResidentChunks chunks are kept in memory. If a scratch directory is
+   * provided, dirty chunks are spilled to a scratch file inside it on eviction.
+   * @param tupleSize
+   * @param tupleCount
+   * @param tuplesPerChunk
+   * @param maxResidentChunks
+   * @param scratchDirectory = {}
+   */
+  ChunkedDataStore(size_t tupleSize, size_t tupleCount, size_t tuplesPerChunk, size_t maxResidentChunks, const std::optional<std::filesystem::path>& scratchDirectory = {})
+  : m_TupleSize(tupleSize)
+  , m_TupleCount(tupleCount)
+  , m_TuplesPerChunk(tuplesPerChunk)
+  , m_MaxResidentChunks(maxResidentChunks)
+  , m_ScratchDirectory(scratchDirectory)
+  , m_Cache(tuplesPerChunk * tupleSize, maxResidentChunks, [this](size_t chunkIndex, T* values) { loadChunk(chunkIndex, values); },
+            [this](size_t chunkIndex, const T* values) { return spillChunk(chunkIndex, values); })
+  {
+    if(m_TuplesPerChunk == 0)
+    {
+      throw std::runtime_error("ChunkedDataStore requires at least one tuple per chunk");
+    }
+    if(m_MaxResidentChunks == 0)
+    {
+      throw std::runtime_error("ChunkedDataStore requires at least one resident chunk");
+    }
+    m_IsSpilled.resize(chunkCountFor(m_TupleCount));
+    m_Cache.resize(m_IsSpilled.size(), this->getSize(), false);
+  }
+
+  ChunkedDataStore(const ChunkedDataStore& other) = delete;
+
+  virtual ~ChunkedDataStore()
+  {
+    closeSpillFile();
+  }
+
+  /**
+   * @brief Returns the number of tuples in the ChunkedDataStore.
+   * @return size_t
+   */
+  size_t getTupleCount() const override
+  {
+    return m_TupleCount;
+  }
+
+  /**
+   * @brief Returns the tuple size.
+   * @return size_t
+   */
+  size_t getTupleSize() const override
+  {
+    return m_TupleSize;
+  }
+
+  /**
+   * @brief Returns the number of tuples stored in each chunk.
+   * @return size_t
+   */
+  size_t getTuplesPerChunk() const
+  {
+    return m_TuplesPerChunk;
+  }
+
+  /**
+   * @brief Returns the number of chunks used to cover all tuples.
+   * @return size_t
+   */
+  size_t getChunkCount() const
+  {
+    return m_IsSpilled.size();
+  }
+
+  /**
+   * @brief Returns the maximum number of chunks kept in memory.
+   * @return size_t
+   */
+  size_t getMaxResidentChunks() const
+  {
+    return m_MaxResidentChunks;
+  }
+
+  /**
+   * @brief Returns the number of chunks currently held in memory.
+   * @return size_t
+   */
+  size_t getResidentChunkCount() const
+  {
+    std::lock_guard<std::mutex> lock(m_Cache.getMutex());
+    return m_Cache.getResidentCount();
+  }
+
+  /**
+   * @brief Returns true if dirty chunks are spilled to a scratch directory.
+   * @return bool
+   */
+  bool canSpill() const
+  {
+    return m_ScratchDirectory.has_value();
+  }
+
+  /**
+   * @brief Resizes the ChunkedDataStore to handle the specified number of
+   * tuples. Values added by growing the store read as zero.
+   * @param numTuples
+   */
+  void resizeTuples(size_t numTuples) override
+  {
+    std::lock_guard<std::mutex> lock(m_Cache.getMutex());
+    const size_t newChunkCount = chunkCountFor(numTuples);
+    const bool zeroTail = newChunkCount > 0 && newChunkCount <= m_IsSpilled.size() && isAllocated(newChunkCount - 1);
+    m_IsSpilled.resize(newChunkCount);
+    m_TupleCount = numTuples;
+    m_Cache.resize(newChunkCount, this->getSize(), zeroTail);
+  }
+
+  /**
+   * @brief Returns the value found at the specified index of the ChunkedDataStore.
+   * This cannot be used to edit the value found at the specified index.
+   * @param index
+   * @return value_type
+   */
+  value_type getValue(size_t index) const override
+  {
+    std::lock_guard<std::mutex> lock(m_Cache.getMutex());
+    const size_t chunkSize = valuesPerChunk();
+    return m_Cache.values(index / chunkSize, false)[index % chunkSize];
+  }
+
+  /**
+   * @brief Sets the value stored at the specified index.
+   * @param index
+   * @param value
+   */
+  void setValue(size_t index, value_type value) override
+  {
+    std::lock_guard<std::mutex> lock(m_Cache.getMutex());
+    const size_t chunkSize = valuesPerChunk();
+    m_Cache.values(index / chunkSize, true)[index % chunkSize] = value;
+  }
+
+  /**
+   * @brief Returns the value found at the specified index of the ChunkedDataStore.
+   * This cannot be used to edit the value found at the specified index. The
+   * reference is only valid until another chunk is accessed.
+   * @param index
+   * @return const_reference
+   */
+  const_reference operator[](size_t index) const override
+  {
+    std::lock_guard<std::mutex> lock(m_Cache.getMutex());
+    const size_t chunkSize = valuesPerChunk();
+    return m_Cache.values(index / chunkSize, false)[index % chunkSize];
+  }
+
+  /**
+   * @brief Returns the value found at the specified index of the ChunkedDataStore.
+   * This can be used to edit the value found at the specified index and marks
+   * the chunk as dirty. The reference is only valid until another chunk is
+   * accessed.
+   * @param index
+   * @return reference
+   */
+  reference operator[](size_t index) override
+  {
+    std::lock_guard<std::mutex> lock(m_Cache.getMutex());
+    const size_t chunkSize = valuesPerChunk();
+    return m_Cache.values(index / chunkSize, true)[index % chunkSize];
+  }
+
+  /**
+   * @brief Returns the value found at the specified index of the ChunkedDataStore.
+   * Throws an exception if the index is out of range.
+   * @param index
+   * @return const_reference
+   */
+  const_reference at(size_t index) const override
+  {
+    if(index >= this->getSize())
+    {
+      throw std::runtime_error("ChunkedDataStore index out of range");
+    }
+    return (*this)[index];
+  }
+
+  /**
+   * @brief Fills the ChunkedDataStore with the specified value. Filling with
+   * zero releases every chunk instead of touching them.
+   * @param value
+   */
+  void fill(value_type value) override
+  {
+    std::lock_guard<std::mutex> lock(m_Cache.getMutex());
+    if(value == T{})
+    {
+      m_Cache.clear();
+      std::fill(m_IsSpilled.begin(), m_IsSpilled.end(), false);
+      return;
+    }
+    const size_t size = this->getSize();
+    for(size_t i = 0; i < m_IsSpilled.size(); i++)
+    {
+      T* values = m_Cache.values(i, true);
+      const size_t count = std::min(valuesPerChunk(), size - i * valuesPerChunk());
+      std::fill(values, values + count, value);
+    }
+  }
+
+  /**
+   * @brief Returns a deep copy of the data store and all its data. Only chunks
+   * that have been written to are copied.
+   * @return IDataStore*
+   */
+  IDataStore<T>* deepCopy() const override
+  {
+    std::lock_guard<std::mutex> lock(m_Cache.getMutex());
+    auto copy = new ChunkedDataStore(m_TupleSize, m_TupleCount, m_TuplesPerChunk, m_MaxResidentChunks, m_ScratchDirectory);
+    for(size_t i = 0; i < m_IsSpilled.size(); i++)
+    {
+      if(!isAllocated(i))
+      {
+        continue;
+      }
+      const T* source = m_Cache.values(i, false);
+      T* destination = copy->m_Cache.values(i, true);
+      BulkCopy::CopyValues(source, destination, valuesPerChunk());
+    }
+    return copy;
+  }
+
+private:
+  /**
+   * @brief Returns the number of values held by each chunk.
+   * @return size_t
+   */
+  size_t valuesPerChunk() const
+  {
+    return m_TuplesPerChunk * m_TupleSize;
+  }
+
+  /**
+   * @brief Returns the number of chunks required for the specified number of tuples.
+   * @param tupleCount
+   * @return size_t
+   */
+  size_t chunkCountFor(size_t tupleCount) const
+  {
+    return (tupleCount + m_TuplesPerChunk - 1) / m_TuplesPerChunk;
+  }
+
+  /**
+   * @brief Returns true if the chunk holds values other than the implicit zeros.
+   * @param chunkIndex
+   * @return bool
+   */
+  bool isAllocated(size_t chunkIndex) const
+  {
+    return m_Cache.residentValues(chunkIndex) != nullptr || m_IsSpilled[chunkIndex];
+  }
+
+  /**
+   * @brief Fills a newly resident chunk, reloading it from the scratch file if
+   * it was spilled. Chunks that were never spilled read as zero.
+   * @param chunkIndex
+   * @param values
+   */
+  void loadChunk(size_t chunkIndex, T* values) const
+  {
+    if(m_IsSpilled[chunkIndex])
+    {
+      readChunk(chunkIndex, values);
+    }
+  }
+
+  /**
+   * @brief Writes a dirty chunk to the scratch file before it is evicted.
+   * Returns false if there is no scratch directory, which keeps the chunk
+   * resident.
+   * @param chunkIndex
+   * @param values
+   * @return bool
+   */
+  bool spillChunk(size_t chunkIndex, const T* values) const
+  {
+    if(!canSpill())
+    {
+      return false;
+    }
+    writeChunk(chunkIndex, values);
+    return true;
+  }
+
+  /**
+   * @brief Opens the scratch file used for spilling if it is not already open.
+   */
+  void openSpillFile() const
+  {
+    if(m_SpillFile.is_open())
+    {
+      return;
+    }
+    std::mt19937_64 generator(std::random_device{}());
+    m_SpillPath = m_ScratchDirectory.value() / fmt::format("complex-chunks-{:016x}.tmp", generator());
+    m_SpillFile.open(m_SpillPath, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    if(!m_SpillFile.is_open())
+    {
+      throw std::runtime_error(fmt::format("Unable to open chunk scratch file \"{}\"", m_SpillPath.string()));
+    }
+  }
+
+  /**
+   * @brief Closes and removes the scratch file used for spilling.
+   */
+  void closeSpillFile() noexcept
+  {
+    if(!m_SpillFile.is_open())
+    {
+      return;
+    }
+    m_SpillFile.close();
+    std::error_code errorCode;
+    std::filesystem::remove(m_SpillPath, errorCode);
+  }
+
+  /**
+   * @brief Writes the chunk's values to its slot in the scratch file.
+   * @param chunkIndex
+   * @param values
+   */
+  void writeChunk(size_t chunkIndex, const T* values) const
+  {
+    openSpillFile();
+    const size_t chunkBytes = valuesPerChunk() * sizeof(T);
+    // A failed operation leaves the stream in a failed state, which would make every later one fail too
+    m_SpillFile.clear();
+    m_SpillFile.seekp(static_cast<std::streamoff>(chunkIndex * chunkBytes));
+    m_SpillFile.write(reinterpret_cast<const char*>(values), static_cast<std::streamsize>(chunkBytes));
+    m_SpillFile.flush();
+    if(!m_SpillFile.good())
+    {
+      m_SpillFile.clear();
+      throw std::runtime_error(fmt::format("Unable to spill chunk {} to \"{}\"", chunkIndex, m_SpillPath.string()));
+    }
+    m_IsSpilled[chunkIndex] = true;
+  }
+
+  /**
+   * @brief Reads the chunk's values back from its slot in the scratch file.
+   * @param chunkIndex
+   * @param values
+   */
+  void readChunk(size_t chunkIndex, T* values) const
+  {
+    const size_t chunkBytes = valuesPerChunk() * sizeof(T);
+    m_SpillFile.clear();
+    m_SpillFile.seekg(static_cast<std::streamoff>(chunkIndex * chunkBytes));
+    m_SpillFile.read(reinterpret_cast<char*>(values), static_cast<std::streamsize>(chunkBytes));
+    if(!m_SpillFile.good())
+    {
+      m_SpillFile.clear();
+      throw std::runtime_error(fmt::format("Unable to reload chunk {} from \"{}\"", chunkIndex, m_SpillPath.string()));
+    }
+  }
+
+  size_t m_TupleSize;
+  size_t m_TupleCount;
+  size_t m_TuplesPerChunk;
+  size_t m_MaxResidentChunks;
+  std::optional<std::filesystem::path> m_ScratchDirectory;
+  mutable std::vector<bool> m_IsSpilled;
+  mutable std::filesystem::path m_SpillPath;
+  mutable std::fstream m_SpillFile;
+  mutable BlockCache<T> m_Cache;
+};
+} // namespace complex
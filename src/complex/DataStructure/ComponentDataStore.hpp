@@ -0,0 +1,246 @@
+#pragma once
+
+#include <memory>
+#include <stdexcept>
+
+#include "complex/DataStructure/DataStore.hpp"
+#include "complex/DataStructure/IDataStore.hpp"
+
+namespace complex
+{
+/**
+ * @class ComponentDataStore
+ * @brief The ComponentDataStore class is a zero-copy, single-component view
+ * of one component of another IDataStore. Reads and writes go directly to
+ * the viewed store, which is kept alive by the view. The view is contiguous
+ * when the viewed store holds the component contiguously, e.g. a
+ * PlanarDataStore. Otherwise, values are accessed with a stride of the
+ * viewed store's tuple size. A view cannot be resized.
+ *
+ * Writable access through the view marks the viewed store as modified, so
+ * data cached against the viewed store's version is recomputed.
+ *
+ * Views bypass the DataArray copy-on-write of the viewed store, so DataArray
+ * copies both of the view and of an array whose store is viewed copy their
+ * values immediately instead of sharing them. A copied DataStructure
+ * therefore holds a plain copy of the component rather than a view.
+ *
+ * Wrapping the view in a DataArray created through
+ * DataStructure::createDataArray() exposes a single component as its own
+ * array.
+ * @tparam T
+ */
+template <typename T>
+class ComponentDataStore : public IDataStore<T>
+{
+public:
+  using value_type = typename IDataStore<T>::value_type;
+  using reference = typename IDataStore<T>::reference;
+  using const_reference = typename IDataStore<T>::const_reference;
+  using pointer = typename IDataStore<T>::pointer;
+  using const_pointer = typename IDataStore<T>::const_pointer;
+
+  /**
+   * @brief Constructs a view of the specified component of the provided
+   * store. Throws an exception if the store is null or the component is out
+   * of range.
+   * @param store
+   * @param component
+   */
+  ComponentDataStore(const std::shared_ptr<IDataStore<T>>& store, size_t component)
+  : m_Store(store)
+  , m_Component(component)
+  {
+    if(m_Store == nullptr)
+    {
+      throw std::runtime_error("ComponentDataStore requires a DataStore to view");
+    }
+    if(m_Component >= m_Store->getTupleSize())
+    {
+      throw std::runtime_error("ComponentDataStore component out of range");
+    }
+  }
+
+  virtual ~ComponentDataStore() = default;
+
+  /**
+   * @brief Returns the number of tuples in the viewed store.
+   * @return size_t
+   */
+  size_t getTupleCount() const override
+  {
+    return m_Store->getTupleCount();
+  }
+
+  /**
+   * @brief Returns 1.
+   * @return size_t
+   */
+  size_t getTupleSize() const override
+  {
+    return 1;
+  }
+
+  /**
+   * @brief Returns the viewed component.
+   * @return size_t
+   */
+  size_t getComponent() const
+  {
+    return m_Component;
+  }
+
+  /**
+   * @brief Throws an exception. Resize the viewed store instead.
+   */
+  void resizeTuples(size_t) override
+  {
+    throw std::runtime_error("ComponentDataStore cannot be resized");
+  }
+
+  /**
+   * @brief Returns the value of the viewed component in the specified tuple.
+   * @param index
+   * @return value_type
+   */
+  value_type getValue(size_t index) const override
+  {
+    return (*this)[index];
+  }
+
+  /**
+   * @brief Sets the value of the viewed component in the specified tuple.
+   * @param index
+   * @param value
+   */
+  void setValue(size_t index, value_type value) override
+  {
+    (*this)[index] = value;
+  }
+
+  /**
+   * @brief Returns the value of the viewed component in the specified tuple.
+   * This cannot be used to edit the value.
+   * @param index
+   * @return const_reference
+   */
+  const_reference operator[](size_t index) const override
+  {
+    const IDataStore<T>& store = *m_Store;
+    if(const_pointer values = store.componentData(m_Component); values != nullptr)
+    {
+      return values[index];
+    }
+    return store[index * store.getTupleSize() + m_Component];
+  }
+
+  /**
+   * @brief Returns the value of the viewed component in the specified tuple.
+   * This can be used to edit the value. Marks the viewed store as modified.
+   * @param index
+   * @return reference
+   */
+  reference operator[](size_t index) override
+  {
+    m_Store->markModified();
+    if(pointer values = m_Store->componentData(m_Component); values != nullptr)
+    {
+      return values[index];
+    }
+    return (*m_Store)[index * m_Store->getTupleSize() + m_Component];
+  }
+
+  /**
+   * @brief Returns the value of the viewed component in the specified tuple.
+   * Throws an exception if the index is out of range.
+   * @param index
+   * @return const_reference
+   */
+  const_reference at(size_t index) const override
+  {
+    if(index >= this->getSize())
+    {
+      throw std::runtime_error("ComponentDataStore index out of range");
+    }
+    return (*this)[index];
+  }
+
+  /**
+   * @brief Returns true if the viewed store holds the component contiguously.
+   * @return bool
+   */
+  bool isContiguous() const override
+  {
+    return data() != nullptr;
+  }
+
+  /**
+   * @brief Returns a pointer to the viewed component's values or nullptr if
+   * they are not contiguous. Marks the viewed store as modified.
+   * @return pointer
+   */
+  pointer data() override
+  {
+    m_Store->markModified();
+    return m_Store->componentData(m_Component);
+  }
+
+  /**
+   * @brief Returns a read-only pointer to the viewed component's values or
+   * nullptr if they are not contiguous.
+   * @return const_pointer
+   */
+  const_pointer data() const override
+  {
+    return static_cast<const IDataStore<T>&>(*m_Store).componentData(m_Component);
+  }
+
+  /**
+   * @brief Fills the viewed component with the specified value. Other
+   * components are not modified.
+   * @param value
+   */
+  void fill(value_type value) override
+  {
+    const size_t count = getTupleCount();
+    for(size_t i = 0; i < count; i++)
+    {
+      (*this)[i] = value;
+    }
+  }
+
+  /**
+   * @brief Returns a single-component DataStore holding a copy of the viewed
+   * component's values. The copy no longer refers to the viewed store.
+   * @return IDataStore*
+   */
+  IDataStore<T>* deepCopy() const override
+  {
+    const size_t count = getTupleCount();
+    auto copy = new DataStore<T>(1, count);
+    if(const_pointer values = data(); values != nullptr)
+    {
+      BulkCopy::CopyValues(values, copy->data(), count);
+      return copy;
+    }
+    for(size_t i = 0; i < count; i++)
+    {
+      (*copy)[i] = (*this)[i];
+    }
+    return copy;
+  }
+
+  /**
+   * @brief Returns true.
+   * @return bool
+   */
+  bool viewsAnotherStore() const override
+  {
+    return true;
+  }
+
+private:
+  std::shared_ptr<IDataStore<T>> m_Store;
+  size_t m_Component;
+};
+} // namespace complex
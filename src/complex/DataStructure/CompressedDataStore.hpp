@@ -0,0 +1,387 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "complex/DataStructure/BlockCache.hpp"
+#include "complex/DataStructure/IDataStore.hpp"
+#include "complex/Utilities/BlockCodec.hpp"
+#include "complex/Utilities/BulkCopy.hpp"
+
+namespace complex
+{
+/**
+ * @class CompressedDataStore
+ * @brief The CompressedDataStore class is an IDataStore that keeps its values
+ * compressed in fixed-size blocks using BlockCodec. It is intended for arrays
+ * that are written once and rarely read afterwards, such as phase IDs, masks
+ * or feature IDs. Blocks are decompressed on access and a small number of
+ * decompressed "hot" blocks are kept in a least recently used list. Modified
+ * hot blocks are recompressed when they are evicted or when compact() is
+ * called. Blocks that were never written cost no memory and read as zero.
+ *
+ * References returned by operator[] point into a hot block and are only
+ * valid until another block is accessed. As with ChunkedDataStore, the hot
+ * blocks are kept in a BlockCache guarded by a mutex, so getValue() and
+ * setValue() may be called from several threads at once while references
+ * returned by operator[] may be invalidated by any other thread's access.
+ * @tparam T
+ */
+template <typename T>
+class CompressedDataStore : public IDataStore<T>
+{
+public:
+  static_assert(std::is_trivially_copyable_v<T>, "CompressedDataStore requires a trivially copyable value type");
+
+  using value_type = typename IDataStore<T>::value_type;
+  using reference = typename IDataStore<T>::reference;
+  using const_reference = typename IDataStore<T>::const_reference;
+
+  static constexpr size_t k_DefaultBlockSize = 64 * 1024;
+  static constexpr size_t k_DefaultMaxHotBlocks = 4;
+
+  /**
+   * @brief Constructs a zero-initialized CompressedDataStore with the
+   * specified tuple size and count. Blocks hold tuplesPerBlock tuples and at
+   * most maxHotBlocks blocks are kept decompressed. By default, blocks are
+   * sized to roughly k_DefaultBlockSize bytes.
+   * @param tupleSize
+   * @param tupleCount
+   * @param tuplesPerBlock = 0
+   * @param maxHotBlocks = k_DefaultMaxHotBlocks
+   */
+  CompressedDataStore(size_t tupleSize, size_t tupleCount, size_t tuplesPerBlock = 0, size_t maxHotBlocks = k_DefaultMaxHotBlocks)
+  : m_TupleSize(tupleSize)
+  , m_TupleCount(tupleCount)
+  , m_TuplesPerBlock(tuplesPerBlock != 0 ? tuplesPerBlock : std::max<size_t>(k_DefaultBlockSize / (sizeof(T) * std::max<size_t>(tupleSize, 1)), 1))
+  , m_MaxHotBlocks(maxHotBlocks)
+  , m_Cache(m_TuplesPerBlock * m_TupleSize, maxHotBlocks, [this](size_t blockIndex, T* values) { decompress(blockIndex, values); },
+            [this](size_t blockIndex, const T* values) {
+              m_Compressed[blockIndex] = compress(values);
+              return true;
+            })
+  {
+    if(m_MaxHotBlocks == 0)
+    {
+      throw std::runtime_error("CompressedDataStore requires at least one hot block");
+    }
+    m_Compressed.resize(blockCountFor(m_TupleCount));
+    m_Cache.resize(m_Compressed.size(), this->getSize(), false);
+  }
+
+  /**
+   * @brief Constructs a CompressedDataStore holding a compressed copy of the
+   * values in the provided store, e.g. to replace a DataStore in place
+   * through DataArray::setDataStore().
+   * @param source
+   * @param tuplesPerBlock = 0
+   * @param maxHotBlocks = k_DefaultMaxHotBlocks
+   */
+  explicit CompressedDataStore(const IDataStore<T>& source, size_t tuplesPerBlock = 0, size_t maxHotBlocks = k_DefaultMaxHotBlocks)
+  : CompressedDataStore(source.getTupleSize(), source.getTupleCount(), tuplesPerBlock, maxHotBlocks)
+  {
+    const size_t size = this->getSize();
+    const T* sourceData = source.data();
+    std::vector<T> values(valuesPerBlock());
+    for(size_t i = 0; i < m_Compressed.size(); i++)
+    {
+      const size_t offset = i * valuesPerBlock();
+      const size_t count = std::min(valuesPerBlock(), size - offset);
+      if(sourceData != nullptr)
+      {
+        BulkCopy::CopyValues(sourceData + offset, values.data(), count);
+      }
+      else
+      {
+        for(size_t j = 0; j < count; j++)
+        {
+          values[j] = source[offset + j];
+        }
+      }
+      std::fill(values.begin() + count, values.end(), T{});
+      m_Compressed[i] = compress(values.data());
+    }
+  }
+
+  CompressedDataStore(const CompressedDataStore& other) = delete;
+
+  virtual ~CompressedDataStore() = default;
+
+  /**
+   * @brief Returns the number of tuples in the CompressedDataStore.
+   * @return size_t
+   */
+  size_t getTupleCount() const override
+  {
+    return m_TupleCount;
+  }
+
+  /**
+   * @brief Returns the tuple size.
+   * @return size_t
+   */
+  size_t getTupleSize() const override
+  {
+    return m_TupleSize;
+  }
+
+  /**
+   * @brief Returns the number of tuples stored in each block.
+   * @return size_t
+   */
+  size_t getTuplesPerBlock() const
+  {
+    return m_TuplesPerBlock;
+  }
+
+  /**
+   * @brief Returns the number of blocks used to cover all tuples.
+   * @return size_t
+   */
+  size_t getBlockCount() const
+  {
+    return m_Compressed.size();
+  }
+
+  /**
+   * @brief Returns the number of blocks currently held decompressed.
+   * @return size_t
+   */
+  size_t getHotBlockCount() const
+  {
+    std::lock_guard<std::mutex> lock(m_Cache.getMutex());
+    return m_Cache.getResidentCount();
+  }
+
+  /**
+   * @brief Returns the number of bytes held by compressed blocks. Hot blocks
+   * that were modified since they were last compressed are not included.
+   * @return size_t
+   */
+  size_t getCompressedByteCount() const
+  {
+    std::lock_guard<std::mutex> lock(m_Cache.getMutex());
+    size_t byteCount = 0;
+    for(const auto& compressed : m_Compressed)
+    {
+      byteCount += compressed.size();
+    }
+    return byteCount;
+  }
+
+  /**
+   * @brief Recompresses all modified hot blocks and releases every hot block.
+   */
+  void compact()
+  {
+    std::lock_guard<std::mutex> lock(m_Cache.getMutex());
+    m_Cache.evict(0);
+  }
+
+  /**
+   * @brief Resizes the CompressedDataStore to handle the specified number of
+   * tuples. Values added by growing the store read as zero.
+   * @param numTuples
+   */
+  void resizeTuples(size_t numTuples) override
+  {
+    std::lock_guard<std::mutex> lock(m_Cache.getMutex());
+    const size_t newBlockCount = blockCountFor(numTuples);
+    const bool zeroTail = newBlockCount > 0 && newBlockCount <= m_Compressed.size() && isAllocated(newBlockCount - 1);
+    m_Compressed.resize(newBlockCount);
+    m_TupleCount = numTuples;
+    m_Cache.resize(newBlockCount, this->getSize(), zeroTail);
+  }
+
+  /**
+   * @brief Returns the value found at the specified index of the CompressedDataStore.
+   * This cannot be used to edit the value found at the specified index.
+   * @param index
+   * @return value_type
+   */
+  value_type getValue(size_t index) const override
+  {
+    std::lock_guard<std::mutex> lock(m_Cache.getMutex());
+    const size_t blockSize = valuesPerBlock();
+    return m_Cache.values(index / blockSize, false)[index % blockSize];
+  }
+
+  /**
+   * @brief Sets the value stored at the specified index.
+   * @param index
+   * @param value
+   */
+  void setValue(size_t index, value_type value) override
+  {
+    std::lock_guard<std::mutex> lock(m_Cache.getMutex());
+    const size_t blockSize = valuesPerBlock();
+    m_Cache.values(index / blockSize, true)[index % blockSize] = value;
+  }
+
+  /**
+   * @brief Returns the value found at the specified index of the CompressedDataStore.
+   * This cannot be used to edit the value found at the specified index. The
+   * reference is only valid until another block is accessed.
+   * @param index
+   * @return const_reference
+   */
+  const_reference operator[](size_t index) const override
+  {
+    std::lock_guard<std::mutex> lock(m_Cache.getMutex());
+    const size_t blockSize = valuesPerBlock();
+    return m_Cache.values(index / blockSize, false)[index % blockSize];
+  }
+
+  /**
+   * @brief Returns the value found at the specified index of the CompressedDataStore.
+   * This can be used to edit the value found at the specified index and marks
+   * the block as modified. The reference is only valid until another block is
+   * accessed.
+   * @param index
+   * @return reference
+   */
+  reference operator[](size_t index) override
+  {
+    std::lock_guard<std::mutex> lock(m_Cache.getMutex());
+    const size_t blockSize = valuesPerBlock();
+    return m_Cache.values(index / blockSize, true)[index % blockSize];
+  }
+
+  /**
+   * @brief Returns the value found at the specified index of the CompressedDataStore.
+   * Throws an exception if the index is out of range.
+   * @param index
+   * @return const_reference
+   */
+  const_reference at(size_t index) const override
+  {
+    if(index >= this->getSize())
+    {
+      throw std::runtime_error("CompressedDataStore index out of range");
+    }
+    return (*this)[index];
+  }
+
+  /**
+   * @brief Fills the CompressedDataStore with the specified value. Every full
+   * block shares the result of compressing a single block. Filling with zero
+   * releases every block instead.
+   * @param value
+   */
+  void fill(value_type value) override
+  {
+    std::lock_guard<std::mutex> lock(m_Cache.getMutex());
+    m_Cache.clear();
+    for(auto& compressed : m_Compressed)
+    {
+      compressed.clear();
+      compressed.shrink_to_fit();
+    }
+    if(value == T{} || m_Compressed.empty())
+    {
+      return;
+    }
+
+    std::vector<T> values(valuesPerBlock(), value);
+    const std::vector<u8> fullBlock = compress(values.data());
+    const size_t lastBlock = m_Compressed.size() - 1;
+    for(size_t i = 0; i < lastBlock; i++)
+    {
+      m_Compressed[i] = fullBlock;
+    }
+    const size_t lastCount = this->getSize() - lastBlock * valuesPerBlock();
+    std::fill(values.begin() + lastCount, values.end(), T{});
+    m_Compressed[lastBlock] = compress(values.data());
+  }
+
+  /**
+   * @brief Returns a deep copy of the data store and all its data. Compressed
+   * blocks are copied without decompressing them.
+   * @return IDataStore*
+   */
+  IDataStore<T>* deepCopy() const override
+  {
+    std::lock_guard<std::mutex> lock(m_Cache.getMutex());
+    auto copy = new CompressedDataStore(m_TupleSize, m_TupleCount, m_TuplesPerBlock, m_MaxHotBlocks);
+    for(size_t i = 0; i < m_Compressed.size(); i++)
+    {
+      const T* hotValues = m_Cache.residentValues(i);
+      if(hotValues != nullptr && m_Cache.isDirty(i))
+      {
+        copy->m_Compressed[i] = compress(hotValues);
+      }
+      else
+      {
+        copy->m_Compressed[i] = m_Compressed[i];
+      }
+    }
+    return copy;
+  }
+
+private:
+  /**
+   * @brief Returns the number of values held by each block.
+   * @return size_t
+   */
+  size_t valuesPerBlock() const
+  {
+    return m_TuplesPerBlock * m_TupleSize;
+  }
+
+  /**
+   * @brief Returns the number of blocks required for the specified number of tuples.
+   * @param tupleCount
+   * @return size_t
+   */
+  size_t blockCountFor(size_t tupleCount) const
+  {
+    return (tupleCount + m_TuplesPerBlock - 1) / m_TuplesPerBlock;
+  }
+
+  /**
+   * @brief Returns true if the block holds values other than the implicit zeros.
+   * @param blockIndex
+   * @return bool
+   */
+  bool isAllocated(size_t blockIndex) const
+  {
+    return m_Cache.residentValues(blockIndex) != nullptr || !m_Compressed[blockIndex].empty();
+  }
+
+  /**
+   * @brief Compresses a full block of values.
+   * @param values
+   * @return std::vector<u8>
+   */
+  std::vector<u8> compress(const T* values) const
+  {
+    return BlockCodec::Compress(values, valuesPerBlock() * sizeof(T), sizeof(T));
+  }
+
+  /**
+   * @brief Decompresses the block into a newly hot block. Blocks that were
+   * never written read as zero.
+   * @param blockIndex
+   * @param values
+   */
+  void decompress(size_t blockIndex, T* values) const
+  {
+    const std::vector<u8>& compressed = m_Compressed[blockIndex];
+    if(!compressed.empty())
+    {
+      BlockCodec::Decompress(compressed.data(), compressed.size(), values, valuesPerBlock() * sizeof(T), sizeof(T));
+    }
+  }
+
+  size_t m_TupleSize;
+  size_t m_TupleCount;
+  size_t m_TuplesPerBlock;
+  size_t m_MaxHotBlocks;
+  mutable std::vector<std::vector<u8>> m_Compressed;
+  mutable BlockCache<T> m_Cache;
+};
+} // namespace complex
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
 
 #include "complex/DataStructure/DataObject.hpp"
@@ -12,6 +15,11 @@ namespace complex
  * @brief The DataArray class is a type of DataObject that exists to store and
  * retrieve array data within the DataStructure. The DataArray is designed to
  * allow expandability into multiple sources of data, including out-of-core data.
+ *
+ * Copies of a DataArray share the DataStore copy-on-write. The first call to
+ * a non-const accessor on a copy that still shares its DataStore replaces it
+ * with a deep copy, leaving every other copy untouched. DataArrays that were
+ * given the same DataStore explicitly through setDataStore() keep sharing it.
  */
 template <class T>
 class DataArray : public DataObject
@@ -20,6 +28,8 @@ public:
   using value_type = T;
   using reference = T&;
   using const_reference = const T&;
+  using pointer = T*;
+  using const_pointer = const T*;
   using store_type = IDataStore<T>;
   using weak_store = typename std::weak_ptr<IDataStore<T>>;
   using Iterator = typename IDataStore<T>::Iterator;
@@ -53,13 +63,15 @@ public:
 
   /**
    * @brief Copy constructor creates a copy of the specified tuple size, count,
-   * and smart pointer to the target DataStore.
+   * and smart pointer to the target DataStore. The DataStore is shared
+   * copy-on-write unless it is also referenced outside of copy-on-write, see
+   * canShareDataStore(), in which case it is copied immediately.
    * @param other
    */
   DataArray(const DataArray<T>& other)
   : DataObject(other)
-  , m_DataStore(other.m_DataStore)
   {
+    copyDataStoreFrom(other);
   }
 
   /**
@@ -69,6 +81,7 @@ public:
   DataArray(DataArray<T>&& other) noexcept
   : DataObject(std::move(other))
   , m_DataStore(std::move(other.m_DataStore))
+  , m_CopyOnWriteToken(std::move(other.m_CopyOnWriteToken))
   {
   }
 
@@ -76,7 +89,8 @@ public:
 
   /**
    * @brief Returns a shallow copy of the DataArray without copying data
-   * store's contents.
+   * store's contents. The DataStore is copied on the first write to either
+   * DataArray.
    * @return DataObject*
    */
   DataObject* shallowCopy() override
@@ -91,7 +105,7 @@ public:
    */
   DataObject* deepCopy() override
   {
-    return new DataArray(getDataStructure(), getName(), getDataStore()->deepCopy());
+    return new DataArray(getDataStructure(), getName(), m_DataStore->deepCopy());
   }
 
   /**
@@ -135,6 +149,7 @@ public:
       throw std::runtime_error("");
     }
 
+    prepareWrite();
     return (*m_DataStore.get())[index];
   }
 
@@ -172,6 +187,85 @@ public:
     return (*m_DataStore.get())[index];
   }
 
+  /**
+   * @brief Returns true if the DataStore holds its values in a single
+   * contiguous buffer that can be accessed through data() or span().
+   * @return bool
+   */
+  bool isContiguous() const
+  {
+    return m_DataStore->isContiguous();
+  }
+
+  /**
+   * @brief Returns a pointer to the DataStore's contiguous buffer or nullptr
+   * if the DataStore is not contiguous. The pointer is invalidated whenever
+   * the DataStore is resized or replaced.
+   * @return pointer
+   */
+  pointer data()
+  {
+    prepareWrite();
+    return m_DataStore->data();
+  }
+
+  /**
+   * @brief Returns a read-only pointer to the DataStore's contiguous buffer or
+   * nullptr if the DataStore is not contiguous. The pointer is invalidated
+   * whenever the DataStore is resized or replaced.
+   * @return const_pointer
+   */
+  const_pointer data() const
+  {
+    return static_cast<const store_type*>(m_DataStore.get())->data();
+  }
+
+  /**
+   * @brief Returns a Span over the DataStore's values. The Span is empty if
+   * the DataStore is not contiguous.
+   * @return Span<T>
+   */
+  Span<T> span()
+  {
+    prepareWrite();
+    return m_DataStore->span();
+  }
+
+  /**
+   * @brief Returns a read-only Span over the DataStore's values. The Span is
+   * empty if the DataStore is not contiguous.
+   * @return Span<const T>
+   */
+  Span<const T> span() const
+  {
+    return static_cast<const store_type*>(m_DataStore.get())->span();
+  }
+
+  /**
+   * @brief Returns a Span over the specified component's values with one
+   * value per tuple. The Span is empty if the DataStore does not hold the
+   * component contiguously.
+   * @param component
+   * @return Span<T>
+   */
+  Span<T> componentSpan(size_t component)
+  {
+    prepareWrite();
+    return m_DataStore->componentSpan(component);
+  }
+
+  /**
+   * @brief Returns a read-only Span over the specified component's values
+   * with one value per tuple. The Span is empty if the DataStore does not
+   * hold the component contiguously.
+   * @param component
+   * @return Span<const T>
+   */
+  Span<const T> componentSpan(size_t component) const
+  {
+    return static_cast<const store_type*>(m_DataStore.get())->componentSpan(component);
+  }
+
   /**
    * @brief Returns a raw pointer to the DataStore for read-only access.
    * @return DataStore<T>*
@@ -187,6 +281,7 @@ public:
    */
   store_type* getDataStore()
   {
+    prepareWrite();
     return m_DataStore.get();
   }
 
@@ -196,6 +291,7 @@ public:
    */
   weak_store getDataStorePtr()
   {
+    prepareWrite();
     return m_DataStore;
   }
 
@@ -208,6 +304,48 @@ public:
     return m_DataStore != nullptr;
   }
 
+  /**
+   * @brief Returns true if the DataStore is still shared copy-on-write with
+   * another copy of this DataArray.
+   * @return bool
+   */
+  bool isDataStoreShared() const
+  {
+    return m_CopyOnWriteToken.use_count() > 1;
+  }
+
+  /**
+   * @brief Replaces the DataStore with a deep copy if it is still shared
+   * copy-on-write with another copy of this DataArray. Several threads may
+   * write through the same DataArray at once; only the first one copies the
+   * DataStore and the others wait for it.
+   */
+  void detach()
+  {
+    if(m_IsDetached.load(std::memory_order_acquire))
+    {
+      return;
+    }
+    std::lock_guard<std::mutex> lock(m_DetachMutex);
+    if(isDataStoreShared())
+    {
+      m_DataStore = std::shared_ptr<store_type>(m_DataStore->deepCopy());
+      m_CopyOnWriteToken = std::make_shared<CopyOnWriteToken>();
+    }
+    m_IsDetached.store(true, std::memory_order_release);
+  }
+
+  /**
+   * @brief Returns the version of the DataStore's values. Every non-const
+   * accessor marks the values as modified, so data derived from the array
+   * can be cached against the version. See IDataStore::getVersion().
+   * @return uint64_t
+   */
+  uint64_t getVersion() const
+  {
+    return m_DataStore->getVersion();
+  }
+
   /**
    * @brief Sets a new DataStore for the DataArray to handle. The existing DataStore
    * is deleted if there are no other references. To save the existing DataStore
@@ -216,6 +354,8 @@ public:
    */
   void setDataStore(store_type* store)
   {
+    m_CopyOnWriteToken = std::make_shared<CopyOnWriteToken>();
+    m_IsDetached = false;
     m_DataStore = std::shared_ptr<store_type>(store);
     if(m_DataStore == nullptr)
     {
@@ -231,6 +371,8 @@ public:
    */
   void setDataStore(const weak_store& store)
   {
+    m_CopyOnWriteToken = std::make_shared<CopyOnWriteToken>();
+    m_IsDetached = false;
     m_DataStore = store.lock();
     if(m_DataStore == nullptr)
     {
@@ -299,7 +441,7 @@ public:
    */
   DataArray& operator=(const DataArray& rhs)
   {
-    m_DataStore = rhs.m_DataStore;
+    copyDataStoreFrom(rhs);
     return *this;
   }
 
@@ -311,12 +453,72 @@ public:
   DataArray& operator=(DataArray&& rhs)
   {
     m_DataStore = std::move(rhs.m_DataStore);
+    m_CopyOnWriteToken = std::move(rhs.m_CopyOnWriteToken);
+    m_IsDetached = false;
     return *this;
   }
 
 protected:
 private:
+  /**
+   * @brief Returns true if the DataStore is only referenced by DataArrays
+   * sharing it copy-on-write. Stores that view another store and stores that
+   * are viewed or were handed out through getDataStorePtr() are written
+   * without going through prepareWrite(), so sharing them would let writes
+   * leak into copies.
+   * @return bool
+   */
+  bool canShareDataStore() const
+  {
+    if(m_DataStore == nullptr)
+    {
+      return true;
+    }
+    return !m_DataStore->viewsAnotherStore() && m_DataStore.use_count() <= m_CopyOnWriteToken.use_count();
+  }
+
+  /**
+   * @brief Shares the other DataArray's DataStore copy-on-write or copies it
+   * immediately if it cannot be shared.
+   * @param other
+   */
+  void copyDataStoreFrom(const DataArray& other)
+  {
+    m_IsDetached = false;
+    if(!other.canShareDataStore())
+    {
+      m_DataStore = std::shared_ptr<store_type>(other.m_DataStore->deepCopy());
+      m_CopyOnWriteToken = std::make_shared<CopyOnWriteToken>();
+      return;
+    }
+    m_DataStore = other.m_DataStore;
+    m_CopyOnWriteToken = other.m_CopyOnWriteToken;
+    other.m_IsDetached = false;
+  }
+
+  /**
+   * @brief Called by every non-const accessor before handing out writable
+   * access. Detaches a shared DataStore and marks the values as modified.
+   */
+  void prepareWrite()
+  {
+    detach();
+    m_DataStore->markModified();
+  }
+
+  /**
+   * @brief Empty type whose shared ownership tracks which DataArray copies
+   * still share the DataStore copy-on-write.
+   */
+  struct CopyOnWriteToken
+  {
+  };
+
   std::shared_ptr<IDataStore<T>> m_DataStore = nullptr;
+  std::shared_ptr<CopyOnWriteToken> m_CopyOnWriteToken = std::make_shared<CopyOnWriteToken>();
+  // Set once the DataStore is known not to be shared so writes can skip the lock. Copying the DataArray clears it again.
+  mutable std::atomic<bool> m_IsDetached = false;
+  std::mutex m_DetachMutex;
 };
 
 // Declare extern templates
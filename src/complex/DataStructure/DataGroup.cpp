@@ -25,7 +25,7 @@ DataGroup::~DataGroup() = default;
 DataObject* DataGroup::deepCopy()
 {
   auto copy = new DataGroup(getDataStructure(), getName());
-  for(auto& pair : getDataMap())
+  for(auto& pair : getDataMap().deepCopy())
   {
     copy->insert(pair.second);
   }
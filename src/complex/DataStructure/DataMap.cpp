@@ -12,17 +12,13 @@ DataMap::DataMap()
 
 DataMap::DataMap(const DataMap& other)
 : m_Map(other.m_Map)
+, m_NameIndex(other.m_NameIndex)
 {
-  auto keys = other.getKeys();
-  for(auto& key : keys)
-  {
-    DataObject* copy = other.m_Map.at(key)->deepCopy();
-    m_Map[key] = std::shared_ptr<DataObject>(copy);
-  }
 }
 
 DataMap::DataMap(DataMap&& other) noexcept
 : m_Map(std::move(other.m_Map))
+, m_NameIndex(std::move(other.m_NameIndex))
 {
 }
 
@@ -30,7 +26,7 @@ DataMap::~DataMap() = default;
 
 DataMap DataMap::deepCopy() const
 {
-  DataMap dataMap(*this);
+  DataMap dataMap;
 
   auto keys = getKeys();
   for(auto& key : keys)
@@ -38,12 +34,19 @@ DataMap DataMap::deepCopy() const
     DataObject* copy = m_Map.at(key)->deepCopy();
     dataMap.m_Map[key] = std::shared_ptr<DataObject>(copy);
   }
+  dataMap.m_NameIndex = m_NameIndex;
   return dataMap;
 }
 
 bool DataMap::insert(const std::shared_ptr<DataObject>& obj)
 {
-  m_Map[obj->getId()] = obj;
+  auto& entry = m_Map[obj->getId()];
+  if(entry != nullptr)
+  {
+    eraseName(entry->getName(), obj->getId());
+  }
+  entry = obj;
+  m_NameIndex.emplace(obj->getName(), obj->getId());
   return true;
 }
 
@@ -70,6 +73,7 @@ bool DataMap::erase(const Iterator& iter)
   {
     return false;
   }
+  eraseName(iter->second->getName(), iter->first);
   m_Map.erase(iter);
   return true;
 }
@@ -116,14 +120,7 @@ std::map<DataMap::IdType, std::weak_ptr<DataObject>> DataMap::getAllItems() cons
 
 bool DataMap::contains(const std::string& name) const
 {
-  for(auto& iter : m_Map)
-  {
-    if(iter.second->getName() == name)
-    {
-      return true;
-    }
-  }
-  return false;
+  return findName(name) != nullptr;
 }
 
 bool DataMap::contains(const DataObject* obj) const
@@ -160,26 +157,14 @@ const DataObject* DataMap::operator[](IdType key) const
 
 DataObject* DataMap::operator[](const std::string& name)
 {
-  for(auto& iter : m_Map)
-  {
-    if(iter.second->getName() == name)
-    {
-      return iter.second.get();
-    }
-  }
-  return nullptr;
+  auto iter = find(name);
+  return (iter == end()) ? nullptr : iter->second.get();
 }
 
 const DataObject* DataMap::operator[](const std::string& name) const
 {
-  for(auto& iter : m_Map)
-  {
-    if(iter.second->getName() == name)
-    {
-      return iter.second.get();
-    }
-  }
-  return nullptr;
+  auto iter = find(name);
+  return (iter == end()) ? nullptr : iter->second.get();
 }
 
 DataMap::Iterator DataMap::find(IdType id)
@@ -194,26 +179,53 @@ DataMap::ConstIterator DataMap::find(IdType id) const
 
 DataMap::Iterator DataMap::find(const std::string& name)
 {
-  for(auto iter = begin(); iter != end(); iter++)
+  const IdType* id = findName(name);
+  return (id == nullptr) ? end() : m_Map.find(*id);
+}
+
+DataMap::ConstIterator DataMap::find(const std::string& name) const
+{
+  const IdType* id = findName(name);
+  return (id == nullptr) ? end() : m_Map.find(*id);
+}
+
+void DataMap::updateName(IdType id, const std::string& oldName)
+{
+  auto iter = m_Map.find(id);
+  if(iter == m_Map.end())
+  {
+    return;
+  }
+  eraseName(oldName, id);
+  m_NameIndex.emplace(iter->second->getName(), id);
+}
+
+const DataMap::IdType* DataMap::findName(const std::string& name) const
+{
+  // Duplicate names are rare, so the range is short
+  const IdType* lowest = nullptr;
+  auto [first, last] = m_NameIndex.equal_range(name);
+  for(auto iter = first; iter != last; ++iter)
   {
-    if((*iter).second->getName() == name)
+    if(lowest == nullptr || iter->second < *lowest)
     {
-      return iter;
+      lowest = &iter->second;
     }
   }
-  return end();
+  return lowest;
 }
 
-DataMap::ConstIterator DataMap::find(const std::string& name) const
+void DataMap::eraseName(const std::string& name, IdType id)
 {
-  for(auto iter = begin(); iter != end(); iter++)
+  auto [first, last] = m_NameIndex.equal_range(name);
+  for(auto iter = first; iter != last; ++iter)
   {
-    if((*iter).second->getName() == name)
+    if(iter->second == id)
     {
-      return iter;
+      m_NameIndex.erase(iter);
+      return;
     }
   }
-  return end();
 }
 
 void DataMap::setDataStructure(DataStructure* dataStr)
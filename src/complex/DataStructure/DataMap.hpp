@@ -3,6 +3,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "complex/complex_export.hpp"
@@ -17,6 +18,11 @@ class DataObject;
  * @brief The DataMap class is used to handle lookup and storage of DataObjects
  * using the objects' ID values or names. The DataMap class is primarily used
  * within the BaseGroup and DataStructure classes as a consistent.
+ *
+ * Names are indexed so lookups by name take constant time. Names are not
+ * required to be unique; a name lookup finds the object with the lowest ID.
+ * The index is updated on insert and erase, and through updateName() when
+ * an object in the map is renamed.
  */
 class COMPLEX_EXPORT DataMap
 {
@@ -32,7 +38,8 @@ public:
   DataMap();
 
   /**
-   * @brief Copy constructor
+   * @brief Copy constructor. The copy shares the DataObjects held by the
+   * original. Use deepCopy() to copy the DataObjects themselves.
    * @param other
    */
   DataMap(const DataMap& other);
@@ -180,6 +187,14 @@ public:
    */
   ConstIterator find(const std::string& name) const;
 
+  /**
+   * @brief Updates the name index after the DataObject with the specified ID
+   * was renamed. Does nothing if the map does not hold the object.
+   * @param id
+   * @param oldName
+   */
+  void updateName(IdType id, const std::string& oldName);
+
   /**
    * @brief Sets a new DataStructure for all items in the DataMap.
    * @param dataStr
@@ -211,6 +226,21 @@ public:
   ConstIterator end() const;
 
 private:
+  /**
+   * @brief Returns the lowest ID indexed under the name, if any.
+   * @param name
+   * @return const IdType*
+   */
+  const IdType* findName(const std::string& name) const;
+
+  /**
+   * @brief Removes the index entry of the ID under the name.
+   * @param name
+   * @param id
+   */
+  void eraseName(const std::string& name, IdType id);
+
   MapType m_Map;
+  std::unordered_multimap<std::string, IdType> m_NameIndex;
 };
 } // namespace complex
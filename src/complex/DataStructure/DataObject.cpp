@@ -6,23 +6,24 @@
 #include "complex/DataStructure/BaseGroup.hpp"
 #include "complex/DataStructure/DataStructure.hpp"
 #include "complex/DataStructure/Metadata.hpp"
+#include "complex/DataStructure/Messaging/DataRenamedMessage.hpp"
 
 using namespace complex;
 
-DataObject::IdType DataObject::generateId(const std::optional<IdType>& opId)
+DataObject::IdType DataObject::generateId(DataStructure* ds)
 {
-  static IdType id = 0;
-  if(opId && opId > id)
+  if(ds == nullptr)
   {
-    id = opId.value();
+    return ObjectTable::CreateDetachedId();
   }
-  return id++;
+  return ds->m_ObjectTable.reserve();
 }
 
 DataObject::DataObject(DataStructure* ds, const std::string& name)
 : m_Name(name)
 , m_DataStructure(ds)
-, m_Id(generateId())
+, m_Id(generateId(ds))
+, m_Metadata(std::make_unique<Metadata>())
 , m_H5Id(-1)
 {
 }
@@ -31,6 +32,7 @@ DataObject::DataObject(const DataObject& other)
 : m_Name(other.m_Name)
 , m_DataStructure(other.m_DataStructure)
 , m_Id(other.m_Id)
+, m_Metadata(other.m_Metadata != nullptr ? std::make_unique<Metadata>(*other.m_Metadata) : std::make_unique<Metadata>())
 , m_H5Id(other.m_H5Id)
 {
 }
@@ -39,13 +41,17 @@ DataObject::DataObject(DataObject&& other) noexcept
 : m_Name(std::move(other.m_Name))
 , m_DataStructure(std::move(other.m_DataStructure))
 , m_Id(std::move(other.m_Id))
+, m_Metadata(std::move(other.m_Metadata))
 , m_H5Id(std::move(other.m_H5Id))
 {
 }
 
 DataObject::~DataObject()
 {
-  getDataStructure()->dataDeleted(getId(), getName());
+  if(m_DataStructure != nullptr)
+  {
+    m_DataStructure->dataDeleted(this);
+  }
 }
 
 DataObject::IdType DataObject::getId() const
@@ -67,6 +73,28 @@ void DataObject::setDataStructure(DataStructure* ds)
   m_DataStructure = ds;
 }
 
+void DataObject::serializeSnapshot(SnapshotArchive&)
+{
+}
+
+std::unique_lock<SharedRecursiveMutex> DataObject::lockHierarchy() const
+{
+  if(m_DataStructure == nullptr)
+  {
+    return {};
+  }
+  return std::unique_lock<SharedRecursiveMutex>(m_DataStructure->m_Mutex);
+}
+
+std::shared_lock<SharedRecursiveMutex> DataObject::lockHierarchyShared() const
+{
+  if(m_DataStructure == nullptr)
+  {
+    return {};
+  }
+  return std::shared_lock<SharedRecursiveMutex>(m_DataStructure->m_Mutex);
+}
+
 std::string DataObject::getName() const
 {
   return m_Name;
@@ -86,12 +114,26 @@ bool DataObject::canRename(const std::string& name) const
 
 bool DataObject::rename(const std::string& name)
 {
+  auto lock = lockHierarchy();
   if(!canRename(name))
   {
     return false;
   }
 
+  const std::string oldName = m_Name;
   m_Name = name;
+  for(BaseGroup* parent : m_ParentList)
+  {
+    parent->m_DataMap.updateName(getId(), oldName);
+  }
+  if(m_DataStructure != nullptr)
+  {
+    m_DataStructure->updateTopLevel(this, oldName, m_ParentList.empty());
+    if(m_DataStructure->m_ObjectTable.contains(getId()))
+    {
+      m_DataStructure->notify(std::make_shared<DataRenamedMessage>(m_DataStructure, getId(), oldName, name));
+    }
+  }
   return true;
 }
 
@@ -107,12 +149,22 @@ Metadata* DataObject::getMetadata() const
 
 void DataObject::addParent(BaseGroup* parent)
 {
+  const bool wasTopLevel = m_ParentList.empty();
   m_ParentList.push_back(parent);
+  if(m_DataStructure != nullptr)
+  {
+    m_DataStructure->updateTopLevel(this, m_Name, wasTopLevel);
+  }
 }
 
 void DataObject::removeParent(BaseGroup* parent)
 {
+  const bool wasTopLevel = m_ParentList.empty();
   m_ParentList.remove(parent);
+  if(m_DataStructure != nullptr)
+  {
+    m_DataStructure->updateTopLevel(this, m_Name, wasTopLevel);
+  }
 }
 
 void DataObject::replaceParent(BaseGroup* oldParent, BaseGroup* newParent)
@@ -3,12 +3,15 @@
 #include <iostream>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <shared_mutex>
 #include <string>
 #include <vector>
 
 #include "complex/DataStructure/Metadata.hpp"
 #include "complex/Utilities/Parsing/HDF5/H5.hpp"
+#include "complex/Utilities/SharedRecursiveMutex.hpp"
 #include "complex/Utilities/TooltipGenerator.hpp"
 
 #include "complex/complex_export.hpp"
@@ -18,6 +21,7 @@ namespace complex
 class BaseGroup;
 class DataPath;
 class DataStructure;
+class SnapshotArchive;
 
 /**
  * @class DataObject
@@ -33,7 +37,8 @@ class COMPLEX_EXPORT DataObject
 public:
   /**
    * @brief The IdType alias serves as an ID type for DataObjects within their
-   * respective DataStructure.
+   * respective DataStructure. IDs are generational handles into the
+   * DataStructure's ObjectTable and are never reused.
    */
   using IdType = uint64_t;
 
@@ -143,6 +148,15 @@ public:
    */
   H5::IdType getH5Id() const;
 
+  /**
+   * @brief Writes or reads the properties and references of the object that
+   * are not stored by DataStructureSnapshot itself. Objects computed from
+   * others are not stored, so they are recomputed after loading. Overrides
+   * must call the base class version first. Does nothing by default.
+   * @param archive
+   */
+  virtual void serializeSnapshot(SnapshotArchive& archive);
+
 protected:
   /**
    * @brief DataObject constructor takes a pointer to the DataStructure and
@@ -177,13 +191,29 @@ protected:
    */
   virtual void setDataStructure(DataStructure* ds);
 
+  /**
+   * @brief Locks the hierarchy of the DataStructure against concurrent
+   * changes. The returned lock is empty if there is no DataStructure.
+   * @return std::unique_lock<SharedRecursiveMutex>
+   */
+  std::unique_lock<SharedRecursiveMutex> lockHierarchy() const;
+
+  /**
+   * @brief Locks the hierarchy of the DataStructure against changes by other
+   * threads while allowing concurrent readers. The returned lock is empty if
+   * there is no DataStructure.
+   * @return std::shared_lock<SharedRecursiveMutex>
+   */
+  std::shared_lock<SharedRecursiveMutex> lockHierarchyShared() const;
+
 private:
   /**
-   * @brief Generates an IdType for the DataObject constructor.
-   * @param opId
+   * @brief Allocates the IdType for the DataObject constructor from the
+   * DataStructure's ObjectTable, or a detached ID without a DataStructure.
+   * @param ds
    * @return IdType
    */
-  static IdType generateId(const std::optional<IdType>& opId = {});
+  static IdType generateId(DataStructure* ds);
 
   ////////////
   // Variables
@@ -1,15 +1,22 @@
 #pragma once
 
+#include <algorithm>
 #include <stdexcept>
+#include <vector>
 
 #include "complex/DataStructure/IDataStore.hpp"
+#include "complex/Utilities/BufferAllocator.hpp"
+#include "complex/Utilities/BulkCopy.hpp"
 
 namespace complex
 {
 /**
  * @class DataStore
  * @brief The DataStore class handles the storing and retrieval of data for
- * use in DataArrays.
+ * use in DataArrays. Values are held in a single buffer allocated according
+ * to the DataStore's AllocationOptions. Large buffers are initialized, copied
+ * and filled in parallel slices so that first-touch page placement spreads
+ * them across NUMA nodes.
  * @tparam T
  */
 template <typename T>
@@ -19,17 +26,26 @@ public:
   using value_type = typename IDataStore<T>::value_type;
   using reference = typename IDataStore<T>::reference;
   using const_reference = typename IDataStore<T>::const_reference;
+  using pointer = typename IDataStore<T>::pointer;
+  using const_pointer = typename IDataStore<T>::const_pointer;
+  using iterator = pointer;
+  using const_iterator = const_pointer;
+
+  using allocator_type = BufferAllocator<value_type>;
 
   /**
-   * @brief Constructs a DataStore with the specified tupleSize and tupleCount.
+   * @brief Constructs a zero-initialized DataStore with the specified
+   * tupleSize and tupleCount.
    * @param tupleSize
    * @param tupleCount
+   * @param options = {}
    */
-  DataStore(size_t tupleSize, size_t tupleCount)
+  DataStore(size_t tupleSize, size_t tupleCount, const AllocationOptions& options = {})
   : m_TupleSize(tupleSize)
   , m_TupleCount(tupleCount)
-  , m_Data(tupleSize * tupleCount)
+  , m_Data(tupleSize * tupleCount, allocator_type(options))
   {
+    BulkCopy::FillValues(m_Data.data(), m_Data.size(), value_type{});
   }
 
   /**
@@ -37,10 +53,12 @@ public:
    * @param other
    */
   DataStore(const DataStore& other)
-  : m_TupleCount(other.m_TupleCount)
+  : IDataStore<T>(other)
   , m_TupleSize(other.m_TupleSize)
-  , m_Data(other.m_Data)
+  , m_TupleCount(other.m_TupleCount)
+  , m_Data(other.m_Data.size(), other.m_Data.get_allocator())
   {
+    BulkCopy::CopyValues(other.m_Data.data(), m_Data.data(), m_Data.size());
   }
 
   /**
@@ -48,8 +66,8 @@ public:
    * @param other
    */
   DataStore(DataStore&& other) noexcept
-  : m_TupleCount(std::move(other.m_TupleCount))
-  , m_TupleSize(std::move(other.m_TupleSize))
+  : m_TupleSize(std::move(other.m_TupleSize))
+  , m_TupleCount(std::move(other.m_TupleCount))
   , m_Data(std::move(other.m_Data))
   {
   }
@@ -74,14 +92,79 @@ public:
     return m_TupleSize;
   }
 
+  /**
+   * @brief Returns the options used to allocate the value buffer.
+   * @return AllocationOptions
+   */
+  AllocationOptions getAllocationOptions() const
+  {
+    return m_Data.get_allocator().getOptions();
+  }
+
   /**
    * @brief Resizes the DataStore to handle the specified number of tuples.
+   * Values added by growing the store are zero-initialized. Growing beyond
+   * the current capacity reserves space according to GrowTupleCapacity(), so
+   * repeated small resizes do not reallocate every time. Shrinking keeps the
+   * capacity.
    * @param numTuples
    */
   void resizeTuples(size_t numTuples) override
   {
+    if(numTuples > getTupleCapacity())
+    {
+      reserveTuples(IDataStore<T>::GrowTupleCapacity(getTupleCapacity(), numTuples));
+    }
     m_TupleCount = numTuples;
-    m_Data.resize(this->getSize());
+    m_Data.resize(this->getSize(), value_type{});
+  }
+
+  /**
+   * @brief Returns the number of tuples the DataStore can hold before it has
+   * to reallocate.
+   * @return size_t
+   */
+  size_t getTupleCapacity() const override
+  {
+    return (m_TupleSize == 0) ? m_TupleCount : m_Data.capacity() / m_TupleSize;
+  }
+
+  /**
+   * @brief Reserves space for at least the specified number of tuples without
+   * changing the tuple count.
+   * @param numTuples
+   */
+  void reserveTuples(size_t numTuples) override
+  {
+    m_Data.reserve(numTuples * m_TupleSize);
+  }
+
+  /**
+   * @brief Releases any capacity beyond the current tuple count.
+   */
+  void shrinkToFit() override
+  {
+    m_Data.shrink_to_fit();
+  }
+
+  /**
+   * @brief Appends count tuples to the end of the DataStore. The values
+   * pointer must hold count * getTupleSize() values and must not point into
+   * this DataStore.
+   * @param values
+   * @param count
+   */
+  void appendTuples(const_pointer values, size_t count) override
+  {
+    const size_t tupleCount = m_TupleCount + count;
+    if(tupleCount > getTupleCapacity())
+    {
+      reserveTuples(IDataStore<T>::GrowTupleCapacity(getTupleCapacity(), tupleCount));
+    }
+    const size_t offset = m_Data.size();
+    m_Data.resize(offset + count * m_TupleSize);
+    BulkCopy::CopyValues(values, m_Data.data() + offset, count * m_TupleSize);
+    m_TupleCount = tupleCount;
   }
 
   /**
@@ -144,23 +227,95 @@ public:
   }
 
   /**
-   * @brief Returns a deep copy of the data store and all its data.
+   * @brief Returns true. DataStore values are always held in a single
+   * contiguous buffer.
+   * @return bool
+   */
+  bool isContiguous() const override
+  {
+    return true;
+  }
+
+  /**
+   * @brief Returns a pointer to the underlying value buffer. The pointer is
+   * invalidated by resizeTuples().
+   * @return pointer
+   */
+  pointer data() override
+  {
+    return m_Data.data();
+  }
+
+  /**
+   * @brief Returns a read-only pointer to the underlying value buffer. The
+   * pointer is invalidated by resizeTuples().
+   * @return const_pointer
+   */
+  const_pointer data() const override
+  {
+    return m_Data.data();
+  }
+
+  /**
+   * @brief Fills the DataStore with the specified value. Large stores are
+   * filled in parallel slices.
+   * @param value
+   */
+  void fill(value_type value) override
+  {
+    BulkCopy::FillValues(m_Data.data(), m_Data.size(), value);
+  }
+
+  /**
+   * @brief Returns a deep copy of the data store and all its data. Large
+   * stores are copied in parallel slices.
    * @return IDataStore*
    */
   IDataStore<T>* deepCopy() const override
   {
-    auto copy = new DataStore(*this);
-    for(size_t i = 0; i < IDataStore<T>::getSize(); i++)
-      for(size_t i = 0; i < this->getSize(); i++)
-      {
-        copy->setValue(i, getValue(i));
-      }
-    return copy;
+    return new DataStore(*this);
+  }
+
+  /**
+   * @brief Returns a pointer-based iterator to the beginning of the DataStore.
+   * Unlike IDataStore::Iterator, this does not hold a reference to the store.
+   * @return iterator
+   */
+  iterator begin()
+  {
+    return m_Data.data();
+  }
+
+  /**
+   * @brief Returns a pointer-based iterator to the end of the DataStore.
+   * @return iterator
+   */
+  iterator end()
+  {
+    return m_Data.data() + m_Data.size();
+  }
+
+  /**
+   * @brief Returns a read-only pointer-based iterator to the beginning of the DataStore.
+   * @return const_iterator
+   */
+  const_iterator begin() const
+  {
+    return m_Data.data();
+  }
+
+  /**
+   * @brief Returns a read-only pointer-based iterator to the end of the DataStore.
+   * @return const_iterator
+   */
+  const_iterator end() const
+  {
+    return m_Data.data() + m_Data.size();
   }
 
 private:
   size_t m_TupleSize;
   size_t m_TupleCount;
-  std::vector<value_type> m_Data;
+  std::vector<value_type, allocator_type> m_Data;
 };
 } // namespace complex
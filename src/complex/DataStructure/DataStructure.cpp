@@ -1,64 +1,105 @@
 #include "DataStructure.hpp"
 
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
 #include <stdexcept>
+#include <thread>
 
 #include "complex/DataStructure/BaseGroup.hpp"
 #include "complex/DataStructure/DataGroup.hpp"
+#include "complex/DataStructure/Geometry/BoundingVolumeHierarchy.hpp"
+#include "complex/DataStructure/Geometry/HalfEdgeTopology.hpp"
+#include "complex/DataStructure/Geometry/SpatialIndex.hpp"
 #include "complex/DataStructure/LinkedPath.hpp"
 #include "complex/DataStructure/Messaging/DataAddedMessage.hpp"
+#include "complex/DataStructure/Messaging/DataBatchMessage.hpp"
 #include "complex/DataStructure/Messaging/DataRemovedMessage.hpp"
+#include "complex/DataStructure/Messaging/DataRenamedMessage.hpp"
 #include "complex/DataStructure/Messaging/DataReparentedMessage.hpp"
 #include "complex/DataStructure/Observers/AbstractDataStructureObserver.hpp"
 
 using namespace complex;
 
+struct DataStructure::NotificationState
+{
+  std::mutex mutex;
+  std::condition_variable queued;
+  std::condition_variable delivered;
+  std::vector<std::shared_ptr<AbstractDataStructureMessage>> pending;
+  usize batchDepth = 0;
+  bool async = false;
+  bool delivering = false;
+  std::thread deliveryThread;
+};
+
 DataStructure::DataStructure()
-: m_IsValid(true)
+: m_Notifications(std::make_shared<NotificationState>())
+, m_IsValid(true)
 {
 }
 
 DataStructure::DataStructure(const DataStructure& ds)
-: m_DataObjects(ds.m_DataObjects)
+: DataStructure(ds, SharedLock(ds.m_Mutex))
+{
+}
+
+DataStructure::DataStructure(const DataStructure& ds, const SharedLock&)
+: m_ObjectTable(ds.m_ObjectTable)
 , m_RootGroup(ds.m_RootGroup)
+, m_Notifications(std::make_shared<NotificationState>())
 , m_IsValid(ds.m_IsValid)
 {
+  // The copied table refers to the objects of ds until they are replaced
   std::map<DataObject::IdType, std::shared_ptr<DataObject>> m_CopyData;
-  for(auto& dataPair : m_DataObjects)
+  for(auto id : m_ObjectTable.getIds())
   {
-    auto id = dataPair.first;
-    auto copy = std::shared_ptr<DataObject>(dataPair.second.lock()->shallowCopy());
+    auto copy = std::shared_ptr<DataObject>(m_ObjectTable.find(id)->shallowCopy());
     m_CopyData[id] = copy;
-    m_DataObjects[id] = copy;
+    m_ObjectTable.insert(copy);
   }
   m_RootGroup.setDataStructure(this);
+  rebuildTopLevelIndex();
 }
 
 DataStructure::DataStructure(DataStructure&& ds) noexcept
-: m_DataObjects(std::move(ds.m_DataObjects))
+: m_ObjectTable(std::move(ds.m_ObjectTable))
+, m_TopLevelIndex(std::move(ds.m_TopLevelIndex))
 , m_RootGroup(std::move(ds.m_RootGroup))
+, m_Notifications(std::make_shared<NotificationState>())
 , m_IsValid(std::move(ds.m_IsValid))
 {
+  // Observers stay with ds, so its queued messages are delivered there
+  ds.stopAsyncNotifications();
   m_RootGroup.setDataStructure(this);
 }
 
 DataStructure::~DataStructure()
 {
+  stopAsyncNotifications();
   m_Observers.clear();
   m_IsValid = false;
 }
 
 size_t DataStructure::size() const
 {
-  return m_DataObjects.size();
+  return m_ObjectTable.size();
 }
 
 std::optional<DataObject::IdType> DataStructure::getId(const DataPath& path) const
 {
-  return getData(path)->getId();
+  SharedLock lock(m_Mutex);
+  const DataObject* data = getData(path);
+  if(data == nullptr)
+  {
+    return {};
+  }
+  return data->getId();
 }
 
 LinkedPath DataStructure::getLinkedPath(const DataPath& path) const
 {
+  SharedLock lock(m_Mutex);
   try
   {
     std::vector<DataObject::IdType> pathIds;
@@ -84,12 +125,7 @@ LinkedPath DataStructure::getLinkedPath(const DataPath& path) const
 
 DataObject* DataStructure::getData(DataObject::IdType id)
 {
-  auto iter = m_DataObjects.find(id);
-  if(m_DataObjects.end() == iter)
-  {
-    return nullptr;
-  }
-  return iter->second.lock().get();
+  return m_ObjectTable.find(id);
 }
 
 DataObject* DataStructure::getData(const std::optional<DataObject::IdType>& id)
@@ -98,13 +134,7 @@ DataObject* DataStructure::getData(const std::optional<DataObject::IdType>& id)
   {
     return nullptr;
   }
-
-  auto iter = m_DataObjects.find(id.value());
-  if(m_DataObjects.end() == iter)
-  {
-    return nullptr;
-  }
-  return iter->second.lock().get();
+  return m_ObjectTable.find(id.value());
 }
 
 DataObject* traversePath(DataObject* obj, const DataPath& path, size_t index)
@@ -124,19 +154,17 @@ DataObject* traversePath(DataObject* obj, const DataPath& path, size_t index)
 
 DataObject* DataStructure::getData(const DataPath& path)
 {
-  auto topLevel = getTopLevelData();
-  for(DataObject* obj : topLevel)
+  if(path.getLength() == 0)
   {
-    if(obj == nullptr)
-    {
-      continue;
-    }
-    if(obj->getName() == path[0])
-    {
-      return traversePath(obj, path, 1);
-    }
+    return nullptr;
+  }
+  SharedLock lock(m_Mutex);
+  DataObject* topLevel = getData(findTopLevel(path[0]));
+  if(topLevel == nullptr)
+  {
+    return nullptr;
   }
-  return nullptr;
+  return traversePath(topLevel, path, 1);
 }
 
 DataObject* DataStructure::getData(const LinkedPath& path)
@@ -146,12 +174,7 @@ DataObject* DataStructure::getData(const LinkedPath& path)
 
 const DataObject* DataStructure::getData(DataObject::IdType id) const
 {
-  auto iter = m_DataObjects.find(id);
-  if(m_DataObjects.end() == iter)
-  {
-    return nullptr;
-  }
-  return iter->second.lock().get();
+  return m_ObjectTable.find(id);
 }
 
 const DataObject* DataStructure::getData(const std::optional<DataObject::IdType>& id) const
@@ -160,30 +183,12 @@ const DataObject* DataStructure::getData(const std::optional<DataObject::IdType>
   {
     return nullptr;
   }
-
-  auto iter = m_DataObjects.find(id.value());
-  if(m_DataObjects.end() == iter)
-  {
-    return nullptr;
-  }
-  return iter->second.lock().get();
+  return m_ObjectTable.find(id.value());
 }
 
 const DataObject* DataStructure::getData(const DataPath& path) const
 {
-  auto topLevel = getTopLevelData();
-  for(DataObject* obj : topLevel)
-  {
-    if(obj == nullptr)
-    {
-      continue;
-    }
-    if(obj->getName() == path[0])
-    {
-      return traversePath(obj, path, 1);
-    }
-  }
-  return nullptr;
+  return const_cast<DataStructure*>(this)->getData(path);
 }
 
 const DataObject* DataStructure::getData(const LinkedPath& path) const
@@ -193,15 +198,12 @@ const DataObject* DataStructure::getData(const LinkedPath& path) const
 
 std::shared_ptr<DataObject> DataStructure::getSharedData(DataObject::IdType id) const
 {
-  if(m_DataObjects.find(id) == m_DataObjects.end())
-  {
-    return nullptr;
-  }
-  return m_DataObjects.at(id).lock();
+  return m_ObjectTable.findShared(id);
 }
 
 bool DataStructure::removeData(DataObject::IdType id)
 {
+  ExclusiveLock lock(m_Mutex);
   DataObject* data = getData(id);
   return removeData(data);
 }
@@ -220,6 +222,7 @@ bool DataStructure::removeData(const std::optional<DataObject::IdType>& id)
 
 bool DataStructure::removeData(const DataPath& path)
 {
+  ExclusiveLock lock(m_Mutex);
   DataObject* data = getData(path);
   return removeData(data);
 }
@@ -230,6 +233,7 @@ bool DataStructure::removeData(DataObject* data)
   {
     return false;
   }
+  ExclusiveLock lock(m_Mutex);
 
   auto pathsToData = data->getDataPaths();
   auto parents = data->getParents();
@@ -248,35 +252,110 @@ bool DataStructure::removeData(DataObject* data)
   return true;
 }
 
-void DataStructure::dataDeleted(DataObject::IdType id, const std::string& name)
+void DataStructure::dataDeleted(const DataObject* data)
 {
   if(!m_IsValid)
   {
     return;
   }
 
-  m_DataObjects.erase(id);
+  ExclusiveLock lock(m_Mutex);
+  // Copies and objects that were never added share or hold unpublished IDs
+  const DataObject::IdType id = data->getId();
+  if(!m_ObjectTable.release(id, data))
+  {
+    return;
+  }
+  const std::string name = data->getName();
+  auto [first, last] = m_TopLevelIndex.equal_range(name);
+  for(auto iter = first; iter != last; ++iter)
+  {
+    if(iter->second == id)
+    {
+      m_TopLevelIndex.erase(iter);
+      break;
+    }
+  }
   auto msg = std::make_shared<DataRemovedMessage>(this, id, name);
   notify(msg);
 }
 
 std::vector<DataObject*> DataStructure::getTopLevelData() const
 {
+  SharedLock lock(m_Mutex);
+  std::vector<DataObject::IdType> ids;
+  ids.reserve(m_TopLevelIndex.size());
+  for(const auto& entry : m_TopLevelIndex)
+  {
+    ids.push_back(entry.second);
+  }
+  std::sort(ids.begin(), ids.end());
+
   std::vector<DataObject*> topLevel;
-  for(auto& iter : m_DataObjects)
+  for(DataObject::IdType id : ids)
   {
-    auto obj = iter.second.lock();
-    if(obj == nullptr)
+    if(DataObject* obj = m_ObjectTable.find(id))
     {
-      continue;
+      topLevel.push_back(obj);
     }
-    if(obj->getParents().size() == 0)
+  }
+  return topLevel;
+}
+
+void DataStructure::updateTopLevel(const DataObject* data, const std::string& oldName, bool wasTopLevel)
+{
+  if(!m_IsValid)
+  {
+    return;
+  }
+  ExclusiveLock lock(m_Mutex);
+  const DataObject::IdType id = data->getId();
+  if(wasTopLevel)
+  {
+    auto [first, last] = m_TopLevelIndex.equal_range(oldName);
+    for(auto iter = first; iter != last; ++iter)
     {
-      topLevel.push_back(obj.get());
+      if(iter->second == id)
+      {
+        m_TopLevelIndex.erase(iter);
+        break;
+      }
     }
   }
+  // Objects are indexed once they are added to the DataStructure
+  if(data->getParents().empty() && m_ObjectTable.contains(id))
+  {
+    m_TopLevelIndex.emplace(data->getName(), id);
+  }
+  if(oldName != data->getName())
+  {
+    m_RootGroup.updateName(id, oldName);
+  }
+}
 
-  return topLevel;
+std::optional<DataObject::IdType> DataStructure::findTopLevel(const std::string& name) const
+{
+  std::optional<DataObject::IdType> lowest;
+  auto [first, last] = m_TopLevelIndex.equal_range(name);
+  for(auto iter = first; iter != last; ++iter)
+  {
+    if(!lowest || iter->second < *lowest)
+    {
+      lowest = iter->second;
+    }
+  }
+  return lowest;
+}
+
+void DataStructure::rebuildTopLevelIndex()
+{
+  m_TopLevelIndex.clear();
+  m_ObjectTable.forEach([this](DataObject::IdType id, const DataObject* obj) {
+    if(obj->getParents().empty())
+    {
+      m_TopLevelIndex.emplace(obj->getName(), id);
+    }
+  });
 }
 
 bool DataStructure::insertTopLevel(const std::shared_ptr<DataObject>& obj)
@@ -312,12 +391,48 @@ DataGroup* DataStructure::createGroup(const std::string& name, const std::option
   return container.get();
 }
 
+HalfEdgeTopology* DataStructure::createHalfEdgeTopology(const std::string& name, const std::optional<DataObject::IdType>& parent)
+{
+  std::shared_ptr<HalfEdgeTopology> topology(new HalfEdgeTopology(this, name));
+  if(!finishAddingObject(topology, parent))
+  {
+    return nullptr;
+  }
+  return topology.get();
+}
+
+BoundingVolumeHierarchy* DataStructure::createBoundingVolumeHierarchy(const std::string& name, const std::optional<DataObject::IdType>& parent)
+{
+  std::shared_ptr<BoundingVolumeHierarchy> hierarchy(new BoundingVolumeHierarchy(this, name));
+  if(!finishAddingObject(hierarchy, parent))
+  {
+    return nullptr;
+  }
+  return hierarchy.get();
+}
+
+SpatialIndex* DataStructure::createSpatialIndex(const std::string& name, const std::optional<DataObject::IdType>& parent)
+{
+  std::shared_ptr<SpatialIndex> index(new SpatialIndex(this, name));
+  if(!finishAddingObject(index, parent))
+  {
+    return nullptr;
+  }
+  return index.get();
+}
+
 bool DataStructure::finishAddingObject(const std::shared_ptr<DataObject>& obj, const std::optional<DataObject::IdType>& parent)
 {
+  // The ID of obj was reserved in the table of the DataStructure it was created for
+  if(obj == nullptr || obj->getDataStructure() != this)
+  {
+    return false;
+  }
+  ExclusiveLock lock(m_Mutex);
   if(parent.has_value())
   {
     auto parentContainer = dynamic_cast<BaseGroup*>(getData(parent.value()));
-    if(!parentContainer->insert(obj))
+    if(parentContainer == nullptr || !parentContainer->insert(obj))
     {
       return false;
     }
@@ -327,7 +442,11 @@ bool DataStructure::finishAddingObject(const std::shared_ptr<DataObject>& obj, c
     return false;
   }
 
-  m_DataObjects[obj->getId()] = obj;
+  m_ObjectTable.insert(obj);
+  if(obj->getParents().empty())
+  {
+    m_TopLevelIndex.emplace(obj->getName(), obj->getId());
+  }
   auto msg = std::make_shared<DataAddedMessage>(this, obj->getId());
   notify(msg);
   return true;
@@ -355,9 +474,10 @@ DataStructure::ConstIterator DataStructure::end() const
 
 bool DataStructure::setAdditionalParent(DataObject::IdType targetId, DataObject::IdType newParentId)
 {
-  auto& target = m_DataObjects[targetId];
+  ExclusiveLock lock(m_Mutex);
+  auto target = m_ObjectTable.findShared(targetId);
   auto newParent = dynamic_cast<BaseGroup*>(getData(newParentId));
-  if(newParent == nullptr)
+  if(target == nullptr || newParent == nullptr)
   {
     return false;
   }
@@ -373,35 +493,222 @@ bool DataStructure::setAdditionalParent(DataObject::IdType targetId, DataObject:
 
 bool DataStructure::removeParent(DataObject::IdType targetId, DataObject::IdType parentId)
 {
-  const auto& target = m_DataObjects[targetId];
+  ExclusiveLock lock(m_Mutex);
+  DataObject* target = getData(targetId);
   auto parent = dynamic_cast<BaseGroup*>(getData(parentId));
-  auto targetPtr = target.lock();
-  if(targetPtr == nullptr)
+  if(target == nullptr || parent == nullptr)
+  {
+    return false;
+  }
+  if(!parent->remove(target))
   {
     return false;
   }
-  return parent->remove(targetPtr.get());
+
+  notify(std::make_shared<DataReparentedMessage>(this, targetId, parentId, false));
+  return true;
 }
 
 void DataStructure::notify(const std::shared_ptr<AbstractDataStructureMessage>& msg)
 {
-  for(auto observer : m_Observers)
+  {
+    std::lock_guard<std::mutex> lock(m_Notifications->mutex);
+    if(m_Notifications->batchDepth > 0 || m_Notifications->async)
+    {
+      m_Notifications->pending.push_back(msg);
+      if(m_Notifications->batchDepth == 0)
+      {
+        m_Notifications->queued.notify_one();
+      }
+      return;
+    }
+  }
+  deliver({msg});
+}
+
+void DataStructure::deliver(std::vector<std::shared_ptr<AbstractDataStructureMessage>> messages)
+{
+  if(messages.empty())
+  {
+    return;
+  }
+  std::shared_ptr<AbstractDataStructureMessage> msg = messages.front();
+  if(messages.size() > 1)
+  {
+    msg = std::make_shared<DataBatchMessage>(this, std::move(messages));
+  }
+  for(auto observer : getObservers())
   {
     observer->onNotify(this, msg);
   }
 }
 
+void DataStructure::deliveryLoop(NotificationState& state)
+{
+  std::unique_lock<std::mutex> lock(state.mutex);
+  while(true)
+  {
+    state.queued.wait(lock, [&state]() { return !state.async || (state.batchDepth == 0 && !state.pending.empty()); });
+    // Messages of open batches are delivered once the batches end
+    if(state.pending.empty() || state.batchDepth > 0)
+    {
+      state.delivered.notify_all();
+      return;
+    }
+    auto messages = std::move(state.pending);
+    state.pending.clear();
+    state.delivering = true;
+    lock.unlock();
+    deliver(std::move(messages));
+    // An observer may have destroyed the DataStructure. It stopped
+    // asynchronous delivery and drained the queue first, so only state is
+    // used from here on
+    lock.lock();
+    state.delivering = false;
+    state.delivered.notify_all();
+  }
+}
+
+void DataStructure::beginNotificationBatch()
+{
+  std::lock_guard<std::mutex> lock(m_Notifications->mutex);
+  m_Notifications->batchDepth++;
+}
+
+void DataStructure::endNotificationBatch()
+{
+  std::vector<std::shared_ptr<AbstractDataStructureMessage>> messages;
+  {
+    std::lock_guard<std::mutex> lock(m_Notifications->mutex);
+    if(--m_Notifications->batchDepth > 0)
+    {
+      return;
+    }
+    if(m_Notifications->async)
+    {
+      m_Notifications->queued.notify_one();
+      return;
+    }
+    messages = std::move(m_Notifications->pending);
+    m_Notifications->pending.clear();
+  }
+  deliver(std::move(messages));
+}
+
+void DataStructure::setAsyncNotifications(bool enabled)
+{
+  NotificationState& state = *m_Notifications;
+  std::unique_lock<std::mutex> lock(state.mutex);
+  if(enabled == state.async)
+  {
+    return;
+  }
+  state.async = enabled;
+  if(enabled)
+  {
+    state.deliveryThread = std::thread([this, keepAlive = m_Notifications]() { deliveryLoop(*keepAlive); });
+    return;
+  }
+  // The delivery thread drains the queue before it stops
+  state.queued.notify_one();
+  lock.unlock();
+  if(state.deliveryThread.get_id() != std::this_thread::get_id())
+  {
+    state.deliveryThread.join();
+  }
+  else
+  {
+    state.deliveryThread.detach();
+  }
+  lock.lock();
+  if(state.batchDepth > 0)
+  {
+    return;
+  }
+  auto messages = std::move(state.pending);
+  state.pending.clear();
+  lock.unlock();
+  deliver(std::move(messages));
+}
+
+void DataStructure::stopAsyncNotifications() noexcept
+{
+  try
+  {
+    setAsyncNotifications(false);
+  } catch(...)
+  {
+    // Neither caller can report the failure. Messages not yet delivered are dropped
+  }
+}
+
+bool DataStructure::getAsyncNotifications() const
+{
+  std::lock_guard<std::mutex> lock(m_Notifications->mutex);
+  return m_Notifications->async;
+}
+
+void DataStructure::flushNotifications()
+{
+  NotificationState& state = *m_Notifications;
+  std::unique_lock<std::mutex> lock(state.mutex);
+  if(!state.async || state.deliveryThread.get_id() == std::this_thread::get_id())
+  {
+    return;
+  }
+  state.delivered.wait(lock, [&state]() { return !state.async || (!state.delivering && (state.pending.empty() || state.batchDepth > 0)); });
+}
+
+DataStructure::NotificationBatch::NotificationBatch(DataStructure& dataStructure)
+: m_DataStructure(dataStructure)
+{
+  m_DataStructure.beginNotificationBatch();
+}
+
+DataStructure::NotificationBatch::~NotificationBatch() noexcept
+{
+  m_DataStructure.endNotificationBatch();
+}
+
 std::set<AbstractDataStructureObserver*> DataStructure::getObservers() const
 {
+  SharedLock lock(m_Mutex);
   return m_Observers;
 }
 
 void DataStructure::addObserver(AbstractDataStructureObserver* obs)
 {
+  ExclusiveLock lock(m_Mutex);
   m_Observers.insert(obs);
 }
 
 void DataStructure::removeObserver(AbstractDataStructureObserver* obs)
 {
-  m_Observers.erase(obs);
+  {
+    ExclusiveLock lock(m_Mutex);
+    m_Observers.erase(obs);
+  }
+  // A delivery in progress may still hold obs. Waiting with the hierarchy locked could deadlock
+  NotificationState& state = *m_Notifications;
+  if(m_Mutex.isLockedByCaller() || state.deliveryThread.get_id() == std::this_thread::get_id())
+  {
+    return;
+  }
+  std::unique_lock<std::mutex> lock(state.mutex);
+  state.delivered.wait(lock, [&state]() { return !state.delivering; });
+}
+
+DataStructure::AccessToken DataStructure::acquireAccess(const std::vector<DataObject::IdType>& readIds, const std::vector<DataObject::IdType>& writeIds)
+{
+  return m_AccessRegistry.acquire(readIds, writeIds);
+}
+
+std::optional<DataStructure::AccessToken> DataStructure::tryAcquireAccess(const std::vector<DataObject::IdType>& readIds, const std::vector<DataObject::IdType>& writeIds)
+{
+  return m_AccessRegistry.tryAcquire(readIds, writeIds);
+}
+
+bool DataStructure::isAccessed(DataObject::IdType id) const
+{
+  return m_AccessRegistry.isAccessed(id);
 }
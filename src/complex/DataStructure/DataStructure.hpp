@@ -5,9 +5,12 @@
 #include <memory>
 #include <optional>
 #include <set>
+#include <shared_mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+#include "complex/DataStructure/AccessRegistry.hpp"
 #include "complex/DataStructure/DataArray.hpp"
 #include "complex/DataStructure/DataMap.hpp"
 #include "complex/DataStructure/DataObject.hpp"
@@ -15,8 +18,10 @@
 #include "complex/DataStructure/DynamicListArray.hpp"
 #include "complex/DataStructure/Geometry/AbstractGeometry.hpp"
 #include "complex/DataStructure/LinkedPath.hpp"
+#include "complex/DataStructure/ObjectTable.hpp"
 #include "complex/DataStructure/Montage/AbstractMontage.hpp"
 #include "complex/DataStructure/ScalarData.hpp"
+#include "complex/Utilities/SharedRecursiveMutex.hpp"
 
 #include "complex/complex_export.hpp"
 
@@ -25,6 +30,9 @@ namespace complex
 class AbstractDataStructureMessage;
 class AbstractDataStructureObserver;
 class DataGroup;
+class BoundingVolumeHierarchy;
+class HalfEdgeTopology;
+class SpatialIndex;
 class DataPath;
 
 /**
@@ -33,6 +41,22 @@ class DataPath;
  * data structure. The DataStructure is where and how DataGroups, montages,
  * geometries, and scalars are added to the structure. The DataStructure allows
  * parents to be added to or removed from DataObjects.
+ *
+ * The DataStructure may be used from several threads at once. Looking up an
+ * object by ID takes no lock. Path lookups take a shared lock on the
+ * hierarchy, while creating, removing, renaming and reparenting objects take
+ * it exclusively and notify observers before releasing it, so observers may
+ * query the structure. Iterating a group is not synchronized with changes
+ * to it. Tasks that work on the objects themselves, such as filters, declare
+ * the objects they read and write with acquireAccess() so that independent
+ * tasks can run in parallel.
+ *
+ * Observers are notified of every change as it happens, on the thread that
+ * made it. A NotificationBatch collects the messages emitted while it is
+ * alive and sends them as one DataBatchMessage when it ends. With
+ * asynchronous notifications enabled, messages are queued instead and
+ * delivered by a dedicated thread, several at a time as a DataBatchMessage
+ * when more than one is waiting.
  */
 class COMPLEX_EXPORT DataStructure
 {
@@ -42,6 +66,38 @@ public:
 
   friend class DataMap;
   friend class DataObject;
+  friend class DataStructureSnapshot;
+
+  using AccessToken = AccessRegistry::Token;
+
+  /**
+   * @class NotificationBatch
+   * @brief Collects the messages the DataStructure emits while the batch is
+   * alive and sends them to observers as a single DataBatchMessage when it
+   * is destroyed. Batches may be nested or opened by several threads; the
+   * messages are sent when the last open batch ends. A batch holding a
+   * single message sends the message itself.
+   */
+  class COMPLEX_EXPORT NotificationBatch
+  {
+  public:
+    /**
+     * @brief Starts collecting the messages of the DataStructure.
+     * @param dataStructure
+     */
+    explicit NotificationBatch(DataStructure& dataStructure);
+
+    NotificationBatch(const NotificationBatch&) = delete;
+    NotificationBatch(NotificationBatch&&) = delete;
+
+    ~NotificationBatch() noexcept;
+
+    NotificationBatch& operator=(const NotificationBatch&) = delete;
+    NotificationBatch& operator=(NotificationBatch&&) = delete;
+
+  private:
+    DataStructure& m_DataStructure;
+  };
 
   /**
    * @brief Default constructor
@@ -247,6 +303,37 @@ public:
    */
   DataGroup* createGroup(const std::string& name, const std::optional<DataObject::IdType>& parent = {});
 
+  /**
+   * @brief Creates and adds an empty HalfEdgeTopology to the DataStructure.
+   * If the parent parameter is not provided, the topology is added to the top
+   * of the DataStructure. The created topology is returned by a raw pointer.
+   * @param name
+   * @param parent
+   * @return HalfEdgeTopology*
+   */
+  HalfEdgeTopology* createHalfEdgeTopology(const std::string& name, const std::optional<DataObject::IdType>& parent = {});
+
+  /**
+   * @brief Creates and adds an empty BoundingVolumeHierarchy to the
+   * DataStructure. If the parent parameter is not provided, the hierarchy is
+   * added to the top of the DataStructure. The created hierarchy is returned
+   * by a raw pointer.
+   * @param name
+   * @param parent
+   * @return BoundingVolumeHierarchy*
+   */
+  BoundingVolumeHierarchy* createBoundingVolumeHierarchy(const std::string& name, const std::optional<DataObject::IdType>& parent = {});
+
+  /**
+   * @brief Creates and adds an empty SpatialIndex to the DataStructure. If the
+   * parent parameter is not provided, the index is added to the top of the
+   * DataStructure. The created index is returned by a raw pointer.
+   * @param name
+   * @param parent
+   * @return SpatialIndex*
+   */
+  SpatialIndex* createSpatialIndex(const std::string& name, const std::optional<DataObject::IdType>& parent = {});
+
   /**
    * @brief Creates a specified montage type and adds it to the DataStructure.
    * The created montage is returned as a raw pointer. If the parent parameter
@@ -323,11 +410,63 @@ public:
   void addObserver(AbstractDataStructureObserver* obs);
 
   /**
-   * @brief Removes an observer.
+   * @brief Removes an observer. With asynchronous notifications, waits until
+   * the observer is no longer being notified, unless called by the delivery
+   * thread or with the hierarchy locked.
    * @param obs
    */
   void removeObserver(AbstractDataStructureObserver* obs);
 
+  /**
+   * @brief Enables or disables delivering messages to observers on a
+   * dedicated thread. Observers are then notified outside of the lock on the
+   * hierarchy and may change the DataStructure. An observer may even destroy
+   * it, provided no other observer is notified of the same message. Disabling
+   * delivers the queued messages first.
+   * @param enabled
+   */
+  void setAsyncNotifications(bool enabled);
+
+  /**
+   * @brief Returns true if messages are delivered on a dedicated thread.
+   * @return bool
+   */
+  bool getAsyncNotifications() const;
+
+  /**
+   * @brief Waits until the queued messages were delivered to observers.
+   * Returns immediately without asynchronous notifications or when called
+   * by the delivery thread. Messages of open batches are not waited for.
+   */
+  void flushNotifications();
+
+  /**
+   * @brief Declares read access to readIds and write access to writeIds,
+   * blocking until no other holder of an AccessToken writes any of them or
+   * reads any of writeIds. The accesses are held until the token is
+   * destroyed, which must happen before the DataStructure is.
+   * @param readIds
+   * @param writeIds
+   * @return AccessToken
+   */
+  AccessToken acquireAccess(const std::vector<DataObject::IdType>& readIds, const std::vector<DataObject::IdType>& writeIds);
+
+  /**
+   * @brief Declares the accesses like acquireAccess() if that would not
+   * block. Returns an empty optional otherwise.
+   * @param readIds
+   * @param writeIds
+   * @return std::optional<AccessToken>
+   */
+  std::optional<AccessToken> tryAcquireAccess(const std::vector<DataObject::IdType>& readIds, const std::vector<DataObject::IdType>& writeIds);
+
+  /**
+   * @brief Returns true if an AccessToken reads or writes the object.
+   * @param id
+   * @return bool
+   */
+  bool isAccessed(DataObject::IdType id) const;
+
   /**
    * @brief Returns an iterator for the the beginning of the top-level DataMap.
    * @return iterator
@@ -372,6 +511,16 @@ protected:
   bool finishAddingObject(const std::shared_ptr<DataObject>& obj, const std::optional<DataObject::IdType>& parent = {});
 
 private:
+  using SharedLock = std::shared_lock<SharedRecursiveMutex>;
+  using ExclusiveLock = std::unique_lock<SharedRecursiveMutex>;
+
+  /**
+   * @brief Copies ds while the lock keeps its hierarchy from changing.
+   * @param ds
+   * @param lock
+   */
+  DataStructure(const DataStructure& ds, const SharedLock& lock);
+
   /**
    * @brief Inserts the target DataObject to the top of the DataStructure.
    * @param obj
@@ -395,22 +544,85 @@ private:
 
   /**
    * @brief Called when a DataObject is deleted from the DataStructure. This notifies observers to the change.
-   * @param id
+   * @param data
+   */
+  void dataDeleted(const DataObject* data);
+
+  /**
+   * @brief Called when a DataObject gains or loses a parent or is renamed.
+   * Keeps the index of top-level objects by name in step with the objects
+   * without parents, which is what DataPaths are resolved from.
+   * @param data
+   * @param oldName Name before a rename, or the current name
+   * @param wasTopLevel Whether data had no parents before the change
+   */
+  void updateTopLevel(const DataObject* data, const std::string& oldName, bool wasTopLevel);
+
+  /**
+   * @brief Returns the ID of the top-level object with the specified name. If
+   * several top-level objects share the name, the lowest ID is returned.
    * @param name
+   * @return std::optional<DataObject::IdType>
    */
-  void dataDeleted(DataObject::IdType id, const std::string& name);
+  std::optional<DataObject::IdType> findTopLevel(const std::string& name) const;
 
   /**
-   * @brief Notifies observers to the provided message.
+   * @brief Rebuilds the index of top-level objects by name.
+   */
+  void rebuildTopLevelIndex();
+
+  struct NotificationState;
+
+  /**
+   * @brief Notifies observers to the provided message, or queues it if a
+   * batch is open or notifications are asynchronous.
    * @param msg
    */
   void notify(const std::shared_ptr<AbstractDataStructureMessage>& msg);
 
+  /**
+   * @brief Calls every observer with the messages, wrapped in a
+   * DataBatchMessage if there is more than one.
+   * @param messages
+   */
+  void deliver(std::vector<std::shared_ptr<AbstractDataStructureMessage>> messages);
+
+  /**
+   * @brief Delivers queued messages until asynchronous notifications are
+   * disabled. Runs on the delivery thread, which shares ownership of state so
+   * an observer may destroy the DataStructure from a notification.
+   * @param state
+   */
+  void deliveryLoop(NotificationState& state);
+
+  /**
+   * @brief Disables asynchronous notifications and delivers the queued
+   * messages for the move constructor and destructor. Exceptions thrown by
+   * observers or by stopping the delivery thread are swallowed.
+   */
+  void stopAsyncNotifications() noexcept;
+
+  /**
+   * @brief Opens a NotificationBatch.
+   */
+  void beginNotificationBatch();
+
+  /**
+   * @brief Closes a NotificationBatch, sending the collected messages if it
+   * was the last one open.
+   */
+  void endNotificationBatch();
+
   ////////////
   // Variables
-  std::map<DataObject::IdType, std::weak_ptr<DataObject>> m_DataObjects;
+  // Declared first, so it is destroyed after the objects that lock it
+  mutable SharedRecursiveMutex m_Mutex;
+  AccessRegistry m_AccessRegistry;
+  ObjectTable m_ObjectTable;
+  std::unordered_multimap<std::string, DataObject::IdType> m_TopLevelIndex;
   DataMap m_RootGroup;
   std::set<AbstractDataStructureObserver*> m_Observers;
+  std::shared_ptr<NotificationState> m_Notifications;
   bool m_IsValid = false;
 };
 } // namespace complex
@@ -1,14 +1,32 @@
 #pragma once
 
+#include <algorithm>
 #include <cstring>
-#include <iostream>
+#include <iterator>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
+#include <vector>
 
+#include <fmt/core.h>
+
+#include "complex/Common/DefaultInitAllocator.hpp"
 #include "complex/DataStructure/DataObject.hpp"
+#include "complex/Utilities/BulkCopy.hpp"
+#include "complex/Utilities/ParallelAlgorithms.hpp"
 
 namespace complex
 {
+/**
+ * @class DynamicListArray
+ * @brief The DynamicListArray class stores a variable length list of K per
+ * element in compressed sparse row form: one offsets array with an entry per
+ * element plus one contiguous array holding every list back to back. Lists
+ * are built in two passes, first allocateLists() with the count of each list
+ * and then insertCellReference() or setElementList() to write the values.
+ * @tparam T Type used to report list lengths
+ * @tparam K Type of the list values
+ */
 template <typename T, typename K>
 class DynamicListArray : public DataObject
 {
@@ -17,53 +35,56 @@ public:
 
   using Self = DynamicListArray<T, K>;
 
+  /**
+   * @brief Non-owning view of a single element list.
+   */
   struct ElementList
   {
     T ncells;
     K* cells;
   };
 
+  /**
+   * @brief Non-owning read-only view of a single element list.
+   */
+  struct ConstElementList
+  {
+    T ncells;
+    const K* cells;
+  };
+
   DynamicListArray(const DynamicListArray& other)
   : DataObject(other)
-  , m_Array(other.m_Array)
-  , m_Size(other.m_Size)
+  , m_Offsets(other.m_Offsets)
+  , m_Indices(other.m_Indices)
   {
   }
 
   DynamicListArray(DynamicListArray&& other)
   : DataObject(std::move(other))
-  , m_Array(std::move(other.m_Array))
-  , m_Size(std::move(other.m_Size))
+  , m_Offsets(std::move(other.m_Offsets))
+  , m_Indices(std::move(other.m_Indices))
   {
   }
 
-  // -----------------------------------------------------------------------------
-  //
-  // -----------------------------------------------------------------------------
-  virtual ~DynamicListArray()
+  virtual ~DynamicListArray() = default;
+
+  /**
+   * @brief Returns the number of lists. A moved-from array holds no lists.
+   * @return size_t
+   */
+  size_t size() const
   {
-    // This makes sure we deallocate any lists that have been created
-    for(size_t i = 0; i < this->m_Size; i++)
-    {
-      if(this->m_Array[i].cells != nullptr)
-      {
-        delete[] this->m_Array[i].cells;
-      }
-    }
-    // Now delete all the "ElementList" structures
-    if(this->m_Array != nullptr)
-    {
-      delete[] this->m_Array;
-    }
+    return m_Offsets.empty() ? 0 : m_Offsets.size() - 1;
   }
 
   /**
-   * @brief size
-   * @return
+   * @brief Returns the total number of values across all lists.
+   * @return size_t
    */
-  size_t size() const
+  size_t getTotalNumberOfElements() const
   {
-    return m_Size;
+    return m_Indices.size();
   }
 
   /**
@@ -72,28 +93,7 @@ public:
    */
   DataObject* deepCopy() override
   {
-    DynamicListArray* copy = new DynamicListArray(*this);
-    std::vector<T> linkCounts(m_Size, 0);
-    // if(forceNoAllocate)
-    //{
-    //  copy->allocateLists(linkCounts);
-    //  return copy;
-    //}
-
-    // Figure out how many entries, and for each entry, how many cells
-    for(size_t ptId = 0; ptId < m_Size; ptId++)
-    {
-      linkCounts[ptId] = this->m_Array[ptId].ncells;
-    }
-    // Allocate all that in the copy
-    copy->allocateLists(linkCounts);
-    // Copy the data from the original to the new
-    for(size_t ptId = 0; ptId < m_Size; ptId++)
-    {
-      ElementList& elementList = getElementList(ptId);
-      copy->setElementList(ptId, elementList);
-    }
-    return copy;
+    return new DynamicListArray(*this);
   }
 
   /**
@@ -113,42 +113,66 @@ public:
    */
   inline void insertCellReference(size_t ptId, size_t pos, size_t cellId)
   {
-    this->m_Array[ptId].cells[pos] = cellId;
+    m_Indices[m_Offsets[ptId] + pos] = static_cast<K>(cellId);
   }
 
   /**
-   * @brief Get a link structure given a point id.
+   * @brief Get a link structure given a point id. The list stays valid until
+   * the lists are reallocated or a list changes length.
    * @param ptId
    * @return
    */
-  ElementList& getElementList(size_t ptId) const
+  ElementList getElementList(size_t ptId)
   {
-    return this->m_Array[ptId];
+    return {getNumberOfElements(ptId), getElementListPointer(ptId)};
   }
 
   /**
-   * @brief setElementList
+   * @brief Get a read-only link structure given a point id. The list stays
+   * valid until the lists are reallocated or a list changes length.
+   * @param ptId
+   * @return
+   */
+  ConstElementList getElementList(size_t ptId) const
+  {
+    return {getNumberOfElements(ptId), getElementListPointer(ptId)};
+  }
+
+  /**
+   * @brief Replaces the list for the specified element. Lists keeping their
+   * length are overwritten in place. Changing the length of a list moves
+   * every following list, so lists should be sized with allocateLists()
+   * up front. data must not point into this array.
    * @param ptId
    * @param nCells
    * @param data
    * @return
    */
-  bool setElementList(size_t ptId, T nCells, K* data)
+  bool setElementList(size_t ptId, T nCells, const K* data)
   {
-    if(ptId >= m_Size)
+    if(ptId >= size())
     {
       return false;
     }
-    if(m_Array[ptId].cells != nullptr && m_Array[ptId].ncells > 0)
+    const size_t begin = m_Offsets[ptId];
+    const size_t oldCount = m_Offsets[ptId + 1] - begin;
+    const size_t newCount = static_cast<size_t>(nCells);
+    if(newCount != oldCount)
     {
-      delete[] this->m_Array[ptId].cells;
-      m_Array[ptId].cells = nullptr;
-      m_Array[ptId].ncells = 0;
+      if(newCount > oldCount)
+      {
+        m_Indices.insert(m_Indices.begin() + begin + oldCount, newCount - oldCount, K{0});
+      }
+      else
+      {
+        m_Indices.erase(m_Indices.begin() + begin + newCount, m_Indices.begin() + begin + oldCount);
+      }
+      for(size_t i = ptId + 1; i < m_Offsets.size(); i++)
+      {
+        m_Offsets[i] = m_Offsets[i] - oldCount + newCount;
+      }
     }
-    m_Array[ptId].ncells = nCells;
-    // If nCells is huge then there could be problems with this
-    this->m_Array[ptId].cells = new K[nCells];
-    std::memcpy(m_Array[ptId].cells, data, sizeof(K) * nCells);
+    std::copy(data, data + newCount, m_Indices.begin() + begin);
     return true;
   }
 
@@ -158,25 +182,20 @@ public:
    * @param list
    * @return
    */
-  bool setElementList(size_t ptId, ElementList& list)
+  bool setElementList(size_t ptId, const ElementList& list)
   {
-    T nCells = list.ncells;
-    K* data = list.cells;
-    if(ptId >= m_Size)
-    {
-      return false;
-    }
-    if(m_Array[ptId].cells != nullptr && m_Array[ptId].ncells > 0)
-    {
-      delete[] this->m_Array[ptId].cells;
-      m_Array[ptId].cells = nullptr;
-      m_Array[ptId].ncells = 0;
-    }
-    m_Array[ptId].ncells = nCells;
-    // If nCells is huge then there could be problems with this
-    this->m_Array[ptId].cells = new K[nCells];
-    std::memcpy(m_Array[ptId].cells, data, sizeof(K) * nCells);
-    return true;
+    return setElementList(ptId, list.ncells, list.cells);
+  }
+
+  /**
+   * @brief setElementList
+   * @param ptId
+   * @param list
+   * @return
+   */
+  bool setElementList(size_t ptId, const ConstElementList& list)
+  {
+    return setElementList(ptId, list.ncells, list.cells);
   }
 
   /**
@@ -186,7 +205,7 @@ public:
    */
   T getNumberOfElements(size_t ptId) const
   {
-    return this->m_Array[ptId].ncells;
+    return static_cast<T>(m_Offsets[ptId + 1] - m_Offsets[ptId]);
   }
 
   /**
@@ -194,52 +213,85 @@ public:
    * @param ptId
    * @return
    */
-  K* getElementListPointer(size_t ptId) const
+  K* getElementListPointer(size_t ptId)
   {
-    return this->m_Array[ptId].cells;
+    return m_Indices.data() + m_Offsets[ptId];
   }
 
   /**
-   * @brief deserializeLinks
+   * @brief Return a list of cell ids using the point.
+   * @param ptId
+   * @return
+   */
+  const K* getElementListPointer(size_t ptId) const
+  {
+    return m_Indices.data() + m_Offsets[ptId];
+  }
+
+  /**
+   * @brief Reads nElements lists from a buffer holding, for each list, its
+   * length as a T followed by its values. Throws an exception without
+   * modifying the array if a length is negative or the buffer is too short.
    * @param buffer
    * @param nElements
    */
   void deserializeLinks(std::vector<uint8_t>& buffer, size_t nElements)
   {
+    const uint8_t* bufPtr = buffer.data();
+
+    // Walk the buffer once to find and validate the length of each list
+    std::vector<T> linkCounts(nElements, 0);
     size_t offset = 0;
-    allocate(nElements); // Allocate all the links with 0 and nullptr;
-    uint8_t* bufPtr = &(buffer.front());
+    for(size_t i = 0; i < nElements; ++i)
+    {
+      if(buffer.size() - offset < sizeof(T))
+      {
+        throw std::runtime_error(fmt::format("DynamicListArray: buffer ends before the length of list {}", i));
+      }
+      std::memcpy(&linkCounts[i], bufPtr + offset, sizeof(T));
+      offset += sizeof(T);
+      if constexpr(std::is_signed_v<T>)
+      {
+        if(linkCounts[i] < 0)
+        {
+          throw std::runtime_error(fmt::format("DynamicListArray: list {} has a negative length", i));
+        }
+      }
+      const size_t count = static_cast<size_t>(linkCounts[i]);
+      if(count > (buffer.size() - offset) / sizeof(K))
+      {
+        throw std::runtime_error(fmt::format("DynamicListArray: buffer ends before the values of list {}", i));
+      }
+      offset += count * sizeof(K);
+    }
+    allocateLists(linkCounts);
 
-    // Walk the array and allocate all the array links to Zero and nullptr
-    T* ncells = nullptr;
-    // int32_t* cells = nullptr;
+    // Then copy each list into its place in the contiguous storage
+    offset = 0;
     for(size_t i = 0; i < nElements; ++i)
     {
-      ncells = reinterpret_cast<T*>(bufPtr + offset);
-      this->m_Array[i].ncells = *ncells; // Set the number of cells in this link
-      offset += 2;
-      this->m_Array[i].cells = new K[(*ncells)];                                   // Allocate a new chunk of memory to store the list
-      std::memcpy(this->m_Array[i].cells, bufPtr + offset, (*ncells) * sizeof(K)); // Copy from the buffer into the new list memory
-      offset += (*ncells) * sizeof(K);                                             // Increment the offset
+      offset += sizeof(T);
+      const size_t byteCount = static_cast<size_t>(linkCounts[i]) * sizeof(K);
+      std::memcpy(getElementListPointer(i), bufPtr + offset, byteCount);
+      offset += byteCount;
     }
   }
 
   /**
-   * @brief
+   * @brief Allocates one list per entry in linkCounts with the specified
+   * length. All values start out as zero. The offsets are computed with a
+   * parallel prefix sum and the lists are zeroed in parallel, so linkCounts
+   * may hold atomics that were incremented concurrently.
    * @param linkCounts
    */
   template <typename Container>
   void allocateLists(const Container& linkCounts)
   {
-    allocate(linkCounts.size());
-    for(typename std::vector<T>::size_type i = 0; i < linkCounts.size(); i++)
-    {
-      this->m_Array[i].ncells = linkCounts[i];
-      if(linkCounts[i] > 0)
-      {
-        this->m_Array[i].cells = new K[this->m_Array[i].ncells];
-      }
-    }
+    const size_t count = std::size(linkCounts);
+    allocate(count);
+    m_Offsets[count] = ParallelAlgorithms::ExclusiveScan(std::data(linkCounts), count, m_Offsets.data());
+    m_Indices.resize(m_Offsets[count]);
+    BulkCopy::FillValues(m_Indices.data(), m_Indices.size(), K{0});
   }
 
 protected:
@@ -253,41 +305,19 @@ protected:
   {
   }
 
-  //----------------------------------------------------------------------------
-  // This will allocate memory to hold all the NeighborList structures where each
-  // structure is initialized to Zero Entries and a nullptr Pointer
+  /**
+   * @brief Resets the array to sz empty lists.
+   * @param sz
+   */
   void allocate(size_t sz)
   {
-    static typename DynamicListArray<T, K>::ElementList linkInit = {0, nullptr};
-
-    // This makes sure we deallocate any lists that have been created
-    for(size_t i = 0; i < this->m_Size; i++)
-    {
-      if(this->m_Array[i].cells != nullptr)
-      {
-        delete[] this->m_Array[i].cells;
-      }
-    }
-    // Now delete all the "ElementList" structures
-    if(this->m_Array != nullptr)
-    {
-      delete[] this->m_Array;
-    }
-
-    this->m_Size = sz;
-    // Allocate a whole new set of structures
-    this->m_Array = new typename DynamicListArray<T, K>::ElementList[sz];
-
-    // Initialize each structure to have 0 entries and nullptr pointer.
-    for(size_t i = 0; i < sz; i++)
-    {
-      this->m_Array[i] = linkInit;
-    }
+    m_Offsets.assign(sz + 1, 0);
+    m_Indices.clear();
   }
 
 private:
-  ElementList* m_Array = nullptr; // pointer to data
-  size_t m_Size = 0;
+  std::vector<size_t> m_Offsets = {0}; // m_Offsets[i] is the start of list i in m_Indices
+  std::vector<K, DefaultInitAllocator<K>> m_Indices;
 };
 
 typedef DynamicListArray<int32_t, int32_t> Int32Int32DynamicListArray;
@@ -46,7 +46,8 @@ public:
    * @param other
    */
   EmptyDataStore(const EmptyDataStore& other)
-  : m_TupleCount(other.m_TupleCount)
+  : IDataStore<T>(other)
+  , m_TupleCount(other.m_TupleCount)
   , m_TupleSize(other.m_TupleSize)
   {
   }
@@ -0,0 +1,300 @@
+#pragma once
+
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+#include <type_traits>
+
+#include "complex/DataStructure/IDataStore.hpp"
+#include "complex/Utilities/BulkCopy.hpp"
+#include "complex/Utilities/MemoryMappedFile.hpp"
+
+namespace complex
+{
+/**
+ * @class FileDataStore
+ * @brief The FileDataStore class is an IDataStore whose values live in a
+ * memory-mapped file instead of the heap. The operating system pages the
+ * values in and out on demand, allowing arrays larger than the available RAM.
+ * Scratch stores are backed by an anonymous temporary file that is removed
+ * when the store is destroyed. Persistent stores are backed by a named file
+ * that is kept so it can be reopened later.
+ * @tparam T
+ */
+template <typename T>
+class FileDataStore : public IDataStore<T>
+{
+public:
+  static_assert(std::is_trivially_copyable_v<T>, "FileDataStore requires a trivially copyable value type");
+
+  using value_type = typename IDataStore<T>::value_type;
+  using reference = typename IDataStore<T>::reference;
+  using const_reference = typename IDataStore<T>::const_reference;
+  using pointer = typename IDataStore<T>::pointer;
+  using const_pointer = typename IDataStore<T>::const_pointer;
+
+  /**
+   * @brief Constructs a FileDataStore backed by a scratch file in the
+   * system's temporary directory. Values are zero-initialized.
+   * @param tupleSize
+   * @param tupleCount
+   */
+  FileDataStore(size_t tupleSize, size_t tupleCount)
+  : m_TupleSize(tupleSize)
+  , m_TupleCount(tupleCount)
+  , m_File(MemoryMappedFile::CreateScratch(tupleSize * tupleCount * sizeof(T)))
+  {
+  }
+
+  /**
+   * @brief Constructs a FileDataStore backed by a scratch file inside the
+   * specified directory. Values are zero-initialized.
+   * @param scratchDirectory
+   * @param tupleSize
+   * @param tupleCount
+   */
+  FileDataStore(const std::filesystem::path& scratchDirectory, size_t tupleSize, size_t tupleCount)
+  : m_TupleSize(tupleSize)
+  , m_TupleCount(tupleCount)
+  , m_File(MemoryMappedFile::CreateScratch(scratchDirectory, tupleSize * tupleCount * sizeof(T)))
+  {
+  }
+
+  /**
+   * @brief Creates a FileDataStore backed by the persistent file at the
+   * specified path. If the file already exists, its contents are kept up to
+   * the requested size so previously written values can be reopened.
+   * @param path
+   * @param tupleSize
+   * @param tupleCount
+   * @return FileDataStore*
+   */
+  static FileDataStore* OpenPersistent(const std::filesystem::path& path, size_t tupleSize, size_t tupleCount)
+  {
+    return new FileDataStore(tupleSize, tupleCount, MemoryMappedFile::OpenPersistent(path, tupleSize * tupleCount * sizeof(T)));
+  }
+
+  /**
+   * @brief Creates a FileDataStore that maps the values stored at the
+   * specified byte offset of an existing file without copying them. Values
+   * are paged in on first access and modified values are kept in memory, so
+   * the file itself is never changed.
+   * @param path
+   * @param offset
+   * @param tupleSize
+   * @param tupleCount
+   * @return FileDataStore*
+   */
+  static FileDataStore* OpenView(const std::filesystem::path& path, size_t offset, size_t tupleSize, size_t tupleCount)
+  {
+    return new FileDataStore(tupleSize, tupleCount, MemoryMappedFile::OpenView(path, offset, tupleSize * tupleCount * sizeof(T)));
+  }
+
+  FileDataStore(const FileDataStore& other) = delete;
+
+  /**
+   * @brief Move constructor
+   * @param other
+   */
+  FileDataStore(FileDataStore&& other) noexcept
+  : m_TupleSize(std::move(other.m_TupleSize))
+  , m_TupleCount(std::move(other.m_TupleCount))
+  , m_File(std::move(other.m_File))
+  {
+  }
+
+  virtual ~FileDataStore() = default;
+
+  /**
+   * @brief Returns the number of tuples in the FileDataStore.
+   * @return size_t
+   */
+  size_t getTupleCount() const override
+  {
+    return m_TupleCount;
+  }
+
+  /**
+   * @brief Returns the tuple size.
+   * @return size_t
+   */
+  size_t getTupleSize() const override
+  {
+    return m_TupleSize;
+  }
+
+  /**
+   * @brief Returns true if the backing file is deleted along with the store.
+   * @return bool
+   */
+  bool isScratch() const
+  {
+    return m_File.isScratch();
+  }
+
+  /**
+   * @brief Returns true if the store maps part of a file it does not modify.
+   * @return bool
+   */
+  bool isView() const
+  {
+    return m_File.isView();
+  }
+
+  /**
+   * @brief Returns the path of the backing file.
+   * @return std::filesystem::path
+   */
+  std::filesystem::path getFilePath() const
+  {
+    return m_File.getPath();
+  }
+
+  /**
+   * @brief Resizes the backing file to handle the specified number of tuples.
+   * Values added by growing the store are zero-initialized.
+   * @param numTuples
+   */
+  void resizeTuples(size_t numTuples) override
+  {
+    m_File.resize(numTuples * m_TupleSize * sizeof(T));
+    m_TupleCount = numTuples;
+  }
+
+  /**
+   * @brief Returns the value found at the specified index of the FileDataStore.
+   * This cannot be used to edit the value found at the specified index.
+   * @param index
+   * @return value_type
+   */
+  value_type getValue(size_t index) const override
+  {
+    return data()[index];
+  }
+
+  /**
+   * @brief Sets the value stored at the specified index.
+   * @param index
+   * @param value
+   */
+  void setValue(size_t index, value_type value) override
+  {
+    data()[index] = value;
+  }
+
+  /**
+   * @brief Returns the value found at the specified index of the FileDataStore.
+   * This cannot be used to edit the value found at the specified index.
+   * @param  index
+   * @return const_reference
+   */
+  const_reference operator[](size_t index) const override
+  {
+    return data()[index];
+  }
+
+  /**
+   * @brief Returns the value found at the specified index of the FileDataStore.
+   * This can be used to edit the value found at the specified index.
+   * @param  index
+   * @return reference
+   */
+  reference operator[](size_t index) override
+  {
+    return data()[index];
+  }
+
+  /**
+   * @brief Returns the value found at the specified index of the FileDataStore.
+   * Throws an exception if the index is out of range.
+   * @param index
+   * @return const_reference
+   */
+  const_reference at(size_t index) const override
+  {
+    if(index >= this->getSize())
+    {
+      throw std::runtime_error("FileDataStore index out of range");
+    }
+    return data()[index];
+  }
+
+  /**
+   * @brief Returns true. The mapped file is a single contiguous range of the
+   * address space.
+   * @return bool
+   */
+  bool isContiguous() const override
+  {
+    return true;
+  }
+
+  /**
+   * @brief Returns a pointer to the mapped values. The pointer is invalidated
+   * by resizeTuples().
+   * @return pointer
+   */
+  pointer data() override
+  {
+    return static_cast<pointer>(m_File.data());
+  }
+
+  /**
+   * @brief Returns a read-only pointer to the mapped values. The pointer is
+   * invalidated by resizeTuples().
+   * @return const_pointer
+   */
+  const_pointer data() const override
+  {
+    return static_cast<const_pointer>(m_File.data());
+  }
+
+  /**
+   * @brief Fills the FileDataStore with the specified value.
+   * @param value
+   */
+  void fill(value_type value) override
+  {
+    std::fill(data(), data() + this->getSize(), value);
+  }
+
+  /**
+   * @brief Writes modified values to the backing file.
+   */
+  void flush()
+  {
+    m_File.flush();
+  }
+
+  /**
+   * @brief Returns a deep copy of the data store and all its data. The copy is
+   * always backed by a new scratch file next to the existing backing file.
+   * @return IDataStore*
+   */
+  IDataStore<T>* deepCopy() const override
+  {
+    // The directory of a view may not be writable, so its copies use the temporary directory
+    auto copy = m_File.isView() ? new FileDataStore(m_TupleSize, m_TupleCount) : new FileDataStore(m_File.getPath().parent_path(), m_TupleSize, m_TupleCount);
+    BulkCopy::CopyValues(data(), copy->data(), this->getSize());
+    return copy;
+  }
+
+private:
+  /**
+   * @brief Constructs a FileDataStore from an already mapped file.
+   * @param tupleSize
+   * @param tupleCount
+   * @param file
+   */
+  FileDataStore(size_t tupleSize, size_t tupleCount, MemoryMappedFile&& file)
+  : m_TupleSize(tupleSize)
+  , m_TupleCount(tupleCount)
+  , m_File(std::move(file))
+  {
+  }
+
+  size_t m_TupleSize;
+  size_t m_TupleCount;
+  MemoryMappedFile m_File;
+};
+} // namespace complex
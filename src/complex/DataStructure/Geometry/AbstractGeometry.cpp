@@ -1,6 +1,7 @@
 #include "AbstractGeometry.hpp"
 
 #include "complex/DataStructure/DataStructure.hpp"
+#include "complex/DataStructure/Snapshot/SnapshotArchive.hpp"
 
 using namespace complex;
 
@@ -106,11 +107,16 @@ AbstractGeometry::AbstractGeometry(DataStructure* ds, const std::string& name)
 
 AbstractGeometry::AbstractGeometry(const AbstractGeometry& other)
 : BaseGroup(other)
+, m_ParametersVersion(other.m_ParametersVersion)
 {
+  auto lock = other.lockHierarchyShared();
+  m_DerivedSources = other.m_DerivedSources;
 }
 
 AbstractGeometry::AbstractGeometry(AbstractGeometry&& other) noexcept
 : BaseGroup(std::move(other))
+, m_DerivedSources(std::move(other.m_DerivedSources))
+, m_ParametersVersion(other.m_ParametersVersion)
 {
 }
 
@@ -188,3 +194,107 @@ AbstractGeometry::SharedEdgeList* AbstractGeometry::createSharedEdgeList(size_t
   edges->getDataStore()->fill(0.0);
   return edges;
 }
+
+AbstractGeometry::SourceVersion AbstractGeometry::parametersVersion() const
+{
+  return {getId(), m_ParametersVersion};
+}
+
+void AbstractGeometry::markParametersModified()
+{
+  m_ParametersVersion++;
+}
+
+AbstractGeometry::SourceVersions AbstractGeometry::getGeometrySources() const
+{
+  return {parametersVersion()};
+}
+
+AbstractGeometry::SourceVersions AbstractGeometry::getConnectivitySources() const
+{
+  return {parametersVersion()};
+}
+
+std::vector<DataObject::IdType> AbstractGeometry::getDerivedIds() const
+{
+  auto lock = lockHierarchyShared();
+  std::vector<DataObject::IdType> ids;
+  ids.reserve(m_DerivedSources.size());
+  for(const auto& entry : m_DerivedSources)
+  {
+    ids.push_back(entry.first);
+  }
+  return ids;
+}
+
+void AbstractGeometry::recordDerived(const std::optional<DataObject::IdType>& derivedId, SourceVersions sources)
+{
+  if(!derivedId)
+  {
+    return;
+  }
+  auto lock = lockHierarchy();
+  m_DerivedSources[*derivedId] = std::move(sources);
+}
+
+void AbstractGeometry::deleteDerived(std::optional<DataObject::IdType>& derivedId)
+{
+  auto lock = lockHierarchy();
+  if(derivedId)
+  {
+    m_DerivedSources.erase(*derivedId);
+  }
+  getDataStructure()->removeData(derivedId);
+  derivedId.reset();
+}
+
+bool AbstractGeometry::isDerivedCurrent(const std::optional<DataObject::IdType>& derivedId, const SourceVersions& sources) const
+{
+  if(!derivedId)
+  {
+    return false;
+  }
+  auto lock = lockHierarchyShared();
+  auto iter = m_DerivedSources.find(*derivedId);
+  return iter != m_DerivedSources.end() && iter->second == sources && getDataStructure()->getData(derivedId) != nullptr;
+}
+
+const DataObject* AbstractGeometry::getDerivedObject(const std::optional<DataObject::IdType>& derivedId, const SourceVersions& sources, const std::function<StatusCode()>& find) const
+{
+  {
+    auto lock = lockHierarchyShared();
+    if(isDerivedCurrent(derivedId, sources))
+    {
+      return getDataStructure()->getData(derivedId);
+    }
+  }
+
+  // Another thread may have computed the object while this one waited
+  auto lock = lockHierarchy();
+  if(isDerivedCurrent(derivedId, sources))
+  {
+    return getDataStructure()->getData(derivedId);
+  }
+  if(derivedId)
+  {
+    // The stale object is replaced by the one find creates
+    auto geometry = const_cast<AbstractGeometry*>(this);
+    geometry->m_DerivedSources.erase(*derivedId);
+    geometry->getDataStructure()->removeData(derivedId);
+  }
+  if(find() < 0)
+  {
+    return nullptr;
+  }
+  return getDataStructure()->getData(derivedId);
+}
+
+void AbstractGeometry::serializeSnapshot(SnapshotArchive& archive)
+{
+  BaseGroup::serializeSnapshot(archive);
+  archive.value(m_Units);
+  archive.value(m_IsTimeSeriesEnabled);
+  archive.value(m_TimeValue);
+  archive.value(m_UnitDimensionality);
+  archive.value(m_SpacialDimensionality);
+}
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <functional>
+#include <map>
 #include <memory>
+#include <optional>
+#include <vector>
 
 #include "complex/Common/Point3D.hpp"
 #include "complex/DataStructure/BaseGroup.hpp"
@@ -374,6 +378,19 @@ public:
    */
   virtual void initializeWithZeros() = 0;
 
+  /**
+   * @brief Returns the IDs of the objects the geometry has computed from its
+   * arrays or parameters, such as element sizes and neighbor lists.
+   * @return std::vector<DataObject::IdType>
+   */
+  std::vector<DataObject::IdType> getDerivedIds() const;
+
+  /**
+   * @brief Writes or reads the units, time series settings and dimensionality.
+   * @param archive
+   */
+  void serializeSnapshot(SnapshotArchive& archive) override;
+
 protected:
   /**
    * @brief
@@ -413,6 +430,131 @@ protected:
    */
   SharedEdgeList* createSharedEdgeList(size_t numEdges);
 
+  /**
+   * @brief Identifies the state of one source of a derived object, either an
+   * array or the parameters of the geometry itself.
+   */
+  struct SourceVersion
+  {
+    std::optional<DataObject::IdType> id;
+    uint64_t version = 0;
+
+    bool operator==(const SourceVersion& rhs) const
+    {
+      return id == rhs.id && version == rhs.version;
+    }
+  };
+  using SourceVersions = std::vector<SourceVersion>;
+
+  /**
+   * @brief Returns the source state of the array's values. It changes
+   * whenever the array's values may have been written or its DataStore is
+   * replaced.
+   * @tparam T
+   * @param array
+   * @return SourceVersion
+   */
+  template <typename T>
+  static SourceVersion ValuesVersion(const DataArray<T>* array)
+  {
+    if(array == nullptr)
+    {
+      return {};
+    }
+    return {array->getId(), array->getVersion()};
+  }
+
+  /**
+   * @brief Returns the source state of the array's tuple count for derived
+   * objects that depend on the size of an array but not on its values.
+   * @tparam T
+   * @param array
+   * @return SourceVersion
+   */
+  template <typename T>
+  static SourceVersion TupleCountVersion(const DataArray<T>* array)
+  {
+    if(array == nullptr)
+    {
+      return {};
+    }
+    return {array->getId(), array->getTupleCount()};
+  }
+
+  /**
+   * @brief Returns the source state of the geometry's own parameters such as
+   * dimensions or spacing.
+   * @return SourceVersion
+   */
+  SourceVersion parametersVersion() const;
+
+  /**
+   * @brief Invalidates every derived object that depends on the geometry's
+   * own parameters. Called by setters of such parameters.
+   */
+  void markParametersModified();
+
+  /**
+   * @brief Returns the sources the element sizes and centroids are computed
+   * from. Defaults to the geometry's parameters.
+   * @return SourceVersions
+   */
+  virtual SourceVersions getGeometrySources() const;
+
+  /**
+   * @brief Returns the sources the elements containing each vertex and the
+   * element neighbors are computed from. Defaults to the geometry's
+   * parameters.
+   * @return SourceVersions
+   */
+  virtual SourceVersions getConnectivitySources() const;
+
+  /**
+   * @brief Records that the derived object was computed from the current
+   * state of sources.
+   * @param derivedId
+   * @param sources
+   */
+  void recordDerived(const std::optional<DataObject::IdType>& derivedId, SourceVersions sources);
+
+  /**
+   * @brief Removes the derived object from the DataStructure, forgets its
+   * sources and resets derivedId.
+   * @param derivedId
+   */
+  void deleteDerived(std::optional<DataObject::IdType>& derivedId);
+
+  /**
+   * @brief Returns true if the derived object exists and was computed from
+   * the current state of sources.
+   * @param derivedId
+   * @param sources
+   * @return bool
+   */
+  bool isDerivedCurrent(const std::optional<DataObject::IdType>& derivedId, const SourceVersions& sources) const;
+
+  /**
+   * @brief Returns the derived object if it was computed from the current
+   * state of sources. Otherwise removes the stale object, calls find to
+   * compute it again and returns the result, or nullptr if find fails. The
+   * geometry does not change logically, so this is allowed on const
+   * geometries. The check holds the DataStructure's hierarchy lock shared
+   * and the recomputation holds it exclusively, so concurrent callers
+   * compute the object once and receive the same object.
+   * @tparam DerivedT
+   * @tparam GeomT
+   * @param derivedId Member holding the id of the derived object. find updates it.
+   * @param sources
+   * @param find
+   * @return const DerivedT*
+   */
+  template <typename DerivedT, typename GeomT>
+  const DerivedT* getDerived(const std::optional<DataObject::IdType>& derivedId, const SourceVersions& sources, StatusCode (GeomT::*find)()) const
+  {
+    auto geometry = const_cast<GeomT*>(dynamic_cast<const GeomT*>(this));
+    return dynamic_cast<const DerivedT*>(getDerivedObject(derivedId, sources, [geometry, find]() { return (geometry->*find)(); }));
+  }
+
   /**
    * @brief
    * @param obj
@@ -421,6 +563,17 @@ protected:
   bool canInsert(const DataObject* obj) const override;
 
 private:
+  /**
+   * @brief Non-template implementation of getDerived().
+   * @param derivedId
+   * @param sources
+   * @param find
+   * @return const DataObject*
+   */
+  const DataObject* getDerivedObject(const std::optional<DataObject::IdType>& derivedId, const SourceVersions& sources, const std::function<StatusCode()>& find) const;
+
+  std::map<DataObject::IdType, SourceVersions> m_DerivedSources;
+  uint64_t m_ParametersVersion = 0;
   LengthUnit m_Units = LengthUnit::Meter;
   bool m_IsTimeSeriesEnabled = false;
   float m_TimeValue = 0.0f;
@@ -1,5 +1,6 @@
 #include "AbstractGeometry2D.hpp"
 #include "complex/DataStructure/DataStructure.hpp"
+#include "complex/DataStructure/Snapshot/SnapshotArchive.hpp"
 
 using namespace complex;
 
@@ -13,6 +14,7 @@ AbstractGeometry2D::AbstractGeometry2D(const AbstractGeometry2D& other)
 , m_VertexListId(other.m_VertexListId)
 , m_EdgeListId(other.m_EdgeListId)
 , m_UnsharedEdgeListId(other.m_UnsharedEdgeListId)
+, m_HalfEdgeTopologyId(other.m_HalfEdgeTopologyId)
 {
 }
 
@@ -21,6 +23,7 @@ AbstractGeometry2D::AbstractGeometry2D(AbstractGeometry2D&& other) noexcept
 , m_VertexListId(std::move(other.m_VertexListId))
 , m_EdgeListId(std::move(other.m_EdgeListId))
 , m_UnsharedEdgeListId(std::move(other.m_UnsharedEdgeListId))
+, m_HalfEdgeTopologyId(std::move(other.m_HalfEdgeTopologyId))
 {
 }
 
@@ -131,3 +134,36 @@ void AbstractGeometry2D::setUnsharedEdges(const SharedEdgeList* bEdgeList)
   }
   m_UnsharedEdgeListId = bEdgeList->getId();
 }
+
+const HalfEdgeTopology* AbstractGeometry2D::getHalfEdgeTopology() const
+{
+  return getDerived<HalfEdgeTopology>(m_HalfEdgeTopologyId, getConnectivitySources(), &AbstractGeometry2D::findHalfEdgeTopology);
+}
+
+bool AbstractGeometry2D::hasHalfEdgeTopology() const
+{
+  return isDerivedCurrent(m_HalfEdgeTopologyId, getConnectivitySources());
+}
+
+void AbstractGeometry2D::deleteHalfEdgeTopology()
+{
+  deleteDerived(m_HalfEdgeTopologyId);
+}
+
+void AbstractGeometry2D::setHalfEdgeTopology(const HalfEdgeTopology* topology)
+{
+  if(!topology)
+  {
+    m_HalfEdgeTopologyId.reset();
+    return;
+  }
+  m_HalfEdgeTopologyId = topology->getId();
+}
+
+void AbstractGeometry2D::serializeSnapshot(SnapshotArchive& archive)
+{
+  AbstractGeometry::serializeSnapshot(archive);
+  archive.reference(m_VertexListId);
+  archive.reference(m_EdgeListId);
+  archive.reference(m_UnsharedEdgeListId);
+}
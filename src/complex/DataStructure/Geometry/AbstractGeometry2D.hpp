@@ -1,6 +1,7 @@
 #pragma once
 
 #include "complex/DataStructure/Geometry/AbstractGeometry.hpp"
+#include "complex/DataStructure/Geometry/HalfEdgeTopology.hpp"
 
 #include "complex/complex_export.hpp"
 
@@ -148,6 +149,45 @@ public:
    */
   void setUnsharedEdges(const SharedEdgeList* bEdgeList);
 
+  /**
+   * @brief Builds the half-edge topology of the faces and stores it as a
+   * child of the geometry, replacing any previous topology. While it is
+   * current, findEdges() and findUnsharedEdges() read the edges from it.
+   * @return StatusCode
+   */
+  virtual StatusCode findHalfEdgeTopology() = 0;
+
+  /**
+   * @brief Returns the half-edge topology, building it first if it does not
+   * exist or the faces changed since it was built. Returns nullptr if it
+   * cannot be built.
+   * @return const HalfEdgeTopology*
+   */
+  const HalfEdgeTopology* getHalfEdgeTopology() const;
+
+  /**
+   * @brief Returns true if a half-edge topology of the current faces exists.
+   * @return bool
+   */
+  bool hasHalfEdgeTopology() const;
+
+  /**
+   * @brief
+   */
+  void deleteHalfEdgeTopology();
+
+  /**
+   * @brief
+   * @param topology
+   */
+  void setHalfEdgeTopology(const HalfEdgeTopology* topology);
+
+  /**
+   * @brief Writes or reads the vertex and edge lists.
+   * @param archive
+   */
+  void serializeSnapshot(SnapshotArchive& archive) override;
+
 protected:
   /**
    * @brief
@@ -172,5 +212,6 @@ private:
   std::optional<DataObject::IdType> m_VertexListId;
   std::optional<DataObject::IdType> m_EdgeListId;
   std::optional<DataObject::IdType> m_UnsharedEdgeListId;
+  std::optional<DataObject::IdType> m_HalfEdgeTopologyId;
 };
 } // namespace complex
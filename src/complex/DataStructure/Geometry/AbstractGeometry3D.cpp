@@ -1,6 +1,7 @@
 #include "AbstractGeometry3D.hpp"
 
 #include "complex/DataStructure/DataStructure.hpp"
+#include "complex/DataStructure/Snapshot/SnapshotArchive.hpp"
 
 using namespace complex;
 
@@ -289,3 +290,13 @@ void AbstractGeometry3D::setUnsharedFaces(const SharedFaceList* bFaceList)
   }
   m_UnsharedFaceListId = bFaceList->getId();
 }
+
+void AbstractGeometry3D::serializeSnapshot(SnapshotArchive& archive)
+{
+  AbstractGeometry::serializeSnapshot(archive);
+  archive.reference(m_VertexListId);
+  archive.reference(m_EdgeListId);
+  archive.reference(m_UnsharedEdgeListId);
+  archive.reference(m_FaceListId);
+  archive.reference(m_UnsharedFaceListId);
+}
@@ -225,6 +225,12 @@ public:
    */
   void setUnsharedFaces(const SharedFaceList* bFaceList);
 
+  /**
+   * @brief Writes or reads the vertex, edge and face lists.
+   * @param archive
+   */
+  void serializeSnapshot(SnapshotArchive& archive) override;
+
 protected:
   /**
    * @brief
@@ -0,0 +1,775 @@
+#include "BoundingVolumeHierarchy.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <stdexcept>
+
+#include <fmt/core.h>
+
+#include "complex/Utilities/GeometryHelpers.hpp"
+#include "complex/Utilities/ParallelAlgorithms.hpp"
+#include "complex/Utilities/ThreadPool.hpp"
+
+using namespace complex;
+using Vec3f = GeometryMath::detail::Vec3<float>;
+
+namespace
+{
+constexpr usize k_MaxLeafSize = 4;
+constexpr usize k_NumBins = 16;
+
+// Ranges above this size are split serially with parallel binning and
+// become independent subtrees below it
+constexpr usize k_SubtreeSize = 16 * 1024;
+constexpr usize k_ParallelBinningSize = 64 * 1024;
+
+// Past this depth ranges are split at the median so the tree depth stays
+// bounded for any input
+constexpr usize k_MaxSahDepth = 48;
+
+// Centroid extents within this many float steps of the coordinates are
+// split at the median, since binning them cannot separate the faces
+constexpr float k_MinBinnedExtentSteps = 4.0f * static_cast<float>(k_NumBins);
+constexpr usize k_StackSize = 128;
+
+constexpr usize k_MinQuerySliceCount = 256;
+constexpr usize k_QueryGranularity = 64;
+
+constexpr float k_Infinity = std::numeric_limits<float>::infinity();
+
+struct Box
+{
+  Vec3f min = {k_Infinity, k_Infinity, k_Infinity};
+  Vec3f max = {-k_Infinity, -k_Infinity, -k_Infinity};
+
+  void grow(const Vec3f& point)
+  {
+    for(usize i = 0; i < 3; i++)
+    {
+      min[i] = std::min(min[i], point[i]);
+      max[i] = std::max(max[i], point[i]);
+    }
+  }
+
+  void grow(const Box& box)
+  {
+    for(usize i = 0; i < 3; i++)
+    {
+      min[i] = std::min(min[i], box.min[i]);
+      max[i] = std::max(max[i], box.max[i]);
+    }
+  }
+
+  /**
+   * @brief Returns half the surface area, which is all the SAH needs.
+   */
+  float halfArea() const
+  {
+    const float x = max[0] - min[0];
+    const float y = max[1] - min[1];
+    const float z = max[2] - min[2];
+    return (x < 0.0f) ? 0.0f : (x * y + y * z + z * x);
+  }
+};
+
+struct Primitive
+{
+  Box bounds;
+  Vec3f centroid;
+};
+
+struct Bin
+{
+  Box bounds;
+  usize count = 0;
+};
+
+/**
+ * @brief Node of a tree under construction: the node index together with
+ * the range of the face order it covers.
+ */
+struct BuildTask
+{
+  u32 node;
+  usize first;
+  usize count;
+  usize depth;
+};
+
+/**
+ * @brief Calls function(begin, end) over [0, count), in parallel slices if
+ * parallel is true and on the calling thread otherwise.
+ */
+template <typename FunctionT>
+void ForEachSlice(usize count, bool parallel, const FunctionT& function)
+{
+  if(!parallel)
+  {
+    function(0, count);
+    return;
+  }
+  ThreadPool::Global().parallelFor(count, k_ParallelBinningSize / 4, 1, function);
+}
+
+/**
+ * @brief Splits the range of the order covered by task and returns the
+ * number of faces that go to the first child, or zero if the range becomes
+ * a leaf. Writes the bounds of the range to bounds.
+ */
+usize SplitRange(const std::vector<Primitive>& primitives, std::vector<u64>& order, const BuildTask& task, Box& bounds)
+{
+  const bool parallel = task.count >= k_ParallelBinningSize;
+  u64* faces = order.data() + task.first;
+
+  Box centroidBounds;
+  bounds = Box();
+  std::mutex mutex;
+  ForEachSlice(task.count, parallel, [&](usize begin, usize end) {
+    Box sliceBounds;
+    Box sliceCentroids;
+    for(usize i = begin; i < end; i++)
+    {
+      const Primitive& primitive = primitives[faces[i]];
+      sliceBounds.grow(primitive.bounds);
+      sliceCentroids.grow(primitive.centroid);
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    bounds.grow(sliceBounds);
+    centroidBounds.grow(sliceCentroids);
+  });
+  if(task.count <= k_MaxLeafSize)
+  {
+    return 0;
+  }
+
+  usize axis = 0;
+  for(usize i = 1; i < 3; i++)
+  {
+    if(centroidBounds.max[i] - centroidBounds.min[i] > centroidBounds.max[axis] - centroidBounds.min[axis])
+    {
+      axis = i;
+    }
+  }
+  const float extent = centroidBounds.max[axis] - centroidBounds.min[axis];
+  const float magnitude = std::fmax(std::fabs(centroidBounds.min[axis]), std::fabs(centroidBounds.max[axis]));
+  const float minExtent = std::fmax(std::numeric_limits<float>::min(), k_MinBinnedExtentSteps * std::numeric_limits<float>::epsilon() * magnitude);
+  if(!(extent >= minExtent) || task.depth >= k_MaxSahDepth)
+  {
+    // Nearly coincident centroids or a deep tree: split at the median
+    const usize half = task.count / 2;
+    std::nth_element(faces, faces + half, faces + task.count, [&](u64 a, u64 b) { return primitives[a].centroid[axis] < primitives[b].centroid[axis]; });
+    return half;
+  }
+
+  const float binScale = static_cast<float>(k_NumBins) / extent;
+  const float binOrigin = centroidBounds.min[axis];
+  constexpr float lastBin = static_cast<float>(k_NumBins - 1);
+  auto binIndex = [&](u64 face) {
+    // Clamp before the cast, which is undefined for values out of range
+    const float bin = (primitives[face].centroid[axis] - binOrigin) * binScale;
+    return static_cast<usize>(std::fmin(std::fmax(bin, 0.0f), lastBin));
+  };
+
+  std::array<Bin, k_NumBins> bins;
+  ForEachSlice(task.count, parallel, [&](usize begin, usize end) {
+    std::array<Bin, k_NumBins> sliceBins;
+    for(usize i = begin; i < end; i++)
+    {
+      Bin& bin = sliceBins[binIndex(faces[i])];
+      bin.bounds.grow(primitives[faces[i]].bounds);
+      bin.count++;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    for(usize b = 0; b < k_NumBins; b++)
+    {
+      bins[b].bounds.grow(sliceBins[b].bounds);
+      bins[b].count += sliceBins[b].count;
+    }
+  });
+
+  // The first and last bins hold the extreme centroids, so every split
+  // between bins leaves faces on both sides
+  std::array<float, k_NumBins> rightCosts = {};
+  Box rightBounds;
+  usize rightCount = 0;
+  for(usize b = k_NumBins - 1; b > 0; b--)
+  {
+    rightBounds.grow(bins[b].bounds);
+    rightCount += bins[b].count;
+    rightCosts[b] = rightBounds.halfArea() * static_cast<float>(rightCount);
+  }
+  Box leftBounds;
+  usize leftCount = 0;
+  usize bestSplit = 0;
+  float bestCost = k_Infinity;
+  for(usize b = 0; b + 1 < k_NumBins; b++)
+  {
+    leftBounds.grow(bins[b].bounds);
+    leftCount += bins[b].count;
+    const float cost = leftBounds.halfArea() * static_cast<float>(leftCount) + rightCosts[b + 1];
+    if(cost < bestCost)
+    {
+      bestCost = cost;
+      bestSplit = b;
+    }
+  }
+
+  u64* middle = std::partition(faces, faces + task.count, [&](u64 face) { return binIndex(face) <= bestSplit; });
+  return static_cast<usize>(middle - faces);
+}
+
+/**
+ * @brief Writes the bounds of box to node.
+ */
+template <typename NodeT>
+void SetBounds(NodeT& node, const Box& box)
+{
+  node.min = box.min;
+  node.max = box.max;
+}
+
+/**
+ * @brief Returns the distance at which the ray enters the node, or infinity
+ * if it misses the node before length. Axes the ray is parallel to are
+ * tested for containment, since an origin on a slab plane gives 0 * inf.
+ */
+template <typename NodeT>
+float EnterNode(const NodeT& node, const Vec3f& origin, const Vec3f& invDir, float length)
+{
+  float near = 0.0f;
+  float far = length;
+  for(usize i = 0; i < 3; i++)
+  {
+    if(std::isinf(invDir[i]))
+    {
+      if(origin[i] < node.min[i] || origin[i] > node.max[i])
+      {
+        return k_Infinity;
+      }
+      continue;
+    }
+    const float t0 = (node.min[i] - origin[i]) * invDir[i];
+    const float t1 = (node.max[i] - origin[i]) * invDir[i];
+    near = std::fmax(near, std::fmin(t0, t1));
+    far = std::fmin(far, std::fmax(t0, t1));
+  }
+  return (near <= far) ? near : k_Infinity;
+}
+
+/**
+ * @brief Returns the squared distance between the point and the node.
+ */
+template <typename NodeT>
+float NodeDistanceSquared(const NodeT& node, const Vec3f& point)
+{
+  float distance = 0.0f;
+  for(usize i = 0; i < 3; i++)
+  {
+    const float offset = std::max({node.min[i] - point[i], 0.0f, point[i] - node.max[i]});
+    distance += offset * offset;
+  }
+  return distance;
+}
+
+Vec3f Add(const Vec3f& a, const Vec3f& b, float scale)
+{
+  return {a[0] + scale * b[0], a[1] + scale * b[1], a[2] + scale * b[2]};
+}
+
+/**
+ * @brief Returns the point of triangle (a, a + ab, a + ac) closest to p by
+ * finding the Voronoi region of the triangle that contains p.
+ */
+Vec3f ClosestPointOnTriangle(const Vec3f& p, const Vec3f& a, const Vec3f& ab, const Vec3f& ac)
+{
+  using GeometryMath::detail::Dot;
+  using GeometryMath::detail::Subtract;
+
+  const Vec3f ap = Subtract(p, a);
+  const float d1 = Dot(ab, ap);
+  const float d2 = Dot(ac, ap);
+  if(d1 <= 0.0f && d2 <= 0.0f)
+  {
+    return a;
+  }
+  const Vec3f b = Add(a, ab, 1.0f);
+  const Vec3f bp = Subtract(p, b);
+  const float d3 = Dot(ab, bp);
+  const float d4 = Dot(ac, bp);
+  if(d3 >= 0.0f && d4 <= d3)
+  {
+    return b;
+  }
+  const float vc = d1 * d4 - d3 * d2;
+  if(vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+  {
+    return Add(a, ab, d1 / (d1 - d3));
+  }
+  const Vec3f c = Add(a, ac, 1.0f);
+  const Vec3f cp = Subtract(p, c);
+  const float d5 = Dot(ab, cp);
+  const float d6 = Dot(ac, cp);
+  if(d6 >= 0.0f && d5 <= d6)
+  {
+    return c;
+  }
+  const float vb = d5 * d2 - d1 * d6;
+  if(vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+  {
+    return Add(a, ac, d2 / (d2 - d6));
+  }
+  const float va = d3 * d6 - d5 * d4;
+  if(va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+  {
+    return Add(b, Subtract(c, b), (d4 - d3) / ((d4 - d3) + (d5 - d6)));
+  }
+  const float denominator = 1.0f / (va + vb + vc);
+  return Add(Add(a, ab, vb * denominator), ac, vc * denominator);
+}
+
+Vec3f InverseDirection(const Vec3f& dir)
+{
+  return {1.0f / dir[0], 1.0f / dir[1], 1.0f / dir[2]};
+}
+
+Vec3f Normalize(const Vec3f& dir)
+{
+  const float length = std::sqrt(GeometryMath::detail::Dot(dir, dir));
+  return {dir[0] / length, dir[1] / length, dir[2] / length};
+}
+
+// Skewed directions for the inside test, unlikely to run along mesh edges
+const std::array<Vec3f, 3> k_InsideDirections = {Normalize({0.6172f, 0.4193f, 0.6659f}), Normalize({-0.3947f, 0.8161f, 0.4221f}), Normalize({0.2710f, -0.5483f, -0.7911f})};
+} // namespace
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy(DataStructure* ds, const std::string& name)
+: DataObject(ds, name)
+, m_Hierarchy(std::make_shared<const Hierarchy>())
+{
+}
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy(const BoundingVolumeHierarchy& other)
+: DataObject(other)
+, m_Hierarchy(other.m_Hierarchy)
+{
+}
+
+BoundingVolumeHierarchy::BoundingVolumeHierarchy(BoundingVolumeHierarchy&& other) noexcept
+: DataObject(std::move(other))
+, m_Hierarchy(std::move(other.m_Hierarchy))
+{
+}
+
+BoundingVolumeHierarchy::~BoundingVolumeHierarchy() = default;
+
+DataObject* BoundingVolumeHierarchy::shallowCopy()
+{
+  return new BoundingVolumeHierarchy(*this);
+}
+
+DataObject* BoundingVolumeHierarchy::deepCopy()
+{
+  return new BoundingVolumeHierarchy(*this);
+}
+
+void BoundingVolumeHierarchy::build(const DataArray<MeshIndexType>& triangles, const DataArray<float>& vertices)
+{
+  namespace Connectivity = GeometryHelpers::Connectivity;
+
+  if(triangles.getTupleSize() != 3 || vertices.getTupleSize() != 3)
+  {
+    throw std::runtime_error(fmt::format("Bounding volume hierarchy requires triangles and 3D vertices, got {} vertices per face and {} coordinates per vertex", triangles.getTupleSize(),
+                                         vertices.getTupleSize()));
+  }
+  const usize numFaces = triangles.getTupleCount();
+  const usize numVertices = vertices.getTupleCount();
+  if(numFaces >= std::numeric_limits<u32>::max())
+  {
+    throw std::runtime_error(fmt::format("Bounding volume hierarchy supports fewer than {} faces, got {}", std::numeric_limits<u32>::max(), numFaces));
+  }
+  if(numFaces > 0 && ParallelAlgorithms::Max(*triangles.getDataStore()) >= numVertices)
+  {
+    throw std::runtime_error(fmt::format("Triangle list refers to vertices beyond the {} vertices of the mesh", numVertices));
+  }
+
+  auto hierarchy = std::make_shared<Hierarchy>();
+  if(numFaces == 0)
+  {
+    m_Hierarchy = std::move(hierarchy);
+    return;
+  }
+
+  std::vector<MeshIndexType> faceBuffer;
+  const MeshIndexType* corners = Connectivity::detail::GetContiguousValues(*triangles.getDataStore(), faceBuffer);
+  std::vector<float> vertexBuffer;
+  const float* coords = Connectivity::detail::GetContiguousValues(*vertices.getDataStore(), vertexBuffer);
+  ThreadPool& pool = ThreadPool::Global();
+
+  std::vector<Primitive> primitives(numFaces);
+  std::vector<u64> order(numFaces);
+  pool.parallelFor(numFaces, Connectivity::detail::k_MinSliceCount, 1, [&](usize begin, usize end) {
+    for(usize face = begin; face < end; face++)
+    {
+      Primitive& primitive = primitives[face];
+      for(usize k = 0; k < 3; k++)
+      {
+        const float* vertex = coords + 3 * corners[3 * face + k];
+        primitive.bounds.grow(Vec3f{vertex[0], vertex[1], vertex[2]});
+      }
+      for(usize i = 0; i < 3; i++)
+      {
+        primitive.centroid[i] = 0.5f * (primitive.bounds.min[i] + primitive.bounds.max[i]);
+      }
+      order[face] = face;
+    }
+  });
+
+  // Upper levels: split large ranges one at a time with parallel binning
+  std::vector<Node>& nodes = hierarchy->nodes;
+  nodes.push_back(Node{});
+  std::vector<BuildTask> subtrees;
+  std::vector<BuildTask> pending = {BuildTask{0, 0, numFaces, 0}};
+  while(!pending.empty())
+  {
+    const BuildTask task = pending.back();
+    pending.pop_back();
+    if(task.count <= k_SubtreeSize)
+    {
+      subtrees.push_back(task);
+      continue;
+    }
+    Box bounds;
+    const usize leftCount = SplitRange(primitives, order, task, bounds);
+    const auto children = static_cast<u32>(nodes.size());
+    nodes.resize(nodes.size() + 2);
+    SetBounds(nodes[task.node], bounds);
+    nodes[task.node].index = children;
+    nodes[task.node].count = 0;
+    pending.push_back(BuildTask{children, task.first, leftCount, task.depth + 1});
+    pending.push_back(BuildTask{children + 1, task.first + leftCount, task.count - leftCount, task.depth + 1});
+  }
+
+  // Lower levels: build each subtree into its own node list in parallel
+  std::vector<std::vector<Node>> subtreeNodes(subtrees.size());
+  pool.parallelFor(subtrees.size(), 1, 1, [&](usize begin, usize end) {
+    for(usize s = begin; s < end; s++)
+    {
+      std::vector<Node>& local = subtreeNodes[s];
+      local.push_back(Node{});
+      std::vector<BuildTask> stack = {BuildTask{0, subtrees[s].first, subtrees[s].count, subtrees[s].depth}};
+      while(!stack.empty())
+      {
+        const BuildTask task = stack.back();
+        stack.pop_back();
+        Box bounds;
+        const usize leftCount = SplitRange(primitives, order, task, bounds);
+        SetBounds(local[task.node], bounds);
+        if(leftCount == 0)
+        {
+          local[task.node].index = static_cast<u32>(task.first);
+          local[task.node].count = static_cast<u32>(task.count);
+          continue;
+        }
+        const auto children = static_cast<u32>(local.size());
+        local.resize(local.size() + 2);
+        local[task.node].index = children;
+        local[task.node].count = 0;
+        stack.push_back(BuildTask{children, task.first, leftCount, task.depth + 1});
+        stack.push_back(BuildTask{children + 1, task.first + leftCount, task.count - leftCount, task.depth + 1});
+      }
+    }
+  });
+
+  // Splice the subtrees in: each root replaces its placeholder and the rest
+  // of its nodes are appended, shifting their child indices
+  std::vector<usize> subtreeSizes(subtrees.size());
+  for(usize s = 0; s < subtrees.size(); s++)
+  {
+    subtreeSizes[s] = subtreeNodes[s].size() - 1;
+  }
+  std::vector<usize> subtreeOffsets(subtrees.size());
+  const usize topCount = nodes.size();
+  nodes.resize(topCount + ParallelAlgorithms::ExclusiveScan(subtreeSizes.data(), subtreeSizes.size(), subtreeOffsets.data()));
+  pool.parallelFor(subtrees.size(), 1, 1, [&](usize begin, usize end) {
+    for(usize s = begin; s < end; s++)
+    {
+      const usize base = topCount + subtreeOffsets[s];
+      auto relocate = [base](Node node) {
+        if(node.count == 0)
+        {
+          node.index = static_cast<u32>(base + node.index - 1);
+        }
+        return node;
+      };
+      const std::vector<Node>& local = subtreeNodes[s];
+      nodes[subtrees[s].node] = relocate(local[0]);
+      for(usize i = 1; i < local.size(); i++)
+      {
+        nodes[base + i - 1] = relocate(local[i]);
+      }
+    }
+  });
+
+  // Copy the triangles into leaf order
+  hierarchy->triangles.resize(numFaces);
+  hierarchy->faces = std::move(order);
+  pool.parallelFor(numFaces, Connectivity::detail::k_MinSliceCount, 1, [&](usize begin, usize end) {
+    for(usize i = begin; i < end; i++)
+    {
+      const MeshIndexType* face = corners + 3 * hierarchy->faces[i];
+      const float* p0 = coords + 3 * face[0];
+      const float* p1 = coords + 3 * face[1];
+      const float* p2 = coords + 3 * face[2];
+      hierarchy->triangles[i] = Triangle{{p0[0], p0[1], p0[2]}, {p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]}, {p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]}};
+    }
+  });
+
+  m_Hierarchy = std::move(hierarchy);
+}
+
+usize BoundingVolumeHierarchy::getNumberOfFaces() const
+{
+  return m_Hierarchy->faces.size();
+}
+
+usize BoundingVolumeHierarchy::getNumberOfNodes() const
+{
+  return m_Hierarchy->nodes.size();
+}
+
+BoundingBox<float> BoundingVolumeHierarchy::getBounds() const
+{
+  if(m_Hierarchy->nodes.empty())
+  {
+    const Box empty;
+    return BoundingBox<float>(Point3D<float>(empty.min[0], empty.min[1], empty.min[2]), Point3D<float>(empty.max[0], empty.max[1], empty.max[2]));
+  }
+  const Node& root = m_Hierarchy->nodes[0];
+  return BoundingBox<float>(Point3D<float>(root.min[0], root.min[1], root.min[2]), Point3D<float>(root.max[0], root.max[1], root.max[2]));
+}
+
+BoundingVolumeHierarchy::RayHit BoundingVolumeHierarchy::intersectRay(const Ray<float>& ray) const
+{
+  return IntersectRay(*m_Hierarchy, GeometryMath::detail::ToVec3(ray.getOrigin()), GeometryMath::detail::RayDirection(ray), ray.getLength());
+}
+
+void BoundingVolumeHierarchy::intersectRay(const GeometryMath::RayArrays<float>& rays, RayHit* hits) const
+{
+  const Hierarchy& hierarchy = *m_Hierarchy;
+  ThreadPool::Global().parallelFor(rays.count, k_MinQuerySliceCount, k_QueryGranularity, [&](usize begin, usize end) {
+    for(usize i = begin; i < end; i++)
+    {
+      hits[i] = IntersectRay(hierarchy, {rays.originX[i], rays.originY[i], rays.originZ[i]}, {rays.dirX[i], rays.dirY[i], rays.dirZ[i]}, rays.length[i]);
+    }
+  });
+}
+
+usize BoundingVolumeHierarchy::countRayIntersections(const Ray<float>& ray) const
+{
+  return CountRayIntersections(*m_Hierarchy, GeometryMath::detail::ToVec3(ray.getOrigin()), GeometryMath::detail::RayDirection(ray), ray.getLength());
+}
+
+BoundingVolumeHierarchy::ClosestPoint BoundingVolumeHierarchy::findClosestPoint(const Point3D<float>& point, float maxDistance) const
+{
+  return FindClosestPoint(*m_Hierarchy, GeometryMath::detail::ToVec3(point), maxDistance);
+}
+
+void BoundingVolumeHierarchy::findClosestPoint(const GeometryMath::PointArrays<float>& points, ClosestPoint* results, float maxDistance) const
+{
+  const Hierarchy& hierarchy = *m_Hierarchy;
+  ThreadPool::Global().parallelFor(points.count, k_MinQuerySliceCount, k_QueryGranularity, [&](usize begin, usize end) {
+    for(usize i = begin; i < end; i++)
+    {
+      results[i] = FindClosestPoint(hierarchy, {points.x[i], points.y[i], points.z[i]}, maxDistance);
+    }
+  });
+}
+
+bool BoundingVolumeHierarchy::isInside(const Point3D<float>& point) const
+{
+  return IsInside(*m_Hierarchy, GeometryMath::detail::ToVec3(point));
+}
+
+void BoundingVolumeHierarchy::isInside(const GeometryMath::PointArrays<float>& points, uint8_t* inside) const
+{
+  const Hierarchy& hierarchy = *m_Hierarchy;
+  ThreadPool::Global().parallelFor(points.count, k_MinQuerySliceCount, k_QueryGranularity, [&](usize begin, usize end) {
+    for(usize i = begin; i < end; i++)
+    {
+      inside[i] = static_cast<uint8_t>(IsInside(hierarchy, {points.x[i], points.y[i], points.z[i]}));
+    }
+  });
+}
+
+BoundingVolumeHierarchy::RayHit BoundingVolumeHierarchy::IntersectRay(const Hierarchy& hierarchy, const Vec3f& origin, const Vec3f& dir, float length)
+{
+  RayHit hit;
+  const Vec3f invDir = InverseDirection(dir);
+  if(hierarchy.nodes.empty() || EnterNode(hierarchy.nodes[0], origin, invDir, length) == k_Infinity)
+  {
+    return hit;
+  }
+  hit.distance = length;
+
+  // Pending nodes with the distance at which the ray enters them
+  std::array<std::pair<u32, float>, k_StackSize> stack;
+  usize stackSize = 0;
+  u32 current = 0;
+  while(true)
+  {
+    const Node& node = hierarchy.nodes[current];
+    if(node.count > 0)
+    {
+      for(usize i = node.index; i < node.index + node.count; i++)
+      {
+        const Triangle& triangle = hierarchy.triangles[i];
+        const float distance = GeometryMath::detail::IntersectTriangle(origin, dir, hit.distance, triangle.origin, triangle.edge0, triangle.edge1);
+        if(distance >= 0.0f && (hit.face == k_InvalidIndex || distance < hit.distance))
+        {
+          hit.distance = distance;
+          hit.face = hierarchy.faces[i];
+        }
+      }
+    }
+    else
+    {
+      // Visit the nearer child first and keep the other for later
+      const float left = EnterNode(hierarchy.nodes[node.index], origin, invDir, hit.distance);
+      const float right = EnterNode(hierarchy.nodes[node.index + 1], origin, invDir, hit.distance);
+      if(left != k_Infinity && right != k_Infinity)
+      {
+        const bool leftFirst = left <= right;
+        stack[stackSize++] = {leftFirst ? node.index + 1 : node.index, leftFirst ? right : left};
+        current = leftFirst ? node.index : node.index + 1;
+        continue;
+      }
+      if(left != k_Infinity || right != k_Infinity)
+      {
+        current = (left != k_Infinity) ? node.index : node.index + 1;
+        continue;
+      }
+    }
+
+    // Resume with the next pending node the ray can still reach before its hit
+    bool found = false;
+    while(stackSize > 0)
+    {
+      const auto [next, entry] = stack[--stackSize];
+      if(entry <= hit.distance)
+      {
+        current = next;
+        found = true;
+        break;
+      }
+    }
+    if(!found)
+    {
+      break;
+    }
+  }
+  if(hit.face == k_InvalidIndex)
+  {
+    hit.distance = k_Infinity;
+  }
+  return hit;
+}
+
+usize BoundingVolumeHierarchy::CountRayIntersections(const Hierarchy& hierarchy, const Vec3f& origin, const Vec3f& dir, float length)
+{
+  if(hierarchy.nodes.empty())
+  {
+    return 0;
+  }
+  const Vec3f invDir = InverseDirection(dir);
+  usize count = 0;
+  std::array<u32, k_StackSize> stack;
+  usize stackSize = 0;
+  stack[stackSize++] = 0;
+  while(stackSize > 0)
+  {
+    const Node& node = hierarchy.nodes[stack[--stackSize]];
+    if(EnterNode(node, origin, invDir, length) == k_Infinity)
+    {
+      continue;
+    }
+    if(node.count > 0)
+    {
+      for(usize i = node.index; i < node.index + node.count; i++)
+      {
+        const Triangle& triangle = hierarchy.triangles[i];
+        count += (GeometryMath::detail::IntersectTriangle(origin, dir, length, triangle.origin, triangle.edge0, triangle.edge1) >= 0.0f) ? 1 : 0;
+      }
+      continue;
+    }
+    stack[stackSize++] = node.index;
+    stack[stackSize++] = node.index + 1;
+  }
+  return count;
+}
+
+BoundingVolumeHierarchy::ClosestPoint BoundingVolumeHierarchy::FindClosestPoint(const Hierarchy& hierarchy, const Vec3f& point, float maxDistance)
+{
+  ClosestPoint result;
+  float bestSquared = (maxDistance == k_Infinity) ? k_Infinity : maxDistance * maxDistance;
+  if(hierarchy.nodes.empty() || NodeDistanceSquared(hierarchy.nodes[0], point) > bestSquared)
+  {
+    return result;
+  }
+
+  std::array<std::pair<u32, float>, k_StackSize> stack;
+  usize stackSize = 0;
+  stack[stackSize++] = {0, 0.0f};
+  while(stackSize > 0)
+  {
+    const auto [index, nodeSquared] = stack[--stackSize];
+    if(nodeSquared > bestSquared)
+    {
+      continue;
+    }
+    const Node& node = hierarchy.nodes[index];
+    if(node.count > 0)
+    {
+      for(usize i = node.index; i < node.index + node.count; i++)
+      {
+        const Triangle& triangle = hierarchy.triangles[i];
+        const Vec3f candidate = ClosestPointOnTriangle(point, triangle.origin, triangle.edge0, triangle.edge1);
+        const Vec3f offset = GeometryMath::detail::Subtract(point, candidate);
+        const float squared = GeometryMath::detail::Dot(offset, offset);
+        if(squared <= bestSquared && (result.face == k_InvalidIndex || squared < bestSquared))
+        {
+          bestSquared = squared;
+          result.face = hierarchy.faces[i];
+          result.point = candidate;
+        }
+      }
+      continue;
+    }
+
+    // Push the farther child first so the nearer one is searched first
+    const float left = NodeDistanceSquared(hierarchy.nodes[node.index], point);
+    const float right = NodeDistanceSquared(hierarchy.nodes[node.index + 1], point);
+    const bool leftFirst = left <= right;
+    stack[stackSize++] = {leftFirst ? node.index + 1 : node.index, leftFirst ? right : left};
+    stack[stackSize++] = {leftFirst ? node.index : node.index + 1, leftFirst ? left : right};
+  }
+  if(result.face != k_InvalidIndex)
+  {
+    result.distance = std::sqrt(bestSquared);
+  }
+  return result;
+}
+
+bool BoundingVolumeHierarchy::IsInside(const Hierarchy& hierarchy, const Vec3f& point)
+{
+  if(hierarchy.nodes.empty() || NodeDistanceSquared(hierarchy.nodes[0], point) > 0.0f)
+  {
+    return false;
+  }
+  usize votes = 0;
+  for(const Vec3f& dir : k_InsideDirections)
+  {
+    votes += CountRayIntersections(hierarchy, point, dir, k_Infinity) % 2;
+  }
+  return votes >= 2;
+}
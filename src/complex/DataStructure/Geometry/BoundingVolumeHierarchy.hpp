@@ -0,0 +1,226 @@
+#pragma once
+
+#include <array>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "complex/Common/BoundingBox.hpp"
+#include "complex/Common/Point3D.hpp"
+#include "complex/Common/Ray.hpp"
+#include "complex/Common/Types.hpp"
+#include "complex/DataStructure/DataArray.hpp"
+#include "complex/DataStructure/DataObject.hpp"
+#include "complex/Utilities/Math/GeometryMath.hpp"
+
+#include "complex/complex_export.hpp"
+
+namespace complex
+{
+/**
+ * @class BoundingVolumeHierarchy
+ * @brief The BoundingVolumeHierarchy class is a spatial index over the faces
+ * of a triangle mesh that answers ray, closest point and inside/outside
+ * queries in logarithmic time. The tree is built top-down with the binned
+ * surface area heuristic: the upper levels split large ranges of faces with
+ * parallel binning and the subtrees below them are built in parallel on the
+ * shared ThreadPool. Nodes are stored in one flat array of 32 byte entries
+ * with the two children of a node next to each other, and the leaf triangles
+ * are copied into leaf order so queries touch contiguous memory.
+ *
+ * The hierarchy is a snapshot of the vertices and triangles; it has to be
+ * rebuilt after either changes. Copies share the immutable hierarchy.
+ */
+class COMPLEX_EXPORT BoundingVolumeHierarchy : public DataObject
+{
+public:
+  friend class DataStructure;
+
+  using MeshIndexType = u64;
+
+  static constexpr MeshIndexType k_InvalidIndex = std::numeric_limits<MeshIndexType>::max();
+
+  /**
+   * @brief Nearest face hit by a ray. face is k_InvalidIndex if the ray
+   * misses the mesh.
+   */
+  struct RayHit
+  {
+    MeshIndexType face = k_InvalidIndex;
+    float distance = std::numeric_limits<float>::infinity();
+  };
+
+  /**
+   * @brief Point of the mesh closest to a query point. face is k_InvalidIndex
+   * if no face lies within the search distance.
+   */
+  struct ClosestPoint
+  {
+    MeshIndexType face = k_InvalidIndex;
+    float distance = std::numeric_limits<float>::infinity();
+    std::array<float, 3> point = {0.0f, 0.0f, 0.0f};
+  };
+
+  /**
+   * @brief Copy constructor. The hierarchy is shared with other.
+   * @param other
+   */
+  BoundingVolumeHierarchy(const BoundingVolumeHierarchy& other);
+
+  /**
+   * @brief Move constructor.
+   * @param other
+   */
+  BoundingVolumeHierarchy(BoundingVolumeHierarchy&& other) noexcept;
+
+  ~BoundingVolumeHierarchy() override;
+
+  /**
+   * @brief Returns a copy sharing the immutable hierarchy.
+   * @return DataObject*
+   */
+  DataObject* shallowCopy() override;
+
+  /**
+   * @brief Returns a copy. The hierarchy is immutable, so it is shared.
+   * @return DataObject*
+   */
+  DataObject* deepCopy() override;
+
+  /**
+   * @brief Builds the hierarchy over the triangles. Runs in parallel on the
+   * shared ThreadPool. Throws if triangles does not hold three vertices per
+   * tuple, vertices does not hold three coordinates per tuple or a triangle
+   * refers to a missing vertex.
+   * @param triangles
+   * @param vertices
+   */
+  void build(const DataArray<MeshIndexType>& triangles, const DataArray<float>& vertices);
+
+  /**
+   * @brief Returns the number of indexed faces.
+   * @return usize
+   */
+  usize getNumberOfFaces() const;
+
+  /**
+   * @brief Returns the number of nodes in the tree.
+   * @return usize
+   */
+  usize getNumberOfNodes() const;
+
+  /**
+   * @brief Returns the bounds of the mesh. The box is invalid if the mesh has
+   * no faces.
+   * @return BoundingBox<float>
+   */
+  BoundingBox<float> getBounds() const;
+
+  /**
+   * @brief Returns the nearest face the ray hits between its origin and its
+   * end point.
+   * @param ray
+   * @return RayHit
+   */
+  RayHit intersectRay(const Ray<float>& ray) const;
+
+  /**
+   * @brief Writes the nearest face hit by each ray to hits. The rays are
+   * processed in parallel.
+   * @param rays
+   * @param hits Holds rays.count values
+   */
+  void intersectRay(const GeometryMath::RayArrays<float>& rays, RayHit* hits) const;
+
+  /**
+   * @brief Returns the number of faces the ray hits between its origin and
+   * its end point.
+   * @param ray
+   * @return usize
+   */
+  usize countRayIntersections(const Ray<float>& ray) const;
+
+  /**
+   * @brief Returns the point of the mesh closest to point among the faces
+   * within maxDistance of it.
+   * @param point
+   * @param maxDistance
+   * @return ClosestPoint
+   */
+  ClosestPoint findClosestPoint(const Point3D<float>& point, float maxDistance = std::numeric_limits<float>::infinity()) const;
+
+  /**
+   * @brief Writes the point of the mesh closest to each point to results. The
+   * points are processed in parallel.
+   * @param points
+   * @param results Holds points.count values
+   * @param maxDistance
+   */
+  void findClosestPoint(const GeometryMath::PointArrays<float>& points, ClosestPoint* results, float maxDistance = std::numeric_limits<float>::infinity()) const;
+
+  /**
+   * @brief Returns true if the point lies inside the mesh, which has to be
+   * closed. Counts the faces crossed by three rays leaving the point and
+   * takes the majority of their parities, so a ray grazing an edge or vertex
+   * does not flip the result.
+   * @param point
+   * @return bool
+   */
+  bool isInside(const Point3D<float>& point) const;
+
+  /**
+   * @brief Sets inside[i] to 1 if point i lies inside the mesh and to 0
+   * otherwise. The points are processed in parallel, e.g. the cell centers
+   * of an ImageGeom when voxelizing a surface mesh.
+   * @param points
+   * @param inside Holds points.count values
+   */
+  void isInside(const GeometryMath::PointArrays<float>& points, uint8_t* inside) const;
+
+protected:
+  /**
+   * @brief Constructs an empty hierarchy.
+   * @param ds
+   * @param name
+   */
+  BoundingVolumeHierarchy(DataStructure* ds, const std::string& name);
+
+private:
+  /**
+   * @brief Tree node. Leaves hold count faces starting at index in leaf
+   * order. Interior nodes have a count of zero and their children at index
+   * and index + 1.
+   */
+  struct Node
+  {
+    std::array<float, 3> min;
+    u32 index;
+    std::array<float, 3> max;
+    u32 count;
+  };
+
+  /**
+   * @brief Triangle stored as its first corner and the edges to the other two.
+   */
+  struct Triangle
+  {
+    GeometryMath::detail::Vec3<float> origin;
+    GeometryMath::detail::Vec3<float> edge0;
+    GeometryMath::detail::Vec3<float> edge1;
+  };
+
+  struct Hierarchy
+  {
+    std::vector<Node> nodes;
+    std::vector<Triangle> triangles;
+    std::vector<MeshIndexType> faces;
+  };
+
+  static RayHit IntersectRay(const Hierarchy& hierarchy, const GeometryMath::detail::Vec3<float>& origin, const GeometryMath::detail::Vec3<float>& dir, float length);
+  static usize CountRayIntersections(const Hierarchy& hierarchy, const GeometryMath::detail::Vec3<float>& origin, const GeometryMath::detail::Vec3<float>& dir, float length);
+  static ClosestPoint FindClosestPoint(const Hierarchy& hierarchy, const GeometryMath::detail::Vec3<float>& point, float maxDistance);
+  static bool IsInside(const Hierarchy& hierarchy, const GeometryMath::detail::Vec3<float>& point);
+
+  std::shared_ptr<const Hierarchy> m_Hierarchy;
+};
+} // namespace complex
@@ -4,6 +4,7 @@
 
 #include "complex/DataStructure/DataArray.hpp"
 #include "complex/DataStructure/DataStructure.hpp"
+#include "complex/DataStructure/Snapshot/SnapshotArchive.hpp"
 #include "complex/Utilities/GeometryHelpers.hpp"
 
 using namespace complex;
@@ -262,6 +263,11 @@ AbstractGeometry::StatusCode EdgeGeom::findElementSizes()
 {
   auto dataStore = new DataStore<float>(1, getNumberOfElements());
   auto sizes = getDataStructure()->createDataArray<float>("Edge Lengths", dataStore, getId());
+  if(sizes == nullptr)
+  {
+    m_EdgeSizesId.reset();
+    return -1;
+  }
   m_EdgeSizesId = sizes->getId();
 
   Point3D<float> vert0 = {0.0f, 0.0f, 0.0f};
@@ -277,45 +283,47 @@ AbstractGeometry::StatusCode EdgeGeom::findElementSizes()
     }
     (*sizes)[i] = sqrtf(length);
   }
-
+  recordDerived(m_EdgeSizesId, getGeometrySources());
   return 1;
 }
 
 const FloatArray* EdgeGeom::getElementSizes() const
 {
-  return dynamic_cast<const FloatArray*>(getDataStructure()->getData(m_EdgeSizesId));
+  return getDerived<FloatArray>(m_EdgeSizesId, getGeometrySources(), &EdgeGeom::findElementSizes);
 }
 
 void EdgeGeom::deleteElementSizes()
 {
-  getDataStructure()->removeData(m_EdgeSizesId.value());
-  m_EdgeSizesId.reset();
+  deleteDerived(m_EdgeSizesId);
 }
 
 AbstractGeometry::StatusCode EdgeGeom::findElementsContainingVert()
 {
   auto containsVert = getDataStructure()->createDynamicList<uint16_t, MeshIndexType>("Edges Containing Vert", getId());
-  GeometryHelpers::Connectivity::FindElementsContainingVert<uint16_t, MeshIndexType>(getEdges(), containsVert, getNumberOfVertices());
-  if(getElementsContainingVert() == nullptr)
+  if(containsVert == nullptr)
   {
+    m_EdgesContainingVertId.reset();
     return -1;
   }
+  if(GeometryHelpers::Connectivity::FindElementsContainingVert<uint16_t, MeshIndexType>(getEdges(), containsVert, getNumberOfVertices()) < 0)
+  {
+    getDataStructure()->removeData(containsVert->getId());
+    m_EdgesContainingVertId.reset();
+    return -1;
+  }
+  m_EdgesContainingVertId = containsVert->getId();
+  recordDerived(m_EdgesContainingVertId, getConnectivitySources());
   return 1;
 }
 
 const AbstractGeometry::ElementDynamicList* EdgeGeom::getElementsContainingVert() const
 {
-  return dynamic_cast<const ElementDynamicList*>(getDataStructure()->getData(m_EdgesContainingVertId.value()));
+  return getDerived<ElementDynamicList>(m_EdgesContainingVertId, getConnectivitySources(), &EdgeGeom::findElementsContainingVert);
 }
 
 void EdgeGeom::deleteElementsContainingVert()
 {
-  if(!m_EdgesContainingVertId)
-  {
-    return;
-  }
-  getDataStructure()->removeData(m_EdgesContainingVertId.value());
-  m_EdgesContainingVertId.reset();
+  deleteDerived(m_EdgesContainingVertId);
 }
 
 AbstractGeometry::StatusCode EdgeGeom::findElementNeighbors()
@@ -330,64 +338,50 @@ AbstractGeometry::StatusCode EdgeGeom::findElementNeighbors()
     }
   }
   auto edgeNeighbors = getDataStructure()->createDynamicList<uint16_t, MeshIndexType>("Edge Neighbors", getId());
-  if(edgeNeighbors == nullptr)
-  {
-    err = -1;
-  }
-  m_EdgeNeighborsId = edgeNeighbors->getId();
   err = GeometryHelpers::Connectivity::FindElementNeighbors<uint16_t, MeshIndexType>(getEdges(), getElementsContainingVert(), edgeNeighbors, AbstractGeometry::Type::Edge);
-  if(getElementNeighbors() == nullptr)
+  if(edgeNeighbors == nullptr)
   {
     m_EdgeNeighborsId.reset();
-    err = -1;
+    return -1;
   }
+  m_EdgeNeighborsId = edgeNeighbors->getId();
+  recordDerived(m_EdgeNeighborsId, getConnectivitySources());
   return err;
 }
 
 const AbstractGeometry::ElementDynamicList* EdgeGeom::getElementNeighbors() const
 {
-  return dynamic_cast<const ElementDynamicList*>(getDataStructure()->getData(m_EdgeNeighborsId));
+  return getDerived<ElementDynamicList>(m_EdgeNeighborsId, getConnectivitySources(), &EdgeGeom::findElementNeighbors);
 }
 
 void EdgeGeom::deleteElementNeighbors()
 {
-  if(!m_EdgeNeighborsId)
-  {
-    return;
-  }
-  getDataStructure()->removeData(m_EdgeNeighborsId.value());
-  m_EdgeNeighborsId.reset();
+  deleteDerived(m_EdgeNeighborsId);
 }
 
 AbstractGeometry::StatusCode EdgeGeom::findElementCentroids()
 {
   auto dataStore = new DataStore<float>(3, getNumberOfElements());
   auto edgeCentroids = getDataStructure()->createDataArray<float>("Edge Centroids", dataStore, getId());
-  GeometryHelpers::Topology::FindElementCentroids(getEdges(), getVertices(), edgeCentroids);
-  if(getElementCentroids() == nullptr)
+  if(edgeCentroids == nullptr)
   {
+    m_EdgeCentroidsId.reset();
     return -1;
   }
+  GeometryHelpers::Topology::FindElementCentroids(getEdges(), getVertices(), edgeCentroids);
+  m_EdgeCentroidsId = edgeCentroids->getId();
+  recordDerived(m_EdgeCentroidsId, getGeometrySources());
   return 1;
 }
 
 const FloatArray* EdgeGeom::getElementCentroids() const
 {
-  if(!m_EdgeCentroidsId)
-  {
-    return nullptr;
-  }
-  return dynamic_cast<const FloatArray*>(getDataStructure()->getData(m_EdgeCentroidsId.value()));
+  return getDerived<FloatArray>(m_EdgeCentroidsId, getGeometrySources(), &EdgeGeom::findElementCentroids);
 }
 
 void EdgeGeom::deleteElementCentroids()
 {
-  if(!m_EdgeCentroidsId)
-  {
-    return;
-  }
-  getDataStructure()->removeData(m_EdgeCentroidsId.value());
-  m_EdgeCentroidsId.reset();
+  deleteDerived(m_EdgeCentroidsId);
 }
 
 complex::Point3D<double> EdgeGeom::getParametricCenter() const
@@ -424,6 +418,16 @@ uint32_t EdgeGeom::getXdmfGridType() const
   throw std::runtime_error("");
 }
 
+AbstractGeometry::SourceVersions EdgeGeom::getGeometrySources() const
+{
+  return {ValuesVersion(getVertices()), ValuesVersion(getEdges())};
+}
+
+AbstractGeometry::SourceVersions EdgeGeom::getConnectivitySources() const
+{
+  return {TupleCountVersion(getVertices()), ValuesVersion(getEdges())};
+}
+
 void EdgeGeom::setElementsContainingVert(const ElementDynamicList* elementsContainingVert)
 {
   deleteElementsContainingVert();
@@ -463,3 +467,10 @@ void EdgeGeom::setElementSizes(const FloatArray* elementSizes)
   }
   m_EdgeSizesId = elementSizes->getId();
 }
+
+void EdgeGeom::serializeSnapshot(SnapshotArchive& archive)
+{
+  AbstractGeometry::serializeSnapshot(archive);
+  archive.reference(m_VertexListId);
+  archive.reference(m_EdgeListId);
+}
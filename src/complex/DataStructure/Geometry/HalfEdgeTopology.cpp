@@ -0,0 +1,343 @@
+#include "HalfEdgeTopology.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+
+#include <fmt/core.h>
+
+#include "complex/Utilities/GeometryHelpers.hpp"
+#include "complex/Utilities/ParallelAlgorithms.hpp"
+#include "complex/Utilities/ThreadPool.hpp"
+
+using namespace complex;
+
+HalfEdgeTopology::HalfEdgeTopology(DataStructure* ds, const std::string& name)
+: DataObject(ds, name)
+, m_Topology(std::make_shared<const Topology>(Topology{0, 0, {}, {}, {}, {}, {}, {0}, {}, 0, true}))
+{
+}
+
+HalfEdgeTopology::HalfEdgeTopology(const HalfEdgeTopology& other)
+: DataObject(other)
+, m_Topology(other.m_Topology)
+{
+}
+
+HalfEdgeTopology::HalfEdgeTopology(HalfEdgeTopology&& other) noexcept
+: DataObject(std::move(other))
+, m_Topology(std::move(other.m_Topology))
+{
+}
+
+HalfEdgeTopology::~HalfEdgeTopology() = default;
+
+DataObject* HalfEdgeTopology::shallowCopy()
+{
+  return new HalfEdgeTopology(*this);
+}
+
+DataObject* HalfEdgeTopology::deepCopy()
+{
+  return new HalfEdgeTopology(*this);
+}
+
+void HalfEdgeTopology::build(const MeshIndexArrayType& faces, usize numVertices)
+{
+  namespace Connectivity = GeometryHelpers::Connectivity;
+  using Connectivity::detail::k_MinSliceCount;
+
+  const usize faceSize = faces.getTupleSize();
+  if(faceSize != 3 && faceSize != 4)
+  {
+    throw std::runtime_error(fmt::format("Half-edge topology requires triangles or quads, got {} vertices per face", faceSize));
+  }
+  const usize numFaces = faces.getTupleCount();
+  const usize numHalfEdges = numFaces * faceSize;
+  if(numHalfEdges > 0 && ParallelAlgorithms::Max(*faces.getDataStore()) >= numVertices)
+  {
+    throw std::runtime_error(fmt::format("Face list refers to vertices beyond the {} vertices of the mesh", numVertices));
+  }
+
+  std::vector<MeshIndexType> faceBuffer;
+  const MeshIndexType* corners = Connectivity::detail::GetContiguousValues(*faces.getDataStore(), faceBuffer);
+  ThreadPool& pool = ThreadPool::Global();
+
+  auto topology = std::make_shared<Topology>();
+  topology->faceSize = faceSize;
+  topology->numVertices = numVertices;
+  topology->origins.assign(corners, corners + numHalfEdges);
+
+  // Half-edges are the edge facets of the faces, so sorting the facets groups the half-edges of each edge
+  const Connectivity::ElementFacets faceEdges = Connectivity::PolygonEdges(faceSize);
+  const Connectivity::detail::SortedFacets sortedFacets = Connectivity::detail::SortFacets(corners, numFaces, faceEdges, numVertices);
+
+  std::vector<usize> edgeOffsets(numVertices + 1, 0);
+  pool.parallelFor(numVertices, k_MinSliceCount, 1, [&](usize begin, usize end) {
+    for(usize vertex = begin; vertex < end; vertex++)
+    {
+      Connectivity::detail::ForEachFacetRun(corners, faceEdges, sortedFacets, vertex, vertex + 1, [&](usize, usize) { edgeOffsets[vertex]++; });
+    }
+  });
+  const usize numEdges = ParallelAlgorithms::ExclusiveScan(edgeOffsets.data(), numVertices, edgeOffsets.data());
+
+  topology->twins.assign(numHalfEdges, k_InvalidIndex);
+  topology->halfEdgeEdges.resize(numHalfEdges);
+  topology->edgeHalfEdges.resize(numEdges);
+  topology->edgeFaceCounts.resize(numEdges);
+  pool.parallelFor(numVertices, k_MinSliceCount, 1, [&](usize begin, usize end) {
+    for(usize vertex = begin; vertex < end; vertex++)
+    {
+      MeshIndexType edge = edgeOffsets[vertex];
+      Connectivity::detail::ForEachFacetRun(corners, faceEdges, sortedFacets, vertex, vertex + 1, [&](usize runBegin, usize runEnd) {
+        topology->edgeHalfEdges[edge] = sortedFacets.facetIds[runBegin];
+        topology->edgeFaceCounts[edge] = static_cast<u32>(runEnd - runBegin);
+        for(usize i = runBegin; i < runEnd; i++)
+        {
+          topology->halfEdgeEdges[sortedFacets.facetIds[i]] = edge;
+        }
+        if(runEnd - runBegin == 2)
+        {
+          topology->twins[sortedFacets.facetIds[runBegin]] = sortedFacets.facetIds[runBegin + 1];
+          topology->twins[sortedFacets.facetIds[runBegin + 1]] = sortedFacets.facetIds[runBegin];
+        }
+        edge++;
+      });
+    }
+  });
+  topology->numBoundaryEdges = static_cast<usize>(std::count(topology->edgeFaceCounts.begin(), topology->edgeFaceCounts.end(), 1u));
+
+  // Group the half-edges by the vertex they leave
+  std::vector<std::atomic<u32>> outgoingCounts(numVertices);
+  pool.parallelFor(numHalfEdges, k_MinSliceCount, 1, [&](usize begin, usize end) {
+    for(usize halfEdge = begin; halfEdge < end; halfEdge++)
+    {
+      outgoingCounts[corners[halfEdge]].fetch_add(1, std::memory_order_relaxed);
+    }
+  });
+  topology->vertexOffsets.resize(numVertices + 1);
+  topology->vertexOffsets[numVertices] = ParallelAlgorithms::ExclusiveScan(outgoingCounts.data(), numVertices, topology->vertexOffsets.data());
+  topology->vertexHalfEdges.resize(numHalfEdges);
+  pool.parallelFor(numHalfEdges, k_MinSliceCount, 1, [&](usize begin, usize end) {
+    for(usize halfEdge = begin; halfEdge < end; halfEdge++)
+    {
+      const MeshIndexType vertex = corners[halfEdge];
+      topology->vertexHalfEdges[topology->vertexOffsets[vertex] + outgoingCounts[vertex].fetch_sub(1, std::memory_order_relaxed) - 1] = halfEdge;
+    }
+  });
+
+  std::atomic<bool> manifold = std::none_of(topology->edgeFaceCounts.begin(), topology->edgeFaceCounts.end(), [](u32 count) { return count > 2; });
+  pool.parallelFor(numVertices, k_MinSliceCount, 1, [&](usize begin, usize end) {
+    bool sliceManifold = true;
+    for(usize vertex = begin; vertex < end; vertex++)
+    {
+      std::sort(topology->vertexHalfEdges.begin() + topology->vertexOffsets[vertex], topology->vertexHalfEdges.begin() + topology->vertexOffsets[vertex + 1]);
+      sliceManifold = sliceManifold && IsManifoldVertex(*topology, vertex);
+    }
+    if(!sliceManifold)
+    {
+      manifold = false;
+    }
+  });
+  topology->manifold = manifold;
+
+  m_Topology = std::move(topology);
+}
+
+usize HalfEdgeTopology::getFaceSize() const
+{
+  return m_Topology->faceSize;
+}
+
+usize HalfEdgeTopology::getNumberOfFaces() const
+{
+  return (m_Topology->faceSize == 0) ? 0 : m_Topology->origins.size() / m_Topology->faceSize;
+}
+
+usize HalfEdgeTopology::getNumberOfVertices() const
+{
+  return m_Topology->numVertices;
+}
+
+usize HalfEdgeTopology::getNumberOfHalfEdges() const
+{
+  return m_Topology->origins.size();
+}
+
+usize HalfEdgeTopology::getNumberOfEdges() const
+{
+  return m_Topology->edgeHalfEdges.size();
+}
+
+usize HalfEdgeTopology::getNumberOfBoundaryEdges() const
+{
+  return m_Topology->numBoundaryEdges;
+}
+
+HalfEdgeTopology::MeshIndexType HalfEdgeTopology::getOrigin(MeshIndexType halfEdge) const
+{
+  return m_Topology->origins[halfEdge];
+}
+
+HalfEdgeTopology::MeshIndexType HalfEdgeTopology::getDestination(MeshIndexType halfEdge) const
+{
+  return m_Topology->origins[getNext(halfEdge)];
+}
+
+HalfEdgeTopology::MeshIndexType HalfEdgeTopology::getNext(MeshIndexType halfEdge) const
+{
+  return Next(*m_Topology, halfEdge);
+}
+
+HalfEdgeTopology::MeshIndexType HalfEdgeTopology::getPrevious(MeshIndexType halfEdge) const
+{
+  return Previous(*m_Topology, halfEdge);
+}
+
+HalfEdgeTopology::MeshIndexType HalfEdgeTopology::getTwin(MeshIndexType halfEdge) const
+{
+  return m_Topology->twins[halfEdge];
+}
+
+HalfEdgeTopology::MeshIndexType HalfEdgeTopology::getFace(MeshIndexType halfEdge) const
+{
+  return halfEdge / m_Topology->faceSize;
+}
+
+HalfEdgeTopology::MeshIndexType HalfEdgeTopology::getEdge(MeshIndexType halfEdge) const
+{
+  return m_Topology->halfEdgeEdges[halfEdge];
+}
+
+std::array<HalfEdgeTopology::MeshIndexType, 2> HalfEdgeTopology::getEdgeVertices(MeshIndexType edge) const
+{
+  const MeshIndexType halfEdge = m_Topology->edgeHalfEdges[edge];
+  const MeshIndexType origin = getOrigin(halfEdge);
+  const MeshIndexType destination = getDestination(halfEdge);
+  return {std::min(origin, destination), std::max(origin, destination)};
+}
+
+HalfEdgeTopology::MeshIndexType HalfEdgeTopology::getEdgeHalfEdge(MeshIndexType edge) const
+{
+  return m_Topology->edgeHalfEdges[edge];
+}
+
+usize HalfEdgeTopology::getEdgeFaceCount(MeshIndexType edge) const
+{
+  return m_Topology->edgeFaceCounts[edge];
+}
+
+bool HalfEdgeTopology::isBoundaryEdge(MeshIndexType edge) const
+{
+  return m_Topology->edgeFaceCounts[edge] == 1;
+}
+
+bool HalfEdgeTopology::isManifoldEdge(MeshIndexType edge) const
+{
+  return m_Topology->edgeFaceCounts[edge] <= 2;
+}
+
+HalfEdgeTopology::MeshIndexType HalfEdgeTopology::getFaceNeighbor(MeshIndexType face, usize localEdge) const
+{
+  const MeshIndexType twin = m_Topology->twins[face * m_Topology->faceSize + localEdge];
+  return (twin == k_InvalidIndex) ? k_InvalidIndex : getFace(twin);
+}
+
+Span<const HalfEdgeTopology::MeshIndexType> HalfEdgeTopology::getOutgoingHalfEdges(MeshIndexType vertex) const
+{
+  const usize begin = m_Topology->vertexOffsets[vertex];
+  return Span<const MeshIndexType>(m_Topology->vertexHalfEdges.data() + begin, m_Topology->vertexOffsets[vertex + 1] - begin);
+}
+
+void HalfEdgeTopology::getVertexRing(MeshIndexType vertex, std::vector<MeshIndexType>& ring) const
+{
+  ring.clear();
+  for(MeshIndexType halfEdge : getOutgoingHalfEdges(vertex))
+  {
+    ring.push_back(getDestination(halfEdge));
+    ring.push_back(getOrigin(getPrevious(halfEdge)));
+  }
+  std::sort(ring.begin(), ring.end());
+  ring.erase(std::unique(ring.begin(), ring.end()), ring.end());
+}
+
+bool HalfEdgeTopology::isManifoldVertex(MeshIndexType vertex) const
+{
+  return IsManifoldVertex(*m_Topology, vertex);
+}
+
+bool HalfEdgeTopology::isManifold() const
+{
+  return m_Topology->manifold;
+}
+
+void HalfEdgeTopology::copyEdges(MeshIndexArrayType& edges, bool boundaryOnly) const
+{
+  const usize numEdges = getNumberOfEdges();
+  edges.getDataStore()->resizeTuples(boundaryOnly ? getNumberOfBoundaryEdges() : numEdges);
+  usize index = 0;
+  for(MeshIndexType edge = 0; edge < numEdges; edge++)
+  {
+    if(boundaryOnly && !isBoundaryEdge(edge))
+    {
+      continue;
+    }
+    const std::array<MeshIndexType, 2> vertices = getEdgeVertices(edge);
+    edges[index * 2] = vertices[0];
+    edges[index * 2 + 1] = vertices[1];
+    index++;
+  }
+}
+
+HalfEdgeTopology::MeshIndexType HalfEdgeTopology::Next(const Topology& topology, MeshIndexType halfEdge)
+{
+  return (halfEdge % topology.faceSize == topology.faceSize - 1) ? halfEdge + 1 - topology.faceSize : halfEdge + 1;
+}
+
+HalfEdgeTopology::MeshIndexType HalfEdgeTopology::Previous(const Topology& topology, MeshIndexType halfEdge)
+{
+  return (halfEdge % topology.faceSize == 0) ? halfEdge + topology.faceSize - 1 : halfEdge - 1;
+}
+
+bool HalfEdgeTopology::IsManifoldVertex(const Topology& topology, MeshIndexType vertex)
+{
+  const usize begin = topology.vertexOffsets[vertex];
+  const usize end = topology.vertexOffsets[vertex + 1];
+  if(begin == end)
+  {
+    return true;
+  }
+
+  // Every edge at the vertex has to be manifold. A fan end is a half-edge without a twin.
+  MeshIndexType start = topology.vertexHalfEdges[begin];
+  for(usize i = begin; i < end; i++)
+  {
+    const MeshIndexType halfEdge = topology.vertexHalfEdges[i];
+    if(topology.edgeFaceCounts[topology.halfEdgeEdges[halfEdge]] > 2 || topology.edgeFaceCounts[topology.halfEdgeEdges[Previous(topology, halfEdge)]] > 2)
+    {
+      return false;
+    }
+    if(topology.twins[halfEdge] == k_InvalidIndex)
+    {
+      start = halfEdge;
+    }
+  }
+
+  // Rotate around the vertex from face to face and check that the fan reaches every face
+  usize visited = 1;
+  for(MeshIndexType halfEdge = start;;)
+  {
+    const MeshIndexType twin = topology.twins[Previous(topology, halfEdge)];
+    if(twin == k_InvalidIndex || twin == start)
+    {
+      break;
+    }
+    if(topology.origins[twin] != vertex || visited == end - begin)
+    {
+      return false;
+    }
+    halfEdge = twin;
+    visited++;
+  }
+  return visited == end - begin;
+}
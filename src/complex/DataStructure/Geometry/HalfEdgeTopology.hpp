@@ -0,0 +1,283 @@
+#pragma once
+
+#include <array>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "complex/Common/Span.hpp"
+#include "complex/Common/Types.hpp"
+#include "complex/DataStructure/DataArray.hpp"
+#include "complex/DataStructure/DataObject.hpp"
+
+#include "complex/complex_export.hpp"
+
+namespace complex
+{
+/**
+ * @class HalfEdgeTopology
+ * @brief The HalfEdgeTopology class is a half-edge representation of a
+ * triangle or quad mesh that is built once from the face list and answers
+ * adjacency queries without further passes over the mesh. Half-edge h of
+ * face f is h = f * faceSize + k and runs from corner k to corner k + 1 of
+ * the face, so next, previous and face lookups are arithmetic. Each
+ * half-edge stores its twin in the adjacent face and the undirected edge it
+ * belongs to. Edges are numbered in the order used by the edge lists of the
+ * geometries: ascending vertex pairs in lexicographic order. Vertex queries
+ * use a compressed list of the half-edges leaving each vertex.
+ *
+ * Edges used by more than two faces are non-manifold. Their half-edges have
+ * no twin, as do the half-edges of boundary edges.
+ *
+ * The topology is a snapshot of the face list; it has to be rebuilt after
+ * the faces change. Copies share the immutable topology.
+ */
+class COMPLEX_EXPORT HalfEdgeTopology : public DataObject
+{
+public:
+  friend class DataStructure;
+
+  using MeshIndexType = u64;
+  using MeshIndexArrayType = DataArray<MeshIndexType>;
+
+  static constexpr MeshIndexType k_InvalidIndex = std::numeric_limits<MeshIndexType>::max();
+
+  /**
+   * @brief Copy constructor. The topology is shared with other.
+   * @param other
+   */
+  HalfEdgeTopology(const HalfEdgeTopology& other);
+
+  /**
+   * @brief Move constructor.
+   * @param other
+   */
+  HalfEdgeTopology(HalfEdgeTopology&& other) noexcept;
+
+  ~HalfEdgeTopology() override;
+
+  /**
+   * @brief Returns a copy sharing the immutable topology.
+   * @return DataObject*
+   */
+  DataObject* shallowCopy() override;
+
+  /**
+   * @brief Returns a copy. The topology is immutable, so it is shared.
+   * @return DataObject*
+   */
+  DataObject* deepCopy() override;
+
+  /**
+   * @brief Builds the topology from a list of triangles or quads. Runs in
+   * parallel on the shared ThreadPool. Throws if faces does not hold three
+   * or four vertices per tuple or refers to a vertex id of numVertices or
+   * more.
+   * @param faces
+   * @param numVertices
+   */
+  void build(const MeshIndexArrayType& faces, usize numVertices);
+
+  /**
+   * @brief Returns the number of vertices per face, or zero if the topology
+   * has not been built.
+   * @return usize
+   */
+  usize getFaceSize() const;
+
+  /**
+   * @brief Returns the number of faces.
+   * @return usize
+   */
+  usize getNumberOfFaces() const;
+
+  /**
+   * @brief Returns the number of vertices.
+   * @return usize
+   */
+  usize getNumberOfVertices() const;
+
+  /**
+   * @brief Returns the number of half-edges, i.e. faces times the face size.
+   * @return usize
+   */
+  usize getNumberOfHalfEdges() const;
+
+  /**
+   * @brief Returns the number of undirected edges.
+   * @return usize
+   */
+  usize getNumberOfEdges() const;
+
+  /**
+   * @brief Returns the number of edges used by exactly one face.
+   * @return usize
+   */
+  usize getNumberOfBoundaryEdges() const;
+
+  /**
+   * @brief Returns the vertex the half-edge starts at.
+   * @param halfEdge
+   * @return MeshIndexType
+   */
+  MeshIndexType getOrigin(MeshIndexType halfEdge) const;
+
+  /**
+   * @brief Returns the vertex the half-edge ends at.
+   * @param halfEdge
+   * @return MeshIndexType
+   */
+  MeshIndexType getDestination(MeshIndexType halfEdge) const;
+
+  /**
+   * @brief Returns the next half-edge around the same face.
+   * @param halfEdge
+   * @return MeshIndexType
+   */
+  MeshIndexType getNext(MeshIndexType halfEdge) const;
+
+  /**
+   * @brief Returns the previous half-edge around the same face.
+   * @param halfEdge
+   * @return MeshIndexType
+   */
+  MeshIndexType getPrevious(MeshIndexType halfEdge) const;
+
+  /**
+   * @brief Returns the half-edge of the adjacent face along the same edge or
+   * k_InvalidIndex for boundary and non-manifold edges.
+   * @param halfEdge
+   * @return MeshIndexType
+   */
+  MeshIndexType getTwin(MeshIndexType halfEdge) const;
+
+  /**
+   * @brief Returns the face the half-edge belongs to.
+   * @param halfEdge
+   * @return MeshIndexType
+   */
+  MeshIndexType getFace(MeshIndexType halfEdge) const;
+
+  /**
+   * @brief Returns the undirected edge the half-edge belongs to.
+   * @param halfEdge
+   * @return MeshIndexType
+   */
+  MeshIndexType getEdge(MeshIndexType halfEdge) const;
+
+  /**
+   * @brief Returns the vertices of the edge in ascending order.
+   * @param edge
+   * @return std::array<MeshIndexType, 2>
+   */
+  std::array<MeshIndexType, 2> getEdgeVertices(MeshIndexType edge) const;
+
+  /**
+   * @brief Returns one of the half-edges of the edge.
+   * @param edge
+   * @return MeshIndexType
+   */
+  MeshIndexType getEdgeHalfEdge(MeshIndexType edge) const;
+
+  /**
+   * @brief Returns the number of faces using the edge.
+   * @param edge
+   * @return usize
+   */
+  usize getEdgeFaceCount(MeshIndexType edge) const;
+
+  /**
+   * @brief Returns true if the edge is used by exactly one face.
+   * @param edge
+   * @return bool
+   */
+  bool isBoundaryEdge(MeshIndexType edge) const;
+
+  /**
+   * @brief Returns true if the edge is used by at most two faces.
+   * @param edge
+   * @return bool
+   */
+  bool isManifoldEdge(MeshIndexType edge) const;
+
+  /**
+   * @brief Returns the face across the specified edge of the face, or
+   * k_InvalidIndex if there is none.
+   * @param face
+   * @param localEdge Index of the edge within the face
+   * @return MeshIndexType
+   */
+  MeshIndexType getFaceNeighbor(MeshIndexType face, usize localEdge) const;
+
+  /**
+   * @brief Returns the half-edges leaving the vertex in ascending order.
+   * The faces around the vertex are the faces of these half-edges.
+   * @param vertex
+   * @return Span<const MeshIndexType>
+   */
+  Span<const MeshIndexType> getOutgoingHalfEdges(MeshIndexType vertex) const;
+
+  /**
+   * @brief Writes the vertices sharing an edge with the vertex to ring in
+   * ascending order. Runs in O(k) for k faces around the vertex.
+   * @param vertex
+   * @param ring
+   */
+  void getVertexRing(MeshIndexType vertex, std::vector<MeshIndexType>& ring) const;
+
+  /**
+   * @brief Returns true if the faces around the vertex form a single
+   * consistently oriented fan, i.e. its neighborhood is a disk or half-disk.
+   * Unused vertices are manifold.
+   * @param vertex
+   * @return bool
+   */
+  bool isManifoldVertex(MeshIndexType vertex) const;
+
+  /**
+   * @brief Returns true if every edge and every vertex is manifold.
+   * @return bool
+   */
+  bool isManifold() const;
+
+  /**
+   * @brief Resizes edges to the number of edges, or boundary edges if
+   * boundaryOnly is true, and writes their vertices in ascending order.
+   * The result matches GeometryHelpers::Connectivity::Find2DElementEdges()
+   * and Find2DUnsharedEdges().
+   * @param edges
+   * @param boundaryOnly
+   */
+  void copyEdges(MeshIndexArrayType& edges, bool boundaryOnly) const;
+
+protected:
+  /**
+   * @brief Constructs an empty topology.
+   * @param ds
+   * @param name
+   */
+  HalfEdgeTopology(DataStructure* ds, const std::string& name);
+
+private:
+  struct Topology
+  {
+    usize faceSize = 0;
+    usize numVertices = 0;
+    std::vector<MeshIndexType> origins;
+    std::vector<MeshIndexType> twins;
+    std::vector<MeshIndexType> halfEdgeEdges;
+    std::vector<MeshIndexType> edgeHalfEdges;
+    std::vector<u32> edgeFaceCounts;
+    std::vector<usize> vertexOffsets;
+    std::vector<MeshIndexType> vertexHalfEdges;
+    usize numBoundaryEdges = 0;
+    bool manifold = true;
+  };
+
+  static MeshIndexType Next(const Topology& topology, MeshIndexType halfEdge);
+  static MeshIndexType Previous(const Topology& topology, MeshIndexType halfEdge);
+  static bool IsManifoldVertex(const Topology& topology, MeshIndexType vertex);
+
+  std::shared_ptr<const Topology> m_Topology;
+};
+} // namespace complex
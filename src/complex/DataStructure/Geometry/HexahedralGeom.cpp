@@ -3,6 +3,7 @@
 #include <stdexcept>
 
 #include "complex/DataStructure/DataStructure.hpp"
+#include "complex/DataStructure/Snapshot/SnapshotArchive.hpp"
 #include "complex/Utilities/GeometryHelpers.hpp"
 
 using namespace complex;
@@ -175,49 +176,54 @@ AbstractGeometry::StatusCode HexahedralGeom::findElementSizes()
 {
   auto dataStore = new DataStore<float>(1, getNumberOfHexas());
   auto hexSizes = getDataStructure()->createDataArray<float>("Hex Volumes", dataStore, getId());
-  m_HexSizesId = hexSizes->getId();
-  GeometryHelpers::Topology::FindHexVolumes<uint64_t>(getHexahedrals(), getVertices(), hexSizes);
-  if(getElementSizes() == nullptr)
+  if(hexSizes == nullptr)
   {
     m_HexSizesId.reset();
     return -1;
   }
+  GeometryHelpers::Topology::FindHexVolumes<uint64_t>(getHexahedrals(), getVertices(), hexSizes);
+  m_HexSizesId = hexSizes->getId();
+  recordDerived(m_HexSizesId, getGeometrySources());
   return 1;
 }
 
 const FloatArray* HexahedralGeom::getElementSizes() const
 {
-  return dynamic_cast<const FloatArray*>(getDataStructure()->getData(m_HexSizesId));
+  return getDerived<FloatArray>(m_HexSizesId, getGeometrySources(), &HexahedralGeom::findElementSizes);
 }
 
 void HexahedralGeom::deleteElementSizes()
 {
-  getDataStructure()->removeData(m_HexSizesId);
-  m_HexSizesId.reset();
+  deleteDerived(m_HexSizesId);
 }
 
 AbstractGeometry::StatusCode HexahedralGeom::findElementsContainingVert()
 {
   auto hexasControllingVert = getDataStructure()->createDynamicList<uint16_t, MeshIndexType>("Hex Containing Vertices", getId());
-  m_HexasContainingVertId = hexasControllingVert->getId();
-  GeometryHelpers::Connectivity::FindElementsContainingVert<uint16_t, MeshIndexType>(getHexahedrals(), hexasControllingVert, getNumberOfVertices());
-  if(getElementsContainingVert() == nullptr)
+  if(hexasControllingVert == nullptr)
   {
     m_HexasContainingVertId.reset();
     return -1;
   }
+  if(GeometryHelpers::Connectivity::FindElementsContainingVert<uint16_t, MeshIndexType>(getHexahedrals(), hexasControllingVert, getNumberOfVertices()) < 0)
+  {
+    getDataStructure()->removeData(hexasControllingVert->getId());
+    m_HexasContainingVertId.reset();
+    return -1;
+  }
+  m_HexasContainingVertId = hexasControllingVert->getId();
+  recordDerived(m_HexasContainingVertId, getConnectivitySources());
   return 1;
 }
 
 const AbstractGeometry::ElementDynamicList* HexahedralGeom::getElementsContainingVert() const
 {
-  return dynamic_cast<const ElementDynamicList*>(getDataStructure()->getData(m_HexasContainingVertId));
+  return getDerived<ElementDynamicList>(m_HexasContainingVertId, getConnectivitySources(), &HexahedralGeom::findElementsContainingVert);
 }
 
 void HexahedralGeom::deleteElementsContainingVert()
 {
-  getDataStructure()->removeData(m_HexasContainingVertId);
-  m_HexasContainingVertId.reset();
+  deleteDerived(m_HexasContainingVertId);
 }
 
 AbstractGeometry::StatusCode HexahedralGeom::findElementNeighbors()
@@ -232,50 +238,50 @@ AbstractGeometry::StatusCode HexahedralGeom::findElementNeighbors()
     }
   }
   auto hexNeighbors = getDataStructure()->createDynamicList<uint16_t, MeshIndexType>("Hex Neighbors", getId());
-  m_HexNeighborsId = hexNeighbors->getId();
   err = GeometryHelpers::Connectivity::FindElementNeighbors<uint16_t, MeshIndexType>(getHexahedrals(), getElementsContainingVert(), hexNeighbors, AbstractGeometry::Type::Hexahedral);
-  if(getElementNeighbors() == nullptr)
+  if(hexNeighbors == nullptr)
   {
     m_HexNeighborsId.reset();
     return -1;
   }
+  m_HexNeighborsId = hexNeighbors->getId();
+  recordDerived(m_HexNeighborsId, getConnectivitySources());
   return err;
 }
 
 const AbstractGeometry::ElementDynamicList* HexahedralGeom::getElementNeighbors() const
 {
-  return dynamic_cast<const ElementDynamicList*>(getDataStructure()->getData(m_HexNeighborsId));
+  return getDerived<ElementDynamicList>(m_HexNeighborsId, getConnectivitySources(), &HexahedralGeom::findElementNeighbors);
 }
 
 void HexahedralGeom::deleteElementNeighbors()
 {
-  getDataStructure()->removeData(m_HexNeighborsId);
-  m_HexNeighborsId.reset();
+  deleteDerived(m_HexNeighborsId);
 }
 
 AbstractGeometry::StatusCode HexahedralGeom::findElementCentroids()
 {
   auto dataStore = new DataStore<float>(3, getNumberOfHexas());
   auto hexCentroids = getDataStructure()->createDataArray<float>("Hex Centroids", dataStore, getId());
-  m_HexCentroidsId = hexCentroids->getId();
-  GeometryHelpers::Topology::FindElementCentroids<uint64_t>(getHexahedrals(), getVertices(), hexCentroids);
-  if(getElementCentroids() == nullptr)
+  if(hexCentroids == nullptr)
   {
     m_HexCentroidsId.reset();
     return -1;
   }
+  GeometryHelpers::Topology::FindElementCentroids<uint64_t>(getHexahedrals(), getVertices(), hexCentroids);
+  m_HexCentroidsId = hexCentroids->getId();
+  recordDerived(m_HexCentroidsId, getGeometrySources());
   return 1;
 }
 
 const FloatArray* HexahedralGeom::getElementCentroids() const
 {
-  return dynamic_cast<const FloatArray*>(getDataStructure()->getData(m_HexCentroidsId));
+  return getDerived<FloatArray>(m_HexCentroidsId, getGeometrySources(), &HexahedralGeom::findElementCentroids);
 }
 
 void HexahedralGeom::deleteElementCentroids()
 {
-  getDataStructure()->removeData(m_HexCentroidsId);
-  m_HexCentroidsId.reset();
+  deleteDerived(m_HexCentroidsId);
 }
 
 complex::Point3D<double> HexahedralGeom::getParametricCenter() const
@@ -343,9 +349,14 @@ complex::TooltipGenerator HexahedralGeom::getTooltipGenerator() const
 AbstractGeometry::StatusCode HexahedralGeom::findEdges()
 {
   auto edgeList = createSharedEdgeList(0);
-  GeometryHelpers::Connectivity::FindHexEdges<uint64_t>(getHexahedrals(), edgeList);
-  if(getEdges() == nullptr)
+  if(edgeList == nullptr)
+  {
+    setEdges(nullptr);
+    return -1;
+  }
+  if(GeometryHelpers::Connectivity::FindHexEdges<uint64_t>(getHexahedrals(), edgeList) < 0)
   {
+    getDataStructure()->removeData(edgeList->getId());
     setEdges(nullptr);
     return -1;
   }
@@ -356,12 +367,17 @@ AbstractGeometry::StatusCode HexahedralGeom::findEdges()
 AbstractGeometry::StatusCode HexahedralGeom::findFaces()
 {
   auto quadList = createSharedQuadList(0);
-  GeometryHelpers::Connectivity::FindHexFaces<uint64_t>(getHexahedrals(), quadList);
   if(quadList == nullptr)
   {
     setQuads(nullptr);
     return -1;
   }
+  if(GeometryHelpers::Connectivity::FindHexFaces<uint64_t>(getHexahedrals(), quadList) < 0)
+  {
+    getDataStructure()->removeData(quadList->getId());
+    setQuads(nullptr);
+    return -1;
+  }
   setQuads(quadList);
   return 1;
 }
@@ -370,12 +386,17 @@ AbstractGeometry::StatusCode HexahedralGeom::findUnsharedEdges()
 {
   auto dataStore = new DataStore<MeshIndexType>(2, 0);
   auto unsharedEdgeList = getDataStructure()->createDataArray("Unshared Edge List", dataStore, getId());
-  GeometryHelpers::Connectivity::FindUnsharedHexEdges<uint64_t>(getHexahedrals(), unsharedEdgeList);
   if(unsharedEdgeList == nullptr)
   {
     setUnsharedEdges(nullptr);
     return -1;
   }
+  if(GeometryHelpers::Connectivity::FindUnsharedHexEdges<uint64_t>(getHexahedrals(), unsharedEdgeList) < 0)
+  {
+    getDataStructure()->removeData(unsharedEdgeList->getId());
+    setUnsharedEdges(nullptr);
+    return -1;
+  }
   setUnsharedEdges(unsharedEdgeList);
   return 1;
 }
@@ -384,12 +405,17 @@ AbstractGeometry::StatusCode HexahedralGeom::findUnsharedFaces()
 {
   auto dataStore = new DataStore<MeshIndexType>(4, 0);
   auto unsharedQuadList = getDataStructure()->createDataArray<MeshIndexType>("Unshared Edge List", dataStore, getId());
-  GeometryHelpers::Connectivity::FindUnsharedHexFaces<uint64_t>(getHexahedrals(), unsharedQuadList);
   if(unsharedQuadList == nullptr)
   {
     setUnsharedFaces(nullptr);
     return -1;
   }
+  if(GeometryHelpers::Connectivity::FindUnsharedHexFaces<uint64_t>(getHexahedrals(), unsharedQuadList) < 0)
+  {
+    getDataStructure()->removeData(unsharedQuadList->getId());
+    setUnsharedFaces(nullptr);
+    return -1;
+  }
   setUnsharedFaces(unsharedQuadList);
   return 1;
 }
@@ -481,6 +507,16 @@ uint32_t HexahedralGeom::getXdmfGridType() const
   throw std::runtime_error("");
 }
 
+AbstractGeometry::SourceVersions HexahedralGeom::getGeometrySources() const
+{
+  return {ValuesVersion(getVertices()), ValuesVersion(getHexahedrals())};
+}
+
+AbstractGeometry::SourceVersions HexahedralGeom::getConnectivitySources() const
+{
+  return {TupleCountVersion(getVertices()), ValuesVersion(getHexahedrals())};
+}
+
 void HexahedralGeom::setElementsContainingVert(const ElementDynamicList* elementsContainingVert)
 {
   if(!elementsContainingVert)
@@ -520,3 +556,9 @@ void HexahedralGeom::setElementSizes(const FloatArray* elementSizes)
   }
   m_HexSizesId = elementSizes->getId();
 }
+
+void HexahedralGeom::serializeSnapshot(SnapshotArchive& archive)
+{
+  AbstractGeometry3D::serializeSnapshot(archive);
+  archive.reference(m_HexListId);
+}
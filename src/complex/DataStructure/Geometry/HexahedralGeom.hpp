@@ -296,6 +296,12 @@ public:
    */
   uint32_t getXdmfGridType() const override;
 
+  /**
+   * @brief Writes or reads the hexahedron list.
+   * @param archive
+   */
+  void serializeSnapshot(SnapshotArchive& archive) override;
+
 protected:
   /**
    * @brief
@@ -347,6 +353,20 @@ protected:
    */
   void setElementSizes(const FloatArray* elementSizes) override;
 
+  /**
+   * @brief Returns the vertex and element lists the element sizes and
+   * centroids are computed from.
+   * @return SourceVersions
+   */
+  SourceVersions getGeometrySources() const override;
+
+  /**
+   * @brief Returns the element list and the number of vertices the
+   * connectivity is computed from.
+   * @return SourceVersions
+   */
+  SourceVersions getConnectivitySources() const override;
+
 private:
   std::optional<DataObject::IdType> m_HexListId;
   std::optional<DataObject::IdType> m_HexasContainingVertId;
@@ -3,7 +3,9 @@
 #include <stdexcept>
 
 #include "complex/DataStructure/DataStructure.hpp"
+#include "complex/DataStructure/Snapshot/SnapshotArchive.hpp"
 #include "complex/Utilities/GeometryHelpers.hpp"
+#include "complex/Utilities/ParallelAlgorithms.hpp"
 
 using namespace complex;
 
@@ -55,11 +57,13 @@ complex::FloatVec3 ImageGeom::getSpacing() const
 void ImageGeom::setSpacing(const complex::FloatVec3& spacing)
 {
   m_Spacing = spacing;
+  markParametersModified();
 }
 
 void ImageGeom::setSpacing(float x, float y, float z)
 {
   m_Spacing = {x, y, z};
+  markParametersModified();
 }
 
 complex::FloatVec3 ImageGeom::getOrigin() const
@@ -70,11 +74,13 @@ complex::FloatVec3 ImageGeom::getOrigin() const
 void ImageGeom::setOrigin(const complex::FloatVec3& origin)
 {
   m_Origin = origin;
+  markParametersModified();
 }
 
 void ImageGeom::setOrigin(float x, float y, float z)
 {
   m_Origin = {x, y, z};
+  markParametersModified();
 }
 
 BoundingBox<float> ImageGeom::getBoundingBoxf() const
@@ -116,20 +122,20 @@ AbstractGeometry::StatusCode ImageGeom::findElementSizes()
   }
   auto dataStore = new DataStore<float>(1, getNumberOfElements());
   auto voxelSizes = getDataStructure()->createDataArray<float>("Voxel Sizes", dataStore, getId());
-  voxelSizes->getDataStore()->fill(res[0] * res[1] * res[2]);
+  ParallelAlgorithms::Fill(*voxelSizes, res[0] * res[1] * res[2]);
   m_VoxelSizesId = voxelSizes->getId();
+  recordDerived(m_VoxelSizesId, getGeometrySources());
   return 1;
 }
 
 const FloatArray* ImageGeom::getElementSizes() const
 {
-  return dynamic_cast<const FloatArray*>(getDataStructure()->getData(m_VoxelSizesId));
+  return getDerived<FloatArray>(m_VoxelSizesId, getGeometrySources(), &ImageGeom::findElementSizes);
 }
 
 void ImageGeom::deleteElementSizes()
 {
-  getDataStructure()->removeData(m_VoxelSizesId);
-  m_VoxelSizesId.reset();
+  deleteDerived(m_VoxelSizesId);
 }
 
 AbstractGeometry::StatusCode ImageGeom::findElementsContainingVert()
@@ -266,6 +272,7 @@ complex::SizeVec3 ImageGeom::getDimensions() const
 void ImageGeom::setDimensions(const complex::SizeVec3& dims)
 {
   m_Dimensions = dims;
+  markParametersModified();
 }
 
 size_t ImageGeom::getNumXPoints() const
@@ -476,3 +483,14 @@ void ImageGeom::setElementSizes(const FloatArray* elementSizes)
   }
   m_VoxelSizesId = elementSizes->getId();
 }
+
+void ImageGeom::serializeSnapshot(SnapshotArchive& archive)
+{
+  AbstractGeometryGrid::serializeSnapshot(archive);
+  for(size_t i = 0; i < 3; i++)
+  {
+    archive.value(m_Spacing[i]);
+    archive.value(m_Origin[i]);
+    archive.value(m_Dimensions[i]);
+  }
+}
@@ -373,6 +373,12 @@ public:
    */
   uint32_t getXdmfGridType() const override;
 
+  /**
+   * @brief Writes or reads the spacing, origin and dimensions.
+   * @param archive
+   */
+  void serializeSnapshot(SnapshotArchive& archive) override;
+
 protected:
   /**
    * @brief
@@ -3,6 +3,7 @@
 #include <stdexcept>
 
 #include "complex/DataStructure/DataStructure.hpp"
+#include "complex/DataStructure/Snapshot/SnapshotArchive.hpp"
 #include "complex/Utilities/GeometryHelpers.hpp"
 
 using namespace complex;
@@ -166,49 +167,54 @@ AbstractGeometry::StatusCode QuadGeom::findElementSizes()
 {
   auto dataStore = new DataStore<float>(1, getNumberOfQuads());
   auto quadSizes = getDataStructure()->createDataArray<float>("Quad Areas", dataStore, getId());
-  GeometryHelpers::Topology::Find2DElementAreas(getQuads(), getVertices(), quadSizes);
   if(quadSizes == nullptr)
   {
     m_QuadSizesId.reset();
     return -1;
   }
+  GeometryHelpers::Topology::Find2DElementAreas(getQuads(), getVertices(), quadSizes);
   m_QuadSizesId = quadSizes->getId();
+  recordDerived(m_QuadSizesId, getGeometrySources());
   return 1;
 }
 
 const FloatArray* QuadGeom::getElementSizes() const
 {
-  return dynamic_cast<const FloatArray*>(getDataStructure()->getData(m_QuadSizesId));
+  return getDerived<FloatArray>(m_QuadSizesId, getGeometrySources(), &QuadGeom::findElementSizes);
 }
 
 void QuadGeom::deleteElementSizes()
 {
-  getDataStructure()->removeData(m_QuadSizesId);
-  m_QuadSizesId.reset();
+  deleteDerived(m_QuadSizesId);
 }
 
 AbstractGeometry::StatusCode QuadGeom::findElementsContainingVert()
 {
   auto quadsContainingVert = getDataStructure()->createDynamicList<uint16_t, MeshIndexType>("Quads Containing Vert", getId());
-  GeometryHelpers::Connectivity::FindElementsContainingVert<uint16_t, MeshIndexType>(getQuads(), quadsContainingVert, getNumberOfVertices());
   if(quadsContainingVert == nullptr)
   {
     m_QuadsContainingVertId.reset();
     return -1;
   }
+  if(GeometryHelpers::Connectivity::FindElementsContainingVert<uint16_t, MeshIndexType>(getQuads(), quadsContainingVert, getNumberOfVertices()) < 0)
+  {
+    getDataStructure()->removeData(quadsContainingVert->getId());
+    m_QuadsContainingVertId.reset();
+    return -1;
+  }
   m_QuadsContainingVertId = quadsContainingVert->getId();
+  recordDerived(m_QuadsContainingVertId, getConnectivitySources());
   return 1;
 }
 
 const AbstractGeometry::ElementDynamicList* QuadGeom::getElementsContainingVert() const
 {
-  return dynamic_cast<const ElementDynamicList*>(getDataStructure()->getData(m_QuadsContainingVertId));
+  return getDerived<ElementDynamicList>(m_QuadsContainingVertId, getConnectivitySources(), &QuadGeom::findElementsContainingVert);
 }
 
 void QuadGeom::deleteElementsContainingVert()
 {
-  getDataStructure()->removeData(m_QuadsContainingVertId);
-  m_QuadsContainingVertId.reset();
+  deleteDerived(m_QuadsContainingVertId);
 }
 
 AbstractGeometry::StatusCode QuadGeom::findElementNeighbors()
@@ -230,43 +236,43 @@ AbstractGeometry::StatusCode QuadGeom::findElementNeighbors()
     return -1;
   }
   m_QuadNeighborsId = quadNeighbors->getId();
+  recordDerived(m_QuadNeighborsId, getConnectivitySources());
   return err;
 }
 
 const AbstractGeometry::ElementDynamicList* QuadGeom::getElementNeighbors() const
 {
-  return dynamic_cast<const ElementDynamicList*>(getDataStructure()->getData(m_QuadNeighborsId));
+  return getDerived<ElementDynamicList>(m_QuadNeighborsId, getConnectivitySources(), &QuadGeom::findElementNeighbors);
 }
 
 void QuadGeom::deleteElementNeighbors()
 {
-  getDataStructure()->removeData(m_QuadNeighborsId);
-  m_QuadNeighborsId.reset();
+  deleteDerived(m_QuadNeighborsId);
 }
 
 AbstractGeometry::StatusCode QuadGeom::findElementCentroids()
 {
   auto dataStore = new DataStore<float>(3, getNumberOfQuads());
   auto quadCentroids = getDataStructure()->createDataArray<float>("Quad Centroids", dataStore, getId());
-  GeometryHelpers::Topology::FindElementCentroids(getQuads(), getVertices(), quadCentroids);
   if(quadCentroids == nullptr)
   {
     m_QuadCentroidsId.reset();
     return -1;
   }
+  GeometryHelpers::Topology::FindElementCentroids(getQuads(), getVertices(), quadCentroids);
   m_QuadCentroidsId = quadCentroids->getId();
+  recordDerived(m_QuadCentroidsId, getGeometrySources());
   return 1;
 }
 
 const FloatArray* QuadGeom::getElementCentroids() const
 {
-  return dynamic_cast<const FloatArray*>(getDataStructure()->getData(m_QuadCentroidsId));
+  return getDerived<FloatArray>(m_QuadCentroidsId, getGeometrySources(), &QuadGeom::findElementCentroids);
 }
 
 void QuadGeom::deleteElementCentroids()
 {
-  getDataStructure()->removeData(m_QuadCentroidsId);
-  m_QuadCentroidsId.reset();
+  deleteDerived(m_QuadCentroidsId);
 }
 
 complex::Point3D<double> QuadGeom::getParametricCenter() const
@@ -374,12 +380,21 @@ void QuadGeom::getVertCoordsAtEdge(size_t edgeId, complex::Point3D<float>& vert1
 AbstractGeometry::StatusCode QuadGeom::findEdges()
 {
   auto edgeList = createSharedEdgeList(0);
-  GeometryHelpers::Connectivity::Find2DElementEdges(getQuads(), edgeList);
   if(edgeList == nullptr)
   {
     setEdges(nullptr);
     return -1;
   }
+  if(hasHalfEdgeTopology())
+  {
+    getHalfEdgeTopology()->copyEdges(*edgeList, false);
+  }
+  else if(GeometryHelpers::Connectivity::Find2DElementEdges(getQuads(), edgeList) < 0)
+  {
+    getDataStructure()->removeData(edgeList->getId());
+    setEdges(nullptr);
+    return -1;
+  }
   setEdges(edgeList);
   return 1;
 }
@@ -388,21 +403,68 @@ AbstractGeometry::StatusCode QuadGeom::findUnsharedEdges()
 {
   auto dataStore = new DataStore<MeshIndexType>(2, 0);
   auto unsharedEdgeList = getDataStructure()->createDataArray<MeshIndexType>("Unshared Edge List", dataStore, getId());
-  GeometryHelpers::Connectivity::Find2DUnsharedEdges(getQuads(), unsharedEdgeList);
   if(unsharedEdgeList == nullptr)
   {
     setUnsharedEdges(nullptr);
     return -1;
   }
+  if(hasHalfEdgeTopology())
+  {
+    getHalfEdgeTopology()->copyEdges(*unsharedEdgeList, true);
+  }
+  else if(GeometryHelpers::Connectivity::Find2DUnsharedEdges(getQuads(), unsharedEdgeList) < 0)
+  {
+    getDataStructure()->removeData(unsharedEdgeList->getId());
+    setUnsharedEdges(nullptr);
+    return -1;
+  }
   setUnsharedEdges(unsharedEdgeList);
   return 1;
 }
 
+AbstractGeometry::StatusCode QuadGeom::findHalfEdgeTopology()
+{
+  const SharedQuadList* faces = getQuads();
+  if(faces == nullptr)
+  {
+    return -1;
+  }
+  deleteHalfEdgeTopology();
+  auto topology = getDataStructure()->createHalfEdgeTopology("Half-Edge Topology", getId());
+  if(topology == nullptr)
+  {
+    setHalfEdgeTopology(nullptr);
+    return -1;
+  }
+  try
+  {
+    topology->build(*faces, getNumberOfVertices());
+  } catch(const std::exception&)
+  {
+    getDataStructure()->removeData(topology->getId());
+    setHalfEdgeTopology(nullptr);
+    return -1;
+  }
+  setHalfEdgeTopology(topology);
+  recordDerived(topology->getId(), getConnectivitySources());
+  return 1;
+}
+
 uint32_t QuadGeom::getXdmfGridType() const
 {
   throw std::runtime_error("");
 }
 
+AbstractGeometry::SourceVersions QuadGeom::getGeometrySources() const
+{
+  return {ValuesVersion(getVertices()), ValuesVersion(getQuads())};
+}
+
+AbstractGeometry::SourceVersions QuadGeom::getConnectivitySources() const
+{
+  return {TupleCountVersion(getVertices()), ValuesVersion(getQuads())};
+}
+
 void QuadGeom::setElementsContainingVert(const ElementDynamicList* elementsContainingVert)
 {
   if(!elementsContainingVert)
@@ -442,3 +504,9 @@ void QuadGeom::setElementSizes(const FloatArray* elementSizes)
   }
   m_QuadSizesId = elementSizes->getId();
 }
+
+void QuadGeom::serializeSnapshot(SnapshotArchive& archive)
+{
+  AbstractGeometry2D::serializeSnapshot(archive);
+  archive.reference(m_QuadListId);
+}
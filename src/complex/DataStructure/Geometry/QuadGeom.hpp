@@ -255,12 +255,24 @@ public:
    */
   StatusCode findUnsharedEdges() override;
 
+  /**
+   * @brief
+   * @return StatusCode
+   */
+  StatusCode findHalfEdgeTopology() override;
+
   /**
    * @brief
    * @return uint32_t
    */
   uint32_t getXdmfGridType() const override;
 
+  /**
+   * @brief Writes or reads the quad list.
+   * @param archive
+   */
+  void serializeSnapshot(SnapshotArchive& archive) override;
+
 protected:
   /**
    * @brief
@@ -312,6 +324,20 @@ protected:
    */
   void setElementSizes(const FloatArray* elementSizes) override;
 
+  /**
+   * @brief Returns the vertex and element lists the element sizes and
+   * centroids are computed from.
+   * @return SourceVersions
+   */
+  SourceVersions getGeometrySources() const override;
+
+  /**
+   * @brief Returns the element list and the number of vertices the
+   * connectivity is computed from.
+   * @return SourceVersions
+   */
+  SourceVersions getConnectivitySources() const override;
+
 private:
   std::optional<DataObject::IdType> m_QuadListId;
   std::optional<DataObject::IdType> m_QuadsContainingVertId;
@@ -3,6 +3,7 @@
 #include <stdexcept>
 
 #include "complex/DataStructure/DataStructure.hpp"
+#include "complex/DataStructure/Snapshot/SnapshotArchive.hpp"
 #include "complex/Utilities/GeometryHelpers.hpp"
 
 using namespace complex;
@@ -149,18 +150,18 @@ AbstractGeometry::StatusCode RectGridGeom::findElementSizes()
   }
 
   m_VoxelSizesId = sizeArray->getId();
+  recordDerived(m_VoxelSizesId, getGeometrySources());
   return 1;
 }
 
 const FloatArray* RectGridGeom::getElementSizes() const
 {
-  return dynamic_cast<const FloatArray*>(getDataStructure()->getData(m_VoxelSizesId));
+  return getDerived<FloatArray>(m_VoxelSizesId, getGeometrySources(), &RectGridGeom::findElementSizes);
 }
 
 void RectGridGeom::deleteElementSizes()
 {
-  getDataStructure()->removeData(m_VoxelSizesId);
-  m_VoxelSizesId.reset();
+  deleteDerived(m_VoxelSizesId);
 }
 
 AbstractGeometry::StatusCode RectGridGeom::findElementsContainingVert()
@@ -284,6 +285,7 @@ complex::TooltipGenerator RectGridGeom::getTooltipGenerator() const
 void RectGridGeom::setDimensions(const complex::SizeVec3& dims)
 {
   m_Dimensions = dims;
+  markParametersModified();
 }
 
 complex::SizeVec3 RectGridGeom::getDimensions() const
@@ -544,6 +546,11 @@ uint32_t RectGridGeom::getXdmfGridType() const
   throw std::runtime_error("");
 }
 
+AbstractGeometry::SourceVersions RectGridGeom::getGeometrySources() const
+{
+  return {parametersVersion(), ValuesVersion(getXBounds()), ValuesVersion(getYBounds()), ValuesVersion(getZBounds())};
+}
+
 void RectGridGeom::setElementsContainingVert(const ElementDynamicList* elementsContainingVert)
 {
 }
@@ -565,3 +572,15 @@ void RectGridGeom::setElementSizes(const FloatArray* elementSizes)
   }
   m_VoxelSizesId = elementSizes->getId();
 }
+
+void RectGridGeom::serializeSnapshot(SnapshotArchive& archive)
+{
+  AbstractGeometryGrid::serializeSnapshot(archive);
+  archive.reference(m_xBoundsId);
+  archive.reference(m_yBoundsId);
+  archive.reference(m_zBoundsId);
+  for(size_t i = 0; i < 3; i++)
+  {
+    archive.value(m_Dimensions[i]);
+  }
+}
@@ -331,6 +331,12 @@ public:
    */
   uint32_t getXdmfGridType() const override;
 
+  /**
+   * @brief Writes or reads the bounds arrays and dimensions.
+   * @param archive
+   */
+  void serializeSnapshot(SnapshotArchive& archive) override;
+
 protected:
   /**
    * @brief
@@ -372,6 +378,13 @@ protected:
    */
   void setElementSizes(const FloatArray* elementSizes) override;
 
+  /**
+   * @brief Returns the dimensions and bounds the element sizes are computed
+   * from.
+   * @return SourceVersions
+   */
+  SourceVersions getGeometrySources() const override;
+
 private:
   std::optional<DataObject::IdType> m_xBoundsId;
   std::optional<DataObject::IdType> m_yBoundsId;
@@ -0,0 +1,827 @@
+#include "SpatialIndex.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+
+#include <fmt/core.h>
+
+#include "complex/Utilities/GeometryHelpers.hpp"
+#include "complex/Utilities/ParallelAlgorithms.hpp"
+#include "complex/Utilities/ThreadPool.hpp"
+
+using namespace complex;
+using Vec3f = GeometryMath::detail::Vec3<float>;
+
+namespace
+{
+constexpr usize k_MaxLeafSize = 8;
+constexpr usize k_StackSize = 128;
+
+// Average number of points per grid cell
+constexpr float k_PointsPerCell = 2.0f;
+
+// The tree is rebuilt instead of refit once more than 1 / k_RebuildFraction
+// of the points moved, since refit bounds overlap more and more
+constexpr usize k_RebuildFraction = 4;
+
+constexpr usize k_MinQuerySliceCount = 256;
+constexpr usize k_QueryGranularity = 64;
+
+constexpr float k_Infinity = std::numeric_limits<float>::infinity();
+
+struct Box
+{
+  Vec3f min = {k_Infinity, k_Infinity, k_Infinity};
+  Vec3f max = {-k_Infinity, -k_Infinity, -k_Infinity};
+
+  void grow(const Vec3f& point)
+  {
+    for(usize i = 0; i < 3; i++)
+    {
+      min[i] = std::min(min[i], point[i]);
+      max[i] = std::max(max[i], point[i]);
+    }
+  }
+
+  void grow(const Box& box)
+  {
+    grow(box.min);
+    grow(box.max);
+  }
+};
+
+Vec3f PointAt(const float* coords, u64 vertex)
+{
+  return {coords[3 * vertex], coords[3 * vertex + 1], coords[3 * vertex + 2]};
+}
+
+/**
+ * @brief Returns the squared distance between the point and the box.
+ */
+float BoxDistanceSquared(const Vec3f& min, const Vec3f& max, const Vec3f& point)
+{
+  float distance = 0.0f;
+  for(usize i = 0; i < 3; i++)
+  {
+    const float offset = std::max({min[i] - point[i], 0.0f, point[i] - max[i]});
+    distance += offset * offset;
+  }
+  return distance;
+}
+
+float DistanceSquared(const Vec3f& a, const Vec3f& b)
+{
+  const float x = a[0] - b[0];
+  const float y = a[1] - b[1];
+  const float z = a[2] - b[2];
+  return x * x + y * y + z * z;
+}
+
+/**
+ * @brief Returns the bounds of the points in parallel.
+ */
+Box FindBounds(const Vec3f* points, usize count)
+{
+  Box bounds;
+  std::mutex mutex;
+  ThreadPool::Global().parallelFor(count, GeometryHelpers::Connectivity::detail::k_MinSliceCount, 1, [&](usize begin, usize end) {
+    Box sliceBounds;
+    for(usize i = begin; i < end; i++)
+    {
+      sliceBounds.grow(points[i]);
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    bounds.grow(sliceBounds);
+  });
+  return bounds;
+}
+
+/**
+ * @brief Returns the first point and number of points of every tree node.
+ * The first half of the points of a node go to its first child.
+ */
+std::vector<std::pair<usize, usize>> NodeRanges(usize numPoints, usize leafLevel)
+{
+  const usize numNodes = (usize(2) << leafLevel) - 1;
+  std::vector<std::pair<usize, usize>> ranges(numNodes);
+  ranges[0] = {0, numPoints};
+  for(usize node = 0; 2 * node + 2 < numNodes; node++)
+  {
+    const auto [first, count] = ranges[node];
+    ranges[2 * node + 1] = {first, count / 2};
+    ranges[2 * node + 2] = {first + count / 2, count - count / 2};
+  }
+  return ranges;
+}
+
+/**
+ * @brief Calls function(node) for the nodes of the tree level in parallel.
+ */
+template <typename FunctionT>
+void ForEachNodeOfLevel(usize level, const FunctionT& function)
+{
+  const usize first = (usize(1) << level) - 1;
+  ThreadPool::Global().parallelFor(usize(1) << level, 1, 1, [&](usize begin, usize end) {
+    for(usize i = begin; i < end; i++)
+    {
+      function(first + i);
+    }
+  });
+}
+
+/**
+ * @brief Returns the edge length of cubic cells holding about
+ * k_PointsPerCell points each if the points filled their bounds evenly.
+ * Axes along which the cloud is flat are widened to the cell size, so
+ * planar and linear clouds get cells sized to their area or length.
+ */
+float FindCellSize(const Box& bounds, usize numPoints)
+{
+  const Vec3f extent = {bounds.max[0] - bounds.min[0], bounds.max[1] - bounds.min[1], bounds.max[2] - bounds.min[2]};
+  float cellSize = std::max({extent[0], extent[1], extent[2]});
+  if(!(cellSize > 0.0f))
+  {
+    return 1.0f;
+  }
+  const float cellVolume = k_PointsPerCell / static_cast<float>(numPoints);
+  for(usize iteration = 0; iteration < 16; iteration++)
+  {
+    const float volume = std::max(extent[0], cellSize) * std::max(extent[1], cellSize) * std::max(extent[2], cellSize);
+    cellSize = std::cbrt(volume * cellVolume);
+  }
+  return cellSize;
+}
+} // namespace
+
+/**
+ * @brief Bounded max-heap of the k best candidates by squared distance and
+ * vertex id.
+ */
+class SpatialIndex::NeighborHeap
+{
+public:
+  explicit NeighborHeap(usize k)
+  : m_K(k)
+  {
+    m_Entries.reserve(k);
+  }
+
+  /**
+   * @brief Returns the squared distance a candidate may have to still be
+   * kept. Candidates at exactly this distance can win on their id.
+   */
+  float bound() const
+  {
+    return (m_Entries.size() < m_K) ? k_Infinity : m_Entries.front().first;
+  }
+
+  bool full() const
+  {
+    return m_Entries.size() == m_K;
+  }
+
+  void push(float distanceSquared, MeshIndexType vertex)
+  {
+    const std::pair<float, MeshIndexType> entry(distanceSquared, vertex);
+    if(m_Entries.size() < m_K)
+    {
+      m_Entries.push_back(entry);
+      std::push_heap(m_Entries.begin(), m_Entries.end());
+    }
+    else if(m_K > 0 && entry < m_Entries.front())
+    {
+      std::pop_heap(m_Entries.begin(), m_Entries.end());
+      m_Entries.back() = entry;
+      std::push_heap(m_Entries.begin(), m_Entries.end());
+    }
+  }
+
+  /**
+   * @brief Writes the candidates to neighbors nearest first and empties the
+   * heap.
+   */
+  template <typename OutputT>
+  usize extract(OutputT neighbors)
+  {
+    std::sort_heap(m_Entries.begin(), m_Entries.end());
+    for(usize i = 0; i < m_Entries.size(); i++)
+    {
+      neighbors[i] = Neighbor{m_Entries[i].second, std::sqrt(m_Entries[i].first)};
+    }
+    const usize count = m_Entries.size();
+    m_Entries.clear();
+    return count;
+  }
+
+private:
+  usize m_K;
+  std::vector<std::pair<float, MeshIndexType>> m_Entries;
+};
+
+SpatialIndex::SpatialIndex(DataStructure* ds, const std::string& name)
+: DataObject(ds, name)
+, m_Index(std::make_shared<Index>())
+{
+}
+
+SpatialIndex::SpatialIndex(const SpatialIndex& other)
+: DataObject(other)
+, m_Index(other.m_Index)
+{
+}
+
+SpatialIndex::SpatialIndex(SpatialIndex&& other) noexcept
+: DataObject(std::move(other))
+, m_Index(std::move(other.m_Index))
+{
+}
+
+SpatialIndex::~SpatialIndex() = default;
+
+DataObject* SpatialIndex::shallowCopy()
+{
+  return new SpatialIndex(*this);
+}
+
+DataObject* SpatialIndex::deepCopy()
+{
+  return new SpatialIndex(*this);
+}
+
+void SpatialIndex::build(const DataArray<float>& vertices, Type type)
+{
+  if(vertices.getTupleSize() != 3)
+  {
+    throw std::runtime_error(fmt::format("Spatial index requires 3D vertices, got {} coordinates per vertex", vertices.getTupleSize()));
+  }
+  std::vector<float> vertexBuffer;
+  const float* coords = GeometryHelpers::Connectivity::detail::GetContiguousValues(*vertices.getDataStore(), vertexBuffer);
+
+  auto index = std::make_shared<Index>();
+  index->type = type;
+  const usize numPoints = vertices.getTupleCount();
+  index->points.resize(numPoints);
+  index->ids.resize(numPoints);
+  index->slots.resize(numPoints);
+  if(type == Type::KdTree)
+  {
+    BuildKdTree(*index, coords);
+  }
+  else
+  {
+    BuildGrid(*index, coords);
+  }
+  m_Index = std::move(index);
+}
+
+void SpatialIndex::BuildKdTree(Index& index, const float* coords)
+{
+  const usize numPoints = index.points.size();
+  ThreadPool& pool = ThreadPool::Global();
+  index.nodes.clear();
+  if(numPoints == 0)
+  {
+    return;
+  }
+
+  index.leafLevel = 0;
+  while(((numPoints - 1) >> index.leafLevel) + 1 > k_MaxLeafSize)
+  {
+    index.leafLevel++;
+  }
+  const std::vector<std::pair<usize, usize>> ranges = NodeRanges(numPoints, index.leafLevel);
+  index.nodes.resize(ranges.size());
+
+  std::vector<u64>& order = index.ids;
+  std::iota(order.begin(), order.end(), u64(0));
+
+  // Each level splits the ranges of its nodes at their median. The upper
+  // levels have few nodes, so the first one or two run on a single thread.
+  for(usize level = 0; level <= index.leafLevel; level++)
+  {
+    ForEachNodeOfLevel(level, [&](usize node) {
+      const auto [first, count] = ranges[node];
+      u64* vertices = order.data() + first;
+      Box bounds;
+      for(usize i = 0; i < count; i++)
+      {
+        bounds.grow(PointAt(coords, vertices[i]));
+      }
+      index.nodes[node] = Node{bounds.min, bounds.max};
+      if(level == index.leafLevel)
+      {
+        return;
+      }
+      usize axis = 0;
+      for(usize i = 1; i < 3; i++)
+      {
+        if(bounds.max[i] - bounds.min[i] > bounds.max[axis] - bounds.min[axis])
+        {
+          axis = i;
+        }
+      }
+      std::nth_element(vertices, vertices + count / 2, vertices + count, [coords, axis](u64 a, u64 b) { return coords[3 * a + axis] < coords[3 * b + axis]; });
+    });
+  }
+
+  pool.parallelFor(numPoints, GeometryHelpers::Connectivity::detail::k_MinSliceCount, 1, [&](usize begin, usize end) {
+    for(usize i = begin; i < end; i++)
+    {
+      index.points[i] = PointAt(coords, order[i]);
+      index.slots[order[i]] = i;
+    }
+  });
+  index.boundsMin = index.nodes[0].min;
+  index.boundsMax = index.nodes[0].max;
+}
+
+void SpatialIndex::RefitKdTree(Index& index)
+{
+  const usize numPoints = index.points.size();
+  if(numPoints == 0)
+  {
+    return;
+  }
+  const std::vector<std::pair<usize, usize>> ranges = NodeRanges(numPoints, index.leafLevel);
+  ForEachNodeOfLevel(index.leafLevel, [&](usize node) {
+    const auto [first, count] = ranges[node];
+    Box bounds;
+    for(usize i = first; i < first + count; i++)
+    {
+      bounds.grow(index.points[i]);
+    }
+    index.nodes[node] = Node{bounds.min, bounds.max};
+  });
+  for(usize level = index.leafLevel; level-- > 0;)
+  {
+    ForEachNodeOfLevel(level, [&](usize node) {
+      Box bounds;
+      bounds.grow(Box{index.nodes[2 * node + 1].min, index.nodes[2 * node + 1].max});
+      bounds.grow(Box{index.nodes[2 * node + 2].min, index.nodes[2 * node + 2].max});
+      index.nodes[node] = Node{bounds.min, bounds.max};
+    });
+  }
+  index.boundsMin = index.nodes[0].min;
+  index.boundsMax = index.nodes[0].max;
+}
+
+void SpatialIndex::BuildGrid(Index& index, const float* coords)
+{
+  namespace Connectivity = GeometryHelpers::Connectivity;
+
+  const usize numPoints = index.points.size();
+  ThreadPool& pool = ThreadPool::Global();
+
+  pool.parallelFor(numPoints, Connectivity::detail::k_MinSliceCount, 1, [&](usize begin, usize end) {
+    for(usize i = begin; i < end; i++)
+    {
+      index.points[i] = PointAt(coords, i);
+    }
+  });
+  const Box bounds = FindBounds(index.points.data(), numPoints);
+  index.boundsMin = bounds.min;
+  index.boundsMax = bounds.max;
+  index.gridOrigin = bounds.min;
+  index.cellSize = (numPoints == 0) ? 1.0f : FindCellSize(bounds, numPoints);
+
+  usize numBuckets = 1;
+  while(numBuckets < numPoints)
+  {
+    numBuckets *= 2;
+  }
+  index.bucketMask = numBuckets - 1;
+
+  // Counting sort of the points by bucket. Points are scattered in any
+  // order and then sorted by vertex id within their bucket.
+  std::vector<u64> buckets(numPoints);
+  std::unique_ptr<std::atomic<usize>[]> cursors(new std::atomic<usize>[numBuckets]());
+  pool.parallelFor(numPoints, Connectivity::detail::k_MinSliceCount, 1, [&](usize begin, usize end) {
+    for(usize i = begin; i < end; i++)
+    {
+      buckets[i] = BucketOf(index, CellOf(index, index.points[i]));
+      cursors[buckets[i]].fetch_add(1, std::memory_order_relaxed);
+    }
+  });
+  std::vector<usize>& offsets = index.bucketOffsets;
+  offsets.resize(numBuckets + 1);
+  for(usize b = 0; b < numBuckets; b++)
+  {
+    offsets[b] = cursors[b].load(std::memory_order_relaxed);
+  }
+  offsets[numBuckets] = ParallelAlgorithms::ExclusiveScan(offsets.data(), numBuckets, offsets.data());
+  for(usize b = 0; b < numBuckets; b++)
+  {
+    cursors[b].store(offsets[b], std::memory_order_relaxed);
+  }
+  pool.parallelFor(numPoints, Connectivity::detail::k_MinSliceCount, 1, [&](usize begin, usize end) {
+    for(usize i = begin; i < end; i++)
+    {
+      index.ids[cursors[buckets[i]].fetch_add(1, std::memory_order_relaxed)] = i;
+    }
+  });
+  pool.parallelFor(numBuckets, Connectivity::detail::k_MinSliceCount, 1, [&](usize begin, usize end) {
+    for(usize b = begin; b < end; b++)
+    {
+      std::sort(index.ids.begin() + offsets[b], index.ids.begin() + offsets[b + 1]);
+    }
+  });
+  pool.parallelFor(numPoints, Connectivity::detail::k_MinSliceCount, 1, [&](usize begin, usize end) {
+    for(usize i = begin; i < end; i++)
+    {
+      index.points[i] = PointAt(coords, index.ids[i]);
+      index.slots[index.ids[i]] = i;
+    }
+  });
+}
+
+usize SpatialIndex::update(const DataArray<float>& vertices)
+{
+  const usize numPoints = vertices.getTupleCount();
+  if(vertices.getTupleSize() != 3 || numPoints != m_Index->points.size())
+  {
+    build(vertices, m_Index->type);
+    return numPoints;
+  }
+  if(m_Index.use_count() > 1)
+  {
+    m_Index = std::make_shared<Index>(*m_Index);
+  }
+  Index& index = *m_Index;
+  std::vector<float> vertexBuffer;
+  const float* coords = GeometryHelpers::Connectivity::detail::GetContiguousValues(*vertices.getDataStore(), vertexBuffer);
+  ThreadPool& pool = ThreadPool::Global();
+
+  // Find the moved vertices and, for the grid, whether any left its bucket
+  std::vector<u64> moved;
+  std::mutex mutex;
+  bool changedBucket = false;
+  pool.parallelFor(numPoints, GeometryHelpers::Connectivity::detail::k_MinSliceCount, 1, [&](usize begin, usize end) {
+    std::vector<u64> sliceMoved;
+    bool sliceChangedBucket = false;
+    for(usize vertex = begin; vertex < end; vertex++)
+    {
+      const Vec3f& current = index.points[index.slots[vertex]];
+      const Vec3f point = PointAt(coords, vertex);
+      if(point == current)
+      {
+        continue;
+      }
+      sliceMoved.push_back(vertex);
+      if(index.type == Type::UniformGrid && !sliceChangedBucket)
+      {
+        sliceChangedBucket = BucketOf(index, CellOf(index, point)) != BucketOf(index, CellOf(index, current));
+      }
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    moved.insert(moved.end(), sliceMoved.begin(), sliceMoved.end());
+    changedBucket = changedBucket || sliceChangedBucket;
+  });
+  if(moved.empty())
+  {
+    return 0;
+  }
+
+  if((index.type == Type::KdTree && moved.size() * k_RebuildFraction > numPoints) || changedBucket)
+  {
+    if(index.type == Type::KdTree)
+    {
+      BuildKdTree(index, coords);
+    }
+    else
+    {
+      BuildGrid(index, coords);
+    }
+    return moved.size();
+  }
+
+  pool.parallelFor(moved.size(), GeometryHelpers::Connectivity::detail::k_MinSliceCount, 1, [&](usize begin, usize end) {
+    for(usize i = begin; i < end; i++)
+    {
+      index.points[index.slots[moved[i]]] = PointAt(coords, moved[i]);
+    }
+  });
+  if(index.type == Type::KdTree)
+  {
+    RefitKdTree(index);
+  }
+  else
+  {
+    // Points stayed in their cells, but may have left the bounds
+    Box bounds{index.boundsMin, index.boundsMax};
+    for(u64 vertex : moved)
+    {
+      bounds.grow(PointAt(coords, vertex));
+    }
+    index.boundsMin = bounds.min;
+    index.boundsMax = bounds.max;
+  }
+  return moved.size();
+}
+
+SpatialIndex::Type SpatialIndex::getType() const
+{
+  return m_Index->type;
+}
+
+usize SpatialIndex::getNumberOfPoints() const
+{
+  return m_Index->points.size();
+}
+
+BoundingBox<float> SpatialIndex::getBounds() const
+{
+  const Index& index = *m_Index;
+  if(index.points.empty())
+  {
+    const Box empty;
+    return BoundingBox<float>(Point3D<float>(empty.min[0], empty.min[1], empty.min[2]), Point3D<float>(empty.max[0], empty.max[1], empty.max[2]));
+  }
+  return BoundingBox<float>(Point3D<float>(index.boundsMin[0], index.boundsMin[1], index.boundsMin[2]), Point3D<float>(index.boundsMax[0], index.boundsMax[1], index.boundsMax[2]));
+}
+
+SpatialIndex::Neighbor SpatialIndex::findNearestNeighbor(const Point3D<float>& point) const
+{
+  NeighborHeap heap(1);
+  FindNearest(*m_Index, GeometryMath::detail::ToVec3(point), heap);
+  Neighbor neighbor;
+  heap.extract(&neighbor);
+  return neighbor;
+}
+
+void SpatialIndex::findNearestNeighbors(const Point3D<float>& point, usize k, std::vector<Neighbor>& neighbors) const
+{
+  NeighborHeap heap(k);
+  FindNearest(*m_Index, GeometryMath::detail::ToVec3(point), heap);
+  neighbors.resize(std::min(k, m_Index->points.size()));
+  heap.extract(neighbors.begin());
+}
+
+void SpatialIndex::findNearestNeighbors(const GeometryMath::PointArrays<float>& points, usize k, Neighbor* neighbors) const
+{
+  const Index& index = *m_Index;
+  ThreadPool::Global().parallelFor(points.count, k_MinQuerySliceCount, k_QueryGranularity, [&](usize begin, usize end) {
+    NeighborHeap heap(k);
+    for(usize i = begin; i < end; i++)
+    {
+      FindNearest(index, {points.x[i], points.y[i], points.z[i]}, heap);
+      Neighbor* results = neighbors + i * k;
+      std::fill(results + heap.extract(results), results + k, Neighbor{});
+    }
+  });
+}
+
+void SpatialIndex::findWithinRadius(const Point3D<float>& point, float radius, std::vector<Neighbor>& neighbors) const
+{
+  FindWithinRadius(*m_Index, GeometryMath::detail::ToVec3(point), radius, neighbors);
+}
+
+void SpatialIndex::findWithinRadius(const GeometryMath::PointArrays<float>& points, float radius, std::vector<usize>& offsets, std::vector<Neighbor>& neighbors) const
+{
+  const Index& index = *m_Index;
+  std::vector<std::vector<Neighbor>> results(points.count);
+  ThreadPool::Global().parallelFor(points.count, k_MinQuerySliceCount, k_QueryGranularity, [&](usize begin, usize end) {
+    for(usize i = begin; i < end; i++)
+    {
+      FindWithinRadius(index, {points.x[i], points.y[i], points.z[i]}, radius, results[i]);
+    }
+  });
+
+  std::vector<usize> counts(points.count);
+  for(usize i = 0; i < points.count; i++)
+  {
+    counts[i] = results[i].size();
+  }
+  offsets.resize(points.count + 1);
+  offsets[points.count] = ParallelAlgorithms::ExclusiveScan(counts.data(), points.count, offsets.data());
+  neighbors.resize(offsets[points.count]);
+  ThreadPool::Global().parallelFor(points.count, k_MinQuerySliceCount, k_QueryGranularity, [&](usize begin, usize end) {
+    for(usize i = begin; i < end; i++)
+    {
+      std::copy(results[i].begin(), results[i].end(), neighbors.begin() + offsets[i]);
+    }
+  });
+}
+
+std::array<i64, 3> SpatialIndex::CellOf(const Index& index, const Vec3f& point)
+{
+  std::array<i64, 3> cell;
+  for(usize i = 0; i < 3; i++)
+  {
+    cell[i] = static_cast<i64>(std::floor((point[i] - index.gridOrigin[i]) / index.cellSize));
+  }
+  return cell;
+}
+
+u64 SpatialIndex::BucketOf(const Index& index, const std::array<i64, 3>& cell)
+{
+  u64 hash = static_cast<u64>(cell[0]) * 0x9E3779B97F4A7C15ull;
+  hash ^= static_cast<u64>(cell[1]) * 0xC2B2AE3D27D4EB4Full;
+  hash ^= static_cast<u64>(cell[2]) * 0x165667B19E3779F9ull;
+  return (hash ^ (hash >> 29)) & index.bucketMask;
+}
+
+void SpatialIndex::FindNearest(const Index& index, const Vec3f& point, NeighborHeap& heap)
+{
+  if(index.points.empty())
+  {
+    return;
+  }
+
+  if(index.type == Type::KdTree)
+  {
+    struct Entry
+    {
+      usize node;
+      usize first;
+      usize count;
+      usize level;
+      float distance;
+    };
+    std::array<Entry, k_StackSize> stack;
+    usize stackSize = 0;
+    stack[stackSize++] = Entry{0, 0, index.points.size(), 0, BoxDistanceSquared(index.nodes[0].min, index.nodes[0].max, point)};
+    while(stackSize > 0)
+    {
+      const Entry entry = stack[--stackSize];
+      if(entry.distance > heap.bound())
+      {
+        continue;
+      }
+      if(entry.level == index.leafLevel)
+      {
+        for(usize i = entry.first; i < entry.first + entry.count; i++)
+        {
+          heap.push(DistanceSquared(index.points[i], point), index.ids[i]);
+        }
+        continue;
+      }
+      const usize left = 2 * entry.node + 1;
+      const usize right = left + 1;
+      Entry near{left, entry.first, entry.count / 2, entry.level + 1, BoxDistanceSquared(index.nodes[left].min, index.nodes[left].max, point)};
+      Entry far{right, entry.first + entry.count / 2, entry.count - entry.count / 2, entry.level + 1, BoxDistanceSquared(index.nodes[right].min, index.nodes[right].max, point)};
+      if(far.distance < near.distance)
+      {
+        std::swap(near, far);
+      }
+      stack[stackSize++] = far;
+      stack[stackSize++] = near;
+    }
+    return;
+  }
+
+  // Grid: visit shells of cells around the cell of the point until the
+  // next shell is farther away than the k-th candidate
+  const std::array<i64, 3> center = CellOf(index, point);
+  const std::array<i64, 3> low = CellOf(index, index.boundsMin);
+  const std::array<i64, 3> high = CellOf(index, index.boundsMax);
+  i64 firstShell = 0;
+  i64 lastShell = 0;
+  for(usize i = 0; i < 3; i++)
+  {
+    firstShell = std::max({firstShell, low[i] - center[i], center[i] - high[i]});
+    lastShell = std::max({lastShell, center[i] - low[i], high[i] - center[i]});
+  }
+  auto visitCell = [&](const std::array<i64, 3>& cell) {
+    const u64 bucket = BucketOf(index, cell);
+    for(usize i = index.bucketOffsets[bucket]; i < index.bucketOffsets[bucket + 1]; i++)
+    {
+      // Other cells may hash to the same bucket
+      if(CellOf(index, index.points[i]) == cell)
+      {
+        heap.push(DistanceSquared(index.points[i], point), index.ids[i]);
+      }
+    }
+  };
+  for(i64 shell = firstShell; shell <= lastShell; shell++)
+  {
+    const i64 xBegin = std::max(center[0] - shell, low[0]);
+    const i64 xEnd = std::min(center[0] + shell, high[0]);
+    const i64 yBegin = std::max(center[1] - shell, low[1]);
+    const i64 yEnd = std::min(center[1] + shell, high[1]);
+    const i64 zBegin = std::max(center[2] - shell, low[2]);
+    const i64 zEnd = std::min(center[2] + shell, high[2]);
+    for(i64 x = xBegin; x <= xEnd; x++)
+    {
+      for(i64 y = yBegin; y <= yEnd; y++)
+      {
+        if(std::abs(x - center[0]) == shell || std::abs(y - center[1]) == shell)
+        {
+          for(i64 z = zBegin; z <= zEnd; z++)
+          {
+            visitCell({x, y, z});
+          }
+          continue;
+        }
+        if(center[2] - shell >= zBegin)
+        {
+          visitCell({x, y, center[2] - shell});
+        }
+        if(shell > 0 && center[2] + shell <= zEnd)
+        {
+          visitCell({x, y, center[2] + shell});
+        }
+      }
+    }
+    // Points in later shells are at least shell cells away
+    const float reach = static_cast<float>(shell) * index.cellSize;
+    if(heap.full() && heap.bound() < reach * reach)
+    {
+      break;
+    }
+  }
+}
+
+void SpatialIndex::FindWithinRadius(const Index& index, const Vec3f& point, float radius, std::vector<Neighbor>& neighbors)
+{
+  neighbors.clear();
+  if(index.points.empty() || !(radius >= 0.0f))
+  {
+    return;
+  }
+  const float radiusSquared = radius * radius;
+
+  if(index.type == Type::KdTree)
+  {
+    struct Entry
+    {
+      usize node;
+      usize first;
+      usize count;
+      usize level;
+    };
+    std::array<Entry, k_StackSize> stack;
+    usize stackSize = 0;
+    stack[stackSize++] = Entry{0, 0, index.points.size(), 0};
+    while(stackSize > 0)
+    {
+      const Entry entry = stack[--stackSize];
+      const Node& node = index.nodes[entry.node];
+      if(BoxDistanceSquared(node.min, node.max, point) > radiusSquared)
+      {
+        continue;
+      }
+      if(entry.level == index.leafLevel)
+      {
+        for(usize i = entry.first; i < entry.first + entry.count; i++)
+        {
+          const float distance = DistanceSquared(index.points[i], point);
+          if(distance <= radiusSquared)
+          {
+            neighbors.push_back(Neighbor{index.ids[i], distance});
+          }
+        }
+        continue;
+      }
+      stack[stackSize++] = Entry{2 * entry.node + 2, entry.first + entry.count / 2, entry.count - entry.count / 2, entry.level + 1};
+      stack[stackSize++] = Entry{2 * entry.node + 1, entry.first, entry.count / 2, entry.level + 1};
+    }
+  }
+  else
+  {
+    // Visit the cells of the search box clipped to the bounds, which also
+    // keeps an infinite radius finite
+    Vec3f searchMin;
+    Vec3f searchMax;
+    for(usize i = 0; i < 3; i++)
+    {
+      searchMin[i] = std::max(point[i] - radius, index.boundsMin[i]);
+      searchMax[i] = std::min(point[i] + radius, index.boundsMax[i]);
+      if(searchMin[i] > searchMax[i])
+      {
+        return;
+      }
+    }
+    const std::array<i64, 3> first = CellOf(index, searchMin);
+    const std::array<i64, 3> last = CellOf(index, searchMax);
+    std::array<i64, 3> cell;
+    for(cell[0] = first[0]; cell[0] <= last[0]; cell[0]++)
+    {
+      for(cell[1] = first[1]; cell[1] <= last[1]; cell[1]++)
+      {
+        for(cell[2] = first[2]; cell[2] <= last[2]; cell[2]++)
+        {
+          const u64 bucket = BucketOf(index, cell);
+          for(usize i = index.bucketOffsets[bucket]; i < index.bucketOffsets[bucket + 1]; i++)
+          {
+            const float distance = DistanceSquared(index.points[i], point);
+            if(distance <= radiusSquared && CellOf(index, index.points[i]) == cell)
+            {
+              neighbors.push_back(Neighbor{index.ids[i], distance});
+            }
+          }
+        }
+      }
+    }
+  }
+
+  // Distances are squared until the results are sorted
+  std::sort(neighbors.begin(), neighbors.end(), [](const Neighbor& a, const Neighbor& b) { return (a.distance < b.distance) || (a.distance == b.distance && a.vertex < b.vertex); });
+  for(Neighbor& neighbor : neighbors)
+  {
+    neighbor.distance = std::sqrt(neighbor.distance);
+  }
+}
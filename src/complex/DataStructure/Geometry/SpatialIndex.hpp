@@ -0,0 +1,229 @@
+#pragma once
+
+#include <array>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "complex/Common/BoundingBox.hpp"
+#include "complex/Common/Point3D.hpp"
+#include "complex/Common/Types.hpp"
+#include "complex/DataStructure/DataArray.hpp"
+#include "complex/DataStructure/DataObject.hpp"
+#include "complex/Utilities/Math/GeometryMath.hpp"
+
+#include "complex/complex_export.hpp"
+
+namespace complex
+{
+/**
+ * @class SpatialIndex
+ * @brief The SpatialIndex class answers nearest neighbor and radius queries
+ * over a point cloud such as the vertices of a VertexGeom. Two layouts are
+ * available:
+ *
+ * - KdTree: a balanced tree split at the median of the widest axis. The
+ *   tree is implicit, the children of node i are 2i + 1 and 2i + 2, and each
+ *   node stores the bounds of its points. The levels are built one after
+ *   the other with the nodes of a level processed in parallel.
+ * - UniformGrid: points are binned into cubic cells of about two points
+ *   each, and the cells are hashed into a table sized to the point count,
+ *   so memory stays linear however sparse the cloud is. The table is filled
+ *   with a parallel counting sort.
+ *
+ * In both layouts the points are copied in query order next to their vertex
+ * ids. update() brings the index up to date after vertices move without a
+ * full rebuild where it can: the tree refits its node bounds, which keeps
+ * queries exact, and is only rebuilt once a quarter of the points moved;
+ * the grid rewrites points that stay in their cell in place.
+ *
+ * Copies share the index until one of them is updated.
+ */
+class COMPLEX_EXPORT SpatialIndex : public DataObject
+{
+public:
+  friend class DataStructure;
+
+  using MeshIndexType = u64;
+
+  static constexpr MeshIndexType k_InvalidIndex = std::numeric_limits<MeshIndexType>::max();
+
+  enum class Type : uint8_t
+  {
+    KdTree = 0,
+    UniformGrid = 1
+  };
+
+  /**
+   * @brief Vertex found by a query. vertex is k_InvalidIndex if fewer
+   * vertices than requested were found.
+   */
+  struct Neighbor
+  {
+    MeshIndexType vertex = k_InvalidIndex;
+    float distance = std::numeric_limits<float>::infinity();
+  };
+
+  /**
+   * @brief Copy constructor. The index is shared with other.
+   * @param other
+   */
+  SpatialIndex(const SpatialIndex& other);
+
+  /**
+   * @brief Move constructor.
+   * @param other
+   */
+  SpatialIndex(SpatialIndex&& other) noexcept;
+
+  ~SpatialIndex() override;
+
+  /**
+   * @brief Returns a copy sharing the index.
+   * @return DataObject*
+   */
+  DataObject* shallowCopy() override;
+
+  /**
+   * @brief Returns a copy. The index is copied on write, so it is shared.
+   * @return DataObject*
+   */
+  DataObject* deepCopy() override;
+
+  /**
+   * @brief Builds the index over the vertices with the specified layout. Runs
+   * in parallel on the shared ThreadPool. Throws if vertices does not hold
+   * three coordinates per tuple.
+   * @param vertices
+   * @param type
+   */
+  void build(const DataArray<float>& vertices, Type type);
+
+  /**
+   * @brief Brings the index up to date with the vertices after some of them
+   * moved, keeping the layout. Rebuilds the index if the vertex count
+   * changed. Returns the number of vertices that moved.
+   * @param vertices
+   * @return usize
+   */
+  usize update(const DataArray<float>& vertices);
+
+  /**
+   * @brief Returns the layout of the index.
+   * @return Type
+   */
+  Type getType() const;
+
+  /**
+   * @brief Returns the number of indexed points.
+   * @return usize
+   */
+  usize getNumberOfPoints() const;
+
+  /**
+   * @brief Returns the bounds of the points. The box is invalid if there are
+   * no points.
+   * @return BoundingBox<float>
+   */
+  BoundingBox<float> getBounds() const;
+
+  /**
+   * @brief Returns the vertex closest to point.
+   * @param point
+   * @return Neighbor
+   */
+  Neighbor findNearestNeighbor(const Point3D<float>& point) const;
+
+  /**
+   * @brief Writes the k vertices closest to point to neighbors, nearest
+   * first. Ties are broken by vertex id. neighbors holds fewer than k values
+   * if the index has fewer points.
+   * @param point
+   * @param k
+   * @param neighbors
+   */
+  void findNearestNeighbors(const Point3D<float>& point, usize k, std::vector<Neighbor>& neighbors) const;
+
+  /**
+   * @brief Writes the k vertices closest to each point to neighbors, nearest
+   * first. The points are processed in parallel. Results for point i start
+   * at neighbors[i * k]; missing neighbors have a vertex of k_InvalidIndex.
+   * @param points
+   * @param k
+   * @param neighbors Holds points.count * k values
+   */
+  void findNearestNeighbors(const GeometryMath::PointArrays<float>& points, usize k, Neighbor* neighbors) const;
+
+  /**
+   * @brief Writes the vertices within radius of point to neighbors, nearest
+   * first.
+   * @param point
+   * @param radius
+   * @param neighbors
+   */
+  void findWithinRadius(const Point3D<float>& point, float radius, std::vector<Neighbor>& neighbors) const;
+
+  /**
+   * @brief Writes the vertices within radius of each point to neighbors,
+   * nearest first. The points are processed in parallel. The results for
+   * point i are neighbors[offsets[i]] up to neighbors[offsets[i + 1]].
+   * @param points
+   * @param radius
+   * @param offsets Resized to points.count + 1
+   * @param neighbors
+   */
+  void findWithinRadius(const GeometryMath::PointArrays<float>& points, float radius, std::vector<usize>& offsets, std::vector<Neighbor>& neighbors) const;
+
+protected:
+  /**
+   * @brief Constructs an empty index.
+   * @param ds
+   * @param name
+   */
+  SpatialIndex(DataStructure* ds, const std::string& name);
+
+private:
+  using Vec3f = GeometryMath::detail::Vec3<float>;
+
+  /**
+   * @brief Bounds of the points of a tree node.
+   */
+  struct Node
+  {
+    Vec3f min;
+    Vec3f max;
+  };
+
+  struct Index
+  {
+    Type type = Type::KdTree;
+    Vec3f boundsMin;
+    Vec3f boundsMax;
+    std::vector<Vec3f> points;
+    std::vector<MeshIndexType> ids;
+    std::vector<MeshIndexType> slots;
+
+    // KdTree: the leaves are the nodes of the last level
+    usize leafLevel = 0;
+    std::vector<Node> nodes;
+
+    // UniformGrid: the points of bucket b are [bucketOffsets[b], bucketOffsets[b + 1])
+    Vec3f gridOrigin;
+    float cellSize = 0.0f;
+    u64 bucketMask = 0;
+    std::vector<usize> bucketOffsets;
+  };
+
+  class NeighborHeap;
+
+  static void BuildKdTree(Index& index, const float* coords);
+  static void BuildGrid(Index& index, const float* coords);
+  static void RefitKdTree(Index& index);
+  static std::array<i64, 3> CellOf(const Index& index, const Vec3f& point);
+  static u64 BucketOf(const Index& index, const std::array<i64, 3>& cell);
+  static void FindNearest(const Index& index, const Vec3f& point, NeighborHeap& heap);
+  static void FindWithinRadius(const Index& index, const Vec3f& point, float radius, std::vector<Neighbor>& neighbors);
+
+  std::shared_ptr<Index> m_Index;
+};
+} // namespace complex
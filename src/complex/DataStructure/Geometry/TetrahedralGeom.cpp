@@ -3,6 +3,7 @@
 #include <stdexcept>
 
 #include "complex/DataStructure/DataStructure.hpp"
+#include "complex/DataStructure/Snapshot/SnapshotArchive.hpp"
 #include "complex/Utilities/GeometryHelpers.hpp"
 
 using namespace complex;
@@ -224,49 +225,54 @@ AbstractGeometry::StatusCode TetrahedralGeom::findElementSizes()
 {
   auto dataStore = new DataStore<float>(1, getNumberOfTets());
   auto tetSizes = getDataStructure()->createDataArray<float>("Tet Volumes", dataStore, getId());
-  GeometryHelpers::Topology::FindTetVolumes(getTetrahedra(), getVertices(), tetSizes);
   if(tetSizes == nullptr)
   {
     m_TetSizesId.reset();
     return -1;
   }
+  GeometryHelpers::Topology::FindTetVolumes(getTetrahedra(), getVertices(), tetSizes);
   m_TetSizesId = tetSizes->getId();
+  recordDerived(m_TetSizesId, getGeometrySources());
   return 1;
 }
 
 const FloatArray* TetrahedralGeom::getElementSizes() const
 {
-  return dynamic_cast<const FloatArray*>(getDataStructure()->getData(m_TetSizesId));
+  return getDerived<FloatArray>(m_TetSizesId, getGeometrySources(), &TetrahedralGeom::findElementSizes);
 }
 
 void TetrahedralGeom::deleteElementSizes()
 {
-  getDataStructure()->removeData(m_TetSizesId);
-  m_TetSizesId.reset();
+  deleteDerived(m_TetSizesId);
 }
 
 AbstractGeometry::StatusCode TetrahedralGeom::findElementsContainingVert()
 {
   auto tetsContainingVert = getDataStructure()->createDynamicList<uint16_t, MeshIndexType>("Elements Containing Vert", getId());
-  GeometryHelpers::Connectivity::FindElementsContainingVert<uint16_t, MeshIndexType>(getTetrahedra(), tetsContainingVert, getNumberOfVertices());
   if(tetsContainingVert == nullptr)
   {
     m_TetsContainingVertId.reset();
     return -1;
   }
+  if(GeometryHelpers::Connectivity::FindElementsContainingVert<uint16_t, MeshIndexType>(getTetrahedra(), tetsContainingVert, getNumberOfVertices()) < 0)
+  {
+    getDataStructure()->removeData(tetsContainingVert->getId());
+    m_TetsContainingVertId.reset();
+    return -1;
+  }
   m_TetsContainingVertId = tetsContainingVert->getId();
+  recordDerived(m_TetsContainingVertId, getConnectivitySources());
   return 1;
 }
 
 const AbstractGeometry::ElementDynamicList* TetrahedralGeom::getElementsContainingVert() const
 {
-  return dynamic_cast<const ElementDynamicList*>(getDataStructure()->getData(m_TetsContainingVertId));
+  return getDerived<ElementDynamicList>(m_TetsContainingVertId, getConnectivitySources(), &TetrahedralGeom::findElementsContainingVert);
 }
 
 void TetrahedralGeom::deleteElementsContainingVert()
 {
-  getDataStructure()->removeData(m_TetsContainingVertId);
-  m_TetsContainingVertId.reset();
+  deleteDerived(m_TetsContainingVertId);
 }
 
 AbstractGeometry::StatusCode TetrahedralGeom::findElementNeighbors()
@@ -288,43 +294,43 @@ AbstractGeometry::StatusCode TetrahedralGeom::findElementNeighbors()
     return -1;
   }
   m_TetNeighborsId = tetNeighbors->getId();
+  recordDerived(m_TetNeighborsId, getConnectivitySources());
   return err;
 }
 
 const AbstractGeometry::ElementDynamicList* TetrahedralGeom::getElementNeighbors() const
 {
-  return dynamic_cast<const ElementDynamicList*>(getDataStructure()->getData(m_TetNeighborsId));
+  return getDerived<ElementDynamicList>(m_TetNeighborsId, getConnectivitySources(), &TetrahedralGeom::findElementNeighbors);
 }
 
 void TetrahedralGeom::deleteElementNeighbors()
 {
-  getDataStructure()->removeData(m_TetNeighborsId);
-  m_TetNeighborsId.reset();
+  deleteDerived(m_TetNeighborsId);
 }
 
 AbstractGeometry::StatusCode TetrahedralGeom::findElementCentroids()
 {
   auto dataStore = new DataStore<float>(3, getNumberOfTets());
   auto tetCentroids = getDataStructure()->createDataArray<float>("Tet Centroids", dataStore, getId());
-  GeometryHelpers::Topology::FindElementCentroids(getTetrahedra(), getVertices(), tetCentroids);
   if(tetCentroids == nullptr)
   {
     m_TetCentroidsId.reset();
     return -1;
   }
+  GeometryHelpers::Topology::FindElementCentroids(getTetrahedra(), getVertices(), tetCentroids);
   m_TetCentroidsId = tetCentroids->getId();
+  recordDerived(m_TetCentroidsId, getGeometrySources());
   return 1;
 }
 
 const FloatArray* TetrahedralGeom::getElementCentroids() const
 {
-  return dynamic_cast<const FloatArray*>(getDataStructure()->getData(m_TetCentroidsId));
+  return getDerived<FloatArray>(m_TetCentroidsId, getGeometrySources(), &TetrahedralGeom::findElementCentroids);
 }
 
 void TetrahedralGeom::deleteElementCentroids()
 {
-  getDataStructure()->removeData(m_TetCentroidsId);
-  m_TetCentroidsId.reset();
+  deleteDerived(m_TetCentroidsId);
 }
 
 complex::Point3D<double> TetrahedralGeom::getParametricCenter() const
@@ -376,12 +382,17 @@ complex::TooltipGenerator TetrahedralGeom::getTooltipGenerator() const
 AbstractGeometry::StatusCode TetrahedralGeom::findEdges()
 {
   auto edgeList = createSharedEdgeList(0);
-  GeometryHelpers::Connectivity::FindTetEdges(getTetrahedra(), edgeList);
   if(edgeList == nullptr)
   {
     setEdges(nullptr);
     return -1;
   }
+  if(GeometryHelpers::Connectivity::FindTetEdges(getTetrahedra(), edgeList) < 0)
+  {
+    getDataStructure()->removeData(edgeList->getId());
+    setEdges(nullptr);
+    return -1;
+  }
   setEdges(edgeList);
   return 1;
 }
@@ -389,12 +400,17 @@ AbstractGeometry::StatusCode TetrahedralGeom::findEdges()
 AbstractGeometry::StatusCode TetrahedralGeom::findFaces()
 {
   auto triList = createSharedTriList(0);
-  GeometryHelpers::Connectivity::FindTetFaces(getTetrahedra(), triList);
   if(triList == nullptr)
   {
     m_TriListId.reset();
     return -1;
   }
+  if(GeometryHelpers::Connectivity::FindTetFaces(getTetrahedra(), triList) < 0)
+  {
+    getDataStructure()->removeData(triList->getId());
+    m_TriListId.reset();
+    return -1;
+  }
   m_TriListId = triList->getId();
   return 1;
 }
@@ -403,12 +419,17 @@ AbstractGeometry::StatusCode TetrahedralGeom::findUnsharedEdges()
 {
   auto dataStore = new DataStore<MeshIndexType>(2, 0);
   auto unsharedEdgeList = getDataStructure()->createDataArray<MeshIndexType>("Unshared Edge List", dataStore, getId());
-  GeometryHelpers::Connectivity::FindUnsharedTetEdges(getTetrahedra(), unsharedEdgeList);
   if(unsharedEdgeList == nullptr)
   {
     setUnsharedEdges(nullptr);
     return -1;
   }
+  if(GeometryHelpers::Connectivity::FindUnsharedTetEdges(getTetrahedra(), unsharedEdgeList) < 0)
+  {
+    getDataStructure()->removeData(unsharedEdgeList->getId());
+    setUnsharedEdges(nullptr);
+    return -1;
+  }
   setUnsharedEdges(unsharedEdgeList);
   return 1;
 }
@@ -417,12 +438,17 @@ AbstractGeometry::StatusCode TetrahedralGeom::findUnsharedFaces()
 {
   auto dataStore = new DataStore<MeshIndexType>(3, 0);
   auto unsharedTriList = getDataStructure()->createDataArray<MeshIndexType>("Unshared Face List", dataStore, getId());
-  GeometryHelpers::Connectivity::FindUnsharedTetFaces(getTetrahedra(), unsharedTriList);
   if(unsharedTriList == nullptr)
   {
     m_UnsharedTriListId.reset();
     return -1;
   }
+  if(GeometryHelpers::Connectivity::FindUnsharedTetFaces(getTetrahedra(), unsharedTriList) < 0)
+  {
+    getDataStructure()->removeData(unsharedTriList->getId());
+    m_UnsharedTriListId.reset();
+    return -1;
+  }
   m_UnsharedTriListId = unsharedTriList->getId();
   return 1;
 }
@@ -442,6 +468,16 @@ uint32_t TetrahedralGeom::getXdmfGridType() const
   throw std::runtime_error("");
 }
 
+AbstractGeometry::SourceVersions TetrahedralGeom::getGeometrySources() const
+{
+  return {ValuesVersion(getVertices()), ValuesVersion(getTetrahedra())};
+}
+
+AbstractGeometry::SourceVersions TetrahedralGeom::getConnectivitySources() const
+{
+  return {TupleCountVersion(getVertices()), ValuesVersion(getTetrahedra())};
+}
+
 void TetrahedralGeom::setElementsContainingVert(const ElementDynamicList* elementsContainingVert)
 {
   if(!elementsContainingVert)
@@ -471,3 +507,11 @@ void TetrahedralGeom::setElementCentroids(const FloatArray* elementCentroids)
   }
   m_TetCentroidsId = elementCentroids->getId();
 }
+
+void TetrahedralGeom::serializeSnapshot(SnapshotArchive& archive)
+{
+  AbstractGeometry3D::serializeSnapshot(archive);
+  archive.reference(m_TriListId);
+  archive.reference(m_UnsharedTriListId);
+  archive.reference(m_TetListId);
+}
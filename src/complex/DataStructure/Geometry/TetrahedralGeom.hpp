@@ -287,6 +287,12 @@ public:
    */
   uint32_t getXdmfGridType() const override;
 
+  /**
+   * @brief Writes or reads the triangle and tetrahedron lists.
+   * @param archive
+   */
+  void serializeSnapshot(SnapshotArchive& archive) override;
+
 protected:
   /**
    * @brief
@@ -332,6 +338,20 @@ protected:
    */
   void setElementCentroids(const FloatArray* elementCentroids) override;
 
+  /**
+   * @brief Returns the vertex and element lists the element sizes and
+   * centroids are computed from.
+   * @return SourceVersions
+   */
+  SourceVersions getGeometrySources() const override;
+
+  /**
+   * @brief Returns the element list and the number of vertices the
+   * connectivity is computed from.
+   * @return SourceVersions
+   */
+  SourceVersions getConnectivitySources() const override;
+
 private:
   std::optional<DataObject::IdType> m_TriListId;
   std::optional<DataObject::IdType> m_UnsharedTriListId;
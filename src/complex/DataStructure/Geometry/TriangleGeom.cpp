@@ -3,6 +3,7 @@
 #include <stdexcept>
 
 #include "complex/DataStructure/DataStructure.hpp"
+#include "complex/DataStructure/Snapshot/SnapshotArchive.hpp"
 #include "complex/DataStructure/DynamicListArray.hpp"
 #include "complex/Utilities/GeometryHelpers.hpp"
 
@@ -30,6 +31,7 @@ TriangleGeom::TriangleGeom(const TriangleGeom& other)
 , m_TriangleNeighborsId(other.m_TriangleNeighborsId)
 , m_TriangleCentroidsId(other.m_TriangleCentroidsId)
 , m_TriangleSizesId(other.m_TriangleSizesId)
+, m_BoundingVolumeHierarchyId(other.m_BoundingVolumeHierarchyId)
 {
 }
 
@@ -40,6 +42,7 @@ TriangleGeom::TriangleGeom(TriangleGeom&& other) noexcept
 , m_TriangleNeighborsId(std::move(other.m_TriangleNeighborsId))
 , m_TriangleCentroidsId(std::move(other.m_TriangleCentroidsId))
 , m_TriangleSizesId(std::move(other.m_TriangleSizesId))
+, m_BoundingVolumeHierarchyId(std::move(other.m_BoundingVolumeHierarchyId))
 {
 }
 
@@ -153,49 +156,54 @@ AbstractGeometry::StatusCode TriangleGeom::findElementSizes()
 {
   auto dataStore = new DataStore<float>(1, getNumberOfTris());
   auto triangleSizes = getDataStructure()->createDataArray<float>("Triangle Areas", dataStore, getId());
-  GeometryHelpers::Topology::Find2DElementAreas(getTriangles(), getVertices(), triangleSizes);
   if(triangleSizes == nullptr)
   {
     m_TriangleSizesId.reset();
     return -1;
   }
+  GeometryHelpers::Topology::Find2DElementAreas(getTriangles(), getVertices(), triangleSizes);
   m_TriangleSizesId = triangleSizes->getId();
+  recordDerived(m_TriangleSizesId, getGeometrySources());
   return 1;
 }
 
 const FloatArray* TriangleGeom::getElementSizes() const
 {
-  return dynamic_cast<const FloatArray*>(getDataStructure()->getData(m_TriangleSizesId));
+  return getDerived<FloatArray>(m_TriangleSizesId, getGeometrySources(), &TriangleGeom::findElementSizes);
 }
 
 void TriangleGeom::deleteElementSizes()
 {
-  getDataStructure()->removeData(m_TriangleSizesId);
-  m_TriangleSizesId.reset();
+  deleteDerived(m_TriangleSizesId);
 }
 
 AbstractGeometry::StatusCode TriangleGeom::findElementsContainingVert()
 {
   auto trianglesContainingVert = getDataStructure()->createDynamicList<uint16_t, MeshIndexType>("Triangles Containing Vert", getId());
-  GeometryHelpers::Connectivity::FindElementsContainingVert<uint16_t, MeshIndexType>(getTriangles(), trianglesContainingVert, getNumberOfVertices());
   if(trianglesContainingVert == nullptr)
   {
     m_TrianglesContainingVertId.reset();
     return -1;
   }
+  if(GeometryHelpers::Connectivity::FindElementsContainingVert<uint16_t, MeshIndexType>(getTriangles(), trianglesContainingVert, getNumberOfVertices()) < 0)
+  {
+    getDataStructure()->removeData(trianglesContainingVert->getId());
+    m_TrianglesContainingVertId.reset();
+    return -1;
+  }
   m_TrianglesContainingVertId = trianglesContainingVert->getId();
+  recordDerived(m_TrianglesContainingVertId, getConnectivitySources());
   return 1;
 }
 
 const AbstractGeometry::ElementDynamicList* TriangleGeom::getElementsContainingVert() const
 {
-  return dynamic_cast<const ElementDynamicList*>(getDataStructure()->getData(m_TrianglesContainingVertId));
+  return getDerived<ElementDynamicList>(m_TrianglesContainingVertId, getConnectivitySources(), &TriangleGeom::findElementsContainingVert);
 }
 
 void TriangleGeom::deleteElementsContainingVert()
 {
-  getDataStructure()->removeData(m_TrianglesContainingVertId);
-  m_TrianglesContainingVertId.reset();
+  deleteDerived(m_TrianglesContainingVertId);
 }
 
 AbstractGeometry::StatusCode TriangleGeom::findElementNeighbors()
@@ -217,43 +225,43 @@ AbstractGeometry::StatusCode TriangleGeom::findElementNeighbors()
     return -1;
   }
   m_TriangleNeighborsId = triangleNeighbors->getId();
+  recordDerived(m_TriangleNeighborsId, getConnectivitySources());
   return err;
 }
 
 const AbstractGeometry::ElementDynamicList* TriangleGeom::getElementNeighbors() const
 {
-  return dynamic_cast<const ElementDynamicList*>(getDataStructure()->getData(m_TriangleNeighborsId));
+  return getDerived<ElementDynamicList>(m_TriangleNeighborsId, getConnectivitySources(), &TriangleGeom::findElementNeighbors);
 }
 
 void TriangleGeom::deleteElementNeighbors()
 {
-  getDataStructure()->removeData(m_TriangleNeighborsId);
-  m_TriangleNeighborsId.reset();
+  deleteDerived(m_TriangleNeighborsId);
 }
 
 AbstractGeometry::StatusCode TriangleGeom::findElementCentroids()
 {
   auto dataStore = new DataStore<float>(3, getNumberOfTris());
   auto triangleCentroids = getDataStructure()->createDataArray<float>("Triangle Centroids", dataStore, getId());
-  GeometryHelpers::Topology::FindElementCentroids(getTriangles(), getVertices(), triangleCentroids);
   if(triangleCentroids == nullptr)
   {
     m_TriangleCentroidsId.reset();
     return -1;
   }
+  GeometryHelpers::Topology::FindElementCentroids(getTriangles(), getVertices(), triangleCentroids);
   m_TriangleCentroidsId = triangleCentroids->getId();
+  recordDerived(m_TriangleCentroidsId, getGeometrySources());
   return 1;
 }
 
 const FloatArray* TriangleGeom::getElementCentroids() const
 {
-  return dynamic_cast<const FloatArray*>(getDataStructure()->getData(m_TriangleCentroidsId));
+  return getDerived<FloatArray>(m_TriangleCentroidsId, getGeometrySources(), &TriangleGeom::findElementCentroids);
 }
 
 void TriangleGeom::deleteElementCentroids()
 {
-  getDataStructure()->removeData(m_TriangleCentroidsId);
-  m_TriangleCentroidsId.reset();
+  deleteDerived(m_TriangleCentroidsId);
 }
 
 complex::Point3D<double> TriangleGeom::getParametricCenter() const
@@ -337,12 +345,21 @@ AbstractGeometry::StatusCode TriangleGeom::findEdges()
 {
   auto dataStore = new DataStore<uint64_t>(2, 0);
   auto edgeList = getDataStructure()->createDataArray<uint64_t>("Edge List", dataStore, getId());
-  GeometryHelpers::Connectivity::Find2DElementEdges(getTriangles(), edgeList);
   if(edgeList == nullptr)
   {
     setEdges(nullptr);
     return -1;
   }
+  if(hasHalfEdgeTopology())
+  {
+    getHalfEdgeTopology()->copyEdges(*edgeList, false);
+  }
+  else if(GeometryHelpers::Connectivity::Find2DElementEdges(getTriangles(), edgeList) < 0)
+  {
+    getDataStructure()->removeData(edgeList->getId());
+    setEdges(nullptr);
+    return -1;
+  }
   setEdges(edgeList);
   return 1;
 }
@@ -372,21 +389,98 @@ AbstractGeometry::StatusCode TriangleGeom::findUnsharedEdges()
 {
   auto dataStore = new DataStore<MeshIndexType>(2, 0);
   auto unsharedEdgeList = getDataStructure()->createDataArray("Unshared Edge List", dataStore, getId());
-  GeometryHelpers::Connectivity::Find2DUnsharedEdges(getTriangles(), unsharedEdgeList);
   if(unsharedEdgeList == nullptr)
   {
     setUnsharedEdges(nullptr);
     return -1;
   }
+  if(hasHalfEdgeTopology())
+  {
+    getHalfEdgeTopology()->copyEdges(*unsharedEdgeList, true);
+  }
+  else if(GeometryHelpers::Connectivity::Find2DUnsharedEdges(getTriangles(), unsharedEdgeList) < 0)
+  {
+    getDataStructure()->removeData(unsharedEdgeList->getId());
+    setUnsharedEdges(nullptr);
+    return -1;
+  }
   setUnsharedEdges(unsharedEdgeList);
   return 1;
 }
 
+AbstractGeometry::StatusCode TriangleGeom::findHalfEdgeTopology()
+{
+  const SharedTriList* faces = getTriangles();
+  if(faces == nullptr)
+  {
+    return -1;
+  }
+  deleteHalfEdgeTopology();
+  auto topology = getDataStructure()->createHalfEdgeTopology("Half-Edge Topology", getId());
+  if(topology == nullptr)
+  {
+    setHalfEdgeTopology(nullptr);
+    return -1;
+  }
+  try
+  {
+    topology->build(*faces, getNumberOfVertices());
+  } catch(const std::exception&)
+  {
+    getDataStructure()->removeData(topology->getId());
+    setHalfEdgeTopology(nullptr);
+    return -1;
+  }
+  setHalfEdgeTopology(topology);
+  recordDerived(topology->getId(), getConnectivitySources());
+  return 1;
+}
+
+AbstractGeometry::StatusCode TriangleGeom::findBoundingVolumeHierarchy()
+{
+  const SharedTriList* triangles = getTriangles();
+  const SharedVertexList* vertices = getVertices();
+  if(triangles == nullptr || vertices == nullptr)
+  {
+    return -1;
+  }
+  deleteBoundingVolumeHierarchy();
+  auto hierarchy = getDataStructure()->createBoundingVolumeHierarchy("Bounding Volume Hierarchy", getId());
+  if(hierarchy == nullptr)
+  {
+    return -1;
+  }
+  hierarchy->build(*triangles, *vertices);
+  m_BoundingVolumeHierarchyId = hierarchy->getId();
+  recordDerived(m_BoundingVolumeHierarchyId, getGeometrySources());
+  return 1;
+}
+
+const BoundingVolumeHierarchy* TriangleGeom::getBoundingVolumeHierarchy() const
+{
+  return getDerived<BoundingVolumeHierarchy>(m_BoundingVolumeHierarchyId, getGeometrySources(), &TriangleGeom::findBoundingVolumeHierarchy);
+}
+
+void TriangleGeom::deleteBoundingVolumeHierarchy()
+{
+  deleteDerived(m_BoundingVolumeHierarchyId);
+}
+
 uint32_t TriangleGeom::getXdmfGridType() const
 {
   throw std::runtime_error("");
 }
 
+AbstractGeometry::SourceVersions TriangleGeom::getGeometrySources() const
+{
+  return {ValuesVersion(getVertices()), ValuesVersion(getTriangles())};
+}
+
+AbstractGeometry::SourceVersions TriangleGeom::getConnectivitySources() const
+{
+  return {TupleCountVersion(getVertices()), ValuesVersion(getTriangles())};
+}
+
 void TriangleGeom::setElementsContainingVert(const ElementDynamicList* elementsContainingVert)
 {
   if(!elementsContainingVert)
@@ -426,3 +520,9 @@ void TriangleGeom::setElementSizes(const FloatArray* elementSizes)
   }
   m_TriangleSizesId = elementSizes->getId();
 }
+
+void TriangleGeom::serializeSnapshot(SnapshotArchive& archive)
+{
+  AbstractGeometry2D::serializeSnapshot(archive);
+  archive.reference(m_TriListId);
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "complex/DataStructure/Geometry/AbstractGeometry2D.hpp"
+#include "complex/DataStructure/Geometry/BoundingVolumeHierarchy.hpp"
 #include "complex/Utilities/TooltipGenerator.hpp"
 
 #include "complex/complex_export.hpp"
@@ -253,12 +254,43 @@ public:
    */
   StatusCode findUnsharedEdges() override;
 
+  /**
+   * @brief
+   * @return StatusCode
+   */
+  StatusCode findHalfEdgeTopology() override;
+
+  /**
+   * @brief Builds a BoundingVolumeHierarchy over the triangles and stores it
+   * as a child of the geometry.
+   * @return StatusCode
+   */
+  StatusCode findBoundingVolumeHierarchy();
+
+  /**
+   * @brief Returns the BoundingVolumeHierarchy over the triangles. It is
+   * built on first use and rebuilt after the vertices or triangles change.
+   * @return const BoundingVolumeHierarchy*
+   */
+  const BoundingVolumeHierarchy* getBoundingVolumeHierarchy() const;
+
+  /**
+   * @brief Removes the BoundingVolumeHierarchy from the DataStructure.
+   */
+  void deleteBoundingVolumeHierarchy();
+
   /**
    * @brief
    * @return uint32_t
    */
   uint32_t getXdmfGridType() const override;
 
+  /**
+   * @brief Writes or reads the triangle list.
+   * @param archive
+   */
+  void serializeSnapshot(SnapshotArchive& archive) override;
+
 protected:
   /**
    * @brief
@@ -310,11 +342,26 @@ protected:
    */
   void setElementSizes(const FloatArray* elementSizes) override;
 
+  /**
+   * @brief Returns the vertex and element lists the element sizes and
+   * centroids are computed from.
+   * @return SourceVersions
+   */
+  SourceVersions getGeometrySources() const override;
+
+  /**
+   * @brief Returns the element list and the number of vertices the
+   * connectivity is computed from.
+   * @return SourceVersions
+   */
+  SourceVersions getConnectivitySources() const override;
+
 private:
   std::optional<DataObject::IdType> m_TriListId;
   std::optional<DataObject::IdType> m_TrianglesContainingVertId;
   std::optional<DataObject::IdType> m_TriangleNeighborsId;
   std::optional<DataObject::IdType> m_TriangleCentroidsId;
   std::optional<DataObject::IdType> m_TriangleSizesId;
+  std::optional<DataObject::IdType> m_BoundingVolumeHierarchyId;
 };
 } // namespace complex
@@ -3,6 +3,7 @@
 #include <stdexcept>
 
 #include "complex/DataStructure/DataStructure.hpp"
+#include "complex/DataStructure/Snapshot/SnapshotArchive.hpp"
 #include "complex/Utilities/GeometryHelpers.hpp"
 
 using namespace complex;
@@ -26,6 +27,8 @@ VertexGeom::VertexGeom(const VertexGeom& other)
 : AbstractGeometry(other)
 , m_VertexListId(other.m_VertexListId)
 , m_VertexSizesId(other.m_VertexSizesId)
+, m_SpatialIndexId(other.m_SpatialIndexId)
+, m_SpatialIndexType(other.m_SpatialIndexType)
 {
 }
 
@@ -33,6 +36,8 @@ VertexGeom::VertexGeom(VertexGeom&& other) noexcept
 : AbstractGeometry(std::move(other))
 , m_VertexListId(std::move(other.m_VertexListId))
 , m_VertexSizesId(std::move(other.m_VertexSizesId))
+, m_SpatialIndexId(std::move(other.m_SpatialIndexId))
+, m_SpatialIndexType(other.m_SpatialIndexType)
 {
 }
 
@@ -136,18 +141,18 @@ AbstractGeometry::StatusCode VertexGeom::findElementSizes()
 
   auto vertexSizes = getDataStructure()->createDataArray<float>("Voxel Sizes", dataStore, getId());
   m_VertexSizesId = vertexSizes->getId();
+  recordDerived(m_VertexSizesId, getGeometrySources());
   return 1;
 }
 
 const FloatArray* VertexGeom::getElementSizes() const
 {
-  return dynamic_cast<const FloatArray*>(getDataStructure()->getData(m_VertexSizesId));
+  return getDerived<FloatArray>(m_VertexSizesId, getGeometrySources(), &VertexGeom::findElementSizes);
 }
 
 void VertexGeom::deleteElementSizes()
 {
-  getDataStructure()->removeData(m_VertexSizesId);
-  m_VertexSizesId.reset();
+  deleteDerived(m_VertexSizesId);
 }
 
 AbstractGeometry::StatusCode VertexGeom::findElementsContainingVert()
@@ -192,6 +197,78 @@ void VertexGeom::deleteElementCentroids()
 {
 }
 
+void VertexGeom::setSpatialIndexType(SpatialIndex::Type type)
+{
+  if(type != m_SpatialIndexType)
+  {
+    deleteSpatialIndex();
+  }
+  m_SpatialIndexType = type;
+}
+
+SpatialIndex::Type VertexGeom::getSpatialIndexType() const
+{
+  return m_SpatialIndexType;
+}
+
+AbstractGeometry::StatusCode VertexGeom::findSpatialIndex()
+{
+  const SharedVertexList* vertices = getVertices();
+  if(vertices == nullptr)
+  {
+    return -1;
+  }
+  const SourceVersions sources = {ValuesVersion(vertices)};
+  auto index = dynamic_cast<SpatialIndex*>(getDataStructure()->getData(m_SpatialIndexId));
+  if(index != nullptr && index->getType() == m_SpatialIndexType)
+  {
+    index->update(*vertices);
+    recordDerived(m_SpatialIndexId, sources);
+    return 1;
+  }
+  deleteSpatialIndex();
+  index = getDataStructure()->createSpatialIndex("Spatial Index", getId());
+  if(index == nullptr)
+  {
+    return -1;
+  }
+  index->build(*vertices, m_SpatialIndexType);
+  m_SpatialIndexId = index->getId();
+  recordDerived(m_SpatialIndexId, sources);
+  return 1;
+}
+
+const SpatialIndex* VertexGeom::getSpatialIndex() const
+{
+  // Not getDerived(), which would discard a stale index instead of updating it
+  const SharedVertexList* vertices = getVertices();
+  if(vertices == nullptr)
+  {
+    return nullptr;
+  }
+  const SourceVersions sources = {ValuesVersion(vertices)};
+  {
+    auto lock = lockHierarchyShared();
+    if(isDerivedCurrent(m_SpatialIndexId, sources))
+    {
+      return dynamic_cast<const SpatialIndex*>(getDataStructure()->getData(m_SpatialIndexId));
+    }
+  }
+
+  // Another thread may have updated the index while this one waited
+  auto lock = lockHierarchy();
+  if(!isDerivedCurrent(m_SpatialIndexId, sources) && const_cast<VertexGeom*>(this)->findSpatialIndex() < 0)
+  {
+    return nullptr;
+  }
+  return dynamic_cast<const SpatialIndex*>(getDataStructure()->getData(m_SpatialIndexId));
+}
+
+void VertexGeom::deleteSpatialIndex()
+{
+  deleteDerived(m_SpatialIndexId);
+}
+
 complex::Point3D<double> VertexGeom::getParametricCenter() const
 {
   return {0.0, 0.0, 0.0};
@@ -239,6 +316,11 @@ uint32_t VertexGeom::getXdmfGridType() const
   throw std::runtime_error("");
 }
 
+AbstractGeometry::SourceVersions VertexGeom::getGeometrySources() const
+{
+  return {TupleCountVersion(getVertices())};
+}
+
 void VertexGeom::setElementsContainingVert(const ElementDynamicList* elementsContainingVert)
 {
 }
@@ -260,3 +342,10 @@ void VertexGeom::setElementSizes(const FloatArray* elementSizes)
   }
   m_VertexSizesId = elementSizes->getId();
 }
+
+void VertexGeom::serializeSnapshot(SnapshotArchive& archive)
+{
+  AbstractGeometry::serializeSnapshot(archive);
+  archive.reference(m_VertexListId);
+  archive.value(m_SpatialIndexType);
+}
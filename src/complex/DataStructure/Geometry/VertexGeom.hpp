@@ -1,6 +1,7 @@
 #pragma once
 
 #include "complex/DataStructure/Geometry/AbstractGeometry.hpp"
+#include "complex/DataStructure/Geometry/SpatialIndex.hpp"
 #include "complex/Utilities/TooltipGenerator.hpp"
 
 #include "complex/complex_export.hpp"
@@ -170,6 +171,43 @@ public:
    */
   void deleteElementCentroids() override;
 
+  /**
+   * @brief Sets the layout used by the SpatialIndex over the vertices. An
+   * index with another layout is removed.
+   * @param type
+   */
+  void setSpatialIndexType(SpatialIndex::Type type);
+
+  /**
+   * @brief Returns the layout used by the SpatialIndex over the vertices.
+   * @return SpatialIndex::Type
+   */
+  SpatialIndex::Type getSpatialIndexType() const;
+
+  /**
+   * @brief Brings the SpatialIndex over the vertices up to date, building it
+   * as a child of the geometry if there is none yet. An existing index is
+   * updated in place for the vertices that moved.
+   * @return StatusCode
+   */
+  StatusCode findSpatialIndex();
+
+  /**
+   * @brief Returns the SpatialIndex over the vertices. It is built on first
+   * use and updated after the vertices change. Checking and updating the
+   * index hold the DataStructure's hierarchy lock, so concurrent callers
+   * update it once and receive the same index. An index obtained before the
+   * vertices changed is updated in place and must not be queried while this
+   * is called again.
+   * @return const SpatialIndex*
+   */
+  const SpatialIndex* getSpatialIndex() const;
+
+  /**
+   * @brief Removes the SpatialIndex from the DataStructure.
+   */
+  void deleteSpatialIndex();
+
   /**
    * @brief
    * @return complex::Point3D<double>
@@ -210,6 +248,12 @@ public:
    */
   uint32_t getXdmfGridType() const override;
 
+  /**
+   * @brief Writes or reads the vertex list and spatial index type.
+   * @param archive
+   */
+  void serializeSnapshot(SnapshotArchive& archive) override;
+
 protected:
   /**
    * @brief
@@ -259,8 +303,16 @@ protected:
    */
   void setElementSizes(const FloatArray* elementSizes) override;
 
+  /**
+   * @brief Returns the vertex list the element sizes are sized from.
+   * @return SourceVersions
+   */
+  SourceVersions getGeometrySources() const override;
+
 private:
   std::optional<DataObject::IdType> m_VertexListId;
   std::optional<DataObject::IdType> m_VertexSizesId;
+  std::optional<DataObject::IdType> m_SpatialIndexId;
+  SpatialIndex::Type m_SpatialIndexType = SpatialIndex::Type::KdTree;
 };
 } // namespace complex
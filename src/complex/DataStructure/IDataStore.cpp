@@ -0,0 +1,10 @@
+#include "IDataStore.hpp"
+
+namespace complex::detail
+{
+uint64_t NextDataStoreVersion()
+{
+  static std::atomic<uint64_t> s_Version = 0;
+  return s_Version.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+} // namespace complex::detail
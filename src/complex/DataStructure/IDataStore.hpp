@@ -1,10 +1,26 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <iterator>
 
+#include "complex/Common/Span.hpp"
+
+#include "complex/complex_export.hpp"
+
 namespace complex
 {
+namespace detail
+{
+/**
+ * @brief Returns a new DataStore version. Versions increase monotonically and
+ * are never handed out twice, regardless of the value type of the store.
+ * @return uint64_t
+ */
+COMPLEX_EXPORT uint64_t NextDataStoreVersion();
+} // namespace detail
+
 template <typename T>
 class IDataStore
 {
@@ -12,6 +28,8 @@ public:
   using value_type = T;
   using reference = T&;
   using const_reference = const T&;
+  using pointer = T*;
+  using const_pointer = const T*;
 
   /////////////////////////////////
   // Begin std::iterator support //
@@ -26,26 +44,25 @@ public:
     using reference = T&;
 
     Iterator(IDataStore& dataStore, size_t index)
-    : m_DataStore(dataStore)
+    : m_DataStore(&dataStore)
+    , m_Data(dataStore.data())
     , m_Index(index)
     {
     }
-    Iterator(const Iterator& other)
-    : m_DataStore(other.m_DataStore)
-    , m_Index(other.m_Index)
-    {
-    }
+    Iterator(const Iterator& other) = default;
     virtual ~Iterator() = default;
 
-    Iterator& operator+(size_t offset)
+    Iterator operator+(size_t offset) const
     {
-      m_Index += offset;
-      return *this;
+      Iterator iter(*this);
+      iter.m_Index += offset;
+      return iter;
     }
-    Iterator& operator-(size_t offset)
+    Iterator operator-(size_t offset) const
     {
-      m_Index -= offset;
-      return *this;
+      Iterator iter(*this);
+      iter.m_Index -= offset;
+      return iter;
     }
     Iterator& operator+=(size_t offset)
     {
@@ -62,43 +79,59 @@ public:
       m_Index++;
       return *this;
     }
-    Iterator& operator++(int)
+    Iterator operator++(int)
     {
+      Iterator iter(*this);
       m_Index++;
-      return *this;
+      return iter;
     }
     Iterator& operator--()
     {
       m_Index--;
       return *this;
     }
-    Iterator& operator--(int)
+    Iterator operator--(int)
     {
+      Iterator iter(*this);
       m_Index--;
-      return *this;
+      return iter;
     }
     difference_type operator-(const Iterator& rhs) const
     {
-      return m_Index - rhs.m_Index;
+      return static_cast<difference_type>(m_Index) - static_cast<difference_type>(rhs.m_Index);
     }
 
+    /**
+     * @brief Dereferences the iterator. Contiguous stores are read through the
+     * cached data pointer so that no virtual call is made per element.
+     * @return reference
+     */
     reference operator*() const
     {
-      return m_DataStore[m_Index];
+      if(m_Data != nullptr)
+      {
+        return m_Data[m_Index];
+      }
+      return (*m_DataStore)[m_Index];
     }
 
-    Iterator& operator=(const Iterator& rhs)
+    reference operator[](difference_type offset) const
     {
-      m_Index = rhs.m_Index;
-      return *this;
+      if(m_Data != nullptr)
+      {
+        return m_Data[m_Index + offset];
+      }
+      return (*m_DataStore)[m_Index + offset];
     }
+
+    Iterator& operator=(const Iterator& rhs) = default;
     bool operator==(const Iterator& rhs) const
     {
-      return (&m_DataStore == &rhs.m_DataStore) && (m_Index == rhs.m_Index);
+      return (m_DataStore == rhs.m_DataStore) && (m_Index == rhs.m_Index);
     }
     bool operator!=(const Iterator& rhs) const
     {
-      return (&m_DataStore != &rhs.m_DataStore) || (m_Index != rhs.m_Index);
+      return (m_DataStore != rhs.m_DataStore) || (m_Index != rhs.m_Index);
     }
 
     bool operator<(const Iterator& rhs) const
@@ -119,7 +152,8 @@ public:
     }
 
   private:
-    IDataStore& m_DataStore;
+    IDataStore* m_DataStore = nullptr;
+    pointer m_Data = nullptr;
     size_t m_Index = 0;
   };
   class ConstIterator
@@ -132,26 +166,25 @@ public:
     using reference = const T&;
 
     ConstIterator(const IDataStore& dataStore, size_t index)
-    : m_DataStore(dataStore)
+    : m_DataStore(&dataStore)
+    , m_Data(dataStore.data())
     , m_Index(index)
     {
     }
-    ConstIterator(const ConstIterator& other)
-    : m_DataStore(other.m_DataStore)
-    , m_Index(other.m_Index)
-    {
-    }
+    ConstIterator(const ConstIterator& other) = default;
     virtual ~ConstIterator() = default;
 
-    ConstIterator& operator+(size_t offset)
+    ConstIterator operator+(size_t offset) const
     {
-      m_Index += offset;
-      return *this;
+      ConstIterator iter(*this);
+      iter.m_Index += offset;
+      return iter;
     }
-    ConstIterator& operator-(size_t offset)
+    ConstIterator operator-(size_t offset) const
     {
-      m_Index -= offset;
-      return *this;
+      ConstIterator iter(*this);
+      iter.m_Index -= offset;
+      return iter;
     }
     ConstIterator& operator+=(size_t offset)
     {
@@ -168,43 +201,59 @@ public:
       m_Index++;
       return *this;
     }
-    ConstIterator& operator++(int)
+    ConstIterator operator++(int)
     {
+      ConstIterator iter(*this);
       m_Index++;
-      return *this;
+      return iter;
     }
     ConstIterator& operator--()
     {
       m_Index--;
       return *this;
     }
-    ConstIterator& operator--(int)
+    ConstIterator operator--(int)
     {
+      ConstIterator iter(*this);
       m_Index--;
-      return *this;
+      return iter;
     }
     difference_type operator-(const ConstIterator& rhs) const
     {
-      return m_Index - rhs.m_Index;
+      return static_cast<difference_type>(m_Index) - static_cast<difference_type>(rhs.m_Index);
     }
 
+    /**
+     * @brief Dereferences the iterator. Contiguous stores are read through the
+     * cached data pointer so that no virtual call is made per element.
+     * @return reference
+     */
     reference operator*() const
     {
-      return m_DataStore[m_Index];
+      if(m_Data != nullptr)
+      {
+        return m_Data[m_Index];
+      }
+      return (*m_DataStore)[m_Index];
     }
 
-    ConstIterator& operator=(const ConstIterator& rhs)
+    reference operator[](difference_type offset) const
     {
-      m_Index = rhs.m_Index;
-      return *this;
+      if(m_Data != nullptr)
+      {
+        return m_Data[m_Index + offset];
+      }
+      return (*m_DataStore)[m_Index + offset];
     }
+
+    ConstIterator& operator=(const ConstIterator& rhs) = default;
     bool operator==(const ConstIterator& rhs) const
     {
-      return (&m_DataStore == &rhs.m_DataStore) && (m_Index == rhs.m_Index);
+      return (m_DataStore == rhs.m_DataStore) && (m_Index == rhs.m_Index);
     }
     bool operator!=(const ConstIterator& rhs) const
     {
-      return (&m_DataStore != &rhs.m_DataStore) || (m_Index != rhs.m_Index);
+      return (m_DataStore != rhs.m_DataStore) || (m_Index != rhs.m_Index);
     }
 
     bool operator<(const ConstIterator& rhs) const
@@ -225,7 +274,8 @@ public:
     }
 
   private:
-    const IDataStore& m_DataStore;
+    const IDataStore* m_DataStore = nullptr;
+    pointer m_Data = nullptr;
     size_t m_Index = 0;
   };
   ///////////////////////////////
@@ -234,6 +284,37 @@ public:
 
   virtual ~IDataStore() = default;
 
+  /**
+   * @brief Returns a number that changes whenever the values may have been
+   * modified since the previous call. Versions are unique across all stores,
+   * so a replaced store never reports the version of the store it replaced.
+   * Derived data can be cached against the version and recomputed only when
+   * it changes. Not safe to call while another thread writes to the store.
+   * @return uint64_t
+   */
+  uint64_t getVersion() const
+  {
+    if(m_Modified.exchange(false, std::memory_order_acq_rel))
+    {
+      m_Version.store(detail::NextDataStoreVersion(), std::memory_order_release);
+    }
+    return m_Version.load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Marks the values as modified so that the next call to getVersion()
+   * returns a new version. DataArray calls this whenever it hands out
+   * writable access. Code that keeps a writable pointer or store around and
+   * writes through it after the version was read has to call it again.
+   */
+  void markModified()
+  {
+    if(!m_Modified.load(std::memory_order_relaxed))
+    {
+      m_Modified.store(true, std::memory_order_relaxed);
+    }
+  }
+
   /**
    * @brief Returns the number of tuples in the DataStore.
    * @return size_t
@@ -261,6 +342,68 @@ public:
    */
   virtual void resizeTuples(size_t numTuples) = 0;
 
+  /**
+   * @brief Returns the capacity to grow to when at least requiredTuples
+   * tuples are needed and currentTuples tuples are already available. The
+   * capacity grows geometrically so that appending tuples one at a time only
+   * reallocates a logarithmic number of times.
+   * @param currentTuples
+   * @param requiredTuples
+   * @return size_t
+   */
+  static size_t GrowTupleCapacity(size_t currentTuples, size_t requiredTuples)
+  {
+    return std::max(requiredTuples, currentTuples + currentTuples / 2);
+  }
+
+  /**
+   * @brief Returns the number of tuples the store can hold before it has to
+   * reallocate. Stores without spare capacity return getTupleCount().
+   * @return size_t
+   */
+  virtual size_t getTupleCapacity() const
+  {
+    return getTupleCount();
+  }
+
+  /**
+   * @brief Reserves space for at least the specified number of tuples without
+   * changing the tuple count. Stores without spare capacity ignore the request.
+   */
+  virtual void reserveTuples(size_t)
+  {
+  }
+
+  /**
+   * @brief Releases any capacity beyond the current tuple count.
+   */
+  virtual void shrinkToFit()
+  {
+  }
+
+  /**
+   * @brief Appends count tuples to the end of the store. The values pointer
+   * must hold count * getTupleSize() values. Capacity grows according to
+   * GrowTupleCapacity().
+   * @param values
+   * @param count
+   */
+  virtual void appendTuples(const_pointer values, size_t count)
+  {
+    const size_t offset = getSize();
+    const size_t tupleCount = getTupleCount() + count;
+    if(tupleCount > getTupleCapacity())
+    {
+      reserveTuples(GrowTupleCapacity(getTupleCapacity(), tupleCount));
+    }
+    resizeTuples(tupleCount);
+    const size_t valueCount = count * getTupleSize();
+    for(size_t i = 0; i < valueCount; i++)
+    {
+      (*this)[offset + i] = values[i];
+    }
+  }
+
   /**
    * @brief Returns the value found at the specified index of the DataStore.
    * This cannot be used to edit the value found at the specified index.
@@ -300,6 +443,125 @@ public:
    */
   virtual reference operator[](size_t index) = 0;
 
+  /**
+   * @brief Returns true if the values are held in a single contiguous buffer
+   * that can be accessed through data(). Returns false otherwise. Stores that
+   * page, compress, or otherwise scatter their values should keep the default.
+   * @return bool
+   */
+  virtual bool isContiguous() const
+  {
+    return false;
+  }
+
+  /**
+   * @brief Returns a pointer to the contiguous value buffer or nullptr if the
+   * store is not contiguous. The pointer is invalidated by resizeTuples().
+   * @return pointer
+   */
+  virtual pointer data()
+  {
+    return nullptr;
+  }
+
+  /**
+   * @brief Returns a read-only pointer to the contiguous value buffer or
+   * nullptr if the store is not contiguous. The pointer is invalidated by
+   * resizeTuples().
+   * @return const_pointer
+   */
+  virtual const_pointer data() const
+  {
+    return nullptr;
+  }
+
+  /**
+   * @brief Returns a Span over all values in the store. If the store is not
+   * contiguous, an empty Span is returned. Check isContiguous() first.
+   * @return Span<T>
+   */
+  Span<T> span()
+  {
+    if(!isContiguous())
+    {
+      return {};
+    }
+    return Span<T>(data(), getSize());
+  }
+
+  /**
+   * @brief Returns a read-only Span over all values in the store. If the store
+   * is not contiguous, an empty Span is returned. Check isContiguous() first.
+   * @return Span<const T>
+   */
+  Span<const T> span() const
+  {
+    if(!isContiguous())
+    {
+      return {};
+    }
+    return Span<const T>(data(), getSize());
+  }
+
+  /**
+   * @brief Returns a pointer to the values of the specified component stored
+   * contiguously by tuple, or nullptr if the component is not stored that
+   * way. Contiguous single-component stores return data(). Planar stores
+   * return the component's plane.
+   * @param component
+   * @return pointer
+   */
+  virtual pointer componentData(size_t component)
+  {
+    return (getTupleSize() == 1 && component == 0) ? data() : nullptr;
+  }
+
+  /**
+   * @brief Returns a read-only pointer to the values of the specified
+   * component stored contiguously by tuple, or nullptr if the component is
+   * not stored that way.
+   * @param component
+   * @return const_pointer
+   */
+  virtual const_pointer componentData(size_t component) const
+  {
+    return (getTupleSize() == 1 && component == 0) ? data() : nullptr;
+  }
+
+  /**
+   * @brief Returns a Span over the specified component's values with one
+   * value per tuple. If the component is not stored contiguously, an empty
+   * Span is returned.
+   * @param component
+   * @return Span<T>
+   */
+  Span<T> componentSpan(size_t component)
+  {
+    pointer values = componentData(component);
+    if(values == nullptr)
+    {
+      return {};
+    }
+    return Span<T>(values, getTupleCount());
+  }
+
+  /**
+   * @brief Returns a read-only Span over the specified component's values
+   * with one value per tuple. If the component is not stored contiguously, an
+   * empty Span is returned.
+   * @param component
+   * @return Span<const T>
+   */
+  Span<const T> componentSpan(size_t component) const
+  {
+    const_pointer values = componentData(component);
+    if(values == nullptr)
+    {
+      return {};
+    }
+    return Span<const T>(values, getTupleCount());
+  }
+
   /**
    * @brief Fills the IDataStore with the specified value.
    * @param value
@@ -315,6 +577,18 @@ public:
    */
   virtual IDataStore* deepCopy() const = 0;
 
+  /**
+   * @brief Returns true if the store reads and writes the values of another
+   * store instead of holding its own, e.g. a ComponentDataStore. DataArray
+   * copies never share such stores copy-on-write and copy them immediately
+   * instead.
+   * @return bool
+   */
+  virtual bool viewsAnotherStore() const
+  {
+    return false;
+  }
+
   /**
    * @brief Returns an Iterator to the begining of the DataStore.
    * @return Iterator
@@ -358,6 +632,27 @@ protected:
   IDataStore()
   {
   }
+
+  /**
+   * @brief Copy constructor. The copy starts out with a version of its own.
+   */
+  IDataStore(const IDataStore&)
+  {
+  }
+
+  /**
+   * @brief Copy assignment marks the values as modified.
+   * @return IDataStore&
+   */
+  IDataStore& operator=(const IDataStore&)
+  {
+    markModified();
+    return *this;
+  }
+
+private:
+  mutable std::atomic<uint64_t> m_Version = detail::NextDataStoreVersion();
+  mutable std::atomic<bool> m_Modified = false;
 };
 
 template <typename Iter>
@@ -0,0 +1,40 @@
+#include "DataBatchMessage.hpp"
+
+#include <algorithm>
+
+using namespace complex;
+
+DataBatchMessage::DataBatchMessage(const DataStructure* ds, MessageCollection messages)
+: AbstractDataStructureMessage(ds)
+, m_Messages(std::move(messages))
+{
+}
+
+DataBatchMessage::DataBatchMessage(const DataBatchMessage& other)
+: AbstractDataStructureMessage(other)
+, m_Messages(other.m_Messages)
+{
+}
+
+DataBatchMessage::DataBatchMessage(DataBatchMessage&& other) noexcept
+: AbstractDataStructureMessage(other)
+, m_Messages(std::move(other.m_Messages))
+{
+}
+
+DataBatchMessage::~DataBatchMessage() = default;
+
+AbstractDataStructureMessage::MessageType DataBatchMessage::getMsgType() const
+{
+  return DataBatchMessage::MsgType;
+}
+
+const DataBatchMessage::MessageCollection& DataBatchMessage::getMessages() const
+{
+  return m_Messages;
+}
+
+usize DataBatchMessage::getMessageCount(MessageType msgType) const
+{
+  return std::count_if(m_Messages.begin(), m_Messages.end(), [msgType](const auto& msg) { return msg->getMsgType() == msgType; });
+}
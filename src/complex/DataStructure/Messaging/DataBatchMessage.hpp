@@ -0,0 +1,73 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "complex/Common/Types.hpp"
+#include "complex/DataStructure/Messaging/AbstractDataStructureMessage.hpp"
+
+#include "complex/complex_export.hpp"
+
+namespace complex
+{
+
+/**
+ * @class DataBatchMessage
+ * @brief The DataBatchMessage class is a DataStructure message class that
+ * carries several messages at once. It is sent in place of the individual
+ * messages when notifications were collected by a
+ * DataStructure::NotificationBatch or delivered asynchronously. The messages
+ * are in the order they were emitted.
+ */
+class COMPLEX_EXPORT DataBatchMessage : public AbstractDataStructureMessage
+{
+public:
+  static const MessageType MsgType = 5;
+
+  using MessageCollection = std::vector<std::shared_ptr<AbstractDataStructureMessage>>;
+
+  /**
+   * @brief Creates a DataBatchMessage for the target DataStructure holding the specified messages.
+   * @param ds
+   * @param messages
+   */
+  DataBatchMessage(const DataStructure* ds, MessageCollection messages);
+
+  /**
+   * @brief Copy constructor
+   * @param other
+   */
+  DataBatchMessage(const DataBatchMessage& other);
+
+  /**
+   * @brief Move constructor
+   * @param other
+   */
+  DataBatchMessage(DataBatchMessage&& other) noexcept;
+
+  virtual ~DataBatchMessage();
+
+  /**
+   * @brief Returns the AbsractDataStructureMessage type.
+   * @return MessageType
+   */
+  MessageType getMsgType() const override;
+
+  /**
+   * @brief Returns the batched messages in the order they were emitted.
+   * @return const MessageCollection&
+   */
+  const MessageCollection& getMessages() const;
+
+  /**
+   * @brief Returns the number of batched messages of the specified type.
+   * @param msgType
+   * @return usize
+   */
+  usize getMessageCount(MessageType msgType) const;
+
+protected:
+private:
+  MessageCollection m_Messages;
+};
+} // namespace complex
@@ -3,6 +3,7 @@
 #include <stdexcept>
 
 #include "complex/DataStructure/DataStructure.hpp"
+#include "complex/DataStructure/Snapshot/SnapshotArchive.hpp"
 
 using namespace complex;
 
@@ -225,3 +226,32 @@ size_t GridMontage::getOffsetFromTilePos(const SizeVec3& tilePos, const Dimensio
 
   return tilePos[0] + tilePos[1] * numCols + tilePos[2] * numCols * numRows;
 }
+
+void GridMontage::serializeSnapshot(SnapshotArchive& archive)
+{
+  AbstractMontage::serializeSnapshot(archive);
+  archive.value(m_RowCount);
+  archive.value(m_ColumnCount);
+  archive.value(m_DepthCount);
+
+  CollectionType& collection = getCollection();
+  uint64_t tileCount = collection.size();
+  archive.value(tileCount);
+  if(archive.isLoading())
+  {
+    collection.assign(tileCount, nullptr);
+  }
+  for(auto& geometry : collection)
+  {
+    std::optional<DataObject::IdType> id;
+    if(geometry != nullptr)
+    {
+      id = geometry->getId();
+    }
+    archive.reference(id);
+    if(archive.isLoading())
+    {
+      geometry = dynamic_cast<AbstractGeometry*>(getDataStructure()->getData(id));
+    }
+  }
+}
@@ -185,6 +185,12 @@ public:
    */
   BoundsType getBounds() const;
 
+  /**
+   * @brief Writes or reads the grid dimensions and the geometry of each tile.
+   * @param archive
+   */
+  void serializeSnapshot(SnapshotArchive& archive) override;
+
 protected:
   /**
    * @brief
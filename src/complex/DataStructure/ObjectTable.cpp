@@ -0,0 +1,255 @@
+#include "ObjectTable.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+using namespace complex;
+
+namespace
+{
+std::atomic<u64>& SerialCounter()
+{
+  static std::atomic<u64> counter(1);
+  return counter;
+}
+
+/**
+ * @brief Draws the next serial number. The counter is wider than a serial
+ * number so running out is detected instead of wrapping around to serials
+ * that live IDs may still use.
+ */
+u32 NextSerial()
+{
+  const u64 serial = SerialCounter().fetch_add(1, std::memory_order_relaxed);
+  if(serial > std::numeric_limits<u32>::max())
+  {
+    throw std::runtime_error("DataObject ID serial numbers are exhausted after 2^32 - 1 allocations");
+  }
+  return static_cast<u32>(serial);
+}
+
+ObjectTable::IdType MakeId(u32 serial, u32 slot)
+{
+  return (static_cast<ObjectTable::IdType>(serial) << 32) | slot;
+}
+} // namespace
+
+ObjectTable::ObjectTable() = default;
+
+ObjectTable::ObjectTable(const ObjectTable& other)
+{
+  std::lock_guard<std::mutex> lock(other.m_Mutex);
+  for(u32 page = 0; page < other.m_Pages.size(); page++)
+  {
+    addPage();
+    for(u32 i = 0; i < k_PageSize; i++)
+    {
+      const Slot& source = other.m_Pages[page][i];
+      Slot& slot = m_Pages[page][i];
+      slot.id.store(source.id.load(std::memory_order_relaxed), std::memory_order_relaxed);
+      slot.object.store(source.object.load(std::memory_order_relaxed), std::memory_order_relaxed);
+      slot.weak = source.weak;
+      slot.nextFree = source.nextFree;
+      slot.reserved = source.reserved;
+    }
+  }
+  m_FirstFree = other.m_FirstFree;
+  m_Count = other.m_Count.load();
+}
+
+ObjectTable::ObjectTable(ObjectTable&& other) noexcept
+: m_Pages(std::move(other.m_Pages))
+, m_Directories(std::move(other.m_Directories))
+, m_Directory(other.m_Directory.load())
+, m_PageCount(other.m_PageCount.load())
+, m_SlotCount(other.m_SlotCount)
+, m_FirstFree(other.m_FirstFree)
+, m_Count(other.m_Count.load())
+{
+  other.m_Directory = nullptr;
+  other.m_PageCount = 0;
+  other.m_SlotCount = 0;
+  other.m_FirstFree = k_NoSlot;
+  other.m_Count = 0;
+}
+
+ObjectTable::~ObjectTable() = default;
+
+u32 ObjectTable::SlotOf(IdType id)
+{
+  return static_cast<u32>(id & 0xFFFFFFFF);
+}
+
+u32 ObjectTable::SerialOf(IdType id)
+{
+  return static_cast<u32>(id >> 32);
+}
+
+ObjectTable::IdType ObjectTable::CreateDetachedId()
+{
+  return MakeId(NextSerial(), k_NoSlot);
+}
+
+void ObjectTable::addPage()
+{
+  if(m_SlotCount > k_NoSlot - k_PageSize)
+  {
+    throw std::runtime_error("DataStructure cannot hold more than 2^32 - 1 objects");
+  }
+  const u32 pageCount = static_cast<u32>(m_Pages.size());
+  m_Pages.push_back(std::make_unique<Slot[]>(k_PageSize));
+  Slot* slots = m_Pages.back().get();
+
+  // Replace the directory once it is full. Readers may still hold the old one
+  Directory* directory = m_Directory.load(std::memory_order_relaxed);
+  if(directory == nullptr || pageCount == directory->capacity)
+  {
+    auto replacement = std::make_unique<Directory>();
+    replacement->capacity = std::max<u32>(8, pageCount * 2);
+    replacement->pages = std::make_unique<std::atomic<Slot*>[]>(replacement->capacity);
+    for(u32 page = 0; page < pageCount; page++)
+    {
+      replacement->pages[page].store(directory->pages[page].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    directory = replacement.get();
+    m_Directories.push_back(std::move(replacement));
+    m_Directory.store(directory, std::memory_order_release);
+  }
+  directory->pages[pageCount].store(slots, std::memory_order_release);
+  m_PageCount.store(pageCount + 1, std::memory_order_release);
+
+  // Link the new slots into the free list, lowest index first
+  const u32 first = m_SlotCount;
+  m_SlotCount += k_PageSize;
+  for(u32 i = k_PageSize; i-- > 0;)
+  {
+    slots[i].nextFree = m_FirstFree;
+    m_FirstFree = first + i;
+  }
+}
+
+ObjectTable::Slot* ObjectTable::slotAt(u32 index) const
+{
+  const u32 page = index >> k_PageBits;
+  if(page >= m_PageCount.load(std::memory_order_acquire))
+  {
+    return nullptr;
+  }
+  const Directory* directory = m_Directory.load(std::memory_order_acquire);
+  return directory->pages[page].load(std::memory_order_acquire) + (index & (k_PageSize - 1));
+}
+
+ObjectTable::IdType ObjectTable::reserve()
+{
+  const u32 serial = NextSerial();
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  if(m_FirstFree == k_NoSlot)
+  {
+    addPage();
+  }
+  const u32 index = m_FirstFree;
+  Slot& slot = *slotAt(index);
+  m_FirstFree = slot.nextFree;
+  slot.nextFree = k_NoSlot;
+  slot.reserved = true;
+  const IdType id = MakeId(serial, index);
+  slot.id.store(id, std::memory_order_release);
+  return id;
+}
+
+bool ObjectTable::insert(const std::shared_ptr<DataObject>& object)
+{
+  if(object == nullptr)
+  {
+    return false;
+  }
+  const IdType id = object->getId();
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  Slot* slot = slotAt(SlotOf(id));
+  if(slot == nullptr || slot->id.load(std::memory_order_relaxed) != id || !slot->reserved)
+  {
+    return false;
+  }
+  if(slot->object.load(std::memory_order_relaxed) == nullptr)
+  {
+    m_Count++;
+  }
+  slot->weak = object;
+  slot->object.store(object.get(), std::memory_order_release);
+  return true;
+}
+
+bool ObjectTable::release(IdType id, const DataObject* object)
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  const u32 index = SlotOf(id);
+  Slot* slot = slotAt(index);
+  if(slot == nullptr)
+  {
+    return false;
+  }
+  // Copies of an object share its ID, so only the stored object frees the slot
+  DataObject* stored = slot->object.load(std::memory_order_relaxed);
+  if(slot->id.load(std::memory_order_relaxed) != id || !slot->reserved || (stored != nullptr && stored != object))
+  {
+    return false;
+  }
+  if(stored != nullptr)
+  {
+    m_Count--;
+  }
+  slot->object.store(nullptr, std::memory_order_release);
+  slot->weak.reset();
+  slot->reserved = false;
+  slot->nextFree = m_FirstFree;
+  m_FirstFree = index;
+  return stored != nullptr;
+}
+
+DataObject* ObjectTable::find(IdType id) const
+{
+  const Slot* slot = slotAt(SlotOf(id));
+  if(slot == nullptr || slot->id.load(std::memory_order_acquire) != id)
+  {
+    return nullptr;
+  }
+  DataObject* object = slot->object.load(std::memory_order_acquire);
+  // IDs are never reused, so the object belongs to id if the slot still holds id
+  if(slot->id.load(std::memory_order_acquire) != id)
+  {
+    return nullptr;
+  }
+  return object;
+}
+
+std::shared_ptr<DataObject> ObjectTable::findShared(IdType id) const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  const Slot* slot = slotAt(SlotOf(id));
+  if(slot == nullptr || slot->id.load(std::memory_order_relaxed) != id)
+  {
+    return nullptr;
+  }
+  return slot->weak.lock();
+}
+
+bool ObjectTable::contains(IdType id) const
+{
+  return find(id) != nullptr;
+}
+
+usize ObjectTable::size() const
+{
+  return m_Count.load(std::memory_order_relaxed);
+}
+
+std::vector<ObjectTable::IdType> ObjectTable::getIds() const
+{
+  std::lock_guard<std::mutex> lock(m_Mutex);
+  std::vector<IdType> ids;
+  ids.reserve(m_Count);
+  forEach([&ids](IdType id, const DataObject*) { ids.push_back(id); });
+  std::sort(ids.begin(), ids.end());
+  return ids;
+}
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "complex/Common/Types.hpp"
+#include "complex/DataStructure/DataObject.hpp"
+
+#include "complex/complex_export.hpp"
+
+namespace complex
+{
+/**
+ * @class ObjectTable
+ * @brief The ObjectTable class is the slot map that owns the lookup from
+ * DataObject IDs to objects within a DataStructure. An ID is a generational
+ * handle: the low 32 bits are the index of the object's slot and the high 32
+ * bits a serial number drawn from a process-wide atomic counter when the ID
+ * is allocated. Looking up an ID is an index into a dense array plus a
+ * comparison of the stored ID, with no tree walk and no weak_ptr lock.
+ *
+ * Freed slots are reused, but a reused slot gets a new serial number, so an
+ * ID kept after its object was removed no longer resolves, even if another
+ * object took the slot. Because serial numbers are shared by every table,
+ * IDs stay unique across DataStructures and sort in allocation order. The
+ * counter does not wrap around: once 2^32 - 1 IDs have been allocated in the
+ * process, allocating another throws.
+ *
+ * Allocating, inserting and releasing IDs take a mutex and may happen
+ * concurrently, e.g. from DataObject constructors on worker threads. find()
+ * and contains() take no lock: slots live in fixed pages that are never
+ * moved, and the directory of pages is replaced rather than grown in place,
+ * with retired directories kept until the table is destroyed.
+ */
+class COMPLEX_EXPORT ObjectTable
+{
+public:
+  using IdType = DataObject::IdType;
+
+  /**
+   * @brief Slot index of IDs that do not belong to any table.
+   */
+  static constexpr u32 k_NoSlot = 0xFFFFFFFF;
+
+  ObjectTable();
+
+  /**
+   * @brief Copy constructor. The copy refers to the same objects as other.
+   * @param other
+   */
+  ObjectTable(const ObjectTable& other);
+
+  /**
+   * @brief Move constructor.
+   * @param other
+   */
+  ObjectTable(ObjectTable&& other) noexcept;
+
+  ~ObjectTable();
+
+  /**
+   * @brief Returns the slot index of the ID.
+   * @param id
+   * @return u32
+   */
+  static u32 SlotOf(IdType id);
+
+  /**
+   * @brief Returns the serial number of the ID.
+   * @param id
+   * @return u32
+   */
+  static u32 SerialOf(IdType id);
+
+  /**
+   * @brief Returns an ID that does not belong to any table, for objects
+   * created outside of a DataStructure. Thread-safe.
+   * @return IdType
+   */
+  static IdType CreateDetachedId();
+
+  /**
+   * @brief Allocates a slot and returns its ID. The ID does not resolve until
+   * an object is inserted under it. Thread-safe.
+   * @return IdType
+   */
+  IdType reserve();
+
+  /**
+   * @brief Stores the object in the slot reserved for its ID, replacing the
+   * object stored there if any. Returns false if the ID was not reserved in
+   * this table.
+   * @param object
+   * @return bool
+   */
+  bool insert(const std::shared_ptr<DataObject>& object);
+
+  /**
+   * @brief Frees the slot of the ID if it holds the object or no object yet.
+   * Returns true if the object was stored in the table. Thread-safe.
+   * @param id
+   * @param object
+   * @return bool
+   */
+  bool release(IdType id, const DataObject* object);
+
+  /**
+   * @brief Returns the object with the ID or nullptr if there is none.
+   * Lock-free; the object may be released by another thread afterwards.
+   * @param id
+   * @return DataObject*
+   */
+  DataObject* find(IdType id) const;
+
+  /**
+   * @brief Returns the object with the ID or nullptr if there is none.
+   * Thread-safe.
+   * @param id
+   * @return std::shared_ptr<DataObject>
+   */
+  std::shared_ptr<DataObject> findShared(IdType id) const;
+
+  /**
+   * @brief Returns true if an object is stored under the ID. Lock-free.
+   * @param id
+   * @return bool
+   */
+  bool contains(IdType id) const;
+
+  /**
+   * @brief Returns the number of stored objects.
+   * @return usize
+   */
+  usize size() const;
+
+  /**
+   * @brief Returns the IDs of the stored objects in allocation order.
+   * Thread-safe.
+   * @return std::vector<IdType>
+   */
+  std::vector<IdType> getIds() const;
+
+  /**
+   * @brief Calls function(id, object) for every stored object in slot order.
+   * Objects inserted or released during the call may be skipped.
+   * @tparam FunctionT
+   * @param function
+   */
+  template <typename FunctionT>
+  void forEach(const FunctionT& function) const
+  {
+    const u32 pageCount = m_PageCount.load(std::memory_order_acquire);
+    const Directory* directory = m_Directory.load(std::memory_order_acquire);
+    for(u32 page = 0; page < pageCount; page++)
+    {
+      const Slot* slots = directory->pages[page].load(std::memory_order_acquire);
+      for(u32 i = 0; i < k_PageSize; i++)
+      {
+        DataObject* object = slots[i].object.load(std::memory_order_acquire);
+        if(object != nullptr)
+        {
+          function(slots[i].id.load(std::memory_order_relaxed), object);
+        }
+      }
+    }
+  }
+
+private:
+  static constexpr u32 k_PageBits = 10;
+  static constexpr u32 k_PageSize = 1 << k_PageBits;
+
+  /**
+   * @brief The ID and object are read without locking. The remaining members
+   * are only accessed with the mutex held.
+   */
+  struct Slot
+  {
+    std::atomic<IdType> id{0};
+    std::atomic<DataObject*> object{nullptr};
+    std::weak_ptr<DataObject> weak;
+    u32 nextFree = k_NoSlot;
+    bool reserved = false;
+  };
+
+  struct Directory
+  {
+    u32 capacity = 0;
+    std::unique_ptr<std::atomic<Slot*>[]> pages;
+  };
+
+  /**
+   * @brief Returns the slot with the index or nullptr if it was not
+   * allocated. Lock-free.
+   * @param index
+   * @return Slot*
+   */
+  Slot* slotAt(u32 index) const;
+
+  /**
+   * @brief Appends a page of free slots. Requires the mutex.
+   */
+  void addPage();
+
+  std::vector<std::unique_ptr<Slot[]>> m_Pages;
+  std::vector<std::unique_ptr<Directory>> m_Directories;
+  std::atomic<Directory*> m_Directory{nullptr};
+  std::atomic<u32> m_PageCount{0};
+  u32 m_SlotCount = 0;
+  u32 m_FirstFree = k_NoSlot;
+  std::atomic<usize> m_Count{0};
+  mutable std::mutex m_Mutex;
+};
+} // namespace complex
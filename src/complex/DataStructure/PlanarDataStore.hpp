@@ -0,0 +1,281 @@
+#pragma once
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include "complex/Common/DefaultInitAllocator.hpp"
+#include "complex/DataStructure/IDataStore.hpp"
+#include "complex/Utilities/BulkCopy.hpp"
+
+namespace complex
+{
+/**
+ * @class PlanarDataStore
+ * @brief The PlanarDataStore class is an IDataStore that holds each component
+ * in its own contiguous plane (struct of arrays) instead of interleaving the
+ * components of each tuple. Indexing through the IDataStore API is unchanged:
+ * index i still refers to component (i % tupleSize) of tuple (i / tupleSize).
+ * Per-component kernels should use componentData() or componentSpan() to read
+ * and write each plane contiguously.
+ * @tparam T
+ */
+template <typename T>
+class PlanarDataStore : public IDataStore<T>
+{
+public:
+  using value_type = typename IDataStore<T>::value_type;
+  using reference = typename IDataStore<T>::reference;
+  using const_reference = typename IDataStore<T>::const_reference;
+  using pointer = typename IDataStore<T>::pointer;
+  using const_pointer = typename IDataStore<T>::const_pointer;
+
+  /**
+   * @brief Constructs a zero-initialized PlanarDataStore with the specified
+   * tupleSize and tupleCount.
+   * @param tupleSize
+   * @param tupleCount
+   */
+  PlanarDataStore(size_t tupleSize, size_t tupleCount)
+  : m_TupleSize(tupleSize)
+  , m_TupleCount(tupleCount)
+  , m_Data(tupleSize * tupleCount, value_type{})
+  {
+  }
+
+  /**
+   * @brief Constructs a PlanarDataStore holding a planar copy of the values
+   * in the provided store, e.g. to replace an interleaved DataStore through
+   * DataArray::setDataStore().
+   * @param source
+   */
+  explicit PlanarDataStore(const IDataStore<T>& source)
+  : m_TupleSize(source.getTupleSize())
+  , m_TupleCount(source.getTupleCount())
+  , m_Data(source.getSize())
+  {
+    for(size_t component = 0; component < m_TupleSize; component++)
+    {
+      pointer plane = componentData(component);
+      if(const_pointer sourcePlane = source.componentData(component); sourcePlane != nullptr)
+      {
+        BulkCopy::CopyValues(sourcePlane, plane, m_TupleCount);
+        continue;
+      }
+      const_pointer sourceData = source.data();
+      for(size_t tuple = 0; tuple < m_TupleCount; tuple++)
+      {
+        const size_t index = tuple * m_TupleSize + component;
+        plane[tuple] = (sourceData != nullptr) ? sourceData[index] : source[index];
+      }
+    }
+  }
+
+  /**
+   * @brief Copy constructor
+   * @param other
+   */
+  PlanarDataStore(const PlanarDataStore& other)
+  : IDataStore<T>(other)
+  , m_TupleSize(other.m_TupleSize)
+  , m_TupleCount(other.m_TupleCount)
+  , m_Data(other.m_Data.size())
+  {
+    BulkCopy::CopyValues(other.m_Data.data(), m_Data.data(), m_Data.size());
+  }
+
+  /**
+   * @brief Move constructor
+   * @param other
+   */
+  PlanarDataStore(PlanarDataStore&& other) noexcept
+  : m_TupleSize(std::move(other.m_TupleSize))
+  , m_TupleCount(std::move(other.m_TupleCount))
+  , m_Data(std::move(other.m_Data))
+  {
+  }
+
+  virtual ~PlanarDataStore() = default;
+
+  /**
+   * @brief Returns the number of tuples in the PlanarDataStore.
+   * @return size_t
+   */
+  size_t getTupleCount() const override
+  {
+    return m_TupleCount;
+  }
+
+  /**
+   * @brief Returns the tuple size.
+   * @return size_t
+   */
+  size_t getTupleSize() const override
+  {
+    return m_TupleSize;
+  }
+
+  /**
+   * @brief Resizes the PlanarDataStore to handle the specified number of
+   * tuples. Every plane is moved to its new offset. Values added by growing
+   * the store are zero-initialized.
+   * @param numTuples
+   */
+  void resizeTuples(size_t numTuples) override
+  {
+    std::vector<value_type, DefaultInitAllocator<value_type>> data(numTuples * m_TupleSize);
+    const size_t keptTuples = std::min(numTuples, m_TupleCount);
+    for(size_t component = 0; component < m_TupleSize; component++)
+    {
+      pointer plane = data.data() + component * numTuples;
+      BulkCopy::CopyValues(componentData(component), plane, keptTuples);
+      std::fill(plane + keptTuples, plane + numTuples, value_type{});
+    }
+    m_Data = std::move(data);
+    m_TupleCount = numTuples;
+  }
+
+  /**
+   * @brief Returns the value found at the specified index of the PlanarDataStore.
+   * This cannot be used to edit the value found at the specified index.
+   * @param index
+   * @return value_type
+   */
+  value_type getValue(size_t index) const override
+  {
+    return m_Data[planarIndex(index)];
+  }
+
+  /**
+   * @brief Sets the value stored at the specified index.
+   * @param index
+   * @param value
+   */
+  void setValue(size_t index, value_type value) override
+  {
+    m_Data[planarIndex(index)] = value;
+  }
+
+  /**
+   * @brief Returns the value found at the specified index of the PlanarDataStore.
+   * This cannot be used to edit the value found at the specified index.
+   * @param index
+   * @return const_reference
+   */
+  const_reference operator[](size_t index) const override
+  {
+    return m_Data[planarIndex(index)];
+  }
+
+  /**
+   * @brief Returns the value found at the specified index of the PlanarDataStore.
+   * This can be used to edit the value found at the specified index.
+   * @param index
+   * @return reference
+   */
+  reference operator[](size_t index) override
+  {
+    return m_Data[planarIndex(index)];
+  }
+
+  /**
+   * @brief Returns the value found at the specified index of the PlanarDataStore.
+   * Throws an exception if the index is out of range.
+   * @param index
+   * @return const_reference
+   */
+  const_reference at(size_t index) const override
+  {
+    if(index >= this->getSize())
+    {
+      throw std::runtime_error("PlanarDataStore index out of range");
+    }
+    return m_Data[planarIndex(index)];
+  }
+
+  /**
+   * @brief Returns true if the store has a single component, in which case
+   * the planar and interleaved layouts are identical.
+   * @return bool
+   */
+  bool isContiguous() const override
+  {
+    return m_TupleSize == 1;
+  }
+
+  /**
+   * @brief Returns a pointer to the values if the store has a single
+   * component. Returns nullptr otherwise.
+   * @return pointer
+   */
+  pointer data() override
+  {
+    return isContiguous() ? m_Data.data() : nullptr;
+  }
+
+  /**
+   * @brief Returns a read-only pointer to the values if the store has a
+   * single component. Returns nullptr otherwise.
+   * @return const_pointer
+   */
+  const_pointer data() const override
+  {
+    return isContiguous() ? m_Data.data() : nullptr;
+  }
+
+  /**
+   * @brief Returns a pointer to the plane holding the specified component.
+   * The pointer is invalidated by resizeTuples().
+   * @param component
+   * @return pointer
+   */
+  pointer componentData(size_t component) override
+  {
+    return m_Data.data() + component * m_TupleCount;
+  }
+
+  /**
+   * @brief Returns a read-only pointer to the plane holding the specified
+   * component. The pointer is invalidated by resizeTuples().
+   * @param component
+   * @return const_pointer
+   */
+  const_pointer componentData(size_t component) const override
+  {
+    return m_Data.data() + component * m_TupleCount;
+  }
+
+  /**
+   * @brief Fills the PlanarDataStore with the specified value.
+   * @param value
+   */
+  void fill(value_type value) override
+  {
+    std::fill(m_Data.begin(), m_Data.end(), value);
+  }
+
+  /**
+   * @brief Returns a deep copy of the data store and all its data.
+   * @return IDataStore*
+   */
+  IDataStore<T>* deepCopy() const override
+  {
+    return new PlanarDataStore(*this);
+  }
+
+private:
+  /**
+   * @brief Converts an interleaved index into an index into the planes.
+   * @param index
+   * @return size_t
+   */
+  size_t planarIndex(size_t index) const
+  {
+    return (index % m_TupleSize) * m_TupleCount + index / m_TupleSize;
+  }
+
+  size_t m_TupleSize;
+  size_t m_TupleCount;
+  std::vector<value_type, DefaultInitAllocator<value_type>> m_Data;
+};
+} // namespace complex
@@ -0,0 +1,955 @@
+#include "DataStructureSnapshot.hpp"
+
+#include <algorithm>
+#include <any>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <typeinfo>
+#include <unordered_set>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "complex/DataStructure/DataArray.hpp"
+#include "complex/DataStructure/DataGroup.hpp"
+#include "complex/DataStructure/DynamicListArray.hpp"
+#include "complex/DataStructure/FileDataStore.hpp"
+#include "complex/DataStructure/Geometry/BoundingVolumeHierarchy.hpp"
+#include "complex/DataStructure/Geometry/EdgeGeom.hpp"
+#include "complex/DataStructure/Geometry/HalfEdgeTopology.hpp"
+#include "complex/DataStructure/Geometry/HexahedralGeom.hpp"
+#include "complex/DataStructure/Geometry/ImageGeom.hpp"
+#include "complex/DataStructure/Geometry/QuadGeom.hpp"
+#include "complex/DataStructure/Geometry/RectGridGeom.hpp"
+#include "complex/DataStructure/Geometry/SpatialIndex.hpp"
+#include "complex/DataStructure/Geometry/TetrahedralGeom.hpp"
+#include "complex/DataStructure/Geometry/TriangleGeom.hpp"
+#include "complex/DataStructure/Geometry/VertexGeom.hpp"
+#include "complex/DataStructure/Montage/GridMontage.hpp"
+#include "complex/DataStructure/ScalarData.hpp"
+#include "complex/DataStructure/Snapshot/SnapshotArchive.hpp"
+
+using namespace complex;
+
+namespace
+{
+using IdType = DataObject::IdType;
+
+constexpr char k_Magic[8] = {'C', 'M', 'P', 'X', 'S', 'N', 'A', 'P'};
+constexpr u32 k_ByteOrderMark = 0x01020304;
+constexpr usize k_HeaderSize = 64;
+constexpr usize k_CopyBufferSize = 65536;
+
+/**
+ * @brief Identifies the class of a stored DataObject. Values are part of the
+ * file format and must not change.
+ */
+enum class ObjectKind : u8
+{
+  DataGroup = 0,
+  DataArray = 1,
+  ScalarData = 2,
+  DynamicList = 3,
+  VertexGeom = 4,
+  EdgeGeom = 5,
+  TriangleGeom = 6,
+  QuadGeom = 7,
+  TetrahedralGeom = 8,
+  HexahedralGeom = 9,
+  ImageGeom = 10,
+  RectGridGeom = 11,
+  GridMontage = 12
+};
+
+/**
+ * @brief Identifies the value type of a stored DataArray or ScalarData and
+ * the count and value types of a stored DynamicListArray.
+ */
+enum class ElementType : u8
+{
+  Int8 = 0,
+  UInt8 = 1,
+  Int16 = 2,
+  UInt16 = 3,
+  Int32 = 4,
+  UInt32 = 5,
+  Int64 = 6,
+  UInt64 = 7,
+  Float32 = 8,
+  Float64 = 9,
+  Bool = 10
+};
+
+/**
+ * @brief Identifies the type of a stored Metadata value.
+ */
+enum class MetadataType : u8
+{
+  Bool = 0,
+  Int32 = 1,
+  Int64 = 2,
+  UInt32 = 3,
+  UInt64 = 4,
+  Float32 = 5,
+  Float64 = 6,
+  String = 7
+};
+
+template <typename T>
+struct TypeTag
+{
+  using type = T;
+};
+
+/**
+ * @brief Calls func with a TypeTag and the ElementType of each supported
+ * element type until it returns true. Returns true if func did.
+ * @param func
+ * @return bool
+ */
+template <typename Func>
+bool VisitElementTypes(Func&& func)
+{
+  return func(TypeTag<i8>{}, ElementType::Int8) || func(TypeTag<u8>{}, ElementType::UInt8) || func(TypeTag<i16>{}, ElementType::Int16) || func(TypeTag<u16>{}, ElementType::UInt16) ||
+         func(TypeTag<i32>{}, ElementType::Int32) || func(TypeTag<u32>{}, ElementType::UInt32) || func(TypeTag<i64>{}, ElementType::Int64) || func(TypeTag<u64>{}, ElementType::UInt64) ||
+         func(TypeTag<f32>{}, ElementType::Float32) || func(TypeTag<f64>{}, ElementType::Float64) || func(TypeTag<bool>{}, ElementType::Bool);
+}
+
+/**
+ * @brief Calls func with a TypeTag for the count type, a TypeTag for the
+ * value type and their ElementTypes for each supported DynamicListArray until
+ * it returns true. Returns true if func did. The supported lists are
+ * AbstractGeometry::ElementDynamicList, Int32Int32DynamicListArray,
+ * UInt16Int64DynamicListArray and Int64Int64DynamicListArray.
+ * @param func
+ * @return bool
+ */
+template <typename Func>
+bool VisitDynamicListTypes(Func&& func)
+{
+  return func(TypeTag<u16>{}, TypeTag<AbstractGeometry::MeshIndexType>{}, ElementType::UInt16, ElementType::UInt64) ||
+         func(TypeTag<i32>{}, TypeTag<i32>{}, ElementType::Int32, ElementType::Int32) || func(TypeTag<u16>{}, TypeTag<i64>{}, ElementType::UInt16, ElementType::Int64) ||
+         func(TypeTag<i64>{}, TypeTag<i64>{}, ElementType::Int64, ElementType::Int64);
+}
+
+/**
+ * @brief Calls func with a TypeTag and the MetadataType of each supported
+ * metadata type until it returns true. Returns true if func did.
+ * @param func
+ * @return bool
+ */
+template <typename Func>
+bool VisitMetadataTypes(Func&& func)
+{
+  return func(TypeTag<bool>{}, MetadataType::Bool) || func(TypeTag<i32>{}, MetadataType::Int32) || func(TypeTag<i64>{}, MetadataType::Int64) || func(TypeTag<u32>{}, MetadataType::UInt32) ||
+         func(TypeTag<u64>{}, MetadataType::UInt64) || func(TypeTag<f32>{}, MetadataType::Float32) || func(TypeTag<f64>{}, MetadataType::Float64) ||
+         func(TypeTag<std::string>{}, MetadataType::String);
+}
+
+/**
+ * @brief Fixed size block at the start of the file.
+ */
+struct Header
+{
+  u32 version = DataStructureSnapshot::k_Version;
+  u32 byteOrderMark = k_ByteOrderMark;
+  u64 payloadAlignment = DataStructureSnapshot::k_PayloadAlignment;
+  u64 objectCount = 0;
+  u64 tocOffset = 0;
+  u64 tocSize = 0;
+
+  void serialize(SnapshotArchive& archive)
+  {
+    char magic[sizeof(k_Magic)];
+    std::memcpy(magic, k_Magic, sizeof(k_Magic));
+    archive.bytes(magic, sizeof(magic));
+    if(archive.isLoading() && std::memcmp(magic, k_Magic, sizeof(k_Magic)) != 0)
+    {
+      throw std::runtime_error("The file is not a DataStructure snapshot");
+    }
+    archive.value(version);
+    archive.value(byteOrderMark);
+    archive.value(payloadAlignment);
+    archive.value(objectCount);
+    archive.value(tocOffset);
+    archive.value(tocSize);
+  }
+};
+
+/**
+ * @brief Returns true for objects a geometry computes from its arrays. These
+ * are recomputed after loading instead of stored.
+ * @param object
+ * @param derivedIds
+ * @return bool
+ */
+bool IsComputed(const DataObject* object, const std::unordered_set<IdType>& derivedIds)
+{
+  if(derivedIds.count(object->getId()) > 0)
+  {
+    return true;
+  }
+  return dynamic_cast<const BoundingVolumeHierarchy*>(object) != nullptr || dynamic_cast<const SpatialIndex*>(object) != nullptr || dynamic_cast<const HalfEdgeTopology*>(object) != nullptr;
+}
+
+/**
+ * @brief Appends object and its descendants in depth-first pre-order, so that
+ * every object follows at least one of its parents.
+ * @param object
+ * @param derivedIds
+ * @param visited
+ * @param objects
+ */
+void AppendObjects(DataObject* object, const std::unordered_set<IdType>& derivedIds, std::unordered_set<IdType>& visited, std::vector<DataObject*>& objects)
+{
+  if(IsComputed(object, derivedIds) || !visited.insert(object->getId()).second)
+  {
+    return;
+  }
+  objects.push_back(object);
+  auto group = dynamic_cast<BaseGroup*>(object);
+  if(group == nullptr)
+  {
+    return;
+  }
+  for(auto& child : *group)
+  {
+    AppendObjects(child.second.get(), derivedIds, visited, objects);
+  }
+}
+
+/**
+ * @brief Returns the objects to store in the order they are written.
+ * @param dataStructure
+ * @return std::vector<DataObject*>
+ */
+std::vector<DataObject*> ListObjects(const DataStructure& dataStructure)
+{
+  const std::vector<DataObject*> topLevel = dataStructure.getTopLevelData();
+
+  std::unordered_set<IdType> derivedIds;
+  std::unordered_set<IdType> visited;
+  std::vector<DataObject*> objects;
+  for(DataObject* object : topLevel)
+  {
+    AppendObjects(object, derivedIds, visited, objects);
+  }
+  for(const DataObject* object : objects)
+  {
+    if(auto geometry = dynamic_cast<const AbstractGeometry*>(object))
+    {
+      for(IdType id : geometry->getDerivedIds())
+      {
+        derivedIds.insert(id);
+      }
+    }
+  }
+
+  visited.clear();
+  objects.clear();
+  for(DataObject* object : topLevel)
+  {
+    AppendObjects(object, derivedIds, visited, objects);
+  }
+  return objects;
+}
+
+ObjectKind GetKind(const DataObject& object)
+{
+  if(dynamic_cast<const GridMontage*>(&object) != nullptr)
+  {
+    return ObjectKind::GridMontage;
+  }
+  if(dynamic_cast<const VertexGeom*>(&object) != nullptr)
+  {
+    return ObjectKind::VertexGeom;
+  }
+  if(dynamic_cast<const EdgeGeom*>(&object) != nullptr)
+  {
+    return ObjectKind::EdgeGeom;
+  }
+  if(dynamic_cast<const TriangleGeom*>(&object) != nullptr)
+  {
+    return ObjectKind::TriangleGeom;
+  }
+  if(dynamic_cast<const QuadGeom*>(&object) != nullptr)
+  {
+    return ObjectKind::QuadGeom;
+  }
+  if(dynamic_cast<const TetrahedralGeom*>(&object) != nullptr)
+  {
+    return ObjectKind::TetrahedralGeom;
+  }
+  if(dynamic_cast<const HexahedralGeom*>(&object) != nullptr)
+  {
+    return ObjectKind::HexahedralGeom;
+  }
+  if(dynamic_cast<const ImageGeom*>(&object) != nullptr)
+  {
+    return ObjectKind::ImageGeom;
+  }
+  if(dynamic_cast<const RectGridGeom*>(&object) != nullptr)
+  {
+    return ObjectKind::RectGridGeom;
+  }
+  if(dynamic_cast<const DataGroup*>(&object) != nullptr)
+  {
+    return ObjectKind::DataGroup;
+  }
+  if(VisitDynamicListTypes([&object](auto countTag, auto valueTag, ElementType, ElementType) {
+       return dynamic_cast<const DynamicListArray<typename decltype(countTag)::type, typename decltype(valueTag)::type>*>(&object) != nullptr;
+     }))
+  {
+    return ObjectKind::DynamicList;
+  }
+  if(VisitElementTypes([&object](auto tag, ElementType) { return dynamic_cast<const DataArray<typename decltype(tag)::type>*>(&object) != nullptr; }))
+  {
+    return ObjectKind::DataArray;
+  }
+  if(VisitElementTypes([&object](auto tag, ElementType) { return dynamic_cast<const ScalarData<typename decltype(tag)::type>*>(&object) != nullptr; }))
+  {
+    return ObjectKind::ScalarData;
+  }
+  throw std::runtime_error(fmt::format("Unable to write \"{}\" to a snapshot: its type is not supported", object.getName()));
+}
+
+///////////
+// Write //
+///////////
+
+/**
+ * @brief Pads the file with zeros up to the next payload boundary and returns
+ * the resulting position.
+ * @param file
+ * @return u64
+ */
+u64 AlignOutput(std::ofstream& file)
+{
+  static const std::vector<char> s_Zeros(DataStructureSnapshot::k_PayloadAlignment, 0);
+  const auto position = static_cast<u64>(file.tellp());
+  const u64 padding = (DataStructureSnapshot::k_PayloadAlignment - position % DataStructureSnapshot::k_PayloadAlignment) % DataStructureSnapshot::k_PayloadAlignment;
+  file.write(s_Zeros.data(), static_cast<std::streamsize>(padding));
+  return position + padding;
+}
+
+/**
+ * @brief Writes size bytes at the next payload boundary and returns their
+ * offset.
+ * @param file
+ * @param data
+ * @param size
+ * @return u64
+ */
+u64 WritePayload(std::ofstream& file, const void* data, usize size)
+{
+  const u64 offset = AlignOutput(file);
+  file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+  return offset;
+}
+
+/**
+ * @brief Writes the values of store at the next payload boundary and returns
+ * their offset.
+ * @tparam T
+ * @param file
+ * @param store
+ * @return u64
+ */
+template <typename T>
+u64 WriteValues(std::ofstream& file, const IDataStore<T>& store)
+{
+  const usize count = store.getSize();
+  if(store.isContiguous() && store.data() != nullptr)
+  {
+    return WritePayload(file, store.data(), count * sizeof(T));
+  }
+
+  // Other stores are copied through a buffer a block at a time
+  const u64 offset = AlignOutput(file);
+  auto buffer = std::make_unique<T[]>(std::min(count, k_CopyBufferSize));
+  for(usize start = 0; start < count; start += k_CopyBufferSize)
+  {
+    const usize blockSize = std::min(count - start, k_CopyBufferSize);
+    for(usize i = 0; i < blockSize; i++)
+    {
+      buffer[i] = store.getValue(start + i);
+    }
+    file.write(reinterpret_cast<const char*>(buffer.get()), static_cast<std::streamsize>(blockSize * sizeof(T)));
+  }
+  return offset;
+}
+
+template <typename T>
+void WriteArray(std::ofstream& file, SnapshotArchive& archive, const DataArray<T>& array, ElementType type)
+{
+  const IDataStore<T>* store = array.getDataStore();
+  u64 tupleSize = store != nullptr ? store->getTupleSize() : 0;
+  u64 tupleCount = store != nullptr ? store->getTupleCount() : 0;
+  u64 offset = store != nullptr ? WriteValues(file, *store) : 0;
+  archive.value(type);
+  archive.value(tupleSize);
+  archive.value(tupleCount);
+  archive.value(offset);
+}
+
+template <typename T, typename K>
+void WriteDynamicList(std::ofstream& file, SnapshotArchive& archive, const DynamicListArray<T, K>& list, ElementType countType, ElementType valueType)
+{
+  u64 listCount = list.size();
+  std::vector<T> counts(list.size());
+  for(usize i = 0; i < counts.size(); i++)
+  {
+    counts[i] = list.getNumberOfElements(i);
+  }
+  u64 countsOffset = WritePayload(file, counts.data(), counts.size() * sizeof(T));
+  u64 indexCount = list.getTotalNumberOfElements();
+  u64 indicesOffset = WritePayload(file, list.getElementListPointer(0), indexCount * sizeof(K));
+  archive.value(countType);
+  archive.value(valueType);
+  archive.value(listCount);
+  archive.value(countsOffset);
+  archive.value(indexCount);
+  archive.value(indicesOffset);
+}
+
+void WriteMetadata(SnapshotArchive& archive, const Metadata& metadata)
+{
+  u64 count = 0;
+  for(const auto& entry : metadata)
+  {
+    const std::any& value = entry.second;
+    if(VisitMetadataTypes([&value](auto tag, MetadataType) { return value.type() == typeid(typename decltype(tag)::type); }))
+    {
+      count++;
+    }
+  }
+  archive.value(count);
+
+  for(const auto& entry : metadata)
+  {
+    VisitMetadataTypes([&archive, &entry](auto tag, MetadataType type) {
+      using T = typename decltype(tag)::type;
+      auto value = std::any_cast<T>(&entry.second);
+      if(value == nullptr)
+      {
+        return false;
+      }
+      std::string key = entry.first;
+      T copy = *value;
+      archive.value(key);
+      archive.value(type);
+      archive.value(copy);
+      return true;
+    });
+  }
+}
+
+void WriteObject(std::ofstream& file, SnapshotArchive& archive, DataObject& object, const SnapshotArchive::IndexMap& indices)
+{
+  ObjectKind kind = GetKind(object);
+  std::string name = object.getName();
+  archive.value(kind);
+  archive.value(name);
+
+  // Parents are sorted, so the first one always precedes the object
+  std::vector<u64> parents;
+  for(const BaseGroup* parent : object.getParents())
+  {
+    auto iter = indices.find(parent->getId());
+    if(iter != indices.end())
+    {
+      parents.push_back(iter->second);
+    }
+  }
+  std::sort(parents.begin(), parents.end());
+  u64 parentCount = parents.size();
+  archive.value(parentCount);
+  for(u64& parent : parents)
+  {
+    archive.value(parent);
+  }
+
+  switch(kind)
+  {
+  case ObjectKind::DataArray:
+    VisitElementTypes([&](auto tag, ElementType type) {
+      auto array = dynamic_cast<const DataArray<typename decltype(tag)::type>*>(&object);
+      if(array == nullptr)
+      {
+        return false;
+      }
+      WriteArray(file, archive, *array, type);
+      return true;
+    });
+    break;
+  case ObjectKind::ScalarData:
+    VisitElementTypes([&](auto tag, ElementType type) {
+      auto scalar = dynamic_cast<const ScalarData<typename decltype(tag)::type>*>(&object);
+      if(scalar == nullptr)
+      {
+        return false;
+      }
+      auto value = scalar->getValue();
+      archive.value(type);
+      archive.value(value);
+      return true;
+    });
+    break;
+  case ObjectKind::DynamicList:
+    VisitDynamicListTypes([&](auto countTag, auto valueTag, ElementType countType, ElementType valueType) {
+      auto list = dynamic_cast<const DynamicListArray<typename decltype(countTag)::type, typename decltype(valueTag)::type>*>(&object);
+      if(list == nullptr)
+      {
+        return false;
+      }
+      WriteDynamicList(file, archive, *list, countType, valueType);
+      return true;
+    });
+    break;
+  default:
+    break;
+  }
+
+  WriteMetadata(archive, *object.getMetadata());
+
+  std::vector<u8> state;
+  SnapshotArchive stateArchive(state, indices);
+  object.serializeSnapshot(stateArchive);
+  u64 stateSize = state.size();
+  archive.value(stateSize);
+  archive.bytes(state.data(), state.size());
+}
+
+//////////
+// Read //
+//////////
+
+/**
+ * @brief State shared by the functions loading a snapshot.
+ */
+struct ReadContext
+{
+  std::filesystem::path path;
+  std::ifstream file;
+  u64 fileSize = 0;
+  DataStructure& dataStructure;
+};
+
+/**
+ * @brief Copies size bytes stored at offset into data.
+ * @param context
+ * @param offset
+ * @param data
+ * @param size
+ */
+void ReadPayload(ReadContext& context, u64 offset, void* data, u64 size)
+{
+  if(offset > context.fileSize || size > context.fileSize - offset)
+  {
+    throw std::runtime_error(fmt::format("Snapshot \"{}\" is too small to hold {} bytes at offset {}", context.path.string(), size, offset));
+  }
+  if(size == 0)
+  {
+    return;
+  }
+  context.file.seekg(static_cast<std::streamoff>(offset));
+  if(!context.file.read(static_cast<char*>(data), static_cast<std::streamsize>(size)))
+  {
+    throw std::runtime_error(fmt::format("Unable to read {} bytes at offset {} of \"{}\"", size, offset, context.path.string()));
+  }
+}
+
+DataObject* ReadArray(ReadContext& context, SnapshotArchive& archive, const std::string& name, const std::optional<IdType>& parent)
+{
+  ElementType type = ElementType::Int8;
+  u64 tupleSize = 0;
+  u64 tupleCount = 0;
+  u64 offset = 0;
+  archive.value(type);
+  archive.value(tupleSize);
+  archive.value(tupleCount);
+  archive.value(offset);
+
+  DataObject* array = nullptr;
+  bool known = VisitElementTypes([&](auto tag, ElementType candidate) {
+    using T = typename decltype(tag)::type;
+    if(candidate != type)
+    {
+      return false;
+    }
+    IDataStore<T>* store = nullptr;
+    if(tupleSize > 0)
+    {
+      if(tupleCount > std::numeric_limits<usize>::max() / tupleSize / sizeof(T))
+      {
+        throw std::runtime_error(fmt::format("Snapshot array \"{}\" is too large", name));
+      }
+      store = FileDataStore<T>::OpenView(context.path, static_cast<usize>(offset), static_cast<usize>(tupleSize), static_cast<usize>(tupleCount));
+    }
+    array = context.dataStructure.createDataArray<T>(name, store, parent);
+    return true;
+  });
+  if(!known)
+  {
+    throw std::runtime_error(fmt::format("Snapshot array \"{}\" has unknown element type {}", name, static_cast<u32>(type)));
+  }
+  return array;
+}
+
+DataObject* ReadScalar(ReadContext& context, SnapshotArchive& archive, const std::string& name, const std::optional<IdType>& parent)
+{
+  ElementType type = ElementType::Int8;
+  archive.value(type);
+
+  DataObject* scalar = nullptr;
+  bool known = VisitElementTypes([&](auto tag, ElementType candidate) {
+    using T = typename decltype(tag)::type;
+    if(candidate != type)
+    {
+      return false;
+    }
+    T value = {};
+    archive.value(value);
+    scalar = context.dataStructure.createScalar<T>(name, value, parent);
+    return true;
+  });
+  if(!known)
+  {
+    throw std::runtime_error(fmt::format("Snapshot scalar \"{}\" has unknown element type {}", name, static_cast<u32>(type)));
+  }
+  return scalar;
+}
+
+template <typename T, typename K>
+DataObject* ReadDynamicListValues(ReadContext& context, SnapshotArchive& archive, const std::string& name, const std::optional<IdType>& parent)
+{
+  u64 listCount = 0;
+  u64 countsOffset = 0;
+  u64 indexCount = 0;
+  u64 indicesOffset = 0;
+  archive.value(listCount);
+  archive.value(countsOffset);
+  archive.value(indexCount);
+  archive.value(indicesOffset);
+  if(listCount > context.fileSize / sizeof(T) || indexCount > context.fileSize / sizeof(K))
+  {
+    throw std::runtime_error(fmt::format("Snapshot \"{}\" is too small to hold dynamic list \"{}\"", context.path.string(), name));
+  }
+
+  std::vector<T> counts(static_cast<usize>(listCount));
+  ReadPayload(context, countsOffset, counts.data(), listCount * sizeof(T));
+  if constexpr(std::is_signed_v<T>)
+  {
+    if(std::any_of(counts.begin(), counts.end(), [](T count) { return count < 0; }))
+    {
+      throw std::runtime_error(fmt::format("Snapshot dynamic list \"{}\" has a list with a negative length", name));
+    }
+  }
+  auto list = context.dataStructure.createDynamicList<T, K>(name, parent);
+  if(list == nullptr)
+  {
+    return nullptr;
+  }
+  list->allocateLists(counts);
+  if(list->getTotalNumberOfElements() != indexCount)
+  {
+    throw std::runtime_error(fmt::format("Snapshot dynamic list \"{}\" holds {} values but its lists add up to {}", name, indexCount, list->getTotalNumberOfElements()));
+  }
+  ReadPayload(context, indicesOffset, list->getElementListPointer(0), indexCount * sizeof(K));
+  return list;
+}
+
+DataObject* ReadDynamicList(ReadContext& context, SnapshotArchive& archive, const std::string& name, const std::optional<IdType>& parent)
+{
+  ElementType countType = ElementType::Int8;
+  ElementType valueType = ElementType::Int8;
+  archive.value(countType);
+  archive.value(valueType);
+
+  DataObject* list = nullptr;
+  bool known = VisitDynamicListTypes([&](auto countTag, auto valueTag, ElementType countCandidate, ElementType valueCandidate) {
+    if(countCandidate != countType || valueCandidate != valueType)
+    {
+      return false;
+    }
+    list = ReadDynamicListValues<typename decltype(countTag)::type, typename decltype(valueTag)::type>(context, archive, name, parent);
+    return true;
+  });
+  if(!known)
+  {
+    throw std::runtime_error(fmt::format("Snapshot dynamic list \"{}\" has unknown count and value types {} and {}", name, static_cast<u32>(countType), static_cast<u32>(valueType)));
+  }
+  return list;
+}
+
+DataObject* ReadObject(ReadContext& context, SnapshotArchive& archive, ObjectKind kind, const std::string& name, const std::optional<IdType>& parent)
+{
+  DataStructure& dataStructure = context.dataStructure;
+  switch(kind)
+  {
+  case ObjectKind::DataGroup:
+    return dataStructure.createGroup(name, parent);
+  case ObjectKind::DataArray:
+    return ReadArray(context, archive, name, parent);
+  case ObjectKind::ScalarData:
+    return ReadScalar(context, archive, name, parent);
+  case ObjectKind::DynamicList:
+    return ReadDynamicList(context, archive, name, parent);
+  case ObjectKind::VertexGeom:
+    return dataStructure.createGeometry<VertexGeom>(name, parent);
+  case ObjectKind::EdgeGeom:
+    return dataStructure.createGeometry<EdgeGeom>(name, parent);
+  case ObjectKind::TriangleGeom:
+    return dataStructure.createGeometry<TriangleGeom>(name, parent);
+  case ObjectKind::QuadGeom:
+    return dataStructure.createGeometry<QuadGeom>(name, parent);
+  case ObjectKind::TetrahedralGeom:
+    return dataStructure.createGeometry<TetrahedralGeom>(name, parent);
+  case ObjectKind::HexahedralGeom:
+    return dataStructure.createGeometry<HexahedralGeom>(name, parent);
+  case ObjectKind::ImageGeom:
+    return dataStructure.createGeometry<ImageGeom>(name, parent);
+  case ObjectKind::RectGridGeom:
+    return dataStructure.createGeometry<RectGridGeom>(name, parent);
+  case ObjectKind::GridMontage:
+    return dataStructure.createMontage<GridMontage>(name, parent);
+  }
+  throw std::runtime_error(fmt::format("Snapshot object \"{}\" has unknown kind {}", name, static_cast<u32>(kind)));
+}
+
+void ReadMetadata(SnapshotArchive& archive, Metadata& metadata)
+{
+  u64 count = 0;
+  archive.value(count);
+  for(u64 i = 0; i < count; i++)
+  {
+    std::string key;
+    MetadataType type = MetadataType::Bool;
+    archive.value(key);
+    archive.value(type);
+    bool known = VisitMetadataTypes([&](auto tag, MetadataType candidate) {
+      using T = typename decltype(tag)::type;
+      if(candidate != type)
+      {
+        return false;
+      }
+      T value = {};
+      archive.value(value);
+      metadata.setData(key, value);
+      return true;
+    });
+    if(!known)
+    {
+      throw std::runtime_error(fmt::format("Snapshot metadata \"{}\" has unknown type {}", key, static_cast<u32>(type)));
+    }
+  }
+}
+
+/**
+ * @brief Returns a path in the directory of path that no other writer uses.
+ */
+std::filesystem::path TemporaryPath(const std::filesystem::path& path)
+{
+  static std::atomic<u64> counter(0);
+  const auto ticks = std::chrono::steady_clock::now().time_since_epoch().count();
+  const usize thread = std::hash<std::thread::id>()(std::this_thread::get_id());
+  std::filesystem::path tempPath = path;
+  tempPath += fmt::format(".{:x}-{:x}-{}.tmp", ticks, thread, counter.fetch_add(1));
+  return tempPath;
+}
+
+/**
+ * @brief Writes the header, payloads and table of contents of the objects.
+ */
+void WriteFile(std::ofstream& file, const std::vector<DataObject*>& objects, const SnapshotArchive::IndexMap& indices)
+{
+  const std::vector<char> placeholder(k_HeaderSize, 0);
+  file.write(placeholder.data(), static_cast<std::streamsize>(placeholder.size()));
+
+  // Payloads are written as the table of contents is built, and the table follows them
+  std::vector<u8> toc;
+  SnapshotArchive tocArchive(toc, indices);
+  for(DataObject* object : objects)
+  {
+    WriteObject(file, tocArchive, *object, indices);
+  }
+
+  Header header;
+  header.objectCount = objects.size();
+  header.tocOffset = static_cast<u64>(file.tellp());
+  header.tocSize = toc.size();
+  file.write(reinterpret_cast<const char*>(toc.data()), static_cast<std::streamsize>(toc.size()));
+
+  std::vector<u8> headerBytes;
+  SnapshotArchive headerArchive(headerBytes, indices);
+  header.serialize(headerArchive);
+  headerBytes.resize(k_HeaderSize, 0);
+  file.seekp(0);
+  file.write(reinterpret_cast<const char*>(headerBytes.data()), static_cast<std::streamsize>(headerBytes.size()));
+}
+} // namespace
+
+void DataStructureSnapshot::Write(const DataStructure& dataStructure, const std::filesystem::path& path)
+{
+  DataStructure::SharedLock lock(dataStructure.m_Mutex);
+  const std::vector<DataObject*> objects = ListObjects(dataStructure);
+  SnapshotArchive::IndexMap indices;
+  for(usize i = 0; i < objects.size(); i++)
+  {
+    indices[objects[i]->getId()] = i + 1;
+  }
+
+  // Loaded arrays may map the file at path, so it is replaced rather than overwritten
+  const std::filesystem::path tempPath = TemporaryPath(path);
+  std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+  if(!file)
+  {
+    throw std::runtime_error(fmt::format("Unable to open \"{}\" for writing", tempPath.string()));
+  }
+  try
+  {
+    WriteFile(file, objects, indices);
+    file.close();
+    if(!file)
+    {
+      throw std::runtime_error(fmt::format("Unable to write snapshot \"{}\"", path.string()));
+    }
+    std::filesystem::rename(tempPath, path);
+  } catch(const std::exception&)
+  {
+    file.close();
+    std::error_code errorCode;
+    std::filesystem::remove(tempPath, errorCode);
+    throw;
+  }
+}
+
+DataStructure DataStructureSnapshot::Read(const std::filesystem::path& path)
+{
+  DataStructure dataStructure;
+  ReadContext context{path, std::ifstream(path, std::ios::binary), 0, dataStructure};
+  if(!context.file)
+  {
+    throw std::runtime_error(fmt::format("Unable to open \"{}\" for reading", path.string()));
+  }
+  std::error_code errorCode;
+  context.fileSize = static_cast<u64>(std::filesystem::file_size(path, errorCode));
+  if(errorCode || context.fileSize < k_HeaderSize)
+  {
+    throw std::runtime_error(fmt::format("\"{}\" is not a DataStructure snapshot", path.string()));
+  }
+
+  SnapshotArchive::IdList ids;
+  std::vector<u8> headerBytes(k_HeaderSize);
+  ReadPayload(context, 0, headerBytes.data(), headerBytes.size());
+  SnapshotArchive headerArchive(headerBytes.data(), headerBytes.size(), ids);
+  Header header;
+  header.serialize(headerArchive);
+  if(header.byteOrderMark != k_ByteOrderMark)
+  {
+    throw std::runtime_error(fmt::format("Snapshot \"{}\" was written with a different byte order", path.string()));
+  }
+  if(header.version != k_Version)
+  {
+    throw std::runtime_error(fmt::format("Snapshot \"{}\" has version {}, but only version {} is supported", path.string(), header.version, k_Version));
+  }
+  if(header.tocOffset > context.fileSize || header.tocSize > context.fileSize - header.tocOffset || header.objectCount > header.tocSize)
+  {
+    throw std::runtime_error(fmt::format("Snapshot \"{}\" is truncated", path.string()));
+  }
+
+  std::vector<u8> toc(static_cast<usize>(header.tocSize));
+  ReadPayload(context, header.tocOffset, toc.data(), toc.size());
+  SnapshotArchive tocArchive(toc.data(), toc.size(), ids);
+
+  // Create each object under its first parent, which always precedes it
+  std::vector<std::vector<u64>> additionalParents(static_cast<usize>(header.objectCount));
+  std::vector<std::vector<u8>> states(static_cast<usize>(header.objectCount));
+  ids.reserve(static_cast<usize>(header.objectCount));
+  for(u64 index = 1; index <= header.objectCount; index++)
+  {
+    ObjectKind kind = ObjectKind::DataGroup;
+    std::string name;
+    u64 parentCount = 0;
+    tocArchive.value(kind);
+    tocArchive.value(name);
+    tocArchive.value(parentCount);
+    if(parentCount > header.objectCount)
+    {
+      throw std::runtime_error(fmt::format("Snapshot object \"{}\" has {} parents", name, parentCount));
+    }
+    std::vector<u64> parents(static_cast<usize>(parentCount));
+    for(u64& parent : parents)
+    {
+      tocArchive.value(parent);
+      if(parent == 0 || parent > header.objectCount || parent == index)
+      {
+        throw std::runtime_error(fmt::format("Snapshot object \"{}\" has invalid parent {}", name, parent));
+      }
+    }
+    std::optional<IdType> parentId;
+    if(!parents.empty())
+    {
+      if(parents.front() >= index)
+      {
+        throw std::runtime_error(fmt::format("Snapshot object \"{}\" precedes its parents", name));
+      }
+      parentId = ids[static_cast<usize>(parents.front() - 1)];
+      additionalParents[static_cast<usize>(index - 1)].assign(parents.begin() + 1, parents.end());
+    }
+
+    DataObject* object = ReadObject(context, tocArchive, kind, name, parentId);
+    if(object == nullptr)
+    {
+      throw std::runtime_error(fmt::format("Unable to add snapshot object \"{}\" to the DataStructure", name));
+    }
+    ids.push_back(object->getId());
+    ReadMetadata(tocArchive, *object->getMetadata());
+
+    u64 stateSize = 0;
+    tocArchive.value(stateSize);
+    if(stateSize > header.tocSize)
+    {
+      throw std::runtime_error(fmt::format("Snapshot \"{}\" is truncated", path.string()));
+    }
+    std::vector<u8>& state = states[static_cast<usize>(index - 1)];
+    state.resize(static_cast<usize>(stateSize));
+    tocArchive.bytes(state.data(), state.size());
+  }
+  if(!tocArchive.atEnd())
+  {
+    throw std::runtime_error(fmt::format("Snapshot \"{}\" has unexpected data after its last object", path.string()));
+  }
+
+  for(usize i = 0; i < ids.size(); i++)
+  {
+    for(u64 parent : additionalParents[i])
+    {
+      if(!dataStructure.setAdditionalParent(ids[i], ids[static_cast<usize>(parent - 1)]))
+      {
+        throw std::runtime_error(fmt::format("Unable to restore parent {} of snapshot object {}", parent, i + 1));
+      }
+    }
+  }
+
+  // References between objects can only be restored once every object exists
+  for(usize i = 0; i < ids.size(); i++)
+  {
+    DataObject* object = dataStructure.getData(ids[i]);
+    SnapshotArchive stateArchive(states[i].data(), states[i].size(), ids);
+    object->serializeSnapshot(stateArchive);
+    if(!stateArchive.atEnd())
+    {
+      throw std::runtime_error(fmt::format("Snapshot object \"{}\" holds more state than it reads", object->getName()));
+    }
+  }
+  return dataStructure;
+}
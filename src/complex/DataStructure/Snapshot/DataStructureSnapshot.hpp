@@ -0,0 +1,59 @@
+#pragma once
+
+#include <filesystem>
+
+#include "complex/Common/Types.hpp"
+#include "complex/DataStructure/DataStructure.hpp"
+
+#include "complex/complex_export.hpp"
+
+namespace complex
+{
+/**
+ * @class DataStructureSnapshot
+ * @brief The DataStructureSnapshot class writes a DataStructure to a single
+ * binary file and loads it back. The file holds a fixed size header, the
+ * values of every DataArray and DynamicListArray, and finally a table of
+ * contents describing each object: its type, name, parents, metadata and the
+ * state written by DataObject::serializeSnapshot().
+ *
+ * Array values are stored raw in the byte order of the writing machine, each
+ * starting on a page boundary. Loading maps them into FileDataStores without
+ * reading them, so loading takes time in proportion to the number of objects
+ * rather than the size of the data, and values are paged in when accessed.
+ * Modified values stay in memory and the file is never changed. Dynamic lists
+ * are read into memory.
+ *
+ * Objects a geometry computes from its arrays, such as element neighbors,
+ * centroids and search structures, are not stored and are recomputed when
+ * needed. Metadata values of types other than bool, 32 and 64 bit integers,
+ * float, double and std::string are not stored. Writing a DataStructure that
+ * holds any other kind of DataObject throws.
+ */
+class COMPLEX_EXPORT DataStructureSnapshot
+{
+public:
+  static constexpr u32 k_Version = 2;
+  static constexpr u64 k_PayloadAlignment = 4096;
+
+  /**
+   * @brief Writes the DataStructure to the file at path, replacing it if it
+   * exists. The snapshot is written to a temporary file in the same directory
+   * that then replaces path, so arrays loaded from path stay valid and path
+   * is left unchanged on failure. Throws std::runtime_error or
+   * std::filesystem::filesystem_error on failure.
+   * @param dataStructure
+   * @param path
+   */
+  static void Write(const DataStructure& dataStructure, const std::filesystem::path& path);
+
+  /**
+   * @brief Loads the DataStructure stored in the file at path. Loaded arrays
+   * map the file, which must not be modified while they exist. Throws
+   * std::runtime_error if the file is not a valid snapshot.
+   * @param path
+   * @return DataStructure
+   */
+  static DataStructure Read(const std::filesystem::path& path);
+};
+} // namespace complex
@@ -0,0 +1,97 @@
+#include "SnapshotArchive.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+#include <fmt/core.h>
+
+using namespace complex;
+
+SnapshotArchive::SnapshotArchive(std::vector<u8>& buffer, const IndexMap& indices)
+: m_Buffer(&buffer)
+, m_Indices(&indices)
+{
+}
+
+SnapshotArchive::SnapshotArchive(const u8* data, usize size, const IdList& ids)
+: m_Data(data)
+, m_Size(size)
+, m_Ids(&ids)
+{
+}
+
+bool SnapshotArchive::isLoading() const
+{
+  return m_Buffer == nullptr;
+}
+
+bool SnapshotArchive::atEnd() const
+{
+  return m_Position == m_Size;
+}
+
+void SnapshotArchive::bytes(void* data, usize size)
+{
+  if(size == 0)
+  {
+    return;
+  }
+  if(!isLoading())
+  {
+    const auto source = static_cast<const u8*>(data);
+    m_Buffer->insert(m_Buffer->end(), source, source + size);
+    return;
+  }
+  if(size > m_Size - m_Position)
+  {
+    throw std::runtime_error(fmt::format("Snapshot record ends after {} bytes while reading {} more", m_Size, size));
+  }
+  std::memcpy(data, m_Data + m_Position, size);
+  m_Position += size;
+}
+
+void SnapshotArchive::value(std::string& value)
+{
+  u64 length = value.size();
+  this->value(length);
+  if(isLoading())
+  {
+    if(length > m_Size - m_Position)
+    {
+      throw std::runtime_error(fmt::format("Snapshot record ends before a string of {} bytes", length));
+    }
+    value.assign(reinterpret_cast<const char*>(m_Data + m_Position), static_cast<usize>(length));
+    m_Position += static_cast<usize>(length);
+    return;
+  }
+  bytes(value.data(), value.size());
+}
+
+void SnapshotArchive::reference(std::optional<IdType>& id)
+{
+  u64 index = 0;
+  if(!isLoading())
+  {
+    if(id)
+    {
+      auto iter = m_Indices->find(*id);
+      if(iter != m_Indices->end())
+      {
+        index = iter->second;
+      }
+    }
+    value(index);
+    return;
+  }
+  value(index);
+  if(index == 0)
+  {
+    id.reset();
+    return;
+  }
+  if(index > m_Ids->size())
+  {
+    throw std::runtime_error(fmt::format("Snapshot references object {} of {}", index, m_Ids->size()));
+  }
+  id = (*m_Ids)[static_cast<usize>(index - 1)];
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "complex/Common/Types.hpp"
+#include "complex/DataStructure/DataObject.hpp"
+
+#include "complex/complex_export.hpp"
+
+namespace complex
+{
+/**
+ * @class SnapshotArchive
+ * @brief The SnapshotArchive class writes values to or reads values from a
+ * DataStructureSnapshot. The same calls are made in both directions, so a
+ * DataObject describes its state once in DataObject::serializeSnapshot():
+ * while saving, value() appends the argument to the archive and, while
+ * loading, assigns the next stored value to it.
+ *
+ * References to other DataObjects are stored as positions in the snapshot
+ * rather than IDs, because loading assigns new IDs. References to objects
+ * that are not part of the snapshot are stored as empty.
+ */
+class COMPLEX_EXPORT SnapshotArchive
+{
+public:
+  using IdType = DataObject::IdType;
+  using IndexMap = std::unordered_map<IdType, u64>;
+  using IdList = std::vector<IdType>;
+
+  /**
+   * @brief Creates an archive that appends to buffer. indices maps the ID of
+   * each stored object to its position, starting at 1.
+   * @param buffer
+   * @param indices
+   */
+  SnapshotArchive(std::vector<u8>& buffer, const IndexMap& indices);
+
+  /**
+   * @brief Creates an archive that reads size bytes from data. ids holds the
+   * ID of the loaded object at each position, starting at 1.
+   * @param data
+   * @param size
+   * @param ids
+   */
+  SnapshotArchive(const u8* data, usize size, const IdList& ids);
+
+  /**
+   * @brief Returns true if values are read from the archive.
+   * @return bool
+   */
+  bool isLoading() const;
+
+  /**
+   * @brief Returns true if every stored value has been read. Always true
+   * while saving.
+   * @return bool
+   */
+  bool atEnd() const;
+
+  /**
+   * @brief Writes or reads a trivially copyable value.
+   * @tparam T
+   * @param value
+   */
+  template <typename T>
+  void value(T& value)
+  {
+    static_assert(std::is_trivially_copyable_v<T>, "SnapshotArchive::value requires a trivially copyable type");
+    bytes(&value, sizeof(T));
+  }
+
+  /**
+   * @brief Writes or reads a string.
+   * @param value
+   */
+  void value(std::string& value);
+
+  /**
+   * @brief Writes or reads a reference to another DataObject.
+   * @param id
+   */
+  void reference(std::optional<IdType>& id);
+
+  /**
+   * @brief Writes or reads size raw bytes. Throws if fewer bytes are left to
+   * read.
+   * @param data
+   * @param size
+   */
+  void bytes(void* data, usize size);
+
+private:
+  std::vector<u8>* m_Buffer = nullptr;
+  const IndexMap* m_Indices = nullptr;
+  const u8* m_Data = nullptr;
+  usize m_Size = 0;
+  usize m_Position = 0;
+  const IdList* m_Ids = nullptr;
+};
+} // namespace complex
@@ -2,12 +2,38 @@
 
 #include <fmt/core.h>
 
+#include "complex/DataStructure/FileDataStore.hpp"
+
 using namespace complex;
 
 namespace
 {
 template <class T>
-IDataStore<T>* CreateDataStore(usize tupleSize, usize tupleCount, IDataAction::Mode mode)
+bool UseFileMappedStore(usize tupleSize, usize tupleCount, CreateArrayAction::StoreType storeType, usize fileMapThreshold)
+{
+  switch(storeType)
+  {
+  case CreateArrayAction::StoreType::InMemory: {
+    return false;
+  }
+  case CreateArrayAction::StoreType::FileMapped: {
+    return true;
+  }
+  case CreateArrayAction::StoreType::Auto: {
+    if(fileMapThreshold == CreateArrayAction::k_NeverFileMap)
+    {
+      return false;
+    }
+    return (tupleSize * tupleCount * sizeof(T)) >= fileMapThreshold;
+  }
+  default: {
+    throw std::runtime_error("Invalid store type");
+  }
+  }
+}
+
+template <class T>
+IDataStore<T>* CreateDataStore(usize tupleSize, usize tupleCount, IDataAction::Mode mode, CreateArrayAction::StoreType storeType, usize fileMapThreshold)
 {
   switch(mode)
   {
@@ -15,6 +41,10 @@ IDataStore<T>* CreateDataStore(usize tupleSize, usize tupleCount, IDataAction::M
     return new EmptyDataStore<T>(tupleSize, tupleCount);
   }
   case IDataAction::Mode::Execute: {
+    if(UseFileMappedStore<T>(tupleSize, tupleCount, storeType, fileMapThreshold))
+    {
+      return new FileDataStore<T>(tupleSize, tupleCount);
+    }
     return new DataStore<T>(tupleSize, tupleCount);
   }
   default: {
@@ -24,7 +54,7 @@ IDataStore<T>* CreateDataStore(usize tupleSize, usize tupleCount, IDataAction::M
 }
 
 template <class T>
-Result<> CreateArray(DataStructure& dataStructure, const std::vector<usize>& dims, const DataPath& path, IDataAction::Mode mode)
+Result<> CreateArray(DataStructure& dataStructure, const std::vector<usize>& dims, const DataPath& path, IDataAction::Mode mode, CreateArrayAction::StoreType storeType, usize fileMapThreshold)
 {
   auto parentPath = path.getParent();
 
@@ -37,7 +67,14 @@ Result<> CreateArray(DataStructure& dataStructure, const std::vector<usize>& dim
 
   std::string name = path[last];
 
-  auto* store = CreateDataStore<T>(dims[0], dims[1], mode);
+  IDataStore<T>* store = nullptr;
+  try
+  {
+    store = CreateDataStore<T>(dims[0], dims[1], mode, storeType, fileMapThreshold);
+  } catch(const std::exception& exception)
+  {
+    return {nonstd::make_unexpected(std::vector<Error>{{-3, fmt::format("Unable to allocate DataArray at \"{}\": {}", path.toString(), exception.what())}})};
+  }
   auto dataArray = dataStructure.createDataArray<T>(name, store, parentObject->getId());
   if(dataArray == nullptr)
   {
@@ -50,10 +87,12 @@ Result<> CreateArray(DataStructure& dataStructure, const std::vector<usize>& dim
 
 namespace complex
 {
-CreateArrayAction::CreateArrayAction(NumericType type, const std::vector<usize>& dims, const DataPath& path)
+CreateArrayAction::CreateArrayAction(NumericType type, const std::vector<usize>& dims, const DataPath& path, StoreType storeType, usize fileMapThreshold)
 : m_Type(type)
 , m_Dims(dims)
 , m_Path(path)
+, m_StoreType(storeType)
+, m_FileMapThreshold(fileMapThreshold)
 {
 }
 
@@ -64,34 +103,34 @@ Result<> CreateArrayAction::apply(DataStructure& dataStructure, Mode mode) const
   switch(m_Type)
   {
   case NumericType::i8: {
-    return CreateArray<i8>(dataStructure, m_Dims, m_Path, mode);
+    return CreateArray<i8>(dataStructure, m_Dims, m_Path, mode, m_StoreType, m_FileMapThreshold);
   }
   case NumericType::u8: {
-    return CreateArray<u8>(dataStructure, m_Dims, m_Path, mode);
+    return CreateArray<u8>(dataStructure, m_Dims, m_Path, mode, m_StoreType, m_FileMapThreshold);
   }
   case NumericType::i16: {
-    return CreateArray<i16>(dataStructure, m_Dims, m_Path, mode);
+    return CreateArray<i16>(dataStructure, m_Dims, m_Path, mode, m_StoreType, m_FileMapThreshold);
   }
   case NumericType::u16: {
-    return CreateArray<u16>(dataStructure, m_Dims, m_Path, mode);
+    return CreateArray<u16>(dataStructure, m_Dims, m_Path, mode, m_StoreType, m_FileMapThreshold);
   }
   case NumericType::i32: {
-    return CreateArray<i32>(dataStructure, m_Dims, m_Path, mode);
+    return CreateArray<i32>(dataStructure, m_Dims, m_Path, mode, m_StoreType, m_FileMapThreshold);
   }
   case NumericType::u32: {
-    return CreateArray<u32>(dataStructure, m_Dims, m_Path, mode);
+    return CreateArray<u32>(dataStructure, m_Dims, m_Path, mode, m_StoreType, m_FileMapThreshold);
   }
   case NumericType::i64: {
-    return CreateArray<i64>(dataStructure, m_Dims, m_Path, mode);
+    return CreateArray<i64>(dataStructure, m_Dims, m_Path, mode, m_StoreType, m_FileMapThreshold);
   }
   case NumericType::u64: {
-    return CreateArray<u64>(dataStructure, m_Dims, m_Path, mode);
+    return CreateArray<u64>(dataStructure, m_Dims, m_Path, mode, m_StoreType, m_FileMapThreshold);
   }
   case NumericType::f32: {
-    return CreateArray<f32>(dataStructure, m_Dims, m_Path, mode);
+    return CreateArray<f32>(dataStructure, m_Dims, m_Path, mode, m_StoreType, m_FileMapThreshold);
   }
   case NumericType::f64: {
-    return CreateArray<f64>(dataStructure, m_Dims, m_Path, mode);
+    return CreateArray<f64>(dataStructure, m_Dims, m_Path, mode, m_StoreType, m_FileMapThreshold);
   }
   default:
     throw std::runtime_error("Invalid type");
@@ -112,4 +151,14 @@ DataPath CreateArrayAction::path() const
 {
   return m_Path;
 }
+
+CreateArrayAction::StoreType CreateArrayAction::storeType() const
+{
+  return m_StoreType;
+}
+
+usize CreateArrayAction::fileMapThreshold() const
+{
+  return m_FileMapThreshold;
+}
 } // namespace complex
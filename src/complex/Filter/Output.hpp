@@ -1,5 +1,6 @@
 #pragma once
 
+#include <limits>
 #include <memory>
 #include <vector>
 
@@ -39,9 +40,23 @@ protected:
 class CreateArrayAction : public IDataAction
 {
 public:
+  /**
+   * @brief Specifies which IDataStore implementation backs the created array
+   * when the action is executed. Auto selects a file-mapped store once the
+   * array's size in bytes reaches the action's file map threshold.
+   */
+  enum class StoreType : u8
+  {
+    InMemory = 0,
+    FileMapped,
+    Auto
+  };
+
+  static constexpr usize k_NeverFileMap = std::numeric_limits<usize>::max();
+
   CreateArrayAction() = delete;
 
-  CreateArrayAction(NumericType type, const std::vector<usize>& dims, const DataPath& path);
+  CreateArrayAction(NumericType type, const std::vector<usize>& dims, const DataPath& path, StoreType storeType = StoreType::Auto, usize fileMapThreshold = k_NeverFileMap);
 
   ~CreateArrayAction() noexcept override;
 
@@ -75,10 +90,25 @@ public:
    */
   [[nodiscard]] DataPath path() const;
 
+  /**
+   * @brief
+   * @return
+   */
+  [[nodiscard]] StoreType storeType() const;
+
+  /**
+   * @brief Returns the size in bytes at which StoreType::Auto switches to a
+   * file-mapped store.
+   * @return
+   */
+  [[nodiscard]] usize fileMapThreshold() const;
+
 private:
   NumericType m_Type;
   std::vector<usize> m_Dims;
   DataPath m_Path;
+  StoreType m_StoreType;
+  usize m_FileMapThreshold;
 };
 
 struct OutputActions
@@ -0,0 +1,267 @@
+#include "complex/Utilities/BlockCodec.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+using namespace complex;
+
+namespace
+{
+enum class Mode : u8
+{
+  Stored = 0,
+  Compressed = 1
+};
+
+constexpr usize k_MinMatch = 4;
+constexpr usize k_MaxOffset = 65535;
+constexpr usize k_HashBits = 14;
+constexpr u8 k_MaxTokenLength = 15;
+
+u32 Read32(const u8* ptr)
+{
+  u32 value;
+  std::memcpy(&value, ptr, sizeof(value));
+  return value;
+}
+
+u32 Hash(u32 sequence)
+{
+  return (sequence * 2654435761u) >> (32 - k_HashBits);
+}
+
+/**
+ * @brief Groups the bytes of each value by significance.
+ */
+void Shuffle(const u8* source, u8* destination, usize count, usize elementSize)
+{
+  for(usize i = 0; i < count; i++)
+  {
+    for(usize b = 0; b < elementSize; b++)
+    {
+      destination[b * count + i] = source[i * elementSize + b];
+    }
+  }
+}
+
+/**
+ * @brief Reverses Shuffle().
+ */
+void Unshuffle(const u8* source, u8* destination, usize count, usize elementSize)
+{
+  for(usize i = 0; i < count; i++)
+  {
+    for(usize b = 0; b < elementSize; b++)
+    {
+      destination[i * elementSize + b] = source[b * count + i];
+    }
+  }
+}
+
+void WriteLength(std::vector<u8>& output, usize length)
+{
+  while(length >= 255)
+  {
+    output.push_back(255);
+    length -= 255;
+  }
+  output.push_back(static_cast<u8>(length));
+}
+
+usize ReadLength(const u8*& input, const u8* end)
+{
+  usize length = 0;
+  u8 byte = 255;
+  while(byte == 255)
+  {
+    if(input >= end)
+    {
+      throw std::runtime_error("Corrupt compressed block: truncated length");
+    }
+    byte = *input++;
+    length += byte;
+  }
+  return length;
+}
+
+void WriteSequence(std::vector<u8>& output, const u8* literals, usize literalCount, usize offset, usize matchLength)
+{
+  const usize matchCode = matchLength - k_MinMatch;
+  const u8 literalToken = static_cast<u8>(std::min<usize>(literalCount, k_MaxTokenLength));
+  const u8 matchToken = static_cast<u8>(std::min<usize>(matchCode, k_MaxTokenLength));
+  output.push_back(static_cast<u8>((literalToken << 4) | matchToken));
+  if(literalToken == k_MaxTokenLength)
+  {
+    WriteLength(output, literalCount - k_MaxTokenLength);
+  }
+  output.insert(output.end(), literals, literals + literalCount);
+  output.push_back(static_cast<u8>(offset & 0xFF));
+  output.push_back(static_cast<u8>(offset >> 8));
+  if(matchToken == k_MaxTokenLength)
+  {
+    WriteLength(output, matchCode - k_MaxTokenLength);
+  }
+}
+
+void WriteLastLiterals(std::vector<u8>& output, const u8* literals, usize literalCount)
+{
+  const u8 literalToken = static_cast<u8>(std::min<usize>(literalCount, k_MaxTokenLength));
+  output.push_back(static_cast<u8>(literalToken << 4));
+  if(literalToken == k_MaxTokenLength)
+  {
+    WriteLength(output, literalCount - k_MaxTokenLength);
+  }
+  output.insert(output.end(), literals, literals + literalCount);
+}
+
+void CompressLz(const u8* input, usize size, std::vector<u8>& output)
+{
+  // Positions are stored offset by one so zero marks an empty slot
+  std::vector<u32> table(usize(1) << k_HashBits, 0);
+  usize anchor = 0;
+  usize position = 0;
+  while(position + k_MinMatch <= size)
+  {
+    const u32 sequence = Read32(input + position);
+    const u32 hash = Hash(sequence);
+    const usize candidate = table[hash];
+    table[hash] = static_cast<u32>(position + 1);
+    if(candidate != 0 && position - (candidate - 1) <= k_MaxOffset && Read32(input + candidate - 1) == sequence)
+    {
+      const usize matchStart = candidate - 1;
+      usize matchLength = k_MinMatch;
+      while(position + matchLength < size && input[matchStart + matchLength] == input[position + matchLength])
+      {
+        matchLength++;
+      }
+      WriteSequence(output, input + anchor, position - anchor, position - matchStart, matchLength);
+      position += matchLength;
+      anchor = position;
+      continue;
+    }
+    // Skip ahead faster the longer no match has been found
+    position += 1 + ((position - anchor) >> 6);
+  }
+  WriteLastLiterals(output, input + anchor, size - anchor);
+}
+
+void DecompressLz(const u8* input, usize inputSize, u8* output, usize outputSize)
+{
+  const u8* inputEnd = input + inputSize;
+  usize outputPosition = 0;
+  while(input < inputEnd)
+  {
+    const u8 token = *input++;
+    usize literalCount = token >> 4;
+    if(literalCount == k_MaxTokenLength)
+    {
+      literalCount += ReadLength(input, inputEnd);
+    }
+    if(literalCount > static_cast<usize>(inputEnd - input) || literalCount > outputSize - outputPosition)
+    {
+      throw std::runtime_error("Corrupt compressed block: literals out of range");
+    }
+    std::memcpy(output + outputPosition, input, literalCount);
+    input += literalCount;
+    outputPosition += literalCount;
+    if(input == inputEnd)
+    {
+      break;
+    }
+
+    if(inputEnd - input < 2)
+    {
+      throw std::runtime_error("Corrupt compressed block: truncated offset");
+    }
+    const usize offset = input[0] | (static_cast<usize>(input[1]) << 8);
+    input += 2;
+    usize matchLength = (token & 0x0F) + k_MinMatch;
+    if((token & 0x0F) == k_MaxTokenLength)
+    {
+      matchLength += ReadLength(input, inputEnd);
+    }
+    if(offset == 0 || offset > outputPosition || matchLength > outputSize - outputPosition)
+    {
+      throw std::runtime_error("Corrupt compressed block: match out of range");
+    }
+    u8* destination = output + outputPosition;
+    const u8* source = destination - offset;
+    if(offset >= matchLength)
+    {
+      std::memcpy(destination, source, matchLength);
+    }
+    else
+    {
+      // Overlapping matches repeat the preceding bytes and must be copied in order
+      for(usize i = 0; i < matchLength; i++)
+      {
+        destination[i] = source[i];
+      }
+    }
+    outputPosition += matchLength;
+  }
+  if(outputPosition != outputSize)
+  {
+    throw std::runtime_error("Corrupt compressed block: unexpected decompressed size");
+  }
+}
+} // namespace
+
+std::vector<u8> BlockCodec::Compress(const void* data, usize byteCount, usize elementSize)
+{
+  const auto* bytes = static_cast<const u8*>(data);
+  std::vector<u8> shuffled;
+  if(elementSize > 1 && byteCount % elementSize == 0)
+  {
+    shuffled.resize(byteCount);
+    Shuffle(bytes, shuffled.data(), byteCount / elementSize, elementSize);
+    bytes = shuffled.data();
+  }
+
+  std::vector<u8> output;
+  output.reserve(byteCount / 2 + 16);
+  output.push_back(static_cast<u8>(Mode::Compressed));
+  CompressLz(bytes, byteCount, output);
+  if(output.size() > byteCount)
+  {
+    output.assign(1, static_cast<u8>(Mode::Stored));
+    output.insert(output.end(), static_cast<const u8*>(data), static_cast<const u8*>(data) + byteCount);
+  }
+  output.shrink_to_fit();
+  return output;
+}
+
+void BlockCodec::Decompress(const u8* compressed, usize compressedSize, void* destination, usize byteCount, usize elementSize)
+{
+  if(compressedSize == 0)
+  {
+    throw std::runtime_error("Corrupt compressed block: missing header");
+  }
+  auto* output = static_cast<u8*>(destination);
+  const auto mode = static_cast<Mode>(compressed[0]);
+  if(mode == Mode::Stored)
+  {
+    if(compressedSize - 1 != byteCount)
+    {
+      throw std::runtime_error("Corrupt compressed block: unexpected stored size");
+    }
+    std::memcpy(output, compressed + 1, byteCount);
+    return;
+  }
+  if(mode != Mode::Compressed)
+  {
+    throw std::runtime_error("Corrupt compressed block: unknown mode");
+  }
+
+  if(elementSize > 1 && byteCount % elementSize == 0)
+  {
+    std::vector<u8> shuffled(byteCount);
+    DecompressLz(compressed + 1, compressedSize - 1, shuffled.data(), byteCount);
+    Unshuffle(shuffled.data(), output, byteCount / elementSize, elementSize);
+  }
+  else
+  {
+    DecompressLz(compressed + 1, compressedSize - 1, output, byteCount);
+  }
+}
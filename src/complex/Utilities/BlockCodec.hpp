@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+
+#include "complex/Common/Types.hpp"
+
+#include "complex/complex_export.hpp"
+
+namespace complex
+{
+/**
+ * @brief The BlockCodec namespace holds a small self-contained LZ77 codec in
+ * the style of LZ4, intended for compressing DataStore blocks in memory. The
+ * bytes of multi-byte values are shuffled so that bytes of equal significance
+ * are adjacent before compressing, which greatly improves the ratio for
+ * integer IDs and masks. Incompressible input is stored as is, so compressed
+ * output is never more than one byte larger than the input.
+ */
+namespace BlockCodec
+{
+/**
+ * @brief Compresses byteCount bytes made up of values of elementSize bytes.
+ * @param data
+ * @param byteCount
+ * @param elementSize
+ * @return std::vector<u8>
+ */
+COMPLEX_EXPORT std::vector<u8> Compress(const void* data, usize byteCount, usize elementSize);
+
+/**
+ * @brief Decompresses data produced by Compress() into byteCount bytes at the
+ * destination. elementSize must match the value passed to Compress(). Throws
+ * std::runtime_error if the compressed data is corrupt or does not decompress
+ * to exactly byteCount bytes.
+ * @param compressed
+ * @param compressedSize
+ * @param destination
+ * @param byteCount
+ * @param elementSize
+ */
+COMPLEX_EXPORT void Decompress(const u8* compressed, usize compressedSize, void* destination, usize byteCount, usize elementSize);
+} // namespace BlockCodec
+} // namespace complex
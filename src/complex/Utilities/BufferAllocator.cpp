@@ -0,0 +1,220 @@
+#include "complex/Utilities/BufferAllocator.hpp"
+
+#include <stdexcept>
+
+#include <fmt/core.h>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <Windows.h>
+#elif defined(__linux__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <sys/syscall.h>
+#endif
+#else
+static_assert(false, "Buffer allocation not implemented on this platform");
+#endif
+
+using namespace complex;
+
+namespace
+{
+constexpr usize k_HugePageSize = 2 * 1024 * 1024;
+
+usize GetPageSize()
+{
+#if defined(_WIN32)
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return info.dwPageSize;
+#else
+  return static_cast<usize>(::sysconf(_SC_PAGESIZE));
+#endif
+}
+
+usize RoundUp(usize value, usize multiple)
+{
+  return (value + multiple - 1) / multiple * multiple;
+}
+
+/**
+ * @brief Returns true if the buffer is mapped from the operating system
+ * directly instead of going through the aligned operator new.
+ */
+bool UsesMapping(usize byteCount, usize alignment, const AllocationOptions& options)
+{
+  static const usize s_PageSize = GetPageSize();
+  if(byteCount == 0 || alignment > s_PageSize)
+  {
+    return false;
+  }
+  return options.hugePages != AllocationOptions::HugePages::None || options.numaPolicy == AllocationOptions::NumaPolicy::Interleave;
+}
+
+/**
+ * @brief Returns the number of bytes actually mapped for a buffer.
+ */
+usize MappedLength(usize byteCount, const AllocationOptions& options)
+{
+  static const usize s_PageSize = GetPageSize();
+  return RoundUp(byteCount, options.hugePages == AllocationOptions::HugePages::None ? s_PageSize : k_HugePageSize);
+}
+
+#if defined(__linux__)
+// Matches MPOL_INTERLEAVE from linux/mempolicy.h
+constexpr int k_MpolInterleave = 3;
+
+/**
+ * @brief Returns a node mask of the online NUMA nodes parsed from sysfs, e.g.
+ * "0-1,3". Returns an empty mask if the system has a single node.
+ */
+std::vector<unsigned long> GetOnlineNodeMask()
+{
+  std::vector<unsigned long> mask;
+  std::ifstream file("/sys/devices/system/node/online");
+  std::string ranges;
+  if(!std::getline(file, ranges))
+  {
+    return mask;
+  }
+
+  constexpr usize k_BitsPerWord = sizeof(unsigned long) * 8;
+  usize nodeCount = 0;
+  usize position = 0;
+  while(position < ranges.size())
+  {
+    const usize end = std::min(ranges.find(',', position), ranges.size());
+    const std::string range = ranges.substr(position, end - position);
+    const usize dash = range.find('-');
+    const usize first = std::stoul(range.substr(0, dash));
+    const usize last = (dash == std::string::npos) ? first : std::stoul(range.substr(dash + 1));
+    for(usize node = first; node <= last; node++)
+    {
+      if(mask.size() <= node / k_BitsPerWord)
+      {
+        mask.resize(node / k_BitsPerWord + 1, 0);
+      }
+      mask[node / k_BitsPerWord] |= 1ul << (node % k_BitsPerWord);
+      nodeCount++;
+    }
+    position = end + 1;
+  }
+  if(nodeCount < 2)
+  {
+    mask.clear();
+  }
+  return mask;
+}
+#endif
+
+void* MapBuffer(usize byteCount, const AllocationOptions& options)
+{
+  const usize length = MappedLength(byteCount, options);
+#if defined(_WIN32)
+  void* ptr = nullptr;
+  if(options.hugePages == AllocationOptions::HugePages::Explicit)
+  {
+    // Requires SeLockMemoryPrivilege; fall back to regular pages without it
+    const usize largePageSize = GetLargePageMinimum();
+    if(largePageSize != 0)
+    {
+      ptr = VirtualAlloc(nullptr, RoundUp(length, largePageSize), MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+    }
+  }
+  if(ptr == nullptr)
+  {
+    ptr = VirtualAlloc(nullptr, length, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+  }
+  if(ptr == nullptr)
+  {
+    throw std::bad_alloc();
+  }
+  return ptr;
+#else
+  void* ptr = MAP_FAILED;
+#if defined(__linux__)
+  if(options.hugePages == AllocationOptions::HugePages::Explicit)
+  {
+    // Fails unless huge pages were reserved through vm.nr_hugepages
+    ptr = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  }
+#endif
+  if(ptr == MAP_FAILED)
+  {
+    ptr = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  }
+  if(ptr == MAP_FAILED)
+  {
+    throw std::bad_alloc();
+  }
+#if defined(__linux__)
+  if(options.hugePages == AllocationOptions::HugePages::Transparent)
+  {
+    ::madvise(ptr, length, MADV_HUGEPAGE);
+  }
+  if(options.numaPolicy == AllocationOptions::NumaPolicy::Interleave)
+  {
+    static const std::vector<unsigned long> s_NodeMask = GetOnlineNodeMask();
+    if(!s_NodeMask.empty())
+    {
+      // Placement is best effort, so a failure leaves the default policy in place
+      ::syscall(SYS_mbind, ptr, length, k_MpolInterleave, s_NodeMask.data(), s_NodeMask.size() * sizeof(unsigned long) * 8 + 1, 0);
+    }
+  }
+#endif
+  return ptr;
+#endif
+}
+
+void UnmapBuffer(void* ptr, usize byteCount, const AllocationOptions& options) noexcept
+{
+#if defined(_WIN32)
+  VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+  ::munmap(ptr, MappedLength(byteCount, options));
+#endif
+}
+} // namespace
+
+bool AllocationOptions::operator==(const AllocationOptions& rhs) const
+{
+  return alignment == rhs.alignment && hugePages == rhs.hugePages && numaPolicy == rhs.numaPolicy;
+}
+
+bool AllocationOptions::operator!=(const AllocationOptions& rhs) const
+{
+  return !(*this == rhs);
+}
+
+void* BufferAllocation::Allocate(usize byteCount, usize alignment, const AllocationOptions& options)
+{
+  if(alignment == 0 || (alignment & (alignment - 1)) != 0)
+  {
+    throw std::runtime_error(fmt::format("Buffer alignment must be a power of two, got {}", alignment));
+  }
+  if(UsesMapping(byteCount, alignment, options))
+  {
+    return MapBuffer(byteCount, options);
+  }
+  return ::operator new(byteCount, std::align_val_t(alignment));
+}
+
+void BufferAllocation::Deallocate(void* ptr, usize byteCount, usize alignment, const AllocationOptions& options) noexcept
+{
+  if(ptr == nullptr)
+  {
+    return;
+  }
+  if(UsesMapping(byteCount, alignment, options))
+  {
+    UnmapBuffer(ptr, byteCount, options);
+    return;
+  }
+  ::operator delete(ptr, std::align_val_t(alignment));
+}
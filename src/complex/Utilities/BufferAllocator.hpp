@@ -0,0 +1,192 @@
+#pragma once
+
+#include <algorithm>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "complex/Common/Types.hpp"
+
+#include "complex/complex_export.hpp"
+
+namespace complex
+{
+/**
+ * @brief Describes how BufferAllocator allocates memory for large buffers.
+ */
+struct COMPLEX_EXPORT AllocationOptions
+{
+  /**
+   * @brief Huge page usage. Transparent advises the kernel to back the buffer
+   * with transparent huge pages. Explicit requests huge pages directly and
+   * falls back to regular pages if none are available.
+   */
+  enum class HugePages : u8
+  {
+    None = 0,
+    Transparent,
+    Explicit
+  };
+
+  /**
+   * @brief NUMA placement. FirstTouch leaves placement to the operating
+   * system, which places each page on the node of the thread that first
+   * writes it. DataStores initialize and fill large buffers in parallel
+   * slices, so FirstTouch partitions a buffer across the nodes of the
+   * threads that processed it. Interleave spreads pages round-robin across
+   * all nodes, which balances bandwidth when access patterns are unknown.
+   */
+  enum class NumaPolicy : u8
+  {
+    FirstTouch = 0,
+    Interleave
+  };
+
+  static constexpr usize k_DefaultAlignment = 64;
+
+  usize alignment = k_DefaultAlignment;
+  HugePages hugePages = HugePages::None;
+  NumaPolicy numaPolicy = NumaPolicy::FirstTouch;
+
+  bool operator==(const AllocationOptions& rhs) const;
+  bool operator!=(const AllocationOptions& rhs) const;
+};
+
+namespace BufferAllocation
+{
+/**
+ * @brief Allocates byteCount bytes aligned to at least alignment bytes
+ * according to the provided options. Huge page and NUMA options are applied
+ * where the platform supports them and ignored otherwise. Throws
+ * std::bad_alloc on failure.
+ * @param byteCount
+ * @param alignment
+ * @param options
+ * @return void*
+ */
+COMPLEX_EXPORT void* Allocate(usize byteCount, usize alignment, const AllocationOptions& options);
+
+/**
+ * @brief Frees memory returned by Allocate(). byteCount, alignment and
+ * options must match the values passed to Allocate().
+ * @param ptr
+ * @param byteCount
+ * @param alignment
+ * @param options
+ */
+COMPLEX_EXPORT void Deallocate(void* ptr, usize byteCount, usize alignment, const AllocationOptions& options) noexcept;
+} // namespace BufferAllocation
+
+/**
+ * @class BufferAllocator
+ * @brief The BufferAllocator class is a stateful allocator that allocates
+ * through BufferAllocation using a set of AllocationOptions. Like
+ * DefaultInitAllocator, it default-initializes values so that buffers can be
+ * initialized in parallel after allocation.
+ * @tparam T
+ */
+template <class T>
+class BufferAllocator
+{
+public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+  using is_always_equal = std::false_type;
+
+  BufferAllocator() noexcept = default;
+
+  /**
+   * @brief Constructs a BufferAllocator using the specified options.
+   * @param options
+   */
+  explicit BufferAllocator(const AllocationOptions& options) noexcept
+  : m_Options(options)
+  {
+  }
+
+  template <class U>
+  BufferAllocator(const BufferAllocator<U>& other) noexcept
+  : m_Options(other.getOptions())
+  {
+  }
+
+  /**
+   * @brief Returns the options used for allocating.
+   * @return const AllocationOptions&
+   */
+  const AllocationOptions& getOptions() const noexcept
+  {
+    return m_Options;
+  }
+
+  /**
+   * @brief Allocates space for count values.
+   * @param count
+   * @return T*
+   */
+  T* allocate(usize count)
+  {
+    return static_cast<T*>(BufferAllocation::Allocate(count * sizeof(T), alignment(), m_Options));
+  }
+
+  /**
+   * @brief Frees space for count values previously returned by allocate().
+   * @param ptr
+   * @param count
+   */
+  void deallocate(T* ptr, usize count) noexcept
+  {
+    BufferAllocation::Deallocate(ptr, count * sizeof(T), alignment(), m_Options);
+  }
+
+  /**
+   * @brief Default-initializes the value at the specified address.
+   * @tparam U
+   * @param ptr
+   */
+  template <class U>
+  void construct(U* ptr) noexcept(std::is_nothrow_default_constructible_v<U>)
+  {
+    ::new(static_cast<void*>(ptr)) U;
+  }
+
+  /**
+   * @brief Constructs the value at the specified address from the provided arguments.
+   * @tparam U
+   * @tparam ArgsT
+   * @param ptr
+   * @param args
+   */
+  template <class U, class... ArgsT>
+  void construct(U* ptr, ArgsT&&... args)
+  {
+    ::new(static_cast<void*>(ptr)) U(std::forward<ArgsT>(args)...);
+  }
+
+  template <class U>
+  bool operator==(const BufferAllocator<U>& rhs) const noexcept
+  {
+    return m_Options == rhs.getOptions();
+  }
+
+  template <class U>
+  bool operator!=(const BufferAllocator<U>& rhs) const noexcept
+  {
+    return !(*this == rhs);
+  }
+
+private:
+  /**
+   * @brief Returns the alignment to use for values of type T.
+   * @return usize
+   */
+  usize alignment() const noexcept
+  {
+    return std::max<usize>(m_Options.alignment, alignof(T));
+  }
+
+  AllocationOptions m_Options;
+};
+} // namespace complex
@@ -0,0 +1,35 @@
+#include "complex/Utilities/BulkCopy.hpp"
+
+#include <cstring>
+
+#include "complex/Utilities/ThreadPool.hpp"
+
+using namespace complex;
+
+namespace
+{
+// Slice boundaries are rounded to cache lines so no two threads write the same line
+constexpr usize k_CacheLineSize = 64;
+} // namespace
+
+void BulkCopy::ForEachSlice(usize count, usize minSliceCount, usize granularity, const std::function<void(usize, usize)>& function)
+{
+  ThreadPool::Global().parallelFor(count, minSliceCount, granularity, function);
+}
+
+void BulkCopy::CopyBytes(const void* source, void* destination, usize byteCount, usize parallelThreshold, usize minSliceSize)
+{
+  if(byteCount == 0)
+  {
+    return;
+  }
+  if(byteCount < parallelThreshold)
+  {
+    std::memcpy(destination, source, byteCount);
+    return;
+  }
+
+  const auto* sourceBytes = static_cast<const u8*>(source);
+  auto* destinationBytes = static_cast<u8*>(destination);
+  ForEachSlice(byteCount, minSliceSize, k_CacheLineSize, [=](usize begin, usize end) { std::memcpy(destinationBytes + begin, sourceBytes + begin, end - begin); });
+}
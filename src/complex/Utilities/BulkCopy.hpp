@@ -0,0 +1,145 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+
+#include "complex/Common/Types.hpp"
+#include "complex/DataStructure/IDataStore.hpp"
+
+#include "complex/complex_export.hpp"
+
+namespace complex
+{
+namespace BulkCopy
+{
+/**
+ * @brief Copies below this many bytes are always performed on the calling thread.
+ */
+inline constexpr usize k_ParallelCopyThreshold = 64 * 1024 * 1024;
+
+/**
+ * @brief Parallel copies are not split into slices smaller than this many
+ * bytes, which would not amortize the cost of handing them to another thread.
+ */
+inline constexpr usize k_MinCopySliceSize = 16 * 1024 * 1024;
+
+/**
+ * @brief Splits the range [0, count) into contiguous slices and calls the
+ * function with the begin and end of each slice on the shared ThreadPool. Slices
+ * hold at least minSliceCount items and, apart from the last one, a multiple
+ * of granularity items. Ranges too small to split are handled on the calling
+ * thread. Because each thread writes its own slice, buffers initialized this
+ * way are placed on the NUMA node of the thread that first touches them.
+ * @param count
+ * @param minSliceCount
+ * @param granularity
+ * @param function
+ */
+COMPLEX_EXPORT void ForEachSlice(usize count, usize minSliceCount, usize granularity, const std::function<void(usize, usize)>& function);
+
+/**
+ * @brief Copies the specified number of bytes between non-overlapping
+ * buffers. Copies of at least parallelThreshold bytes are split into
+ * contiguous slices of at least minSliceSize bytes that are copied
+ * concurrently.
+ * @param source
+ * @param destination
+ * @param byteCount
+ * @param parallelThreshold = k_ParallelCopyThreshold
+ * @param minSliceSize = k_MinCopySliceSize
+ */
+COMPLEX_EXPORT void CopyBytes(const void* source, void* destination, usize byteCount, usize parallelThreshold = k_ParallelCopyThreshold, usize minSliceSize = k_MinCopySliceSize);
+
+/**
+ * @brief Copies count values between non-overlapping buffers. Trivially
+ * copyable types are copied with CopyBytes. Other types are copied
+ * element-wise on the calling thread.
+ * @tparam T
+ * @param source
+ * @param destination
+ * @param count
+ * @param parallelThreshold = k_ParallelCopyThreshold
+ * @param minSliceSize = k_MinCopySliceSize
+ */
+template <class T>
+void CopyValues(const T* source, T* destination, usize count, usize parallelThreshold = k_ParallelCopyThreshold, usize minSliceSize = k_MinCopySliceSize)
+{
+  if constexpr(std::is_trivially_copyable_v<T>)
+  {
+    CopyBytes(source, destination, count * sizeof(T), parallelThreshold, minSliceSize);
+  }
+  else
+  {
+    std::copy(source, source + count, destination);
+  }
+}
+
+/**
+ * @brief Sets count values starting at destination to the specified value.
+ * Fills of at least parallelThreshold bytes are split into contiguous slices
+ * that are written concurrently, which also distributes first-touch page
+ * placement across the threads.
+ * @tparam T
+ * @param destination
+ * @param count
+ * @param value
+ * @param parallelThreshold = k_ParallelCopyThreshold
+ */
+template <class T>
+void FillValues(T* destination, usize count, const T& value, usize parallelThreshold = k_ParallelCopyThreshold)
+{
+  if(count * sizeof(T) < parallelThreshold)
+  {
+    std::fill(destination, destination + count, value);
+    return;
+  }
+  const usize minSliceCount = std::max<usize>(parallelThreshold / sizeof(T) / 4, 1);
+  const usize granularity = std::max<usize>(64 / sizeof(T), 1);
+  ForEachSlice(count, minSliceCount, granularity, [destination, &value](usize begin, usize end) { std::fill(destination + begin, destination + end, value); });
+}
+
+/**
+ * @brief Copies all values from one store into another store of the same
+ * value type. Contiguous stores are copied in bulk. Otherwise, values are
+ * copied through whichever side exposes a contiguous buffer, falling back to
+ * the virtual per-element accessors. The destination must hold at least as
+ * many values as the source.
+ * @tparam T
+ * @param source
+ * @param destination
+ */
+template <class T>
+void CopyStore(const IDataStore<T>& source, IDataStore<T>& destination)
+{
+  const usize count = source.getSize();
+  const T* sourceData = source.data();
+  T* destinationData = destination.data();
+  if(sourceData != nullptr && destinationData != nullptr)
+  {
+    CopyValues(sourceData, destinationData, count);
+  }
+  else if(sourceData != nullptr)
+  {
+    for(usize i = 0; i < count; i++)
+    {
+      destination[i] = sourceData[i];
+    }
+  }
+  else if(destinationData != nullptr)
+  {
+    for(usize i = 0; i < count; i++)
+    {
+      destinationData[i] = source[i];
+    }
+  }
+  else
+  {
+    for(usize i = 0; i < count; i++)
+    {
+      destination[i] = source[i];
+    }
+  }
+}
+} // namespace BulkCopy
+} // namespace complex
@@ -1,10 +1,22 @@
 #pragma once
 
-#include "Eigen/Dense"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
 
 #include "complex/Common/Array.hpp"
+#include "complex/Common/DefaultInitAllocator.hpp"
 #include "complex/DataStructure/DataArray.hpp"
-#include "complex/Utilities/Math/GeometryMath.hpp"
+#include "complex/DataStructure/Geometry/AbstractGeometry.hpp"
+#include "complex/Utilities/ParallelAlgorithms.hpp"
+#include "complex/Utilities/ThreadPool.hpp"
 
 namespace complex
 {
@@ -15,811 +27,987 @@ using ErrorCode = int32_t;
 namespace Connectivity
 {
 /**
- * @brief
- * @tparam T
- * @tparam K
- * @param elemList
- * @param dynamicList
- * @param numVerts
+ * @brief Local vertex indices of the facets of an element type, e.g. its
+ * edges or faces. Facets have at most four vertices.
  */
-template <typename T, typename K>
-void FindElementsContainingVert(const DataArray<K>* elemList, DynamicListArray<T, K>* dynamicList, size_t numVerts)
+struct ElementFacets
 {
-  DataStructure* dataStructure = dynamicList->getDataStructure();
-  auto parentId = dynamicList->getParents().front()->getId();
+  usize verticesPerElement = 0;
+  usize verticesPerFacet = 0;
+  std::vector<std::array<u8, 4>> facets;
+};
 
-  auto& elems = *elemList;
-  const size_t numElems = elemList->getTupleCount();
-  const size_t numVertsPerElem = elemList->getTupleSize();
+/**
+ * @brief Returns the facets through which two elements of the specified
+ * geometry type are connected: vertices for edges, edges for triangles and
+ * quads and faces for tetrahedra and hexahedra. Returns an empty optional if
+ * the type has no explicit elements.
+ * Hexahedra follow the VTK vertex ordering.
+ * @param geometryType
+ * @return std::optional<ElementFacets>
+ */
+inline std::optional<ElementFacets> GetElementFacets(AbstractGeometry::Type geometryType)
+{
+  switch(geometryType)
+  {
+  case AbstractGeometry::Type::Edge:
+    return ElementFacets{2, 1, {{0}, {1}}};
+  case AbstractGeometry::Type::Triangle:
+    return ElementFacets{3, 2, {{0, 1}, {1, 2}, {2, 0}}};
+  case AbstractGeometry::Type::Quad:
+    return ElementFacets{4, 2, {{0, 1}, {1, 2}, {2, 3}, {3, 0}}};
+  case AbstractGeometry::Type::Tetrahedral:
+    return ElementFacets{4, 3, {{0, 1, 2}, {1, 2, 3}, {0, 2, 3}, {0, 1, 3}}};
+  case AbstractGeometry::Type::Hexahedral:
+    return ElementFacets{8, 4, {{0, 1, 5, 4}, {1, 2, 6, 5}, {2, 3, 7, 6}, {3, 0, 4, 7}, {0, 1, 2, 3}, {4, 5, 6, 7}}};
+  default:
+    return {};
+  }
+}
 
-  // Allocate the basic structures
-  std::vector<T> linkCount(numVerts, 0);
+/**
+ * @brief Edges of a tetrahedron.
+ * @return ElementFacets
+ */
+inline ElementFacets TetEdges()
+{
+  return ElementFacets{4, 2, {{0, 1}, {0, 2}, {1, 2}, {0, 3}, {1, 3}, {2, 3}}};
+}
 
-  // Fill out lists with number of references to cells
-  auto dataStore = new DataStore<K>(1, numVerts);
-  DataArray<K>* linkLocPtr = dataStructure->createDataArray<K>("_INTERNAL_USE_ONLY_Vertices", dataStore, parentId);
-  linkLocPtr->getDataStore()->fill(0);
-  auto linkLoc = *linkLocPtr;
-  K* verts = nullptr;
+/**
+ * @brief Edges of a hexahedron.
+ * @return ElementFacets
+ */
+inline ElementFacets HexEdges()
+{
+  return ElementFacets{8, 2, {{0, 1}, {1, 2}, {2, 3}, {3, 0}, {0, 4}, {1, 5}, {2, 6}, {3, 7}, {4, 5}, {5, 6}, {6, 7}, {7, 4}}};
+}
 
-  // vtkPolyData *pdata = static_cast<vtkPolyData *>(data);
-  // Traverse data to determine number of uses of each point
-  for(size_t elemId = 0; elemId < numElems; elemId++)
+/**
+ * @brief Edges of a polygon with the specified number of vertices.
+ * @param numVertsPerElem
+ * @return ElementFacets
+ */
+inline ElementFacets PolygonEdges(usize numVertsPerElem)
+{
+  ElementFacets elementFacets{numVertsPerElem, 2, {}};
+  for(usize j = 0; j < numVertsPerElem; j++)
   {
-    size_t offset = elemId * numVertsPerElem;
-    for(size_t j = 0; j < numVertsPerElem; j++)
-    {
-      linkCount[elems[offset + j]]++;
-    }
+    elementFacets.facets.push_back({static_cast<u8>(j), static_cast<u8>((j + 1) % numVertsPerElem)});
   }
+  return elementFacets;
+}
 
-  // Now allocate storage for the links
-  dynamicList->allocateLists(linkCount);
+namespace detail
+{
+// Grain size in elements that keeps slices large enough to be worth handing to another thread
+inline constexpr usize k_MinSliceCount = 16 * 1024;
 
-  for(size_t elemId = 0; elemId < numElems; elemId++)
+/**
+ * @brief Returns the vertex ids of a facet of an element in ascending order.
+ * Unused trailing entries are zero.
+ * @tparam K
+ * @param element
+ * @param facet
+ * @param verticesPerFacet
+ * @return std::array<K, 4>
+ */
+template <typename K>
+std::array<K, 4> FacetKey(const K* element, const std::array<u8, 4>& facet, usize verticesPerFacet)
+{
+  std::array<K, 4> key = {0, 0, 0, 0};
+  for(usize i = 0; i < verticesPerFacet; i++)
   {
-    size_t offset = elemId * numVertsPerElem;
-    for(size_t j = 0; j < numVertsPerElem; j++)
-    {
-      dynamicList->insertCellReference(elems[offset + j], (linkLoc[elems[offset + j]])++, elemId);
-    }
+    key[i] = element[facet[i]];
   }
+  std::sort(key.begin(), key.begin() + verticesPerFacet);
+  return key;
 }
 
 /**
- * @brief
- * @tparam T
+ * @brief Returns a pointer to all values of the store. Stores without a
+ * contiguous buffer are not safe for concurrent reads, so their values are
+ * copied into buffer first.
  * @tparam K
- * @param elemList
- * @param elemsContainingVert
- * @param dynamicList
- * @param geometryType
- * @return int32_t
+ * @param store
+ * @param buffer
+ * @return const K*
  */
-template <typename T, typename K>
-ErrorCode FindElementNeighbors(const DataArray<K>* elemList, const DynamicListArray<T, K>* elemsContainingVert, DynamicListArray<T, K>* dynamicList, AbstractGeometry::Type geometryType)
+template <typename K>
+const K* GetContiguousValues(const IDataStore<K>& store, std::vector<K>& buffer)
 {
-  DataStructure* dataStructure = dynamicList->getDataStructure();
-  auto parentId = dynamicList->getParents().front()->getId();
-  auto& elems = *elemList;
-  const size_t numElems = elemList->getTupleCount();
-  const size_t numVertsPerElem = elemList->getTupleSize();
-  size_t numSharedVerts = 0;
-  std::vector<T> linkCount(numElems, 0);
-  ErrorCode err = 0;
-
-  switch(geometryType)
-  {
-  case AbstractGeometry::Type::Edge: // edges
-  {
-    numSharedVerts = 1;
-    break;
-  }
-  case AbstractGeometry::Type::Triangle: // triangles
-  {
-    numSharedVerts = 2;
-    break;
-  }
-  case AbstractGeometry::Type::Quad: // quadrilaterals
-  {
-    numSharedVerts = 2;
-    break;
-  }
-  case AbstractGeometry::Type::Tetrahedral: // tetrahedra
+  if(const K* data = store.data(); data != nullptr)
   {
-    numSharedVerts = 3;
-    break;
+    return data;
   }
-  case AbstractGeometry::Type::Hexahedral: // hexahedra
+  buffer.resize(store.getSize());
+  for(usize i = 0; i < buffer.size(); i++)
   {
-    numSharedVerts = 4;
-    break;
-  }
-  default:
-    numSharedVerts = 0;
-    break;
-  }
-
-  if(numSharedVerts == 0)
-  {
-    return -1;
+    buffer[i] = store[i];
   }
+  return buffer.data();
+}
 
-  dynamicList->allocateLists(linkCount);
+/**
+ * @brief Returns the vertex ids of a facet in ascending order. Facets are
+ * identified by elemId * the number of facets per element + the local facet
+ * index.
+ * @tparam K
+ * @param elems
+ * @param elementFacets
+ * @param facetId
+ * @return std::array<K, 4>
+ */
+template <typename K>
+std::array<K, 4> FacetKey(const K* elems, const ElementFacets& elementFacets, u64 facetId)
+{
+  const usize numFacetsPerElem = elementFacets.facets.size();
+  const usize elemId = facetId / numFacetsPerElem;
+  return FacetKey(elems + elemId * elementFacets.verticesPerElement, elementFacets.facets[facetId % numFacetsPerElem], elementFacets.verticesPerFacet);
+}
 
-  // Allocate an array of bools that we use each iteration so that we don't put duplicates into the array
-  auto visitedDataStore = new DataStore<uint8_t>(1, numElems);
-  DataArray<uint8_t>* visitedPtr = dataStructure->createDataArray<uint8_t>("_INTERNAL_USE_ONLY_Visited", visitedDataStore, parentId);
-  visitedDataStore->fill(0);
-  auto& visited = *visitedPtr;
+/**
+ * @brief The facets of all elements of a mesh ordered by their sorted vertex
+ * ids and then by facet id, so that equal facets are adjacent. The facets are
+ * grouped into one bucket per smallest vertex. Equal facets never span
+ * buckets, so buckets can be processed independently.
+ */
+struct SortedFacets
+{
+  std::vector<usize> bucketOffsets;
+  std::vector<u64, DefaultInitAllocator<u64>> facetIds;
+};
 
-  // Reuse this vector for each loop. Avoids re-allocating the memory each time through the loop
-  std::vector<K> loop_neighbors(32, 0);
+/**
+ * @brief Sorts the facets of all elements in parallel. The facets are
+ * distributed into buckets by their smallest vertex with a counting sort,
+ * which acts as the most significant radix pass, and each bucket is then
+ * sorted by the remaining vertices. No memory is allocated per element.
+ * @tparam K
+ * @param elems
+ * @param numElems
+ * @param elementFacets
+ * @param numVerts Must be greater than every vertex id
+ * @return SortedFacets
+ */
+template <typename K>
+SortedFacets SortFacets(const K* elems, usize numElems, const ElementFacets& elementFacets, usize numVerts)
+{
+  ThreadPool& pool = ThreadPool::Global();
+  const usize numFacets = numElems * elementFacets.facets.size();
 
-  // Build up the element adjacency list now that we have the element links
-  for(size_t t = 0; t < numElems; ++t)
-  {
-    //   qDebug() << "Analyzing Cell " << t << "\n";
-    const size_t offset = t * numVertsPerElem;
-    for(size_t v = 0; v < numVertsPerElem; ++v)
+  std::vector<std::atomic<u32>> bucketCounts(numVerts);
+  pool.parallelFor(numFacets, k_MinSliceCount, 1, [&](usize begin, usize end) {
+    for(u64 facetId = begin; facetId < end; facetId++)
     {
-      //   qDebug() << " vert " << v << "\n";
-      T nEs = elemsContainingVert->getNumberOfElements(elems[offset + v]);
-      K* vertIdxs = elemsContainingVert->getElementListPointer(elems[offset + v]);
+      bucketCounts[FacetKey(elems, elementFacets, facetId)[0]].fetch_add(1, std::memory_order_relaxed);
+    }
+  });
 
-      for(T vt = 0; vt < nEs; ++vt)
-      {
-        if(vertIdxs[vt] == static_cast<K>(t))
-        {
-          continue;
-        } // This is the same element as our "source"
-        if(visited[vertIdxs[vt]])
-        {
-          continue;
-        } // We already added this element so loop again
-        //      qDebug() << "   Comparing Element " << vertIdxs[vt] << "\n";
-        size_t vCount = 0;
-        // Loop over all the vertex indices of this element and try to match numSharedVerts of them to the current loop element
-        // If there is numSharedVerts match then that element is a neighbor of the source. If there are more than numVertsPerElem
-        // matches then there is a real problem with the mesh and the program is going to return an error.
-        for(size_t i = 0; i < numVertsPerElem; i++)
-        {
-          for(size_t j = 0; j < numVertsPerElem; j++)
-          {
-            if(elems[offset + i] == elems[offset + j])
-            {
-              vCount++;
-            }
-          }
-        }
+  SortedFacets sortedFacets;
+  sortedFacets.bucketOffsets.resize(numVerts + 1);
+  sortedFacets.bucketOffsets[numVerts] = ParallelAlgorithms::ExclusiveScan(bucketCounts.data(), numVerts, sortedFacets.bucketOffsets.data());
+  sortedFacets.facetIds.resize(numFacets);
+  const std::vector<usize>& bucketOffsets = sortedFacets.bucketOffsets;
+  auto& facetIds = sortedFacets.facetIds;
 
-        // So if our vertex match count is numSharedVerts and we have not visited the element in question then add this element index
-        // into the list of vertex indices as neighbors for the source element.
-        if(vCount == numSharedVerts)
-        {
-          // qDebug() << "       Neighbor: " << vertIdxs[vt] << "\n";
-          // Use the current count of neighbors as the index
-          // into the loop_neighbors vector and place the value of the vertex element at that index
-          loop_neighbors[linkCount[t]] = vertIdxs[vt];
-          linkCount[t]++; // Increment the count for the next time through
-          if(linkCount[t] >= loop_neighbors.size())
-          {
-            loop_neighbors.resize(loop_neighbors.size() + 10);
-          }
-          visited[vertIdxs[vt]] = true; // Set this element as visited so we do NOT add it again
-        }
-      }
-    }
-    // Reset all the visited cell indexs back to false (zero)
-    for(int64_t k = 0; k < linkCount[t]; ++k)
+  pool.parallelFor(numFacets, k_MinSliceCount, 1, [&](usize begin, usize end) {
+    for(u64 facetId = begin; facetId < end; facetId++)
     {
-      visited[loop_neighbors[k]] = false;
+      const K vert = FacetKey(elems, elementFacets, facetId)[0];
+      facetIds[bucketOffsets[vert] + bucketCounts[vert].fetch_sub(1, std::memory_order_relaxed) - 1] = facetId;
     }
-    // Allocate the array storage for the current edge to hold its vertex list
-    dynamicList->setElementList(t, linkCount[t], &(loop_neighbors[0]));
-  }
+  });
 
-  return err;
+  pool.parallelFor(numVerts, k_MinSliceCount, 1, [&](usize begin, usize end) {
+    std::vector<std::pair<std::array<K, 4>, u64>> bucket;
+    for(usize vert = begin; vert < end; vert++)
+    {
+      bucket.clear();
+      for(usize i = bucketOffsets[vert]; i < bucketOffsets[vert + 1]; i++)
+      {
+        bucket.emplace_back(FacetKey(elems, elementFacets, facetIds[i]), facetIds[i]);
+      }
+      std::sort(bucket.begin(), bucket.end());
+      for(usize i = 0; i < bucket.size(); i++)
+      {
+        facetIds[bucketOffsets[vert] + i] = bucket[i].second;
+      }
+    }
+  });
+  return sortedFacets;
 }
 
 /**
- * @brief
- * @tparam T
- * @param tetList
- * @param edgeList
+ * @brief Calls visit(runBegin, runEnd) for every run of equal facets in the
+ * buckets [beginBucket, endBucket), where the run is a range of indices into
+ * sortedFacets.facetIds.
+ * @tparam K
+ * @tparam VisitT
+ * @param elems
+ * @param elementFacets
+ * @param sortedFacets
+ * @param beginBucket
+ * @param endBucket
+ * @param visit
  */
-template <typename T>
-void FindTetEdges(const DataArray<T>* tetList, DataArray<T>* edgeList)
+template <typename K, typename VisitT>
+void ForEachFacetRun(const K* elems, const ElementFacets& elementFacets, const SortedFacets& sortedFacets, usize beginBucket, usize endBucket, const VisitT& visit)
 {
-  const size_t numElems = tetList->getTupleCount();
-  const size_t numVertsPerTet = tetList->getTupleSize();
-  auto& tets = *tetList;
-
-  std::pair<T, T> edge;
-  std::set<std::pair<T, T>> edgeSet;
-
-  for(size_t i = 0; i < numElems; i++)
+  const usize end = sortedFacets.bucketOffsets[endBucket];
+  for(usize run = sortedFacets.bucketOffsets[beginBucket]; run < end;)
   {
-    const size_t offset = i * numVertsPerTet;
-
-    std::vector<T> edge0 = {tets[offset + 0], tets[offset + 1]};
-    std::vector<T> edge1 = {tets[offset + 0], tets[offset + 2]};
-    std::vector<T> edge2 = {tets[offset + 1], tets[offset + 2]};
-    std::vector<T> edge3 = {tets[offset + 0], tets[offset + 3]};
-    std::vector<T> edge4 = {tets[offset + 1], tets[offset + 3]};
-    std::vector<T> edge5 = {tets[offset + 2], tets[offset + 3]};
-    std::list<std::vector<T>> edgeList = {edge0, edge1, edge2, edge3, edge4, edge5};
-
-    for(auto&& uEdge : edgeList)
+    const std::array<K, 4> key = FacetKey(elems, elementFacets, sortedFacets.facetIds[run]);
+    usize runEnd = run + 1;
+    while(runEnd < end && FacetKey(elems, elementFacets, sortedFacets.facetIds[runEnd]) == key)
     {
-      std::sort(uEdge.begin(), uEdge.end());
-      edge = std::make_pair(uEdge[0], uEdge[1]);
-      edgeSet.insert(edge);
+      runEnd++;
     }
+    visit(run, runEnd);
+    run = runEnd;
   }
+}
 
-  edgeList->getDataStore()->resizeTuples(edgeSet.size());
-  auto& uEdges = *edgeList;
-  T index = 0;
+} // namespace detail
 
-  for(auto& edge : edgeSet)
-  {
-    uEdges[2 * index] = edge.first;
-    uEdges[2 * index + 1] = edge.second;
-    ++index;
-  }
-}
+/**
+ * @brief Selects which facets FindUniqueFacets() writes.
+ */
+enum class FacetSelection : u8
+{
+  All = 0,
+  Unshared
+};
 
 /**
- * @brief
+ * @brief Writes each distinct facet of the elements in elemList to
+ * facetList, as its vertex ids in ascending order, with the facets in
+ * lexicographic order. Unshared selects the facets used by exactly one
+ * element. If occurrenceCounts is provided, it receives the number of
+ * elements using each written facet, counted in the same pass. Runs in
+ * parallel on the shared ThreadPool. Returns -1 without modifying facetList
+ * if elemList does not have the number of vertices per element expected by
+ * elementFacets or holds a negative vertex id.
  * @tparam T
- * @param hexList
- * @param edge_List
+ * @param elemList
+ * @param elementFacets
+ * @param facetList
+ * @param selection
+ * @param occurrenceCounts = nullptr
+ * @return ErrorCode
  */
 template <typename T>
-void FindHexEdges(const DataArray<T>* hexList, DataArray<T>* edge_List)
+ErrorCode FindUniqueFacets(const DataArray<T>* elemList, const ElementFacets& elementFacets, DataArray<T>* facetList, FacetSelection selection, std::vector<u32>* occurrenceCounts = nullptr)
 {
-  const size_t numElems = hexList->getTupleCount();
-  const size_t numVertsPerHex = hexList->getTupleSize();
-
-  auto& hexas = *hexList;
-
-  std::pair<T, T> edge;
-  std::set<std::pair<T, T>> edgeSet;
-
-  for(size_t i = 0; i < numElems; i++)
+  if(elemList->getTupleSize() != elementFacets.verticesPerElement)
   {
-    const size_t offset = i * numVertsPerHex;
-
-    std::vector<T> edge0 = {hexas[offset + 0], hexas[offset + 1]};
-    std::vector<T> edge1 = {hexas[offset + 1], hexas[offset + 2]};
-    std::vector<T> edge2 = {hexas[offset + 2], hexas[offset + 3]};
-    std::vector<T> edge3 = {hexas[offset + 3], hexas[offset + 0]};
+    return -1;
+  }
 
-    std::vector<T> edge4 = {hexas[offset + 0], hexas[offset + 4]};
-    std::vector<T> edge5 = {hexas[offset + 1], hexas[offset + 5]};
-    std::vector<T> edge6 = {hexas[offset + 2], hexas[offset + 6]};
-    std::vector<T> edge7 = {hexas[offset + 3], hexas[offset + 7]};
+  const usize numElems = elemList->getTupleCount();
+  const usize numVertsPerFacet = elementFacets.verticesPerFacet;
+  usize numVerts = 0;
+  if(numElems > 0)
+  {
+    // Vertex ids index the buckets of the facet sort
+    const auto [minVert, maxVert] = ParallelAlgorithms::MinMax(*elemList->getDataStore());
+    if constexpr(std::is_signed_v<T>)
+    {
+      if(minVert < 0)
+      {
+        return -1;
+      }
+    }
+    numVerts = static_cast<usize>(maxVert) + 1;
+  }
+  std::vector<T> elemBuffer;
+  const T* elems = detail::GetContiguousValues(*elemList->getDataStore(), elemBuffer);
 
-    std::vector<T> edge8 = {hexas[offset + 4], hexas[offset + 5]};
-    std::vector<T> edge9 = {hexas[offset + 5], hexas[offset + 6]};
-    std::vector<T> edge10 = {hexas[offset + 6], hexas[offset + 7]};
-    std::vector<T> edge11 = {hexas[offset + 7], hexas[offset + 4]};
+  const detail::SortedFacets sortedFacets = detail::SortFacets(elems, numElems, elementFacets, numVerts);
 
-    std::list<std::vector<T>> edgeList = {edge0, edge1, edge2, edge3, edge4, edge5, edge6, edge7, edge8, edge9, edge10, edge11};
+  auto isSelected = [selection](usize runLength) { return selection == FacetSelection::All || runLength == 1; };
 
-    for(auto&& uEdge : edgeList)
+  // Count the selected facets per bucket, then write each bucket's facets at its offset
+  ThreadPool& pool = ThreadPool::Global();
+  std::vector<usize> outputOffsets(numVerts + 1, 0);
+  pool.parallelFor(numVerts, detail::k_MinSliceCount, 1, [&](usize begin, usize end) {
+    for(usize vert = begin; vert < end; vert++)
     {
-      std::sort(uEdge.begin(), uEdge.end());
-      edge = std::make_pair(uEdge[0], uEdge[1]);
-      edgeSet.insert(edge);
+      detail::ForEachFacetRun(elems, elementFacets, sortedFacets, vert, vert + 1, [&](usize runBegin, usize runEnd) {
+        if(isSelected(runEnd - runBegin))
+        {
+          outputOffsets[vert]++;
+        }
+      });
     }
-  }
+  });
+  const usize numOutputFacets = ParallelAlgorithms::ExclusiveScan(outputOffsets.data(), numVerts, outputOffsets.data());
 
-  typename std::set<std::pair<T, T>>::iterator setIter;
-  edge_List->getDataStore()->resizeTuples(edgeSet.size());
-  auto& uEdges = *edge_List;
-  T index = 0;
-
-  for(auto edge : edgeSet)
+  facetList->getDataStore()->resizeTuples(numOutputFacets);
+  std::vector<T> facetBuffer;
+  T* facets = facetList->getDataStore()->data();
+  if(facets == nullptr)
   {
-    uEdges[2 * index] = edge.first;
-    uEdges[2 * index + 1] = edge.second;
-    ++index;
+    facetBuffer.resize(numOutputFacets * numVertsPerFacet);
+    facets = facetBuffer.data();
   }
-}
-
-/**
- * @brief
- * @tparam T
- * @param tetList
- * @param faceList
- */
-template <typename T>
-void FindTetFaces(const DataArray<T>* tetList, DataArray<T>* faceList)
-{
-  auto& tets = *tetList;
-  const size_t numElems = tetList->getTupleCount();
-  const size_t numVertsPerTet = tetList->getTupleSize();
-
-  std::tuple<T, T, T> face;
-  std::set<std::tuple<T, T, T>> faceSet;
-
-  for(size_t i = 0; i < numElems; i++)
+  if(occurrenceCounts != nullptr)
   {
-    const size_t offset = i * numVertsPerTet;
-
-    std::vector<T> tri0 = {tets[offset + 0], tets[offset + 1], tets[offset + 2]};
-    std::vector<T> tri1 = {tets[offset + 1], tets[offset + 2], tets[offset + 3]};
-    std::vector<T> tri2 = {tets[offset + 0], tets[offset + 2], tets[offset + 3]};
-    std::vector<T> tri3 = {tets[offset + 0], tets[offset + 1], tets[offset + 3]};
-    std::list<std::vector<T>> triList = {tri0, tri1, tri2, tri3};
+    occurrenceCounts->resize(numOutputFacets);
+  }
 
-    for(auto&& tri : triList)
+  pool.parallelFor(numVerts, detail::k_MinSliceCount, 1, [&](usize begin, usize end) {
+    for(usize vert = begin; vert < end; vert++)
     {
-      std::sort(tri.begin(), tri.end());
-      face = std::make_tuple(tri[0], tri[1], tri[2]);
-      faceSet.insert(face);
+      usize index = outputOffsets[vert];
+      detail::ForEachFacetRun(elems, elementFacets, sortedFacets, vert, vert + 1, [&](usize runBegin, usize runEnd) {
+        if(!isSelected(runEnd - runBegin))
+        {
+          return;
+        }
+        const std::array<T, 4> key = detail::FacetKey(elems, elementFacets, sortedFacets.facetIds[runBegin]);
+        std::copy_n(key.begin(), numVertsPerFacet, facets + index * numVertsPerFacet);
+        if(occurrenceCounts != nullptr)
+        {
+          (*occurrenceCounts)[index] = static_cast<u32>(runEnd - runBegin);
+        }
+        index++;
+      });
     }
-  }
+  });
 
-  faceList->getDataStore()->resizeTuples(faceSet.size());
-  auto& uFaces = *faceList;
-  T index = 0;
-
-  for(auto& face : faceSet)
+  for(usize i = 0; i < facetBuffer.size(); i++)
   {
-    uFaces[3 * index] = std::get<0>(face);
-    uFaces[3 * index + 1] = std::get<1>(face);
-    uFaces[3 * index + 2] = std::get<2>(face);
-    ++index;
+    (*facetList)[i] = facetBuffer[i];
   }
+  return 0;
 }
 
 /**
- * @brief
+ * @brief Fills dynamicList with the ids of the elements using each vertex,
+ * sorted in ascending order. Runs in parallel on the shared ThreadPool: the
+ * elements using each vertex are counted with atomics, the list offsets are
+ * built with a parallel prefix sum, the element ids are scattered
+ * concurrently and each list is then sorted. Scratch memory is private to
+ * the call. Returns -1 if elemList references a vertex outside of
+ * [0, numVerts) or a vertex is used by more elements than T can count.
  * @tparam T
- * @param hexList
- * @param faceList
+ * @tparam K
+ * @param elemList
+ * @param dynamicList
+ * @param numVerts
+ * @return ErrorCode
  */
-template <typename T>
-void FindHexFaces(const DataArray<T>* hexList, DataArray<T>* faceList)
+template <typename T, typename K>
+ErrorCode FindElementsContainingVert(const DataArray<K>* elemList, DynamicListArray<T, K>* dynamicList, size_t numVerts)
 {
-  auto& hexas = *hexList;
-  const size_t numElems = hexList->getTupleCount();
-  const size_t numVertsPerHex = hexList->getTupleSize();
+  using detail::k_MinSliceCount;
 
-  std::tuple<T, T, T, T> face;
-  std::set<std::tuple<T, T, T, T>> faceSet;
-
-  for(size_t i = 0; i < numElems; i++)
+  const size_t numElems = elemList->getTupleCount();
+  const size_t numVertsPerElem = elemList->getTupleSize();
+  if(numElems > 0 && numVertsPerElem > 0)
   {
-    const size_t offset = i * numVertsPerHex;
+    // Vertex ids index the per-vertex counters, so every id must be below numVerts
+    const auto [minVert, maxVert] = ParallelAlgorithms::MinMax(*elemList->getDataStore());
+    if constexpr(std::is_signed_v<K>)
+    {
+      if(minVert < 0)
+      {
+        return -1;
+      }
+    }
+    if(static_cast<size_t>(maxVert) >= numVerts)
+    {
+      return -1;
+    }
+  }
+  std::vector<K> elemBuffer;
+  const K* elems = detail::GetContiguousValues(*elemList->getDataStore(), elemBuffer);
 
-    std::vector<T> quad0 = {hexas[offset + 0], hexas[offset + 1], hexas[offset + 5], hexas[offset + 4]};
-    std::vector<T> quad1 = {hexas[offset + 1], hexas[offset + 2], hexas[offset + 6], hexas[offset + 5]};
-    std::vector<T> quad2 = {hexas[offset + 2], hexas[offset + 3], hexas[offset + 7], hexas[offset + 6]};
-    std::vector<T> quad3 = {hexas[offset + 3], hexas[offset + 0], hexas[offset + 4], hexas[offset + 7]};
-    std::vector<T> quad4 = {hexas[offset + 0], hexas[offset + 1], hexas[offset + 2], hexas[offset + 3]};
-    std::vector<T> quad5 = {hexas[offset + 4], hexas[offset + 5], hexas[offset + 6], hexas[offset + 7]};
+  ThreadPool& pool = ThreadPool::Global();
 
-    std::list<std::vector<T>> quadList = {quad0, quad1, quad2, quad3, quad4, quad5};
+  // Count the number of uses of each vertex
+  std::vector<std::atomic<u32>> linkCount(numVerts);
+  pool.parallelFor(numElems, k_MinSliceCount, 1, [&](usize begin, usize end) {
+    for(size_t i = begin * numVertsPerElem; i < end * numVertsPerElem; i++)
+    {
+      linkCount[elems[i]].fetch_add(1, std::memory_order_relaxed);
+    }
+  });
 
-    for(auto&& quad : quadList)
+  // List lengths are reported as T, so longer lists cannot be represented
+  std::atomic<bool> isTooLong = false;
+  pool.parallelFor(numVerts, k_MinSliceCount, 1, [&](usize begin, usize end) {
+    for(size_t vert = begin; vert < end; vert++)
     {
-      std::sort(quad.begin(), quad.end());
-      face = std::make_tuple(quad[0], quad[1], quad[2], quad[3]);
-      faceSet.insert(face);
+      if(linkCount[vert].load(std::memory_order_relaxed) > std::numeric_limits<T>::max())
+      {
+        isTooLong = true;
+      }
     }
+  });
+  if(isTooLong)
+  {
+    return -1;
   }
 
-  faceList->getDataStore()->resizeTuples(faceSet.size());
-  auto& uFaces = *faceList;
-  T index = 0;
+  // Now allocate storage for the links
+  dynamicList->allocateLists(linkCount);
 
-  for(auto& face : faceSet)
-  {
-    uFaces[4 * index] = std::get<0>(face);
-    uFaces[4 * index + 1] = std::get<1>(face);
-    uFaces[4 * index + 2] = std::get<2>(face);
-    uFaces[4 * index + 3] = std::get<3>(face);
-    ++index;
-  }
+  // Scatter each element into the lists of its vertices. The counts are used
+  // up as cursors, so each list is filled from the back in arbitrary order.
+  pool.parallelFor(numElems, k_MinSliceCount, 1, [&](usize begin, usize end) {
+    for(size_t elemId = begin; elemId < end; elemId++)
+    {
+      const size_t offset = elemId * numVertsPerElem;
+      for(size_t j = 0; j < numVertsPerElem; j++)
+      {
+        const K vert = elems[offset + j];
+        const u32 pos = linkCount[vert].fetch_sub(1, std::memory_order_relaxed) - 1;
+        dynamicList->insertCellReference(vert, pos, elemId);
+      }
+    }
+  });
+
+  // Sort each list so the result does not depend on thread scheduling
+  pool.parallelFor(numVerts, k_MinSliceCount, 1, [dynamicList](usize begin, usize end) {
+    for(size_t vert = begin; vert < end; vert++)
+    {
+      K* list = dynamicList->getElementListPointer(vert);
+      std::sort(list, list + dynamicList->getNumberOfElements(vert));
+    }
+  });
+  return 0;
 }
 
 /**
- * @brief
+ * @brief Fills dynamicList with the ids of the elements sharing a facet with
+ * each element, sorted in ascending order. Edges are neighbors if they share
+ * a vertex, triangles and quads if they share an edge and tetrahedra and
+ * hexahedra if they share a face. Runs in parallel on the shared ThreadPool:
+ * the facets of all elements are bucketed by their smallest vertex with a
+ * counting sort, each bucket is sorted by the remaining vertices so that
+ * elements sharing a facet end up adjacent, and the matching pairs are
+ * counted and scattered into the neighbor lists. The result does not depend
+ * on the number of threads. Returns -1 if the geometry type has no explicit
+ * elements, elemList does not match it or elemList references a vertex that
+ * elemsContainingVert does not cover.
  * @tparam T
- * @param tetList
- * @param edgeList
+ * @tparam K
+ * @param elemList
+ * @param elemsContainingVert Used for the number of vertices
+ * @param dynamicList
+ * @param geometryType
+ * @return ErrorCode
  */
-template <typename T>
-void FindUnsharedTetEdges(const DataArray<T>* tetList, DataArray<T>* edgeList)
+template <typename T, typename K>
+ErrorCode FindElementNeighbors(const DataArray<K>* elemList, const DynamicListArray<T, K>* elemsContainingVert, DynamicListArray<T, K>* dynamicList, AbstractGeometry::Type geometryType)
 {
-  auto& tets = *tetList;
-  const size_t numElems = tetList->getTupleCount();
-  const size_t numVertsPerTet = tetList->getTupleSize();
+  using detail::k_MinSliceCount;
 
-  std::pair<T, T> edge;
-  std::map<std::pair<T, T>, T> edgeMap;
-
-  for(size_t i = 0; i < numElems; i++)
+  const std::optional<ElementFacets> elementFacets = GetElementFacets(geometryType);
+  if(!elementFacets.has_value() || elemList->getTupleSize() != elementFacets->verticesPerElement || elemsContainingVert == nullptr)
   {
-    const size_t offset = i * numVertsPerTet;
-
-    std::vector<T> edge0 = {tets[offset + 0], tets[offset + 1]};
-    std::vector<T> edge1 = {tets[offset + 0], tets[offset + 2]};
-    std::vector<T> edge2 = {tets[offset + 1], tets[offset + 2]};
-    std::vector<T> edge3 = {tets[offset + 0], tets[offset + 3]};
-    std::vector<T> edge4 = {tets[offset + 1], tets[offset + 3]};
-    std::vector<T> edge5 = {tets[offset + 2], tets[offset + 3]};
-    std::list<std::vector<T>> edgeList = {edge0, edge1, edge2, edge3, edge4, edge5};
+    return -1;
+  }
 
-    for(auto&& uEdge : edgeList)
+  const size_t numElems = elemList->getTupleCount();
+  const size_t numFacetsPerElem = elementFacets->facets.size();
+  const size_t numVerts = elemsContainingVert->size();
+  if(numElems > 0)
+  {
+    // Vertex ids index the per-vertex buckets, so every id must be covered by elemsContainingVert
+    const auto [minVert, maxVert] = ParallelAlgorithms::MinMax(*elemList->getDataStore());
+    if constexpr(std::is_signed_v<K>)
     {
-      std::sort(uEdge.begin(), uEdge.end());
-      edge = std::make_pair(uEdge[0], uEdge[1]);
-      edgeMap[edge]++;
+      if(minVert < 0)
+      {
+        return -1;
+      }
+    }
+    if(static_cast<size_t>(maxVert) >= numVerts)
+    {
+      return -1;
     }
   }
+  std::vector<K> elemBuffer;
+  const K* elems = detail::GetContiguousValues(*elemList->getDataStore(), elemBuffer);
 
-  typename std::map<std::pair<T, T>, T>::iterator mapIter = edgeMap.begin();
+  ThreadPool& pool = ThreadPool::Global();
+  const detail::SortedFacets sortedFacets = detail::SortFacets(elems, numElems, *elementFacets, numVerts);
 
-  while(mapIter != edgeMap.end())
-  {
-    if((*mapIter).second > 1)
+  // Calls visit(elemId, neighborId) for every ordered pair of distinct elements sharing a facet in the buckets [begin, end)
+  auto forEachNeighborPair = [&](usize begin, usize end, const auto& visit) {
+    detail::ForEachFacetRun(elems, *elementFacets, sortedFacets, begin, end, [&](usize runBegin, usize runEnd) {
+      for(size_t i = runBegin; i < runEnd; i++)
+      {
+        for(size_t j = runBegin; j < runEnd; j++)
+        {
+          const size_t elemId = sortedFacets.facetIds[i] / numFacetsPerElem;
+          const size_t neighborId = sortedFacets.facetIds[j] / numFacetsPerElem;
+          if(elemId != neighborId)
+          {
+            visit(elemId, neighborId);
+          }
+        }
+      }
+    });
+  };
+
+  // Runs never span buckets, so buckets can be split across threads
+  std::vector<std::atomic<u32>> linkCount(numElems);
+  pool.parallelFor(numVerts, k_MinSliceCount, 1, [&](usize begin, usize end) {
+    forEachNeighborPair(begin, end, [&linkCount](size_t elemId, size_t) { linkCount[elemId].fetch_add(1, std::memory_order_relaxed); });
+  });
+  dynamicList->allocateLists(linkCount);
+  pool.parallelFor(numVerts, k_MinSliceCount, 1, [&](usize begin, usize end) {
+    forEachNeighborPair(begin, end, [&linkCount, dynamicList](size_t elemId, size_t neighborId) {
+      dynamicList->insertCellReference(elemId, linkCount[elemId].fetch_sub(1, std::memory_order_relaxed) - 1, neighborId);
+    });
+  });
+
+  // Elements sharing more than one facet, e.g. duplicated elements, are listed once
+  std::vector<u32> uniqueCount(numElems);
+  pool.parallelFor(numElems, k_MinSliceCount, 1, [&](usize begin, usize end) {
+    for(size_t elemId = begin; elemId < end; elemId++)
     {
-      edgeMap.erase(mapIter++);
+      K* list = dynamicList->getElementListPointer(elemId);
+      K* listEnd = list + dynamicList->getNumberOfElements(elemId);
+      std::sort(list, listEnd);
+      uniqueCount[elemId] = static_cast<u32>(std::unique(list, listEnd) - list);
     }
-    else
+  });
+  std::vector<usize> uniqueOffsets(numElems + 1);
+  uniqueOffsets[numElems] = ParallelAlgorithms::ExclusiveScan(uniqueCount.data(), numElems, uniqueOffsets.data());
+  if(uniqueOffsets[numElems] != dynamicList->getTotalNumberOfElements())
+  {
+    std::vector<K> uniqueNeighbors(uniqueOffsets[numElems]);
+    for(size_t elemId = 0; elemId < numElems; elemId++)
     {
-      ++mapIter;
+      std::copy_n(dynamicList->getElementListPointer(elemId), uniqueCount[elemId], uniqueNeighbors.begin() + uniqueOffsets[elemId]);
     }
+    dynamicList->allocateLists(uniqueCount);
+    std::copy(uniqueNeighbors.begin(), uniqueNeighbors.end(), dynamicList->getElementListPointer(0));
   }
 
-  edgeList->getDataStore()->resizeTuples(edgeMap.size());
-  auto& bEdges = *edgeList;
-  T index = 0;
+  return 0;
+}
 
-  for(auto& pair : edgeMap)
-  {
-    bEdges[2 * index] = pair.first.first;
-    bEdges[2 * index + 1] = pair.first.second;
-    ++index;
-  }
+/**
+ * @brief Finds the unique edges of the tetrahedra in tetList, sorted as pairs of ascending vertex ids.
+ * @tparam T
+ * @param tetList
+ * @param edgeList
+ * @return ErrorCode
+ */
+template <typename T>
+ErrorCode FindTetEdges(const DataArray<T>* tetList, DataArray<T>* edgeList)
+{
+  return FindUniqueFacets(tetList, TetEdges(), edgeList, FacetSelection::All);
 }
 
 /**
- * @brief
+ * @brief Finds the unique edges of the hexahedra in hexList, sorted as pairs of ascending vertex ids.
  * @tparam T
  * @param hexList
  * @param edge_List
+ * @return ErrorCode
  */
 template <typename T>
-void FindUnsharedHexEdges(const DataArray<T>* hexList, DataArray<T>* edge_List)
+ErrorCode FindHexEdges(const DataArray<T>* hexList, DataArray<T>* edge_List)
 {
-  const size_t numElems = hexList->getTupleCount();
-  const size_t numVertsPerHex = hexList->getTupleSize();
-  auto& hexas = *hexList;
-
-  std::pair<T, T> edge;
-  std::map<std::pair<T, T>, T> edgeMap;
-
-  for(size_t i = 0; i < numElems; i++)
-  {
-    const size_t offset = i * numVertsPerHex;
-
-    std::vector<T> edge0 = {hexas[offset + 0], hexas[offset + 1]};
-    std::vector<T> edge1 = {hexas[offset + 1], hexas[offset + 2]};
-    std::vector<T> edge2 = {hexas[offset + 2], hexas[offset + 3]};
-    std::vector<T> edge3 = {hexas[offset + 3], hexas[offset + 0]};
-
-    std::vector<T> edge4 = {hexas[offset + 0], hexas[offset + 4]};
-    std::vector<T> edge5 = {hexas[offset + 1], hexas[offset + 5]};
-    std::vector<T> edge6 = {hexas[offset + 2], hexas[offset + 6]};
-    std::vector<T> edge7 = {hexas[offset + 3], hexas[offset + 7]};
-
-    std::vector<T> edge8 = {hexas[offset + 4], hexas[offset + 5]};
-    std::vector<T> edge9 = {hexas[offset + 5], hexas[offset + 6]};
-    std::vector<T> edge10 = {hexas[offset + 6], hexas[offset + 7]};
-    std::vector<T> edge11 = {hexas[offset + 7], hexas[offset + 4]};
-
-    std::list<std::vector<T>> edgeList = {edge0, edge1, edge2, edge3, edge4, edge5, edge6, edge7, edge8, edge9, edge10, edge11};
-
-    for(auto&& uEdge : edgeList)
-    {
-      std::sort(uEdge.begin(), uEdge.end());
-      edge = std::make_pair(uEdge[0], uEdge[1]);
-      edgeMap[edge]++;
-    }
-  }
-
-  typename std::map<std::pair<T, T>, T>::iterator mapIter = edgeMap.begin();
-
-  while(mapIter != edgeMap.end())
-  {
-    if((*mapIter).second > 1)
-    {
-      edgeMap.erase(mapIter++);
-    }
-    else
-    {
-      ++mapIter;
-    }
-  }
-
-  edge_List->getDataStore()->resizeTuples(edgeMap.size());
-  auto& bEdges = *edge_List;
-  T index = 0;
-
-  for(auto& pair : edgeMap)
-  {
-    bEdges[2 * index] = pair.first.first;
-    bEdges[2 * index + 1] = pair.first.second;
-    ++index;
-  }
+  return FindUniqueFacets(hexList, HexEdges(), edge_List, FacetSelection::All);
 }
 
 /**
- * @brief
+ * @brief Finds the unique faces of the tetrahedra in tetList, sorted as triples of ascending vertex ids.
  * @tparam T
  * @param tetList
  * @param faceList
+ * @return ErrorCode
  */
 template <typename T>
-void FindUnsharedTetFaces(const DataArray<T>* tetList, DataArray<T>* faceList)
+ErrorCode FindTetFaces(const DataArray<T>* tetList, DataArray<T>* faceList)
 {
-  const size_t numElems = tetList->getTupleCount();
-  const size_t numVertsPerTet = tetList->getTupleSize();
-  auto& tets = *tetList;
-
-  std::tuple<T, T, T> face;
-  std::map<std::tuple<T, T, T>, T> faceMap;
-
-  for(size_t i = 0; i < numElems; i++)
-  {
-    const size_t offset = i * numVertsPerTet;
-
-    std::vector<T> tri0 = {tets[offset + 0], tets[offset + 1], tets[offset + 2]};
-    std::vector<T> tri1 = {tets[offset + 1], tets[offset + 2], tets[offset + 3]};
-    std::vector<T> tri2 = {tets[offset + 0], tets[offset + 2], tets[offset + 3]};
-    std::vector<T> tri3 = {tets[offset + 0], tets[offset + 1], tets[offset + 3]};
-    std::list<std::vector<T>> triList = {tri0, tri1, tri2, tri3};
-
-    for(auto&& tri : triList)
-    {
-      std::sort(tri.begin(), tri.end());
-      face = std::make_tuple(tri[0], tri[1], tri[2]);
-      faceMap[face]++;
-    }
-  }
+  return FindUniqueFacets(tetList, *GetElementFacets(AbstractGeometry::Type::Tetrahedral), faceList, FacetSelection::All);
+}
 
-  typename std::map<std::tuple<T, T, T>, T>::iterator mapIter = faceMap.begin();
+/**
+ * @brief Finds the unique faces of the hexahedra in hexList, sorted as quadruples of ascending vertex ids.
+ * @tparam T
+ * @param hexList
+ * @param faceList
+ * @return ErrorCode
+ */
+template <typename T>
+ErrorCode FindHexFaces(const DataArray<T>* hexList, DataArray<T>* faceList)
+{
+  return FindUniqueFacets(hexList, *GetElementFacets(AbstractGeometry::Type::Hexahedral), faceList, FacetSelection::All);
+}
 
-  while(mapIter != faceMap.end())
-  {
-    if((*mapIter).second > 1)
-    {
-      faceMap.erase(mapIter++);
-    }
-    else
-    {
-      ++mapIter;
-    }
-  }
+/**
+ * @brief Finds the edges used by exactly one of the tetrahedra in tetList.
+ * @tparam T
+ * @param tetList
+ * @param edgeList
+ * @return ErrorCode
+ */
+template <typename T>
+ErrorCode FindUnsharedTetEdges(const DataArray<T>* tetList, DataArray<T>* edgeList)
+{
+  return FindUniqueFacets(tetList, TetEdges(), edgeList, FacetSelection::Unshared);
+}
 
-  faceList->getDataStore()->resizeTuples(faceMap.size());
-  auto& uFaces = *faceList;
-  T index = 0;
+/**
+ * @brief Finds the edges used by exactly one of the hexahedra in hexList.
+ * @tparam T
+ * @param hexList
+ * @param edge_List
+ * @return ErrorCode
+ */
+template <typename T>
+ErrorCode FindUnsharedHexEdges(const DataArray<T>* hexList, DataArray<T>* edge_List)
+{
+  return FindUniqueFacets(hexList, HexEdges(), edge_List, FacetSelection::Unshared);
+}
 
-  for(auto& pair : faceMap)
-  {
-    uFaces[3 * index] = std::get<0>(pair.first);
-    uFaces[3 * index + 1] = std::get<1>(pair.first);
-    uFaces[3 * index + 2] = std::get<2>(pair.first);
-    ++index;
-  }
+/**
+ * @brief Finds the boundary faces of the tetrahedra in tetList, i.e. the faces used by exactly one tetrahedron.
+ * @tparam T
+ * @param tetList
+ * @param faceList
+ * @return ErrorCode
+ */
+template <typename T>
+ErrorCode FindUnsharedTetFaces(const DataArray<T>* tetList, DataArray<T>* faceList)
+{
+  return FindUniqueFacets(tetList, *GetElementFacets(AbstractGeometry::Type::Tetrahedral), faceList, FacetSelection::Unshared);
 }
 
 /**
- * @brief
+ * @brief Finds the boundary faces of the hexahedra in hexList, i.e. the faces used by exactly one hexahedron.
  * @tparam T
  * @param hexList
  * @param faceList
+ * @return ErrorCode
  */
 template <typename T>
-void FindUnsharedHexFaces(const DataArray<T>* hexList, DataArray<T>* faceList)
+ErrorCode FindUnsharedHexFaces(const DataArray<T>* hexList, DataArray<T>* faceList)
 {
-  auto& hexas = *hexList;
-  const size_t numElems = hexList->getTupleCount();
-  const size_t numVertsPerHex = hexList->getTupleSize();
+  return FindUniqueFacets(hexList, *GetElementFacets(AbstractGeometry::Type::Hexahedral), faceList, FacetSelection::Unshared);
+}
 
-  std::tuple<T, T, T, T> face;
-  std::map<std::tuple<T, T, T, T>, T> faceMap;
+/**
+ * @brief Finds the unique edges of the triangles or quads in elemList, sorted as pairs of ascending vertex ids.
+ * @tparam T
+ * @param elemList
+ * @param edgeList
+ * @return ErrorCode
+ */
+template <typename T>
+ErrorCode Find2DElementEdges(const DataArray<T>* elemList, DataArray<T>* edgeList)
+{
+  return FindUniqueFacets(elemList, PolygonEdges(elemList->getTupleSize()), edgeList, FacetSelection::All);
+}
 
-  for(size_t i = 0; i < numElems; i++)
-  {
-    const size_t offset = i * numVertsPerHex;
+/**
+ * @brief Finds the boundary edges of the triangles or quads in elemList, i.e. the edges used by exactly one element.
+ * @tparam T
+ * @param elemList
+ * @param edgeList
+ * @return ErrorCode
+ */
+template <typename T>
+ErrorCode Find2DUnsharedEdges(const DataArray<T>* elemList, DataArray<T>* edgeList)
+{
+  return FindUniqueFacets(elemList, PolygonEdges(elemList->getTupleSize()), edgeList, FacetSelection::Unshared);
+}
+} // namespace Connectivity
 
-    std::vector<T> quad0 = {hexas[offset + 0], hexas[offset + 1], hexas[offset + 5], hexas[offset + 4]};
-    std::vector<T> quad1 = {hexas[offset + 1], hexas[offset + 2], hexas[offset + 6], hexas[offset + 5]};
-    std::vector<T> quad2 = {hexas[offset + 2], hexas[offset + 3], hexas[offset + 7], hexas[offset + 6]};
-    std::vector<T> quad3 = {hexas[offset + 3], hexas[offset + 0], hexas[offset + 4], hexas[offset + 7]};
-    std::vector<T> quad4 = {hexas[offset + 0], hexas[offset + 1], hexas[offset + 2], hexas[offset + 3]};
-    std::vector<T> quad5 = {hexas[offset + 4], hexas[offset + 5], hexas[offset + 6], hexas[offset + 7]};
+namespace Topology
+{
+namespace detail
+{
+/**
+ * @brief Number of elements the kernels handle per batch. The corners of a
+ * batch are gathered into one array per corner and axis so the arithmetic
+ * runs lane by lane over contiguous floats. Compilers turn those loops into
+ * AVX2 or AVX-512 instructions when the target allows it and into scalar code
+ * otherwise. Sixteen floats fill one AVX-512 register.
+ */
+inline constexpr usize k_BatchSize = 16;
+
+/**
+ * @brief Coordinates of the N corners of a batch of elements.
+ * @tparam N Number of vertices per element
+ */
+template <usize N>
+struct CornerBatch
+{
+  alignas(64) float x[N][k_BatchSize];
+  alignas(64) float y[N][k_BatchSize];
+  alignas(64) float z[N][k_BatchSize];
+};
 
-    std::list<std::vector<T>> quadList = {quad0, quad1, quad2, quad3, quad4, quad5};
+/**
+ * @brief Per lane results of a kernel with C components.
+ * @tparam C
+ */
+template <usize C>
+struct ResultBatch
+{
+  alignas(64) float values[C][k_BatchSize];
+};
 
-    for(auto&& quad : quadList)
+/**
+ * @brief Gathers the corners of count elements starting at first. Lanes past
+ * count repeat the last element so every lane computes finite values.
+ * @tparam N
+ * @tparam K
+ * @param elems
+ * @param vertices Interleaved xyz coordinates
+ * @param first
+ * @param count
+ * @param corners
+ */
+template <usize N, typename K>
+void GatherCorners(const K* elems, const float* vertices, usize first, usize count, CornerBatch<N>& corners)
+{
+  for(usize lane = 0; lane < k_BatchSize; lane++)
+  {
+    const K* elem = elems + (first + std::min(lane, count - 1)) * N;
+    for(usize k = 0; k < N; k++)
     {
-      std::sort(quad.begin(), quad.end());
-      face = std::make_tuple(quad[0], quad[1], quad[2], quad[3]);
-      faceMap[face]++;
+      const float* vertex = vertices + 3 * static_cast<usize>(elem[k]);
+      corners.x[k][lane] = vertex[0];
+      corners.y[k][lane] = vertex[1];
+      corners.z[k][lane] = vertex[2];
     }
   }
+}
 
-  typename std::map<std::tuple<T, T, T, T>, T>::iterator mapIter = faceMap.begin();
+/**
+ * @brief Averages the corners of each element.
+ * @tparam N
+ */
+template <usize N>
+struct CentroidKernel
+{
+  static constexpr usize k_NumComponents = 3;
 
-  while(mapIter != faceMap.end())
+  void operator()(const CornerBatch<N>& corners, ResultBatch<3>& result) const
   {
-    if((*mapIter).second > 1)
-    {
-      faceMap.erase(mapIter++);
-    }
-    else
+    constexpr float scale = 1.0f / static_cast<float>(N);
+    for(usize lane = 0; lane < k_BatchSize; lane++)
     {
-      ++mapIter;
+      float x = 0.0f;
+      float y = 0.0f;
+      float z = 0.0f;
+      for(usize k = 0; k < N; k++)
+      {
+        x += corners.x[k][lane];
+        y += corners.y[k][lane];
+        z += corners.z[k][lane];
+      }
+      result.values[0][lane] = x * scale;
+      result.values[1][lane] = y * scale;
+      result.values[2][lane] = z * scale;
     }
   }
+};
 
-  faceList->getDataStore()->resizeTuples(faceMap.size());
-  auto& uFaces = *faceList;
-  T index = 0;
+/**
+ * @brief Computes the area of each polygon as half the length of its vector
+ * area, summed over the fan of triangles around corner 0. This is exact for
+ * planar polygons; for quads it reduces to half the cross product of the
+ * diagonals.
+ * @tparam N
+ */
+template <usize N>
+struct PolygonAreaKernel
+{
+  static constexpr usize k_NumComponents = 1;
 
-  for(auto& pair : faceMap)
+  void operator()(const CornerBatch<N>& corners, ResultBatch<1>& result) const
   {
-    uFaces[4 * index] = std::get<0>(pair.first);
-    uFaces[4 * index + 1] = std::get<1>(pair.first);
-    uFaces[4 * index + 2] = std::get<2>(pair.first);
-    uFaces[4 * index + 3] = std::get<3>(pair.first);
-    ++index;
+    for(usize lane = 0; lane < k_BatchSize; lane++)
+    {
+      float nx = 0.0f;
+      float ny = 0.0f;
+      float nz = 0.0f;
+      for(usize k = 1; k + 1 < N; k++)
+      {
+        const float ax = corners.x[k][lane] - corners.x[0][lane];
+        const float ay = corners.y[k][lane] - corners.y[0][lane];
+        const float az = corners.z[k][lane] - corners.z[0][lane];
+        const float bx = corners.x[k + 1][lane] - corners.x[0][lane];
+        const float by = corners.y[k + 1][lane] - corners.y[0][lane];
+        const float bz = corners.z[k + 1][lane] - corners.z[0][lane];
+        nx += ay * bz - az * by;
+        ny += az * bx - ax * bz;
+        nz += ax * by - ay * bx;
+      }
+      result.values[0][lane] = 0.5f * std::sqrt(nx * nx + ny * ny + nz * nz);
+    }
   }
-}
+};
 
 /**
- * @brief
- * @tparam T
- * @param elemList
- * @param edgeList
+ * @brief Returns the signed volume of tet (a, b, c, d) of the batch in the
+ * specified lane, positive when d lies on the side of triangle (a, b, c)
+ * that its counter-clockwise normal points to.
+ * @tparam N
+ * @param corners
+ * @param lane
+ * @param a
+ * @param b
+ * @param c
+ * @param d
+ * @return float
  */
-template <typename T>
-void Find2DElementEdges(const DataArray<T>* elemList, DataArray<T>* edgeList)
+template <usize N>
+inline float SignedTetVolume(const CornerBatch<N>& corners, usize lane, usize a, usize b, usize c, usize d)
 {
-  const size_t numElems = elemList->getTupleCount();
-  const size_t numVertsPerElem = elemList->getTupleSize();
-  auto& elems = *elemList;
-  T v0 = 0;
-  T v1 = 0;
+  const float ux = corners.x[b][lane] - corners.x[a][lane];
+  const float uy = corners.y[b][lane] - corners.y[a][lane];
+  const float uz = corners.z[b][lane] - corners.z[a][lane];
+  const float vx = corners.x[c][lane] - corners.x[a][lane];
+  const float vy = corners.y[c][lane] - corners.y[a][lane];
+  const float vz = corners.z[c][lane] - corners.z[a][lane];
+  const float wx = corners.x[d][lane] - corners.x[a][lane];
+  const float wy = corners.y[d][lane] - corners.y[a][lane];
+  const float wz = corners.z[d][lane] - corners.z[a][lane];
+  return (ux * (vy * wz - vz * wy) - vx * (uy * wz - uz * wy) + wx * (uy * vz - uz * vy)) / 6.0f;
+}
 
-  std::pair<T, T> edge;
-  std::set<std::pair<T, T>> edgeSet;
+/**
+ * @brief Computes the signed volume of each tetrahedron.
+ */
+struct TetVolumeKernel
+{
+  static constexpr usize k_NumComponents = 1;
 
-  for(size_t i = 0; i < numElems; i++)
+  void operator()(const CornerBatch<4>& corners, ResultBatch<1>& result) const
   {
-    const size_t offset = i * numVertsPerElem;
-
-    for(size_t j = 0; j < numVertsPerElem; j++)
+    for(usize lane = 0; lane < k_BatchSize; lane++)
     {
-      if(j == (numVertsPerElem - 1))
-      {
-        if(elems[offset + j] > elems[offset + 0])
-        {
-          v0 = elems[offset + 0];
-          v1 = elems[offset + j];
-        }
-        else
-        {
-          v0 = elems[offset + j];
-          v1 = elems[offset + 0];
-        }
-      }
-      else
-      {
-        if(elems[offset + j] > elems[offset + j + 1])
-        {
-          v0 = elems[offset + j + 1];
-          v1 = elems[offset + j];
-        }
-        else
-        {
-          v0 = elems[offset + j];
-          v1 = elems[offset + j + 1];
-        }
-      }
-      edge = std::make_pair(v0, v1);
-      edgeSet.insert(edge);
+      result.values[0][lane] = SignedTetVolume(corners, lane, 0, 1, 2, 3);
     }
   }
+};
 
-  typename std::set<std::pair<T, T>>::iterator setIter;
-  edgeList->getDataStore()->resizeTuples(edgeSet.size());
-  auto& uEdges = *edgeList;
-  T index = 0;
+/**
+ * @brief Computes the volume of each hexahedron as the sum of the signed
+ * volumes of five tetrahedra: the corner tets at vertices 0, 2, 5 and 7 plus
+ * the central tet (1, 4, 6, 3).
+ */
+struct HexVolumeKernel
+{
+  static constexpr usize k_NumComponents = 1;
 
-  for(auto& edge : edgeSet)
+  void operator()(const CornerBatch<8>& corners, ResultBatch<1>& result) const
   {
-    uEdges[2 * index] = edge.first;
-    uEdges[2 * index + 1] = edge.second;
-    ++index;
+    for(usize lane = 0; lane < k_BatchSize; lane++)
+    {
+      result.values[0][lane] = SignedTetVolume(corners, lane, 0, 1, 3, 4) + SignedTetVolume(corners, lane, 1, 4, 5, 6) + SignedTetVolume(corners, lane, 1, 4, 6, 3) +
+                               SignedTetVolume(corners, lane, 1, 3, 6, 2) + SignedTetVolume(corners, lane, 3, 6, 7, 4);
+    }
   }
-}
+};
 
 /**
- * @brief
- * @tparam T
+ * @brief Runs the kernel over every element in batches of k_BatchSize on the
+ * shared ThreadPool and writes its components to output. Contiguous and
+ * planar outputs are written in place; other stores are filled from a
+ * buffer afterwards.
+ * @tparam N Number of vertices per element
+ * @tparam K
+ * @tparam KernelT
  * @param elemList
- * @param edgeList
+ * @param vertices
+ * @param output
+ * @param kernel
  */
-template <typename T>
-void Find2DUnsharedEdges(const DataArray<T>* elemList, DataArray<T>* edgeList)
+template <usize N, typename K, typename KernelT>
+void RunElementKernel(const DataArray<K>* elemList, const FloatArray* vertices, FloatArray* output, const KernelT& kernel)
 {
-  auto& elems = *elemList;
-  const size_t numElems = elemList->getTupleCount();
-  const size_t numVertsPerElem = elemList->getTupleSize();
-  T v0 = 0;
-  T v1 = 0;
+  constexpr usize numComps = KernelT::k_NumComponents;
+  const usize numElems = elemList->getTupleCount();
+  if(elemList->getTupleSize() != N || vertices->getTupleSize() != 3 || output->getTupleSize() != numComps || output->getTupleCount() < numElems)
+  {
+    throw std::runtime_error("Element list, vertices and output do not match the element kernel");
+  }
+  if(numElems == 0)
+  {
+    return;
+  }
 
-  std::pair<T, T> edge;
-  std::map<std::pair<T, T>, T> edgeMap;
+  std::vector<K> elemBuffer;
+  const K* elems = Connectivity::detail::GetContiguousValues(*elemList->getDataStore(), elemBuffer);
+  std::vector<float> vertexBuffer;
+  const float* coords = Connectivity::detail::GetContiguousValues(*vertices->getDataStore(), vertexBuffer);
 
-  for(size_t i = 0; i < numElems; i++)
+  // Component c of element i is written to outputs[c][i * stride]
+  std::array<float*, numComps> outputs = {};
+  usize stride = numComps;
+  std::vector<float> outputBuffer;
+  if(float* values = output->data(); values != nullptr)
   {
-    const size_t offset = i * numVertsPerElem;
-
-    for(size_t j = 0; j < numVertsPerElem; j++)
+    for(usize c = 0; c < numComps; c++)
     {
-      if(j == (numVertsPerElem - 1))
-      {
-        if(elems[offset + j] > elems[offset + 0])
-        {
-          v0 = elems[offset + 0];
-          v1 = elems[offset + j];
-        }
-        else
-        {
-          v0 = elems[offset + j];
-          v1 = elems[offset + 0];
-        }
-      }
-      else
-      {
-        if(elems[offset + j] > elems[offset + j + 1])
-        {
-          v0 = elems[offset + j + 1];
-          v1 = elems[offset + j];
-        }
-        else
-        {
-          v0 = elems[offset + j];
-          v1 = elems[offset + j + 1];
-        }
-      }
-      edge = std::make_pair(v0, v1);
-      edgeMap[edge]++;
+      outputs[c] = values + c;
     }
   }
-
-  typename std::map<std::pair<T, T>, T>::iterator mapIter = edgeMap.begin();
-
-  while(mapIter != edgeMap.end())
+  else if(!output->componentSpan(0).empty())
   {
-    if((*mapIter).second > 1)
+    stride = 1;
+    for(usize c = 0; c < numComps; c++)
     {
-      edgeMap.erase(mapIter++);
+      outputs[c] = output->componentSpan(c).data();
     }
-    else
+  }
+  else
+  {
+    outputBuffer.resize(numElems * numComps);
+    for(usize c = 0; c < numComps; c++)
     {
-      ++mapIter;
+      outputs[c] = outputBuffer.data() + c;
     }
   }
 
-  edgeList->getDataStore()->resizeTuples(edgeMap.size());
-  auto& bEdges = *edgeList;
-  T index = 0;
+  ThreadPool::Global().parallelFor(numElems, Connectivity::detail::k_MinSliceCount, k_BatchSize, [&](usize begin, usize end) {
+    CornerBatch<N> corners;
+    ResultBatch<numComps> result;
+    for(usize first = begin; first < end; first += k_BatchSize)
+    {
+      const usize count = std::min(k_BatchSize, end - first);
+      GatherCorners<N>(elems, coords, first, count, corners);
+      kernel(corners, result);
+      for(usize c = 0; c < numComps; c++)
+      {
+        float* values = outputs[c] + first * stride;
+        for(usize lane = 0; lane < count; lane++)
+        {
+          values[lane * stride] = result.values[c][lane];
+        }
+      }
+    }
+  });
 
-  for(auto& edge : edgeMap)
+  if(!outputBuffer.empty())
   {
-    bEdges[2 * index] = edge.first.first;
-    bEdges[2 * index + 1] = edge.first.second;
-    ++index;
+    auto* store = output->getDataStore();
+    for(usize i = 0; i < outputBuffer.size(); i++)
+    {
+      store->setValue(i, outputBuffer[i]);
+    }
   }
 }
-} // namespace Connectivity
+} // namespace detail
 
-namespace Topology
-{
 /**
- * @brief
+ * @brief Computes the centroid of each element as the average of its
+ * vertices. Supports elements with 2, 3, 4 or 8 vertices.
  * @tparam T
  * @param elemList
  * @param vertices
@@ -828,31 +1016,27 @@ namespace Topology
 template <typename T>
 void FindElementCentroids(const DataArray<T>* elemList, const FloatArray* vertices, FloatArray* centroids)
 {
-  auto& elems = *elemList;
-  const size_t numElems = elemList->getTupleCount();
-  const size_t numVertsPerElem = elemList->getTupleSize();
-  size_t numDims = 3;
-  auto& elementCentroids = *centroids;
-  auto& vertex = *vertices;
-
-  for(size_t i = 0; i < numDims; i++)
+  switch(elemList->getTupleSize())
   {
-    for(size_t j = 0; j < numElems; j++)
-    {
-      size_t offset = j * numVertsPerElem;
-      float vertPos = 0.0;
-      for(size_t k = 0; k < numVertsPerElem; k++)
-      {
-        vertPos += vertex[3 * elems[offset + k] + i];
-      }
-      vertPos /= static_cast<float>(numVertsPerElem);
-      elementCentroids[numDims * j + i] = vertPos;
-    }
+  case 2:
+    detail::RunElementKernel<2>(elemList, vertices, centroids, detail::CentroidKernel<2>{});
+    break;
+  case 3:
+    detail::RunElementKernel<3>(elemList, vertices, centroids, detail::CentroidKernel<3>{});
+    break;
+  case 4:
+    detail::RunElementKernel<4>(elemList, vertices, centroids, detail::CentroidKernel<4>{});
+    break;
+  case 8:
+    detail::RunElementKernel<8>(elemList, vertices, centroids, detail::CentroidKernel<8>{});
+    break;
+  default:
+    throw std::runtime_error("FindElementCentroids does not support elements with " + std::to_string(elemList->getTupleSize()) + " vertices");
   }
 }
 
 /**
- * @brief
+ * @brief Computes the signed volume of each tetrahedron.
  * @tparam T
  * @param tetList
  * @param vertices
@@ -861,30 +1045,12 @@ void FindElementCentroids(const DataArray<T>* elemList, const FloatArray* vertic
 template <typename T>
 void FindTetVolumes(const DataArray<T>* tetList, const FloatArray* vertices, FloatArray* volumes)
 {
-  auto& tets = *tetList;
-  const size_t numTets = tetList->getTupleCount();
-  const size_t numVertsPerTet = tetList->getTupleSize();
-  auto& vertex = *vertices;
-  auto& volumePtr = *volumes;
-
-  for(size_t i = 0; i < numTets; i++)
-  {
-    const size_t offset = i * numVertsPerTet;
-    float vert0[3] = {vertex[3 * tets[offset + 0] + 0], vertex[3 * tets[offset + 0] + 1], vertex[3 * tets[offset + 0] + 2]};
-    float vert1[3] = {vertex[3 * tets[offset + 1] + 0], vertex[3 * tets[offset + 1] + 1], vertex[3 * tets[offset + 1] + 2]};
-    float vert2[3] = {vertex[3 * tets[offset + 2] + 0], vertex[3 * tets[offset + 2] + 1], vertex[3 * tets[offset + 2] + 2]};
-    float vert3[3] = {vertex[3 * tets[offset + 3] + 0], vertex[3 * tets[offset + 3] + 1], vertex[3 * tets[offset + 3] + 2]};
-
-    Eigen::Matrix3f vertMatrix;
-    vertMatrix << vert1[0] - vert0[0], vert2[0] - vert0[0], vert3[0] - vert0[0], vert1[1] - vert0[1], vert2[1] - vert0[1], vert3[1] - vert0[1], vert1[2] - vert0[2], vert2[2] - vert0[2],
-        vert3[2] - vert0[2];
-
-    volumePtr[i] = (vertMatrix.determinant() / 6.0f);
-  }
+  detail::RunElementKernel<4>(tetList, vertices, volumes, detail::TetVolumeKernel{});
 }
 
 /**
- * @brief
+ * @brief Computes the volume of each hexahedron by splitting it into five
+ * tetrahedra.
  * @tparam T
  * @param hexList
  * @param vertices
@@ -893,70 +1059,11 @@ void FindTetVolumes(const DataArray<T>* tetList, const FloatArray* vertices, Flo
 template <typename T>
 void FindHexVolumes(const DataArray<T>* hexList, const FloatArray* vertices, FloatArray* volumes)
 {
-  const size_t numHexas = hexList->getTupleCount();
-  const size_t numElementsPerHex = hexList->getTupleSize();
-  auto& vertex = *vertices;
-  auto& volumePtr = *volumes;
-  auto& hexas = *hexList;
-
-  for(size_t i = 0; i < numHexas; i++)
-  {
-    // Subdivide each hexahedron into 5 tetrahedra & sum their volumes
-    std::vector<std::vector<uint64_t>> subTets(5, std::vector<uint64_t>(4, 0));
-    const size_t offset = i * numElementsPerHex;
-
-    // First tetrahedron from hexahedron vertices (0, 1, 3, 4);
-    subTets[0][0] = hexas[offset + 0];
-    subTets[0][1] = hexas[offset + 1];
-    subTets[0][2] = hexas[offset + 3];
-    subTets[0][3] = hexas[offset + 4];
-
-    // Second tetrahedron from hexahedron vertices (1, 4, 5, 6);
-    subTets[1][0] = hexas[offset + 1];
-    subTets[1][1] = hexas[offset + 4];
-    subTets[1][2] = hexas[offset + 5];
-    subTets[1][3] = hexas[offset + 6];
-
-    // Third tetrahedron from hexahedron vertices (1, 4, 6, 3);
-    subTets[2][0] = hexas[offset + 1];
-    subTets[2][1] = hexas[offset + 3];
-    subTets[2][2] = hexas[offset + 6];
-    subTets[2][3] = hexas[offset + 3];
-
-    // Fourth tetrahedron from hexahedron vertices (1, 3, 6, 2);
-    subTets[3][0] = hexas[offset + 1];
-    subTets[3][1] = hexas[offset + 3];
-    subTets[3][2] = hexas[offset + 6];
-    subTets[3][3] = hexas[offset + 2];
-
-    // Fifth tetrahedron from hexahedron vertices (3, 6, 7, 4);
-    subTets[4][0] = hexas[offset + 3];
-    subTets[4][1] = hexas[offset + 6];
-    subTets[4][2] = hexas[offset + 7];
-    subTets[4][3] = hexas[offset + 4];
-
-    float volume = 0.0f;
-
-    for(auto&& tet : subTets)
-    {
-      float vert0[3] = {vertex[3 * tet[0] + 0], vertex[3 * tet[0] + 1], vertex[3 * tet[0] + 2]};
-      float vert1[3] = {vertex[3 * tet[1] + 0], vertex[3 * tet[1] + 1], vertex[3 * tet[1] + 2]};
-      float vert2[3] = {vertex[3 * tet[2] + 0], vertex[3 * tet[2] + 1], vertex[3 * tet[2] + 2]};
-      float vert3[3] = {vertex[3 * tet[3] + 0], vertex[3 * tet[3] + 1], vertex[3 * tet[3] + 2]};
-
-      Eigen::Matrix3f vertMatrix;
-      vertMatrix << vert1[0] - vert0[0], vert2[0] - vert0[0], vert3[0] - vert0[0], vert1[1] - vert0[1], vert2[1] - vert0[1], vert3[1] - vert0[1], vert1[2] - vert0[2], vert2[2] - vert0[2],
-          vert3[2] - vert0[2];
-
-      volume += (vertMatrix.determinant() / 6.0f);
-    }
-
-    volumePtr[i] = volume;
-  }
+  detail::RunElementKernel<8>(hexList, vertices, volumes, detail::HexVolumeKernel{});
 }
 
 /**
- * @brief
+ * @brief Computes the area of each triangle or quad.
  * @tparam T
  * @param elemList
  * @param vertices
@@ -965,79 +1072,16 @@ void FindHexVolumes(const DataArray<T>* hexList, const FloatArray* vertices, Flo
 template <typename T>
 void Find2DElementAreas(const DataArray<T>* elemList, const FloatArray* vertices, FloatArray* areas)
 {
-  float nx, ny, nz;
-  int32_t projection;
-
-  auto& elems = *elemList;
-  const size_t numElems = elemList->getTupleCount();
-  const size_t numVertsPerElem = static_cast<int64_t>(elemList->getTupleSize());
-  if(numVertsPerElem < 3)
-  {
-    return;
-  }
-  auto& elemAreas = *areas;
-  std::vector<float> coords(3 * numVertsPerElem, 0.0f);
-
-  for(size_t i = 0; i < numElems; i++)
+  switch(elemList->getTupleSize())
   {
-    float area = 0.0f;
-    const size_t offset = i * numVertsPerElem;
-
-    // Create a contiguous vertex coordinates list
-    // This simplifies the pointer arithmetic a bit
-    for(size_t j = 0; j < numVertsPerElem; j++)
-    {
-      std::vector<float> point{vertices->at(3 * elems[offset + j]), vertices->at(3 * elems[offset + j] + 1), vertices->at(3 * elems[offset + j] + 2)};
-      coords.insert(point.begin(), point.end(), coords.begin());
-    }
-
-    float* coordinates = coords.data();
-    ZXZEuler normal = GeometryMath::FindPolygonNormal(coordinates, numVertsPerElem);
-    normal.normalize();
-
-    nx = (normal[0] > 0.0 ? normal[0] : -normal[0]);
-    ny = (normal[1] > 0.0 ? normal[1] : -normal[1]);
-    nz = (normal[2] > 0.0 ? normal[2] : -normal[2]);
-    projection = (nx > ny ? (nx > nz ? 0 : 2) : (ny > nz ? 1 : 2));
-
-    for(int64_t j = 0; j < numVertsPerElem; j++)
-    {
-      Point3D<float> vert0(coordinates + (3 * j));
-      Point3D<float> vert1(coordinates + (3 * ((j + 1) % numVertsPerElem)));
-      Point3D<float> vert2(coordinates + (3 * ((j + 2) % numVertsPerElem)));
-
-      switch(projection)
-      {
-      case 0: {
-        area += coordinates[3 * ((j + 1) % numVertsPerElem) + 1] * (coordinates[3 * ((j + 2) % numVertsPerElem) + 2] - coordinates[3 * j + 2]);
-        continue;
-      }
-      case 1: {
-        area += coordinates[3 * ((j + 1) % numVertsPerElem) + 0] * (coordinates[3 * ((j + 2) % numVertsPerElem) + 2] - coordinates[3 * j + 2]);
-        continue;
-      }
-      case 2: {
-        area += coordinates[3 * ((j + 1) % numVertsPerElem) + 0] * (coordinates[3 * ((j + 2) % numVertsPerElem) + 1] - coordinates[3 * j + 1]);
-        continue;
-      }
-      }
-    }
-
-    switch(projection)
-    {
-    case 0: {
-      area /= (2.0f * nx);
-      break;
-    }
-    case 1: {
-      area /= (2.0f * ny);
-      break;
-    }
-    case 2: {
-      area /= (2.0f * nz);
-    }
-    }
-    elemAreas[i] = fabsf(area);
+  case 3:
+    detail::RunElementKernel<3>(elemList, vertices, areas, detail::PolygonAreaKernel<3>{});
+    break;
+  case 4:
+    detail::RunElementKernel<4>(elemList, vertices, areas, detail::PolygonAreaKernel<4>{});
+    break;
+  default:
+    throw std::runtime_error("Find2DElementAreas does not support elements with " + std::to_string(elemList->getTupleSize()) + " vertices");
   }
 }
 } // namespace Topology
@@ -1,40 +1,134 @@
 #include "GeometryMath.hpp"
 
-#include <stdexcept>
+#include <limits>
+#include <random>
+
+#include "complex/DataStructure/Geometry/TriangleGeom.hpp"
+#include "complex/DataStructure/Geometry/VertexGeom.hpp"
 
 using namespace complex;
 
+namespace
+{
+/**
+ * @brief Grows the bounds to contain the point.
+ * @param bounds
+ * @param x
+ * @param y
+ * @param z
+ */
+void ExpandBounds(std::array<float, 6>& bounds, float x, float y, float z)
+{
+  bounds[0] = std::min(bounds[0], x);
+  bounds[1] = std::min(bounds[1], y);
+  bounds[2] = std::min(bounds[2], z);
+  bounds[3] = std::max(bounds[3], x);
+  bounds[4] = std::max(bounds[4], y);
+  bounds[5] = std::max(bounds[5], z);
+}
+
+/**
+ * @brief Returns bounds that contain nothing and are invalid until expanded.
+ * @return std::array<float, 6>
+ */
+std::array<float, 6> EmptyBounds()
+{
+  constexpr float max = std::numeric_limits<float>::max();
+  return {max, max, max, -max, -max, -max};
+}
+} // namespace
+
 float complex::GeometryMath::AngleBetweenVectors(const complex::ZXZEuler& a, const complex::ZXZEuler& b)
 {
-  throw std::runtime_error("");
+  const float cosTheta = CosThetaBetweenVectors(Point3D<float>(a[0], a[1], a[2]), Point3D<float>(b[0], b[1], b[2]));
+  return std::acos(cosTheta);
 }
 
 ZXZEuler complex::GeometryMath::FindPolygonNormal(const float* vertices, uint64_t numVerts)
 {
-  throw std::runtime_error("");
+  ZXZEuler normal(0.0f, 0.0f, 0.0f);
+  for(uint64_t i = 0; i < numVerts; i++)
+  {
+    const float* current = vertices + 3 * i;
+    const float* next = vertices + 3 * ((i + 1) % numVerts);
+    normal[0] += (current[1] - next[1]) * (current[2] + next[2]);
+    normal[1] += (current[2] - next[2]) * (current[0] + next[0]);
+    normal[2] += (current[0] - next[0]) * (current[1] + next[1]);
+  }
+  const float length = normal.norm();
+  if(length > 0.0f)
+  {
+    normal /= length;
+  }
+  return normal;
 }
 
 complex::ZXZEuler complex::GeometryMath::FindPlaneNormalVector(const complex::Point3D<float>& p0, const complex::Point3D<float>& p1, const complex::Point3D<float>& p2)
 {
-  throw std::runtime_error("");
+  const ZXZEuler edge0(p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2]);
+  const ZXZEuler edge1(p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2]);
+  ZXZEuler normal = edge0.cross(edge1);
+  const float length = normal.norm();
+  if(length > 0.0f)
+  {
+    normal /= length;
+  }
+  return normal;
 }
 
 complex::Ray<float> complex::GeometryMath::GenerateRandomRay(float length)
 {
-  throw std::runtime_error("");
+  thread_local std::mt19937_64 generator(std::random_device{}());
+  std::uniform_real_distribution<float> heights(-1.0f, 1.0f);
+  std::uniform_real_distribution<float> angles(0.0f, 2.0f * 3.14159265358979f);
+
+  // Uniform on the sphere: uniform height and uniform angle around the z axis
+  const float z = heights(generator);
+  const float angle = angles(generator);
+  const float radius = std::sqrt(std::max(0.0f, 1.0f - z * z));
+  const ZXZEuler direction(radius * std::cos(angle), radius * std::sin(angle), z);
+  return Ray<float>(Point3D<float>(0.0f, 0.0f, 0.0f), direction, length);
 }
 
 complex::BoundingBox<float> complex::GeometryMath::FindBoundingBoxOfVertices(complex::VertexGeom* verts)
 {
-  throw std::runtime_error("");
+  std::array<float, 6> bounds = EmptyBounds();
+  const AbstractGeometry::SharedVertexList* vertices = (verts != nullptr) ? static_cast<const VertexGeom*>(verts)->getVertices() : nullptr;
+  if(vertices == nullptr)
+  {
+    return BoundingBox<float>(bounds);
+  }
+  const usize numVerts = vertices->getTupleCount();
+  for(usize i = 0; i < numVerts; i++)
+  {
+    ExpandBounds(bounds, vertices->at(3 * i), vertices->at(3 * i + 1), vertices->at(3 * i + 2));
+  }
+  return BoundingBox<float>(bounds);
 }
 
 complex::BoundingBox<float> complex::GeometryMath::FindBoundingBoxOfFace(complex::TriangleGeom* faces, int32_t faceId)
 {
-  throw std::runtime_error("");
+  std::array<Point3D<float>, 3> corners;
+  faces->getVertCoordsAtTri(static_cast<usize>(faceId), corners[0], corners[1], corners[2]);
+  std::array<float, 6> bounds = EmptyBounds();
+  for(const auto& corner : corners)
+  {
+    ExpandBounds(bounds, corner[0], corner[1], corner[2]);
+  }
+  return BoundingBox<float>(bounds);
 }
 
 complex::BoundingBox<float> complex::GeometryMath::FindBoundingBoxOfRotatedFace(complex::TriangleGeom* faces, int32_t faceId, float g[3][3])
 {
-  throw std::runtime_error("");
+  std::array<Point3D<float>, 3> corners;
+  faces->getVertCoordsAtTri(static_cast<usize>(faceId), corners[0], corners[1], corners[2]);
+  std::array<float, 6> bounds = EmptyBounds();
+  for(const auto& corner : corners)
+  {
+    const float x = g[0][0] * corner[0] + g[0][1] * corner[1] + g[0][2] * corner[2];
+    const float y = g[1][0] * corner[0] + g[1][1] * corner[1] + g[1][2] * corner[2];
+    const float z = g[2][0] * corner[0] + g[2][1] * corner[1] + g[2][2] * corner[2];
+    ExpandBounds(bounds, x, y, z);
+  }
+  return BoundingBox<float>(bounds);
 }
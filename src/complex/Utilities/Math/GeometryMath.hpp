@@ -1,5 +1,8 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <stdexcept>
 #include <vector>
 
@@ -8,6 +11,7 @@
 #include "complex/Common/Point2D.hpp"
 #include "complex/Common/Point3D.hpp"
 #include "complex/Common/Ray.hpp"
+#include "complex/Common/Types.hpp"
 
 #include "complex/complex_export.hpp"
 
@@ -19,20 +23,206 @@ class VertexGeom;
 namespace GeometryMath
 {
 /**
- * @brief Returns the cosine between two angles defined by a point along each
- * vector. The vectors are assumed to cross at (0,0,0).
+ * @brief Read-only structure of arrays view over count points, one array per
+ * coordinate. Used by the batched overloads below, which loop over the
+ * points without per-point function calls or conversions to Point3D.
+ */
+template <typename T>
+struct PointArrays
+{
+  const T* x = nullptr;
+  const T* y = nullptr;
+  const T* z = nullptr;
+  usize count = 0;
+};
+
+/**
+ * @brief Read-only structure of arrays view over count rays. Directions must
+ * have unit length; a ray covers the segment from its origin to origin +
+ * length * direction.
+ */
+template <typename T>
+struct RayArrays
+{
+  const T* originX = nullptr;
+  const T* originY = nullptr;
+  const T* originZ = nullptr;
+  const T* dirX = nullptr;
+  const T* dirY = nullptr;
+  const T* dirZ = nullptr;
+  const T* length = nullptr;
+  usize count = 0;
+};
+
+namespace detail
+{
+template <typename T>
+using Vec3 = std::array<T, 3>;
+
+template <typename T>
+inline Vec3<T> ToVec3(const Point3D<T>& point)
+{
+  return {point[0], point[1], point[2]};
+}
+
+template <typename T>
+inline Vec3<T> Subtract(const Vec3<T>& a, const Vec3<T>& b)
+{
+  return {a[0] - b[0], a[1] - b[1], a[2] - b[2]};
+}
+
+template <typename T>
+inline T Dot(const Vec3<T>& a, const Vec3<T>& b)
+{
+  return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+template <typename T>
+inline Vec3<T> Cross(const Vec3<T>& a, const Vec3<T>& b)
+{
+  return {a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]};
+}
+
+/**
+ * @brief Returns the unit direction of a ray, which stores its direction as
+ * an unnormalized vector.
+ */
+template <typename T>
+inline Vec3<T> RayDirection(const Ray<T>& ray)
+{
+  const ZXZEuler direction = ray.getEuler().normalized();
+  return {static_cast<T>(direction[0]), static_cast<T>(direction[1]), static_cast<T>(direction[2])};
+}
+
+/**
+ * @brief Per-triangle terms of the barycentric point-in-triangle test.
+ */
+template <typename T>
+struct TriangleFrame
+{
+  Vec3<T> origin;
+  Vec3<T> edge0;
+  Vec3<T> edge1;
+  T d00;
+  T d01;
+  T d11;
+  T denominator;
+
+  TriangleFrame(const Point3D<T>& p0, const Point3D<T>& p1, const Point3D<T>& p2)
+  : origin(ToVec3(p0))
+  , edge0(Subtract(ToVec3(p1), origin))
+  , edge1(Subtract(ToVec3(p2), origin))
+  , d00(Dot(edge0, edge0))
+  , d01(Dot(edge0, edge1))
+  , d11(Dot(edge1, edge1))
+  , denominator(d00 * d11 - d01 * d01)
+  {
+  }
+
+  /**
+   * @brief Returns true if the orthogonal projection of the point onto the
+   * plane of the triangle lies inside the triangle or on its boundary.
+   * Degenerate triangles contain no points.
+   */
+  bool contains(T x, T y, T z) const
+  {
+    const Vec3<T> offset = {x - origin[0], y - origin[1], z - origin[2]};
+    const T d20 = Dot(offset, edge0);
+    const T d21 = Dot(offset, edge1);
+    const T v = d11 * d20 - d01 * d21;
+    const T w = d00 * d21 - d01 * d20;
+    return (denominator > T(0)) & (v >= T(0)) & (w >= T(0)) & (v + w <= denominator);
+  }
+};
+
+/**
+ * @brief Clips one axis of a segment against the slab [min, max] and narrows
+ * the parameter range. A segment parallel to the slab is either inside for
+ * its whole length or misses it; testing that explicitly avoids the NaN of
+ * 0 * inf when the origin lies on a slab plane.
+ */
+template <typename T>
+inline void ClipToSlab(T origin, T dir, T min, T max, T& near, T& far)
+{
+  if(dir == T(0))
+  {
+    if(origin < min || origin > max)
+    {
+      near = T(1);
+      far = T(0);
+    }
+    return;
+  }
+  const T inv = T(1) / dir;
+  const T t0 = (min - origin) * inv;
+  const T t1 = (max - origin) * inv;
+  near = std::fmax(near, std::fmin(t0, t1));
+  far = std::fmin(far, std::fmax(t0, t1));
+}
+
+/**
+ * @brief Clips the segment from origin along dir of the specified length
+ * against the slabs of the box and writes the parameter range inside it. The
+ * range is empty if near > far.
+ */
+template <typename T>
+inline void ClipToBox(T originX, T originY, T originZ, T dirX, T dirY, T dirZ, T length, const BoundingBox<T>& box, T& near, T& far)
+{
+  near = T(0);
+  far = length;
+  ClipToSlab(originX, dirX, box.getMinX(), box.getMaxX(), near, far);
+  ClipToSlab(originY, dirY, box.getMinY(), box.getMaxY(), near, far);
+  ClipToSlab(originZ, dirZ, box.getMinZ(), box.getMaxZ(), near, far);
+}
+
+/**
+ * @brief Moller-Trumbore intersection of a segment with a triangle given by
+ * p0 and its edges. Returns the distance along the unit direction or a
+ * negative value if the segment misses the triangle or lies in its plane.
+ */
+template <typename T>
+inline T IntersectTriangle(const Vec3<T>& origin, const Vec3<T>& dir, T length, const Vec3<T>& p0, const Vec3<T>& edge0, const Vec3<T>& edge1)
+{
+  const Vec3<T> pvec = Cross(dir, edge1);
+  const T det = Dot(edge0, pvec);
+  if(det == T(0))
+  {
+    return T(-1);
+  }
+  const T invDet = T(1) / det;
+  const Vec3<T> tvec = Subtract(origin, p0);
+  const T u = Dot(tvec, pvec) * invDet;
+  const Vec3<T> qvec = Cross(tvec, edge0);
+  const T v = Dot(dir, qvec) * invDet;
+  const T t = Dot(edge1, qvec) * invDet;
+  const bool hit = (u >= T(0)) & (v >= T(0)) & (u + v <= T(1)) & (t >= T(0)) & (t <= length);
+  return hit ? t : T(-1);
+}
+} // namespace detail
+
+/**
+ * @brief Returns the cosine of the angle between two vectors. The vectors
+ * are assumed to cross at (0,0,0). Returns 1 if either vector has zero
+ * length.
  * @param a
  * @param b
- * @return float
+ * @return T
  */
 template <typename T>
 T CosThetaBetweenVectors(const complex::Point3D<T>& a, const complex::Point3D<T>& b)
 {
-  throw std::runtime_error("");
+  const detail::Vec3<T> va = detail::ToVec3(a);
+  const detail::Vec3<T> vb = detail::ToVec3(b);
+  const T norms = std::sqrt(detail::Dot(va, va) * detail::Dot(vb, vb));
+  if(norms == T(0))
+  {
+    return T(1);
+  }
+  return std::clamp(detail::Dot(va, vb) / norms, T(-1), T(1));
 }
 
 /**
- * @brief Returns the angle between two vectors that are defined by a ZXZEuler.
+ * @brief Returns the angle in radians between two vectors stored as ZXZEuler.
  * @param a
  * @param b
  * @return float
@@ -48,7 +238,8 @@ float COMPLEX_EXPORT AngleBetweenVectors(const complex::ZXZEuler& a, const compl
 template <typename T>
 T FindDistanceBetweenPoints(const complex::Point3D<T>& a, const complex::Point3D<T>& b)
 {
-  throw std::runtime_error("");
+  const detail::Vec3<T> offset = detail::Subtract(detail::ToVec3(a), detail::ToVec3(b));
+  return std::sqrt(detail::Dot(offset, offset));
 }
 
 /**
@@ -60,7 +251,30 @@ T FindDistanceBetweenPoints(const complex::Point3D<T>& a, const complex::Point3D
 template <typename T>
 T FindDistanceBetweenPoints(const complex::Point2D<T>& a, const complex::Point2D<T>& b)
 {
-  throw std::runtime_error("");
+  const T x = a[0] - b[0];
+  const T y = a[1] - b[1];
+  return std::sqrt(x * x + y * y);
+}
+
+/**
+ * @brief Writes the distance between each point and target to distances.
+ * @param points
+ * @param target
+ * @param distances Holds points.count values
+ */
+template <typename T>
+void FindDistanceBetweenPoints(const PointArrays<T>& points, const complex::Point3D<T>& target, T* distances)
+{
+  const T tx = target[0];
+  const T ty = target[1];
+  const T tz = target[2];
+  for(usize i = 0; i < points.count; i++)
+  {
+    const T x = points.x[i] - tx;
+    const T y = points.y[i] - ty;
+    const T z = points.z[i] - tz;
+    distances[i] = std::sqrt(x * x + y * y + z * z);
+  }
 }
 
 /**
@@ -73,7 +287,9 @@ T FindDistanceBetweenPoints(const complex::Point2D<T>& a, const complex::Point2D
 template <typename T>
 T FindTriangleArea(const complex::Point3D<T>& a, const complex::Point3D<T>& b, const complex::Point3D<T>& c)
 {
-  throw std::runtime_error("");
+  const detail::Vec3<T> origin = detail::ToVec3(a);
+  const detail::Vec3<T> normal = detail::Cross(detail::Subtract(detail::ToVec3(b), origin), detail::Subtract(detail::ToVec3(c), origin));
+  return std::sqrt(detail::Dot(normal, normal)) / T(2);
 }
 
 /**
@@ -82,36 +298,42 @@ T FindTriangleArea(const complex::Point3D<T>& a, const complex::Point3D<T>& b, c
  * @param p1
  * @param p2
  * @param p3
- * @return float
+ * @return T
  */
 template <typename T>
 T FindTetrahedronVolume(const complex::Point3D<T>& p0, const complex::Point3D<T>& p1, const complex::Point3D<T>& p2, const complex::Point3D<T>& p3)
 {
-  throw std::runtime_error("");
+  const detail::Vec3<T> origin = detail::ToVec3(p0);
+  const detail::Vec3<T> a = detail::Subtract(detail::ToVec3(p1), origin);
+  const detail::Vec3<T> b = detail::Subtract(detail::ToVec3(p2), origin);
+  const detail::Vec3<T> c = detail::Subtract(detail::ToVec3(p3), origin);
+  return std::abs(detail::Dot(a, detail::Cross(b, c))) / T(6);
 }
 
 /**
- * @brief Returns the normal angle for an arbitrary polygon defined by an array
- * of vertices.
- * @param vertices
+ * @brief Returns the unit normal of an arbitrary polygon defined by an array
+ * of vertices, computed with Newell's method so nearly collinear corners do
+ * not matter. Returns a zero vector for degenerate polygons.
+ * @param vertices Interleaved xyz coordinates of numVerts vertices
  * @param numVerts
- * @return complex::ZXZEuler<float>
+ * @return complex::ZXZEuler
  */
 ZXZEuler COMPLEX_EXPORT FindPolygonNormal(const float* vertices, uint64_t numVerts);
 
 /**
- * @brief Returns the normal vector for a plane defined by three points along
- * its surface.
+ * @brief Returns the unit normal vector for a plane defined by three points
+ * along its surface, following the right-hand rule. Returns a zero vector if
+ * the points are collinear.
  * @param p0
  * @param p1
  * @param p2
- * @return complex::ZXZEuler<T>
+ * @return complex::ZXZEuler
  */
 complex::ZXZEuler COMPLEX_EXPORT FindPlaneNormalVector(const complex::Point3D<float>& p0, const complex::Point3D<float>& p1, const complex::Point3D<float>& p2);
 
 /**
  * @brief Finds the coefficients and normal for a plane defined by three points
- * along its surface.
+ * along its surface. Points x on the plane satisfy normal . x = c.
  * @param p0
  * @param p1
  * @param p2
@@ -119,9 +341,13 @@ complex::ZXZEuler COMPLEX_EXPORT FindPlaneNormalVector(const complex::Point3D<fl
  * @param normal
  */
 template <typename T>
-void FindPlaneCoefficients(const complex::Point3D<T>& p0, const complex::Point3D<T>& p1, const complex::Point3D<T>& p2, const float& c, ZXZEuler& normal)
+void FindPlaneCoefficients(const complex::Point3D<T>& p0, const complex::Point3D<T>& p1, const complex::Point3D<T>& p2, float& c, ZXZEuler& normal)
 {
-  throw std::runtime_error("");
+  const Point3D<float> a(static_cast<float>(p0[0]), static_cast<float>(p0[1]), static_cast<float>(p0[2]));
+  const Point3D<float> b(static_cast<float>(p1[0]), static_cast<float>(p1[1]), static_cast<float>(p1[2]));
+  const Point3D<float> d(static_cast<float>(p2[0]), static_cast<float>(p2[1]), static_cast<float>(p2[2]));
+  normal = FindPlaneNormalVector(a, b, d);
+  c = normal[0] * a[0] + normal[1] * a[1] + normal[2] * a[2];
 }
 
 /**
@@ -136,12 +362,14 @@ void FindPlaneCoefficients(const complex::Point3D<T>& p0, const complex::Point3D
 template <typename T>
 float FindDistanceToTriangleCentroid(const complex::Point3D<T>& p0, const complex::Point3D<T>& p1, const complex::Point3D<T>& p2, const complex::Point3D<T>& point)
 {
-  throw std::runtime_error("");
+  const Point3D<T> centroid((p0[0] + p1[0] + p2[0]) / T(3), (p0[1] + p1[1] + p2[1]) / T(3), (p0[2] + p1[2] + p2[2]) / T(3));
+  return static_cast<float>(FindDistanceBetweenPoints(centroid, point));
 }
 
 /**
- * @brief Returns the distance between a point and a plane defined by three
- * points along its surface.
+ * @brief Returns the signed distance between a point and a plane defined by
+ * three points along its surface. The distance is positive on the side the
+ * normal from FindPlaneNormalVector() points to.
  * @param p0
  * @param p1
  * @param p2
@@ -151,11 +379,15 @@ float FindDistanceToTriangleCentroid(const complex::Point3D<T>& p0, const comple
 template <typename T>
 float FindDistanceFromPlane(const complex::Point3D<T>& p0, const complex::Point3D<T>& p1, const complex::Point3D<T>& p2, const complex::Point3D<T>& pos)
 {
-  throw std::runtime_error("");
+  float c = 0.0f;
+  ZXZEuler normal;
+  FindPlaneCoefficients(p0, p1, p2, c, normal);
+  return normal[0] * static_cast<float>(pos[0]) + normal[1] * static_cast<float>(pos[1]) + normal[2] * static_cast<float>(pos[2]) - c;
 }
 
 /**
- * @brief Returns true if a point is within the specified box.
+ * @brief Returns true if a point is within the specified box. Points on the
+ * boundary are inside.
  * @param point
  * @param box
  * @return bool
@@ -163,7 +395,32 @@ float FindDistanceFromPlane(const complex::Point3D<T>& p0, const complex::Point3
 template <typename T>
 bool IsPointInBox(const complex::Point3D<T>& point, const complex::BoundingBox<T>& box)
 {
-  throw std::runtime_error("");
+  return (point[0] >= box.getMinX()) && (point[0] <= box.getMaxX()) && (point[1] >= box.getMinY()) && (point[1] <= box.getMaxY()) && (point[2] >= box.getMinZ()) && (point[2] <= box.getMaxZ());
+}
+
+/**
+ * @brief Sets inside[i] to 1 if point i is within the specified box and to 0
+ * otherwise.
+ * @param points
+ * @param box
+ * @param inside Holds points.count values
+ */
+template <typename T>
+void IsPointInBox(const PointArrays<T>& points, const complex::BoundingBox<T>& box, uint8_t* inside)
+{
+  const T minX = box.getMinX();
+  const T minY = box.getMinY();
+  const T minZ = box.getMinZ();
+  const T maxX = box.getMaxX();
+  const T maxY = box.getMaxY();
+  const T maxZ = box.getMaxZ();
+  for(usize i = 0; i < points.count; i++)
+  {
+    const T x = points.x[i];
+    const T y = points.y[i];
+    const T z = points.z[i];
+    inside[i] = static_cast<uint8_t>((x >= minX) & (x <= maxX) & (y >= minY) & (y <= maxY) & (z >= minZ) & (z <= maxZ));
+  }
 }
 
 /**
@@ -186,7 +443,8 @@ bool IsPointInBox(const complex::Point3D<T>& point, const complex::BoundingBox<T
 /**
  * @brief Returns true if a point is within the triangle defined by three
  * specified points. Returns false otherwise. This function operates in 3D
- * space.
+ * space: the point is projected onto the plane of the triangle, and points
+ * on the boundary are inside.
  * @param p0
  * @param p1
  * @param p2
@@ -196,13 +454,32 @@ bool IsPointInBox(const complex::Point3D<T>& point, const complex::BoundingBox<T
 template <typename T>
 bool IsPointInTriangle3D(const complex::Point3D<T>& p0, const complex::Point3D<T>& p1, const complex::Point3D<T>& p2, const complex::Point3D<T>& point)
 {
-  throw std::runtime_error("");
+  return detail::TriangleFrame<T>(p0, p1, p2).contains(point[0], point[1], point[2]);
+}
+
+/**
+ * @brief Sets inside[i] to 1 if point i is within the triangle defined by
+ * three specified points and to 0 otherwise. See IsPointInTriangle3D().
+ * @param p0
+ * @param p1
+ * @param p2
+ * @param points
+ * @param inside Holds points.count values
+ */
+template <typename T>
+void IsPointInTriangle3D(const complex::Point3D<T>& p0, const complex::Point3D<T>& p1, const complex::Point3D<T>& p2, const PointArrays<T>& points, uint8_t* inside)
+{
+  const detail::TriangleFrame<T> triangle(p0, p1, p2);
+  for(usize i = 0; i < points.count; i++)
+  {
+    inside[i] = static_cast<uint8_t>(triangle.contains(points.x[i], points.y[i], points.z[i]));
+  }
 }
 
 /**
  * @brief Returns true if a point is within the triangle defined by three
  * specified points. Returns false otherwise. This function operates in 2D
- * space.
+ * space. Points on the boundary are inside.
  * @param p0
  * @param p1
  * @param p2
@@ -212,12 +489,17 @@ bool IsPointInTriangle3D(const complex::Point3D<T>& p0, const complex::Point3D<T
 template <typename T>
 bool IsPointInTriangle2D(const complex::Point2D<T>& p0, const complex::Point2D<T>& p1, const complex::Point2D<T>& p2, const complex::Point2D<T>& point)
 {
-  throw std::runtime_error("");
+  const T s0 = (p1[0] - p0[0]) * (point[1] - p0[1]) - (p1[1] - p0[1]) * (point[0] - p0[0]);
+  const T s1 = (p2[0] - p1[0]) * (point[1] - p1[1]) - (p2[1] - p1[1]) * (point[0] - p1[0]);
+  const T s2 = (p0[0] - p2[0]) * (point[1] - p2[1]) - (p0[1] - p2[1]) * (point[0] - p2[0]);
+  const bool hasNegative = (s0 < T(0)) || (s1 < T(0)) || (s2 < T(0));
+  const bool hasPositive = (s0 > T(0)) || (s1 > T(0)) || (s2 > T(0));
+  return !(hasNegative && hasPositive);
 }
 
 /**
  * @brief Returns true if a ray intersects the specified box. Returns false
- * otherwise.
+ * otherwise. The ray covers the segment from its origin to its end point.
  * @param ray
  * @param bounds
  * @return bool
@@ -225,7 +507,31 @@ bool IsPointInTriangle2D(const complex::Point2D<T>& p0, const complex::Point2D<T
 template <typename T>
 bool DoesRayIntersectBox(complex::Ray<T> ray, const complex::BoundingBox<T>& bounds)
 {
-  throw std::runtime_error("");
+  const Point3D<T> origin = ray.getOrigin();
+  const detail::Vec3<T> dir = detail::RayDirection(ray);
+  T near = 0;
+  T far = 0;
+  detail::ClipToBox(origin[0], origin[1], origin[2], dir[0], dir[1], dir[2], ray.getLength(), bounds, near, far);
+  return near <= far;
+}
+
+/**
+ * @brief Sets hits[i] to 1 if ray i intersects the specified box and to 0
+ * otherwise.
+ * @param rays
+ * @param bounds
+ * @param hits Holds rays.count values
+ */
+template <typename T>
+void DoesRayIntersectBox(const RayArrays<T>& rays, const complex::BoundingBox<T>& bounds, uint8_t* hits)
+{
+  for(usize i = 0; i < rays.count; i++)
+  {
+    T near = 0;
+    T far = 0;
+    detail::ClipToBox(rays.originX[i], rays.originY[i], rays.originZ[i], rays.dirX[i], rays.dirY[i], rays.dirZ[i], rays.length[i], bounds, near, far);
+    hits[i] = static_cast<uint8_t>(near <= far);
+  }
 }
 
 /**
@@ -237,35 +543,62 @@ bool DoesRayIntersectBox(complex::Ray<T> ray, const complex::BoundingBox<T>& bou
  * @param origin
  * @param radius
  * @param intersections
- * @return bool
+ * @return uint8_t
  */
 template <typename T>
 uint8_t FindRayIntersectionsWithSphere(const complex::Ray<T>& ray, const complex::Point3D<T>& origin, T radius, std::vector<Point3D<T>>& intersections)
 {
-  throw std::runtime_error("");
+  intersections.clear();
+  const detail::Vec3<T> start = detail::ToVec3(ray.getOrigin());
+  const detail::Vec3<T> dir = detail::RayDirection(ray);
+  const detail::Vec3<T> offset = detail::Subtract(start, detail::ToVec3(origin));
+  const T b = detail::Dot(offset, dir);
+  const T discriminant = b * b - (detail::Dot(offset, offset) - radius * radius);
+  if(discriminant < T(0))
+  {
+    return 0;
+  }
+  const T root = std::sqrt(discriminant);
+  const std::array<T, 2> distances = {-b - root, -b + root};
+  const usize numRoots = (root == T(0)) ? 1 : 2;
+  for(usize i = 0; i < numRoots; i++)
+  {
+    if(distances[i] >= T(0) && distances[i] <= ray.getLength())
+    {
+      intersections.emplace_back(start[0] + distances[i] * dir[0], start[1] + distances[i] * dir[1], start[2] + distances[i] * dir[2]);
+    }
+  }
+  return static_cast<uint8_t>(intersections.size());
 }
 
 /**
- * @brief Returns the length of an array that falls within the specified box.
+ * @brief Returns the length of a ray that falls within the specified box.
  * @param ray
  * @param box
- * @return float
+ * @return T
  */
 template <typename T>
 T GetLengthOfRayInBox(const complex::Ray<T>& ray, const complex::BoundingBox<T>& box)
 {
-  throw std::runtime_error("");
+  const Point3D<T> origin = ray.getOrigin();
+  const detail::Vec3<T> dir = detail::RayDirection(ray);
+  T near = 0;
+  T far = 0;
+  detail::ClipToBox(origin[0], origin[1], origin[2], dir[0], dir[1], dir[2], ray.getLength(), box, near, far);
+  return std::max(far - near, T(0));
 }
 
 /**
- * @brief Generates a random Ray with the specified length.
+ * @brief Generates a Ray starting at (0,0,0) with the specified length and a
+ * direction drawn uniformly from the unit sphere.
  * @param length
  * @return complex::Ray<float>
  */
 complex::Ray<float> COMPLEX_EXPORT GenerateRandomRay(float length);
 
 /**
- * @brief Returns the BoundingBox around the specified vertices.
+ * @brief Returns the BoundingBox around the specified vertices. The box is
+ * invalid if there are no vertices.
  * @param verts
  * @return complex::BoundingBox<float>
  */
@@ -316,18 +649,53 @@ complex::BoundingBox<float> COMPLEX_EXPORT FindBoundingBoxOfRotatedFace(complex:
  * @brief Checks if the specified Ray intersects a triangle defined by the
  * corner points. The inter parameter is updated to reflect the points at which
  * the ray intersects the triangle. Returns the number of points at which the
- * Ray intersects the triangle.
+ * Ray intersects the triangle. Rays lying in the plane of the triangle do not
+ * intersect it.
  * @param ray
  * @param p0
  * @param p1
  * @param p2
  * @param inter
- * @return char
+ * @return uint8_t
  */
 template <typename T>
 uint8_t RayIntersectsTriangle(const Ray<T>& ray, const complex::Point3D<T>& p0, const complex::Point3D<T>& p1, const complex::Point3D<T>& p2, std::vector<Point3D<T>>& inter)
 {
-  throw std::runtime_error("");
+  inter.clear();
+  const detail::Vec3<T> origin = detail::ToVec3(ray.getOrigin());
+  const detail::Vec3<T> dir = detail::RayDirection(ray);
+  const detail::Vec3<T> corner = detail::ToVec3(p0);
+  const T distance = detail::IntersectTriangle(origin, dir, ray.getLength(), corner, detail::Subtract(detail::ToVec3(p1), corner), detail::Subtract(detail::ToVec3(p2), corner));
+  if(distance < T(0))
+  {
+    return 0;
+  }
+  inter.emplace_back(origin[0] + distance * dir[0], origin[1] + distance * dir[1], origin[2] + distance * dir[2]);
+  return 1;
+}
+
+/**
+ * @brief Writes the distance along each ray to the triangle defined by the
+ * corner points to distances, or a negative value if the ray misses it. See
+ * RayIntersectsTriangle().
+ * @param rays
+ * @param p0
+ * @param p1
+ * @param p2
+ * @param distances Holds rays.count values
+ */
+template <typename T>
+void RayIntersectsTriangle(const RayArrays<T>& rays, const complex::Point3D<T>& p0, const complex::Point3D<T>& p1, const complex::Point3D<T>& p2, T* distances)
+{
+  const detail::Vec3<T> corner = detail::ToVec3(p0);
+  const detail::Vec3<T> edge0 = detail::Subtract(detail::ToVec3(p1), corner);
+  const detail::Vec3<T> edge1 = detail::Subtract(detail::ToVec3(p2), corner);
+  for(usize i = 0; i < rays.count; i++)
+  {
+    const detail::Vec3<T> origin = {rays.originX[i], rays.originY[i], rays.originZ[i]};
+    const detail::Vec3<T> dir = {rays.dirX[i], rays.dirY[i], rays.dirZ[i]};
+    distances[i] = detail::IntersectTriangle(origin, dir, rays.length[i], corner, edge0, edge1);
+  }
 }
 
 /**
@@ -345,7 +713,21 @@ uint8_t RayIntersectsTriangle(const Ray<T>& ray, const complex::Point3D<T>& p0,
 template <typename T>
 bool RayCrossesTriangle(const Ray<T>& ray, const Point3D<T>& p0, const Point3D<T>& p1, const Point3D<T>& p2)
 {
-  throw std::runtime_error("");
+  const detail::Vec3<T> origin = detail::ToVec3(ray.getOrigin());
+  const detail::Vec3<T> dir = detail::RayDirection(ray);
+  const detail::Vec3<T> corner = detail::ToVec3(p0);
+  const detail::Vec3<T> edge0 = detail::Subtract(detail::ToVec3(p1), corner);
+  const detail::Vec3<T> edge1 = detail::Subtract(detail::ToVec3(p2), corner);
+  const detail::Vec3<T> normal = detail::Cross(edge0, edge1);
+
+  // The end points have to lie strictly on opposite sides of the plane
+  const T startSide = detail::Dot(normal, detail::Subtract(origin, corner));
+  const T endSide = startSide + ray.getLength() * detail::Dot(normal, dir);
+  if(!((startSide < T(0) && endSide > T(0)) || (startSide > T(0) && endSide < T(0))))
+  {
+    return false;
+  }
+  return detail::IntersectTriangle(origin, dir, ray.getLength(), corner, edge0, edge1) >= T(0);
 }
 
 /**
@@ -360,7 +742,11 @@ bool RayCrossesTriangle(const Ray<T>& ray, const Point3D<T>& p0, const Point3D<T
 template <typename T>
 bool RayIntersectsPlane(const Ray<T>& ray, const Point3D<T>& p0, const Point3D<T>& p1, const Point3D<T>& p2)
 {
-  throw std::runtime_error("");
+  const detail::Vec3<T> corner = detail::ToVec3(p0);
+  const detail::Vec3<T> normal = detail::Cross(detail::Subtract(detail::ToVec3(p1), corner), detail::Subtract(detail::ToVec3(p2), corner));
+  const T startSide = detail::Dot(normal, detail::Subtract(detail::ToVec3(ray.getOrigin()), corner));
+  const T endSide = startSide + ray.getLength() * detail::Dot(normal, detail::RayDirection(ray));
+  return (startSide <= T(0) && endSide >= T(0)) || (startSide >= T(0) && endSide <= T(0));
 }
 } // namespace GeometryMath
 } // namespace complex
@@ -0,0 +1,436 @@
+#include "complex/Utilities/MemoryMappedFile.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <utility>
+
+#include <fmt/core.h>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <Windows.h>
+#elif defined(__linux__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+static_assert(false, "Memory mapped files not implemented on this platform");
+#endif
+
+using namespace complex;
+
+namespace
+{
+constexpr usize k_MaxScratchAttempts = 16;
+
+std::string GetErrorMessage()
+{
+#if defined(_WIN32)
+  return fmt::format("error code {}", GetLastError());
+#else
+  return std::strerror(errno);
+#endif
+}
+
+std::filesystem::path GenerateScratchPath(const std::filesystem::path& directory)
+{
+  static std::atomic<u64> s_Counter = 0;
+  static thread_local std::mt19937_64 s_Generator(std::random_device{}());
+  return directory / fmt::format("complex-{:016x}-{}.tmp", s_Generator(), s_Counter++);
+}
+
+/**
+ * @brief Returns the alignment required for the file offset of a mapping.
+ * @return usize
+ */
+usize GetAllocationGranularity()
+{
+#if defined(_WIN32)
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  return static_cast<usize>(info.dwAllocationGranularity);
+#else
+  return static_cast<usize>(::sysconf(_SC_PAGESIZE));
+#endif
+}
+
+/**
+ * @brief Returns the distance from the start of the mapping to the first
+ * byte at offset, which is mapped from the aligned offset below it.
+ * @param offset
+ * @return usize
+ */
+usize GetMappingDelta(usize offset)
+{
+  static const usize s_Granularity = GetAllocationGranularity();
+  return offset % s_Granularity;
+}
+} // namespace
+
+MemoryMappedFile MemoryMappedFile::CreateScratch(usize size)
+{
+  return CreateScratch(std::filesystem::temp_directory_path(), size);
+}
+
+MemoryMappedFile MemoryMappedFile::CreateScratch(const std::filesystem::path& directory, usize size)
+{
+  MemoryMappedFile file;
+  file.m_IsScratch = true;
+  for(usize attempt = 0; attempt < k_MaxScratchAttempts; attempt++)
+  {
+    file.m_Path = GenerateScratchPath(directory);
+    if(std::filesystem::exists(file.m_Path))
+    {
+      continue;
+    }
+    file.open(size, true);
+    return file;
+  }
+  throw std::runtime_error(fmt::format("Unable to create a unique scratch file in \"{}\"", directory.string()));
+}
+
+MemoryMappedFile MemoryMappedFile::OpenPersistent(const std::filesystem::path& path, usize size)
+{
+  MemoryMappedFile file;
+  file.m_Path = path;
+  file.m_IsScratch = false;
+  file.open(size, false);
+  return file;
+}
+
+MemoryMappedFile MemoryMappedFile::OpenView(const std::filesystem::path& path, usize offset, usize size)
+{
+  MemoryMappedFile file;
+  file.m_Path = path;
+  file.m_IsView = true;
+  file.m_ViewOffset = offset;
+#if defined(_WIN32)
+  HANDLE handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if(handle == INVALID_HANDLE_VALUE)
+  {
+    throw std::runtime_error(fmt::format("Unable to open \"{}\" for mapping: {}", path.string(), GetErrorMessage()));
+  }
+  file.m_FileHandle = handle;
+#else
+  file.m_FileDescriptor = ::open(path.c_str(), O_RDONLY);
+  if(file.m_FileDescriptor < 0)
+  {
+    throw std::runtime_error(fmt::format("Unable to open \"{}\" for mapping: {}", path.string(), GetErrorMessage()));
+  }
+#endif
+  std::error_code errorCode;
+  const auto fileSize = static_cast<usize>(std::filesystem::file_size(path, errorCode));
+  if(errorCode || offset > fileSize || size > fileSize - offset)
+  {
+    throw std::runtime_error(fmt::format("Unable to map {} bytes at offset {} of \"{}\": the file is too small", size, offset, path.string()));
+  }
+  file.m_Size = size;
+  file.map();
+
+  // The mapping stays valid without the file handle, so release it instead of holding one per view
+#if defined(_WIN32)
+  if(file.m_MappingHandle != nullptr)
+  {
+    CloseHandle(file.m_MappingHandle);
+    file.m_MappingHandle = nullptr;
+  }
+  CloseHandle(file.m_FileHandle);
+  file.m_FileHandle = nullptr;
+#else
+  ::close(file.m_FileDescriptor);
+  file.m_FileDescriptor = -1;
+#endif
+  return file;
+}
+
+MemoryMappedFile::MemoryMappedFile() noexcept = default;
+
+MemoryMappedFile::MemoryMappedFile(MemoryMappedFile&& other) noexcept
+: m_Path(std::move(other.m_Path))
+, m_Data(std::exchange(other.m_Data, nullptr))
+, m_Size(std::exchange(other.m_Size, 0))
+, m_ViewOffset(std::exchange(other.m_ViewOffset, 0))
+, m_IsScratch(std::exchange(other.m_IsScratch, false))
+, m_IsView(std::exchange(other.m_IsView, false))
+#if defined(_WIN32)
+, m_FileHandle(std::exchange(other.m_FileHandle, nullptr))
+, m_MappingHandle(std::exchange(other.m_MappingHandle, nullptr))
+#else
+, m_FileDescriptor(std::exchange(other.m_FileDescriptor, -1))
+#endif
+{
+}
+
+MemoryMappedFile& MemoryMappedFile::operator=(MemoryMappedFile&& rhs) noexcept
+{
+  if(this != &rhs)
+  {
+    close();
+    m_Path = std::move(rhs.m_Path);
+    m_Data = std::exchange(rhs.m_Data, nullptr);
+    m_Size = std::exchange(rhs.m_Size, 0);
+    m_ViewOffset = std::exchange(rhs.m_ViewOffset, 0);
+    m_IsScratch = std::exchange(rhs.m_IsScratch, false);
+    m_IsView = std::exchange(rhs.m_IsView, false);
+#if defined(_WIN32)
+    m_FileHandle = std::exchange(rhs.m_FileHandle, nullptr);
+    m_MappingHandle = std::exchange(rhs.m_MappingHandle, nullptr);
+#else
+    m_FileDescriptor = std::exchange(rhs.m_FileDescriptor, -1);
+#endif
+  }
+  return *this;
+}
+
+MemoryMappedFile::~MemoryMappedFile() noexcept
+{
+  close();
+}
+
+bool MemoryMappedFile::isOpen() const
+{
+#if defined(_WIN32)
+  return m_IsView || m_FileHandle != nullptr;
+#else
+  return m_IsView || m_FileDescriptor >= 0;
+#endif
+}
+
+bool MemoryMappedFile::isScratch() const
+{
+  return m_IsScratch;
+}
+
+bool MemoryMappedFile::isView() const
+{
+  return m_IsView;
+}
+
+std::filesystem::path MemoryMappedFile::getPath() const
+{
+  return m_Path;
+}
+
+usize MemoryMappedFile::size() const
+{
+  return m_Size;
+}
+
+void* MemoryMappedFile::data()
+{
+  return m_Data;
+}
+
+const void* MemoryMappedFile::data() const
+{
+  return m_Data;
+}
+
+void MemoryMappedFile::open(usize size, bool exclusive)
+{
+#if defined(_WIN32)
+  DWORD flags = FILE_ATTRIBUTE_NORMAL;
+  if(m_IsScratch)
+  {
+    flags = FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE;
+  }
+  HANDLE handle = CreateFileW(m_Path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, exclusive ? CREATE_NEW : OPEN_ALWAYS, flags, nullptr);
+  if(handle == INVALID_HANDLE_VALUE)
+  {
+    throw std::runtime_error(fmt::format("Unable to open \"{}\" for mapping: {}", m_Path.string(), GetErrorMessage()));
+  }
+  m_FileHandle = handle;
+#else
+  int flags = O_RDWR | O_CREAT;
+  if(exclusive)
+  {
+    flags |= O_EXCL;
+  }
+  m_FileDescriptor = ::open(m_Path.c_str(), flags, S_IRUSR | S_IWUSR);
+  if(m_FileDescriptor < 0)
+  {
+    throw std::runtime_error(fmt::format("Unable to open \"{}\" for mapping: {}", m_Path.string(), GetErrorMessage()));
+  }
+  if(m_IsScratch)
+  {
+    // Unlink immediately so the scratch file cannot outlive the process
+    ::unlink(m_Path.c_str());
+  }
+#endif
+  resize(size);
+}
+
+void MemoryMappedFile::map()
+{
+  if(m_Size == 0)
+  {
+    return;
+  }
+  // Views may start anywhere in the file, so map from the aligned offset below
+  const usize delta = GetMappingDelta(m_ViewOffset);
+  const auto offset = static_cast<u64>(m_ViewOffset - delta);
+#if defined(_WIN32)
+  if(m_IsView)
+  {
+    m_MappingHandle = CreateFileMappingW(m_FileHandle, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+  }
+  else
+  {
+    const auto size = static_cast<u64>(m_Size);
+    m_MappingHandle = CreateFileMappingW(m_FileHandle, nullptr, PAGE_READWRITE, static_cast<DWORD>(size >> 32), static_cast<DWORD>(size & 0xFFFFFFFFull), nullptr);
+  }
+  if(m_MappingHandle == nullptr)
+  {
+    throw std::runtime_error(fmt::format("Unable to map \"{}\": {}", m_Path.string(), GetErrorMessage()));
+  }
+  void* data = MapViewOfFile(m_MappingHandle, m_IsView ? FILE_MAP_COPY : FILE_MAP_ALL_ACCESS, static_cast<DWORD>(offset >> 32), static_cast<DWORD>(offset & 0xFFFFFFFFull), m_Size + delta);
+  if(data == nullptr)
+  {
+    CloseHandle(m_MappingHandle);
+    m_MappingHandle = nullptr;
+    throw std::runtime_error(fmt::format("Unable to map \"{}\": {}", m_Path.string(), GetErrorMessage()));
+  }
+#else
+  void* data = ::mmap(nullptr, m_Size + delta, PROT_READ | PROT_WRITE, m_IsView ? MAP_PRIVATE : MAP_SHARED, m_FileDescriptor, static_cast<off_t>(offset));
+  if(data == MAP_FAILED)
+  {
+    throw std::runtime_error(fmt::format("Unable to map \"{}\": {}", m_Path.string(), GetErrorMessage()));
+  }
+#endif
+  m_Data = static_cast<u8*>(data) + delta;
+}
+
+void MemoryMappedFile::unmap() noexcept
+{
+  const usize delta = GetMappingDelta(m_ViewOffset);
+#if defined(_WIN32)
+  if(m_Data != nullptr)
+  {
+    UnmapViewOfFile(static_cast<u8*>(m_Data) - delta);
+  }
+  if(m_MappingHandle != nullptr)
+  {
+    CloseHandle(m_MappingHandle);
+    m_MappingHandle = nullptr;
+  }
+#else
+  if(m_Data != nullptr)
+  {
+    ::munmap(static_cast<u8*>(m_Data) - delta, m_Size + delta);
+  }
+#endif
+  m_Data = nullptr;
+}
+
+void MemoryMappedFile::resize(usize size)
+{
+  if(!isOpen())
+  {
+    throw std::runtime_error("Unable to resize a MemoryMappedFile that is not open");
+  }
+  if(m_IsView)
+  {
+    // Growing or shrinking a view would change the mapped file, so move it to a scratch file instead
+    MemoryMappedFile scratch = CreateScratch(size);
+    const usize count = std::min(size, m_Size);
+    if(count > 0)
+    {
+      std::memcpy(scratch.data(), m_Data, count);
+    }
+    *this = std::move(scratch);
+    return;
+  }
+  // Windows cannot resize a mapped file, so the view is always dropped first
+  const usize oldSize = m_Size;
+  unmap();
+  bool isFileResized = false;
+  try
+  {
+    setFileSize(size);
+    isFileResized = true;
+    m_Size = size;
+    map();
+  }
+  catch(...)
+  {
+    // Map the previous size again so that existing contents stay accessible.
+    // The file must be restored first, since mapping past its end raises
+    // SIGBUS on access. If that fails, only the part that still exists is mapped
+    m_Size = oldSize;
+    if(isFileResized)
+    {
+      try
+      {
+        setFileSize(oldSize);
+      }
+      catch(...)
+      {
+        m_Size = std::min(oldSize, size);
+      }
+    }
+    map();
+    throw;
+  }
+}
+
+void MemoryMappedFile::setFileSize(usize size)
+{
+#if defined(_WIN32)
+  LARGE_INTEGER fileSize;
+  fileSize.QuadPart = static_cast<LONGLONG>(size);
+  if(!SetFilePointerEx(m_FileHandle, fileSize, nullptr, FILE_BEGIN) || !SetEndOfFile(m_FileHandle))
+  {
+    throw std::runtime_error(fmt::format("Unable to resize \"{}\" to {} bytes: {}", m_Path.string(), size, GetErrorMessage()));
+  }
+#else
+  if(::ftruncate(m_FileDescriptor, static_cast<off_t>(size)) != 0)
+  {
+    throw std::runtime_error(fmt::format("Unable to resize \"{}\" to {} bytes: {}", m_Path.string(), size, GetErrorMessage()));
+  }
+#endif
+}
+
+void MemoryMappedFile::flush()
+{
+  if(m_Data == nullptr || m_IsView)
+  {
+    return;
+  }
+#if defined(_WIN32)
+  if(!FlushViewOfFile(m_Data, m_Size))
+  {
+    throw std::runtime_error(fmt::format("Unable to flush \"{}\": {}", m_Path.string(), GetErrorMessage()));
+  }
+#else
+  if(::msync(m_Data, m_Size, MS_SYNC) != 0)
+  {
+    throw std::runtime_error(fmt::format("Unable to flush \"{}\": {}", m_Path.string(), GetErrorMessage()));
+  }
+#endif
+}
+
+void MemoryMappedFile::close() noexcept
+{
+  unmap();
+#if defined(_WIN32)
+  if(m_FileHandle != nullptr)
+  {
+    CloseHandle(m_FileHandle);
+    m_FileHandle = nullptr;
+  }
+#else
+  if(m_FileDescriptor >= 0)
+  {
+    ::close(m_FileDescriptor);
+    m_FileDescriptor = -1;
+  }
+#endif
+  m_Size = 0;
+  m_ViewOffset = 0;
+  m_IsView = false;
+}
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <filesystem>
+
+#include "complex/Common/Types.hpp"
+
+#include "complex/complex_export.hpp"
+
+namespace complex
+{
+/**
+ * @class MemoryMappedFile
+ * @brief The MemoryMappedFile class maps a file on disk into the process's
+ * address space for reading and writing. Scratch files are created in a
+ * temporary directory and removed when the mapping is closed. Persistent
+ * files are kept after closing so that their contents can be mapped again
+ * later. All failures are reported by throwing std::runtime_error.
+ */
+class COMPLEX_EXPORT MemoryMappedFile
+{
+public:
+  /**
+   * @brief Creates a scratch file in the system's temporary directory sized
+   * to the specified number of bytes. The file is removed when closed.
+   * @param size
+   * @return MemoryMappedFile
+   */
+  static MemoryMappedFile CreateScratch(usize size);
+
+  /**
+   * @brief Creates a scratch file inside the specified directory sized to the
+   * specified number of bytes. The file is removed when closed.
+   * @param directory
+   * @param size
+   * @return MemoryMappedFile
+   */
+  static MemoryMappedFile CreateScratch(const std::filesystem::path& directory, usize size);
+
+  /**
+   * @brief Opens or creates the persistent file at the specified path and
+   * resizes it to the specified number of bytes. The file is kept when closed.
+   * @param path
+   * @param size
+   * @return MemoryMappedFile
+   */
+  static MemoryMappedFile OpenPersistent(const std::filesystem::path& path, usize size);
+
+  /**
+   * @brief Maps size bytes of an existing file starting at offset without
+   * modifying it. Pages are read from the file when first touched and writes
+   * go to private copies of the touched pages, so the file is never changed.
+   * Resizing a view copies it into a scratch file. The file handle is
+   * released once the view is mapped, but the file must not be truncated
+   * while the view is open.
+   * @param path
+   * @param offset
+   * @param size
+   * @return MemoryMappedFile
+   */
+  static MemoryMappedFile OpenView(const std::filesystem::path& path, usize offset, usize size);
+
+  /**
+   * @brief Constructs an unmapped MemoryMappedFile.
+   */
+  MemoryMappedFile() noexcept;
+
+  MemoryMappedFile(const MemoryMappedFile&) = delete;
+
+  /**
+   * @brief Move constructor
+   * @param other
+   */
+  MemoryMappedFile(MemoryMappedFile&& other) noexcept;
+
+  MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+  /**
+   * @brief Move assignment operator
+   * @param rhs
+   * @return MemoryMappedFile&
+   */
+  MemoryMappedFile& operator=(MemoryMappedFile&& rhs) noexcept;
+
+  /**
+   * @brief Unmaps and closes the file. Scratch files are deleted.
+   */
+  ~MemoryMappedFile() noexcept;
+
+  /**
+   * @brief Returns true if a file is currently open.
+   * @return bool
+   */
+  bool isOpen() const;
+
+  /**
+   * @brief Returns true if the file is deleted when closed.
+   * @return bool
+   */
+  bool isScratch() const;
+
+  /**
+   * @brief Returns true if the file is a copy-on-write view of part of a file.
+   * @return bool
+   */
+  bool isView() const;
+
+  /**
+   * @brief Returns the path to the mapped file.
+   * @return std::filesystem::path
+   */
+  std::filesystem::path getPath() const;
+
+  /**
+   * @brief Returns the number of mapped bytes.
+   * @return usize
+   */
+  usize size() const;
+
+  /**
+   * @brief Returns a pointer to the mapped bytes or nullptr if nothing is mapped.
+   * @return void*
+   */
+  void* data();
+
+  /**
+   * @brief Returns a read-only pointer to the mapped bytes or nullptr if nothing is mapped.
+   * @return const void*
+   */
+  const void* data() const;
+
+  /**
+   * @brief Resizes the file and remaps it. Existing contents up to the smaller
+   * of the old and new sizes are preserved. Pointers returned by data() are
+   * invalidated. If the file cannot be resized or mapped, it is mapped
+   * at its previous size again before the exception is rethrown.
+   * @param size
+   */
+  void resize(usize size);
+
+  /**
+   * @brief Flushes modified pages to disk. Does nothing for views.
+   */
+  void flush();
+
+  /**
+   * @brief Unmaps and closes the file. Scratch files are deleted.
+   */
+  void close() noexcept;
+
+private:
+  /**
+   * @brief Opens the file at m_Path, resizes it and maps it.
+   * @param size
+   * @param exclusive
+   */
+  void open(usize size, bool exclusive);
+
+  /**
+   * @brief Maps the currently open file.
+   */
+  void map();
+
+  /**
+   * @brief Sets the size of the open file without changing the mapping.
+   * @param size
+   */
+  void setFileSize(usize size);
+
+  /**
+   * @brief Unmaps the currently mapped view, if any.
+   */
+  void unmap() noexcept;
+
+  std::filesystem::path m_Path;
+  void* m_Data = nullptr;
+  usize m_Size = 0;
+  usize m_ViewOffset = 0;
+  bool m_IsScratch = false;
+  bool m_IsView = false;
+#if defined(_WIN32)
+  void* m_FileHandle = nullptr;
+  void* m_MappingHandle = nullptr;
+#else
+  int m_FileDescriptor = -1;
+#endif
+};
+} // namespace complex
@@ -0,0 +1,567 @@
+#pragma once
+
+#include <algorithm>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "complex/Common/Types.hpp"
+#include "complex/DataStructure/DataArray.hpp"
+#include "complex/DataStructure/IDataStore.hpp"
+#include "complex/Utilities/BulkCopy.hpp"
+#include "complex/Utilities/ThreadPool.hpp"
+
+namespace complex
+{
+/**
+ * @brief Bulk algorithms over IDataStores and DataArrays that run on the
+ * shared ThreadPool. Stores exposing a contiguous buffer, or one contiguous
+ * buffer per component, are processed in parallel slices of those buffers.
+ * Other stores, e.g. chunked or compressed ones, are not safe for concurrent
+ * access and are processed on the calling thread through their virtual
+ * accessors.
+ */
+namespace ParallelAlgorithms
+{
+/**
+ * @brief Buffers are split into slices of at least this many bytes.
+ */
+inline constexpr usize k_MinSliceBytes = 1024 * 1024;
+
+/**
+ * @brief Type used to accumulate sums of T without overflowing for typical inputs.
+ */
+template <class T>
+using SumType = std::conditional_t<std::is_floating_point_v<T>, f64, std::conditional_t<std::is_signed_v<T>, i64, u64>>;
+
+namespace detail
+{
+/**
+ * @brief Returns the minimum number of values of type T per slice.
+ * @tparam T
+ * @return usize
+ */
+template <class T>
+constexpr usize MinSliceCount()
+{
+  return std::max<usize>(k_MinSliceBytes / sizeof(T), 1);
+}
+
+/**
+ * @brief Returns the number of values of type T per cache line.
+ * @tparam T
+ * @return usize
+ */
+template <class T>
+constexpr usize Granularity()
+{
+  return std::max<usize>(64 / sizeof(T), 1);
+}
+
+/**
+ * @brief Returns buffers that together hold every value of the store, in no
+ * particular order: the whole buffer of a contiguous store or one buffer per
+ * component of a planar store. Returns no buffers if the store has neither.
+ * @tparam StoreT IDataStore<T> or const IDataStore<T>
+ * @param store
+ * @return std::vector<std::pair<pointer, usize>>
+ */
+template <class StoreT>
+auto ContiguousRanges(StoreT& store) -> std::vector<std::pair<decltype(store.data()), usize>>
+{
+  using PointerT = decltype(store.data());
+  std::vector<std::pair<PointerT, usize>> ranges;
+  if(PointerT data = store.data(); data != nullptr)
+  {
+    ranges.emplace_back(data, store.getSize());
+    return ranges;
+  }
+
+  const usize tupleCount = store.getTupleCount();
+  const usize tupleSize = store.getTupleSize();
+  for(usize component = 0; component < tupleSize; component++)
+  {
+    PointerT plane = store.componentData(component);
+    if(plane == nullptr)
+    {
+      return {};
+    }
+    ranges.emplace_back(plane, tupleCount);
+  }
+  return ranges;
+}
+
+/**
+ * @brief Calls function(begin, end) for parallel slices of every range.
+ * @tparam PointerT
+ * @tparam FunctionT
+ * @param ranges
+ * @param function
+ */
+template <class PointerT, class FunctionT>
+void ForEachRangeSlice(const std::vector<std::pair<PointerT, usize>>& ranges, const FunctionT& function)
+{
+  using T = std::remove_const_t<std::remove_pointer_t<PointerT>>;
+  for(const auto& [data, count] : ranges)
+  {
+    PointerT rangeData = data;
+    ThreadPool::Global().parallelFor(count, MinSliceCount<T>(), Granularity<T>(), [rangeData, &function](usize begin, usize end) { function(rangeData + begin, rangeData + end); });
+  }
+}
+
+/**
+ * @brief Accumulates every value of the store into a copy of identity per
+ * slice using accumulate(result, value), then merges the slice results in
+ * store order using combine(result, sliceResult). Merging in a fixed order
+ * keeps floating point results reproducible for a given thread count.
+ * @tparam R
+ * @tparam T
+ * @tparam AccumulateT
+ * @tparam CombineT
+ * @param store
+ * @param identity
+ * @param accumulate
+ * @param combine
+ * @return R
+ */
+template <class R, class T, class AccumulateT, class CombineT>
+R Reduce(const IDataStore<T>& store, const R& identity, const AccumulateT& accumulate, const CombineT& combine)
+{
+  const auto ranges = ContiguousRanges(store);
+  if(ranges.empty())
+  {
+    R result = identity;
+    const usize count = store.getSize();
+    for(usize i = 0; i < count; i++)
+    {
+      accumulate(result, store[i]);
+    }
+    return result;
+  }
+
+  std::mutex mutex;
+  std::vector<std::tuple<usize, usize, R>> sliceResults;
+  for(usize rangeIndex = 0; rangeIndex < ranges.size(); rangeIndex++)
+  {
+    const T* rangeData = ranges[rangeIndex].first;
+    ThreadPool::Global().parallelFor(ranges[rangeIndex].second, MinSliceCount<T>(), Granularity<T>(), [&, rangeIndex, rangeData](usize begin, usize end) {
+      R sliceResult = identity;
+      for(const T* value = rangeData + begin; value != rangeData + end; ++value)
+      {
+        accumulate(sliceResult, *value);
+      }
+      std::lock_guard<std::mutex> lock(mutex);
+      sliceResults.emplace_back(rangeIndex, begin, std::move(sliceResult));
+    });
+  }
+
+  std::sort(sliceResults.begin(), sliceResults.end(), [](const auto& lhs, const auto& rhs) { return std::tie(std::get<0>(lhs), std::get<1>(lhs)) < std::tie(std::get<0>(rhs), std::get<1>(rhs)); });
+  R result = identity;
+  for(auto& sliceResult : sliceResults)
+  {
+    combine(result, std::get<2>(sliceResult));
+  }
+  return result;
+}
+} // namespace detail
+
+/**
+ * @brief Writes the exclusive prefix sum of count input values to output,
+ * i.e. output[i] is the sum of input[0, i), and returns the sum of all
+ * values. Each thread sums a slice, the slice sums are scanned, and each
+ * thread then writes its slice. output may be the same buffer as input.
+ * @tparam InputT
+ * @tparam OutputT
+ * @param input
+ * @param count
+ * @param output
+ * @return OutputT
+ */
+template <class InputT, class OutputT>
+OutputT ExclusiveScan(const InputT* input, usize count, OutputT* output)
+{
+  ThreadPool& pool = ThreadPool::Global();
+  const usize sliceCount = std::min(pool.getThreadCount(), std::max<usize>(count / detail::MinSliceCount<OutputT>(), 1));
+  const usize sliceSize = (count + sliceCount - 1) / sliceCount;
+
+  std::vector<OutputT> sliceOffsets(sliceCount, OutputT{0});
+  pool.run(sliceCount, [&](usize slice) {
+    const usize end = std::min((slice + 1) * sliceSize, count);
+    OutputT sum{0};
+    for(usize i = slice * sliceSize; i < end; i++)
+    {
+      sum += static_cast<OutputT>(input[i]);
+    }
+    sliceOffsets[slice] = sum;
+  });
+
+  OutputT total{0};
+  for(auto& sliceOffset : sliceOffsets)
+  {
+    const OutputT sliceSum = sliceOffset;
+    sliceOffset = total;
+    total += sliceSum;
+  }
+
+  pool.run(sliceCount, [&](usize slice) {
+    const usize end = std::min((slice + 1) * sliceSize, count);
+    OutputT sum = sliceOffsets[slice];
+    for(usize i = slice * sliceSize; i < end; i++)
+    {
+      const auto value = static_cast<OutputT>(input[i]);
+      output[i] = sum;
+      sum += value;
+    }
+  });
+  return total;
+}
+
+/**
+ * @brief Sets every value in the store to the specified value.
+ * @tparam T
+ * @param store
+ * @param value
+ */
+template <class T>
+void Fill(IDataStore<T>& store, typename IDataStore<T>::value_type value)
+{
+  const auto ranges = detail::ContiguousRanges(store);
+  if(ranges.empty())
+  {
+    store.fill(value);
+    return;
+  }
+  detail::ForEachRangeSlice(ranges, [&value](T* begin, T* end) { std::fill(begin, end, value); });
+}
+
+/**
+ * @brief Copies every value from the source store into the destination
+ * store. The destination must hold at least as many values as the source.
+ * @tparam T
+ * @param source
+ * @param destination
+ */
+template <class T>
+void Copy(const IDataStore<T>& source, IDataStore<T>& destination)
+{
+  BulkCopy::CopyStore(source, destination);
+}
+
+/**
+ * @brief Replaces every value in the store with op(value).
+ * @tparam T
+ * @tparam OpT
+ * @param store
+ * @param op
+ */
+template <class T, class OpT>
+void Transform(IDataStore<T>& store, OpT op)
+{
+  const auto ranges = detail::ContiguousRanges(store);
+  if(ranges.empty())
+  {
+    const usize count = store.getSize();
+    for(usize i = 0; i < count; i++)
+    {
+      store[i] = op(store[i]);
+    }
+    return;
+  }
+  detail::ForEachRangeSlice(ranges, [&op](T* begin, T* end) { std::transform(begin, end, begin, op); });
+}
+
+/**
+ * @brief Sets each value in the destination store to op() of the value at
+ * the same index in the source store. The destination must hold at least as
+ * many values as the source.
+ * @tparam T
+ * @tparam U
+ * @tparam OpT
+ * @param source
+ * @param destination
+ * @param op
+ */
+template <class T, class U, class OpT>
+void Transform(const IDataStore<T>& source, IDataStore<U>& destination, OpT op)
+{
+  const usize count = source.getSize();
+  const T* sourceData = source.data();
+  U* destinationData = destination.data();
+  if(sourceData == nullptr || destinationData == nullptr)
+  {
+    for(usize i = 0; i < count; i++)
+    {
+      destination[i] = op(source[i]);
+    }
+    return;
+  }
+  ThreadPool::Global().parallelFor(count, detail::MinSliceCount<U>(), detail::Granularity<U>(),
+                                   [&op, sourceData, destinationData](usize begin, usize end) { std::transform(sourceData + begin, sourceData + end, destinationData + begin, op); });
+}
+
+/**
+ * @brief Returns the smallest and largest values in the store. NaN values
+ * are ignored. An empty store returns (max(), lowest()).
+ * @tparam T
+ * @param store
+ * @return std::pair<T, T>
+ */
+template <class T>
+std::pair<T, T> MinMax(const IDataStore<T>& store)
+{
+  using ResultT = std::pair<T, T>;
+  const ResultT identity(std::numeric_limits<T>::max(), std::numeric_limits<T>::lowest());
+  return detail::Reduce(
+      store, identity,
+      [](ResultT& result, T value) {
+        result.first = (value < result.first) ? value : result.first;
+        result.second = (result.second < value) ? value : result.second;
+      },
+      [](ResultT& result, const ResultT& sliceResult) {
+        result.first = std::min(result.first, sliceResult.first);
+        result.second = std::max(result.second, sliceResult.second);
+      });
+}
+
+/**
+ * @brief Returns the smallest value in the store. An empty store returns max().
+ * @tparam T
+ * @param store
+ * @return T
+ */
+template <class T>
+T Min(const IDataStore<T>& store)
+{
+  return MinMax(store).first;
+}
+
+/**
+ * @brief Returns the largest value in the store. An empty store returns lowest().
+ * @tparam T
+ * @param store
+ * @return T
+ */
+template <class T>
+T Max(const IDataStore<T>& store)
+{
+  return MinMax(store).second;
+}
+
+/**
+ * @brief Returns the sum of all values in the store accumulated as SumType<T>.
+ * @tparam T
+ * @param store
+ * @return SumType<T>
+ */
+template <class T>
+SumType<T> Sum(const IDataStore<T>& store)
+{
+  using ResultT = SumType<T>;
+  return detail::Reduce(
+      store, ResultT{0}, [](ResultT& result, T value) { result += static_cast<ResultT>(value); }, [](ResultT& result, ResultT sliceResult) { result += sliceResult; });
+}
+
+/**
+ * @brief Returns the number of values in the store for which pred(value) is true.
+ * @tparam T
+ * @tparam PredicateT
+ * @param store
+ * @param pred
+ * @return usize
+ */
+template <class T, class PredicateT>
+usize CountIf(const IDataStore<T>& store, PredicateT pred)
+{
+  return detail::Reduce(
+      store, usize{0},
+      [&pred](usize& result, T value) {
+        if(pred(value))
+        {
+          result++;
+        }
+      },
+      [](usize& result, usize sliceResult) { result += sliceResult; });
+}
+
+/**
+ * @brief Counts the values in the store that fall into each of binCount
+ * equally sized bins spanning [rangeMin, rangeMax]. Values equal to rangeMax
+ * are counted in the last bin. Values outside the range and NaN values are
+ * not counted. Throws if binCount is zero or rangeMax is less than rangeMin.
+ * @tparam T
+ * @param store
+ * @param binCount
+ * @param rangeMin
+ * @param rangeMax
+ * @return std::vector<u64>
+ */
+template <class T>
+std::vector<u64> Histogram(const IDataStore<T>& store, usize binCount, typename IDataStore<T>::value_type rangeMin, typename IDataStore<T>::value_type rangeMax)
+{
+  if(binCount == 0)
+  {
+    throw std::runtime_error("Histogram requires at least one bin");
+  }
+  if(rangeMax < rangeMin)
+  {
+    throw std::runtime_error("Histogram range maximum is less than the minimum");
+  }
+
+  const f64 minimum = static_cast<f64>(rangeMin);
+  const f64 binScale = (rangeMax == rangeMin) ? 0.0 : static_cast<f64>(binCount) / (static_cast<f64>(rangeMax) - minimum);
+  const usize lastBin = binCount - 1;
+  return detail::Reduce(
+      store, std::vector<u64>(binCount, 0),
+      [rangeMin, rangeMax, minimum, binScale, lastBin](std::vector<u64>& result, T value) {
+        if(!(rangeMin <= value && value <= rangeMax))
+        {
+          return;
+        }
+        const auto bin = static_cast<usize>((static_cast<f64>(value) - minimum) * binScale);
+        result[std::min(bin, lastBin)]++;
+      },
+      [](std::vector<u64>& result, const std::vector<u64>& sliceResult) {
+        for(usize i = 0; i < result.size(); i++)
+        {
+          result[i] += sliceResult[i];
+        }
+      });
+}
+
+/**
+ * @brief Sets every value in the array to the specified value.
+ * @tparam T
+ * @param array
+ * @param value
+ */
+template <class T>
+void Fill(DataArray<T>& array, typename DataArray<T>::value_type value)
+{
+  Fill(*array.getDataStore(), value);
+}
+
+/**
+ * @brief Copies every value from the source array into the destination
+ * array. The destination must hold at least as many values as the source.
+ * @tparam T
+ * @param source
+ * @param destination
+ */
+template <class T>
+void Copy(const DataArray<T>& source, DataArray<T>& destination)
+{
+  Copy(*source.getDataStore(), *destination.getDataStore());
+}
+
+/**
+ * @brief Replaces every value in the array with op(value).
+ * @tparam T
+ * @tparam OpT
+ * @param array
+ * @param op
+ */
+template <class T, class OpT>
+void Transform(DataArray<T>& array, OpT op)
+{
+  Transform(*array.getDataStore(), op);
+}
+
+/**
+ * @brief Sets each value in the destination array to op() of the value at
+ * the same index in the source array.
+ * @tparam T
+ * @tparam U
+ * @tparam OpT
+ * @param source
+ * @param destination
+ * @param op
+ */
+template <class T, class U, class OpT>
+void Transform(const DataArray<T>& source, DataArray<U>& destination, OpT op)
+{
+  Transform(*source.getDataStore(), *destination.getDataStore(), op);
+}
+
+/**
+ * @brief Returns the smallest and largest values in the array.
+ * @tparam T
+ * @param array
+ * @return std::pair<T, T>
+ */
+template <class T>
+std::pair<T, T> MinMax(const DataArray<T>& array)
+{
+  return MinMax(*array.getDataStore());
+}
+
+/**
+ * @brief Returns the smallest value in the array.
+ * @tparam T
+ * @param array
+ * @return T
+ */
+template <class T>
+T Min(const DataArray<T>& array)
+{
+  return Min(*array.getDataStore());
+}
+
+/**
+ * @brief Returns the largest value in the array.
+ * @tparam T
+ * @param array
+ * @return T
+ */
+template <class T>
+T Max(const DataArray<T>& array)
+{
+  return Max(*array.getDataStore());
+}
+
+/**
+ * @brief Returns the sum of all values in the array.
+ * @tparam T
+ * @param array
+ * @return SumType<T>
+ */
+template <class T>
+SumType<T> Sum(const DataArray<T>& array)
+{
+  return Sum(*array.getDataStore());
+}
+
+/**
+ * @brief Returns the number of values in the array for which pred(value) is true.
+ * @tparam T
+ * @tparam PredicateT
+ * @param array
+ * @param pred
+ * @return usize
+ */
+template <class T, class PredicateT>
+usize CountIf(const DataArray<T>& array, PredicateT pred)
+{
+  return CountIf(*array.getDataStore(), pred);
+}
+
+/**
+ * @brief Counts the values in the array that fall into each of binCount
+ * equally sized bins spanning [rangeMin, rangeMax].
+ * @tparam T
+ * @param array
+ * @param binCount
+ * @param rangeMin
+ * @param rangeMax
+ * @return std::vector<u64>
+ */
+template <class T>
+std::vector<u64> Histogram(const DataArray<T>& array, usize binCount, typename DataArray<T>::value_type rangeMin, typename DataArray<T>::value_type rangeMax)
+{
+  return Histogram(*array.getDataStore(), binCount, rangeMin, rangeMax);
+}
+} // namespace ParallelAlgorithms
+} // namespace complex
@@ -0,0 +1,119 @@
+#include "complex/Utilities/SharedRecursiveMutex.hpp"
+
+#include <stdexcept>
+#include <unordered_map>
+
+using namespace complex;
+
+namespace
+{
+// Shared lock count of the calling thread per mutex
+thread_local std::unordered_map<const SharedRecursiveMutex*, u32> t_SharedDepths;
+} // namespace
+
+SharedRecursiveMutex::SharedRecursiveMutex() = default;
+
+SharedRecursiveMutex::~SharedRecursiveMutex() noexcept = default;
+
+u32 SharedRecursiveMutex::sharedDepth() const
+{
+  auto iter = t_SharedDepths.find(this);
+  return (iter == t_SharedDepths.end()) ? 0 : iter->second;
+}
+
+bool SharedRecursiveMutex::isLockedByCaller() const
+{
+  return m_Owner.load(std::memory_order_relaxed) == std::this_thread::get_id();
+}
+
+void SharedRecursiveMutex::lock()
+{
+  if(isLockedByCaller())
+  {
+    m_Depth++;
+    return;
+  }
+  if(sharedDepth() > 0)
+  {
+    throw std::runtime_error("A shared lock cannot be upgraded to an exclusive lock");
+  }
+  m_Mutex.lock();
+  m_Owner.store(std::this_thread::get_id(), std::memory_order_relaxed);
+  m_Depth = 1;
+}
+
+bool SharedRecursiveMutex::try_lock()
+{
+  if(isLockedByCaller())
+  {
+    m_Depth++;
+    return true;
+  }
+  if(sharedDepth() > 0)
+  {
+    throw std::runtime_error("A shared lock cannot be upgraded to an exclusive lock");
+  }
+  if(!m_Mutex.try_lock())
+  {
+    return false;
+  }
+  m_Owner.store(std::this_thread::get_id(), std::memory_order_relaxed);
+  m_Depth = 1;
+  return true;
+}
+
+void SharedRecursiveMutex::unlock()
+{
+  if(--m_Depth == 0)
+  {
+    m_Owner.store(std::thread::id(), std::memory_order_relaxed);
+    m_Mutex.unlock();
+  }
+}
+
+void SharedRecursiveMutex::lock_shared()
+{
+  // Readers nested in a writer count towards the exclusive lock
+  if(isLockedByCaller())
+  {
+    m_Depth++;
+    return;
+  }
+  u32& depth = t_SharedDepths[this];
+  if(depth == 0)
+  {
+    m_Mutex.lock_shared();
+  }
+  depth++;
+}
+
+bool SharedRecursiveMutex::try_lock_shared()
+{
+  if(isLockedByCaller())
+  {
+    m_Depth++;
+    return true;
+  }
+  const u32 depth = sharedDepth();
+  if(depth == 0 && !m_Mutex.try_lock_shared())
+  {
+    return false;
+  }
+  t_SharedDepths[this] = depth + 1;
+  return true;
+}
+
+void SharedRecursiveMutex::unlock_shared()
+{
+  if(isLockedByCaller())
+  {
+    unlock();
+    return;
+  }
+  auto iter = t_SharedDepths.find(this);
+  if(--iter->second == 0)
+  {
+    t_SharedDepths.erase(iter);
+    m_Mutex.unlock_shared();
+  }
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <shared_mutex>
+#include <thread>
+
+#include "complex/Common/Types.hpp"
+
+#include "complex/complex_export.hpp"
+
+namespace complex
+{
+/**
+ * @class SharedRecursiveMutex
+ * @brief The SharedRecursiveMutex class is a reader-writer lock that the
+ * owning thread may lock again. A thread holding the exclusive lock may take
+ * either lock again, so code that mutates a structure can call its queries
+ * and callbacks can read it. A thread holding shared locks may take further
+ * shared locks, but requesting the exclusive lock throws, since upgrading
+ * would deadlock against another reader doing the same.
+ *
+ * Meets the Lockable and SharedLockable requirements, so it works with
+ * std::unique_lock and std::shared_lock.
+ */
+class COMPLEX_EXPORT SharedRecursiveMutex
+{
+public:
+  SharedRecursiveMutex();
+
+  SharedRecursiveMutex(const SharedRecursiveMutex&) = delete;
+  SharedRecursiveMutex(SharedRecursiveMutex&&) = delete;
+
+  ~SharedRecursiveMutex() noexcept;
+
+  SharedRecursiveMutex& operator=(const SharedRecursiveMutex&) = delete;
+  SharedRecursiveMutex& operator=(SharedRecursiveMutex&&) = delete;
+
+  /**
+   * @brief Takes the exclusive lock, blocking until no other thread holds
+   * the mutex. Throws if the calling thread only holds shared locks.
+   */
+  void lock();
+
+  /**
+   * @brief Takes the exclusive lock if no other thread holds the mutex.
+   * Throws if the calling thread only holds shared locks.
+   * @return bool
+   */
+  bool try_lock();
+
+  /**
+   * @brief Releases one exclusive lock.
+   */
+  void unlock();
+
+  /**
+   * @brief Takes a shared lock, blocking while another thread holds the
+   * exclusive lock.
+   */
+  void lock_shared();
+
+  /**
+   * @brief Takes a shared lock if no other thread holds the exclusive lock.
+   * @return bool
+   */
+  bool try_lock_shared();
+
+  /**
+   * @brief Releases one shared lock.
+   */
+  void unlock_shared();
+
+  /**
+   * @brief Returns true if the calling thread holds the exclusive lock.
+   * @return bool
+   */
+  bool isLockedByCaller() const;
+
+private:
+  /**
+   * @brief Returns the number of shared locks the calling thread holds.
+   * @return u32
+   */
+  u32 sharedDepth() const;
+
+  std::shared_mutex m_Mutex;
+  std::atomic<std::thread::id> m_Owner;
+  u32 m_Depth = 0;
+};
+} // namespace complex
@@ -0,0 +1,186 @@
+#include "complex/Utilities/ThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+using namespace complex;
+
+namespace
+{
+// Set on pool workers and on callers while they take part in a batch
+thread_local bool t_InsideBatch = false;
+} // namespace
+
+struct ThreadPool::Batch
+{
+  const std::function<void(usize)>* task = nullptr;
+  usize taskCount = 0;
+  std::atomic<usize> nextTask = 0;
+  usize activeWorkers = 0;
+  std::mutex errorMutex;
+  std::exception_ptr error;
+};
+
+ThreadPool& ThreadPool::Global()
+{
+  // Deliberately leaked: joining the workers from a static destructor can deadlock or race with other static destructors
+  static ThreadPool* s_Pool = new ThreadPool(std::max<usize>(std::thread::hardware_concurrency(), 1));
+  return *s_Pool;
+}
+
+ThreadPool::ThreadPool(usize threadCount)
+{
+  const usize workerCount = std::max<usize>(threadCount, 1) - 1;
+  m_Workers.reserve(workerCount);
+  for(usize i = 0; i < workerCount; i++)
+  {
+    m_Workers.emplace_back([this]() { work(); });
+  }
+}
+
+ThreadPool::~ThreadPool() noexcept
+{
+  shutdown();
+}
+
+void ThreadPool::shutdown() noexcept
+{
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Stop = true;
+  }
+  m_WakeCondition.notify_all();
+  for(auto& worker : m_Workers)
+  {
+    worker.join();
+  }
+  m_Workers.clear();
+}
+
+usize ThreadPool::getThreadCount() const
+{
+  return m_Workers.size() + 1;
+}
+
+void ThreadPool::runTasks(Batch& batch)
+{
+  for(usize index = batch.nextTask++; index < batch.taskCount; index = batch.nextTask++)
+  {
+    try
+    {
+      (*batch.task)(index);
+    } catch(...)
+    {
+      std::lock_guard<std::mutex> lock(batch.errorMutex);
+      if(batch.error == nullptr)
+      {
+        batch.error = std::current_exception();
+      }
+    }
+  }
+}
+
+void ThreadPool::removeBatch(Batch* batch)
+{
+  auto iter = std::find(m_Batches.begin(), m_Batches.end(), batch);
+  if(iter != m_Batches.end())
+  {
+    m_Batches.erase(iter);
+  }
+}
+
+void ThreadPool::work()
+{
+  t_InsideBatch = true;
+  while(true)
+  {
+    Batch* batch = nullptr;
+    {
+      std::unique_lock<std::mutex> lock(m_Mutex);
+      m_WakeCondition.wait(lock, [this]() { return m_Stop || !m_Batches.empty(); });
+      if(m_Stop)
+      {
+        return;
+      }
+      batch = m_Batches.front();
+      batch->activeWorkers++;
+    }
+
+    runTasks(*batch);
+
+    {
+      // Every task has been claimed, so no other worker needs to pick the batch up
+      std::lock_guard<std::mutex> lock(m_Mutex);
+      removeBatch(batch);
+      batch->activeWorkers--;
+    }
+    m_DoneCondition.notify_all();
+  }
+}
+
+void ThreadPool::run(usize taskCount, const std::function<void(usize)>& task)
+{
+  if(taskCount == 0)
+  {
+    return;
+  }
+  if(taskCount == 1 || m_Workers.empty() || t_InsideBatch)
+  {
+    for(usize i = 0; i < taskCount; i++)
+    {
+      task(i);
+    }
+    return;
+  }
+
+  Batch batch;
+  batch.task = &task;
+  batch.taskCount = taskCount;
+  {
+    std::lock_guard<std::mutex> lock(m_Mutex);
+    m_Batches.push_back(&batch);
+  }
+  m_WakeCondition.notify_all();
+
+  t_InsideBatch = true;
+  runTasks(batch);
+  t_InsideBatch = false;
+
+  {
+    // Every task has been claimed, so only workers still running one are waited on
+    std::unique_lock<std::mutex> lock(m_Mutex);
+    removeBatch(&batch);
+    m_DoneCondition.wait(lock, [&batch]() { return batch.activeWorkers == 0; });
+  }
+
+  if(batch.error != nullptr)
+  {
+    std::rethrow_exception(batch.error);
+  }
+}
+
+void ThreadPool::parallelFor(usize count, usize minSliceCount, usize granularity, const std::function<void(usize, usize)>& function)
+{
+  if(count == 0)
+  {
+    return;
+  }
+
+  const usize sliceCount = std::min(getThreadCount(), std::max<usize>(count / std::max<usize>(minSliceCount, 1), 1));
+  if(sliceCount < 2 || t_InsideBatch)
+  {
+    function(0, count);
+    return;
+  }
+
+  granularity = std::max<usize>(granularity, 1);
+  const usize sliceSize = ((count / sliceCount) + granularity - 1) / granularity * granularity;
+  run(sliceCount, [&](usize slice) {
+    const usize begin = slice * sliceSize;
+    if(begin < count)
+    {
+      function(begin, std::min(begin + sliceSize, count));
+    }
+  });
+}
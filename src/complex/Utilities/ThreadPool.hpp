@@ -0,0 +1,117 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "complex/Common/Types.hpp"
+
+#include "complex/complex_export.hpp"
+
+namespace complex
+{
+/**
+ * @class ThreadPool
+ * @brief The ThreadPool class runs batches of tasks on a fixed set of worker
+ * threads. The calling thread takes part in each batch and returns once every
+ * task has finished, so tasks may reference the caller's stack. Batches
+ * started from inside a task run on the calling thread to avoid deadlock.
+ * Batches started concurrently from different threads are queued. Workers
+ * take tasks from the oldest batch and move on to the next one once every
+ * task of it has been claimed, so concurrent batches run side by side.
+ */
+class COMPLEX_EXPORT ThreadPool
+{
+public:
+  /**
+   * @brief Returns the pool shared by the library. It uses one thread per
+   * hardware thread, including the calling thread. The pool is never
+   * destroyed, so its workers are not joined during static destruction.
+   * Applications that need the workers stopped before exiting can call
+   * shutdown().
+   * @return ThreadPool&
+   */
+  static ThreadPool& Global();
+
+  /**
+   * @brief Constructs a pool that runs tasks on threadCount threads. The
+   * calling thread counts as one of them, so threadCount - 1 workers are
+   * started.
+   * @param threadCount
+   */
+  explicit ThreadPool(usize threadCount);
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool(ThreadPool&&) = delete;
+
+  ~ThreadPool() noexcept;
+
+  ThreadPool& operator=(const ThreadPool&) = delete;
+  ThreadPool& operator=(ThreadPool&&) = delete;
+
+  /**
+   * @brief Returns the number of threads running tasks, including the calling thread.
+   * @return usize
+   */
+  usize getThreadCount() const;
+
+  /**
+   * @brief Stops and joins the worker threads. Batches started afterwards run
+   * on the calling thread. Must not be called while a batch is running.
+   */
+  void shutdown() noexcept;
+
+  /**
+   * @brief Calls task once for each index in [0, taskCount) and waits for all
+   * calls to finish. The first exception thrown by a task is rethrown after
+   * the remaining tasks have run.
+   * @param taskCount
+   * @param task
+   */
+  void run(usize taskCount, const std::function<void(usize)>& task);
+
+  /**
+   * @brief Splits the range [0, count) into contiguous slices, one per thread
+   * at most, and calls the function with the begin and end of each slice.
+   * Slices hold at least minSliceCount items and, apart from the last one, a
+   * multiple of granularity items. Ranges too small to split are handled on
+   * the calling thread.
+   * @param count
+   * @param minSliceCount
+   * @param granularity
+   * @param function
+   */
+  void parallelFor(usize count, usize minSliceCount, usize granularity, const std::function<void(usize, usize)>& function);
+
+private:
+  struct Batch;
+
+  /**
+   * @brief Worker thread loop.
+   */
+  void work();
+
+  /**
+   * @brief Runs tasks from the batch until none are left.
+   * @param batch
+   */
+  static void runTasks(Batch& batch);
+
+  /**
+   * @brief Removes the batch from the queue if it is still queued. Must be
+   * called with m_Mutex held.
+   * @param batch
+   */
+  void removeBatch(Batch* batch);
+
+  std::vector<std::thread> m_Workers;
+  std::mutex m_Mutex;
+  std::condition_variable m_WakeCondition;
+  std::condition_variable m_DoneCondition;
+  std::deque<Batch*> m_Batches;
+  bool m_Stop = false;
+};
+} // namespace complex
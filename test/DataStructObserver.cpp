@@ -6,6 +6,7 @@
 #include "complex/DataStructure/BaseGroup.hpp"
 #include "complex/DataStructure/DataStructure.hpp"
 #include "complex/DataStructure/Messaging/DataAddedMessage.hpp"
+#include "complex/DataStructure/Messaging/DataBatchMessage.hpp"
 #include "complex/DataStructure/Messaging/DataRemovedMessage.hpp"
 #include "complex/DataStructure/Messaging/DataRenamedMessage.hpp"
 #include "complex/DataStructure/Messaging/DataReparentedMessage.hpp"
@@ -35,6 +36,13 @@ void DataStructObserver::onNotify(DataStructure* target, const std::shared_ptr<A
   case DataReparentedMessage::MsgType:
     m_ReparentedCount++;
     break;
+  case DataBatchMessage::MsgType:
+    m_BatchCount++;
+    for(const auto& batchedMsg : std::dynamic_pointer_cast<DataBatchMessage>(msg)->getMessages())
+    {
+      onNotify(target, batchedMsg);
+    }
+    break;
   }
 }
 
@@ -62,3 +70,8 @@ size_t DataStructObserver::getDataReparentedCount() const
 {
   return m_ReparentedCount;
 }
+
+size_t DataStructObserver::getDataBatchCount() const
+{
+  return m_BatchCount;
+}
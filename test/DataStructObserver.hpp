@@ -43,6 +43,7 @@ public:
   size_t getDataRemovedCount() const;
   size_t getDataRenamedCount() const;
   size_t getDataReparentedCount() const;
+  size_t getDataBatchCount() const;
 
 private:
   complex::DataStructure& m_DataStructure;
@@ -50,4 +51,5 @@ private:
   size_t m_RemovedCount = 0;
   size_t m_RenamedCount = 0;
   size_t m_ReparentedCount = 0;
+  size_t m_BatchCount = 0;
 };
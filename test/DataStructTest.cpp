@@ -1,13 +1,37 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
 #include <memory>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <thread>
 #include <vector>
 
 #include <catch2/catch.hpp>
 
 #include "DataStructObserver.hpp"
 
+#include "complex/DataStructure/ChunkedDataStore.hpp"
+#include "complex/DataStructure/ComponentDataStore.hpp"
+#include "complex/DataStructure/CompressedDataStore.hpp"
 #include "complex/DataStructure/DataGroup.hpp"
 #include "complex/DataStructure/DataStore.hpp"
 #include "complex/DataStructure/DataStructure.hpp"
+#include "complex/DataStructure/FileDataStore.hpp"
+#include "complex/DataStructure/ObjectTable.hpp"
+#include "complex/DataStructure/PlanarDataStore.hpp"
+#include "complex/DataStructure/Snapshot/DataStructureSnapshot.hpp"
+#include "complex/Filter/Output.hpp"
+#include "complex/Utilities/BlockCodec.hpp"
+#include "complex/Utilities/BulkCopy.hpp"
+#include "complex/Utilities/ParallelAlgorithms.hpp"
+#include "complex/Utilities/SharedRecursiveMutex.hpp"
+#include "complex/Utilities/ThreadPool.hpp"
 
 /**
  * @brief Test creation and removal of items in a tree-style structure. No node has more than one parent.
@@ -150,6 +174,72 @@ TEST_CASE("LinkedPathTest")
   REQUIRE(!linkedPath.isValid());
 }
 
+TEST_CASE("DataPathIndexTest")
+{
+  DataStructure dataStr;
+  auto group = dataStr.createGroup("Foo");
+  auto child = dataStr.createGroup("Bar", group->getId());
+  auto other = dataStr.createGroup("Other");
+  const auto groupId = group->getId();
+  const auto childId = child->getId();
+  const auto otherId = other->getId();
+
+  REQUIRE(dataStr.getId(DataPath({"Foo", "Bar"})) == childId);
+  REQUIRE(!dataStr.getId(DataPath({"Foo", "Missing"})));
+  REQUIRE(dataStr.getTopLevelData().size() == 2);
+
+  SECTION("rename")
+  {
+    REQUIRE(child->rename("Baz"));
+    REQUIRE(dataStr.getData(DataPath({"Foo", "Bar"})) == nullptr);
+    REQUIRE(dataStr.getId(DataPath({"Foo", "Baz"})) == childId);
+    REQUIRE(group->contains("Baz"));
+    REQUIRE(!group->contains("Bar"));
+
+    REQUIRE(group->rename("Qux"));
+    REQUIRE(dataStr.getData(DataPath({"Foo"})) == nullptr);
+    REQUIRE(dataStr.getId(DataPath({"Qux", "Baz"})) == childId);
+  }
+  SECTION("reparent")
+  {
+    // A top-level object that gains a parent is no longer a top-level path
+    REQUIRE(dataStr.setAdditionalParent(otherId, childId));
+    REQUIRE(dataStr.getData(DataPath({"Other"})) == nullptr);
+    REQUIRE(dataStr.getId(DataPath({"Foo", "Bar", "Other"})) == otherId);
+    REQUIRE(dataStr.getTopLevelData().size() == 1);
+
+    REQUIRE(dataStr.removeParent(otherId, childId));
+    REQUIRE(dataStr.getData(DataPath({"Foo", "Bar", "Other"})) == nullptr);
+    REQUIRE(dataStr.getId(DataPath({"Other"})) == otherId);
+    REQUIRE(other->getParents().empty());
+  }
+  SECTION("remove")
+  {
+    REQUIRE(dataStr.removeData(groupId));
+    REQUIRE(dataStr.getData(DataPath({"Foo"})) == nullptr);
+    REQUIRE(dataStr.getData(DataPath({"Foo", "Bar"})) == nullptr);
+    REQUIRE(dataStr.getTopLevelData().size() == 1);
+
+    // The name can be reused
+    auto replacement = dataStr.createGroup("Foo");
+    REQUIRE(dataStr.getId(DataPath({"Foo"})) == replacement->getId());
+  }
+  SECTION("duplicate names")
+  {
+    // Lookups find the object with the lowest id, as the linear scan did
+    auto duplicate = dataStr.createGroup("Foo");
+    REQUIRE(dataStr.getId(DataPath({"Foo"})) == groupId);
+    REQUIRE(dataStr.removeData(groupId));
+    REQUIRE(dataStr.getId(DataPath({"Foo"})) == duplicate->getId());
+  }
+  SECTION("copy")
+  {
+    DataStructure dataStrCopy(dataStr);
+    REQUIRE(dataStrCopy.getData(DataPath({"Foo"})) == dataStrCopy.getData(groupId));
+    REQUIRE(dataStrCopy.getData(DataPath({"Other"})) == dataStrCopy.getData(otherId));
+  }
+}
+
 /**
  * @brief Tests IDataStructureListener usage
  */
@@ -179,6 +269,99 @@ TEST_CASE("DataStructureListenerTest")
   REQUIRE(dsListener.getDataRemovedCount() == 4);
 }
 
+TEST_CASE("DataStructureNotificationTest")
+{
+  DataStructure dataStr;
+  DataStructObserver dsListener(dataStr);
+  auto group = dataStr.createGroup("Foo");
+  const auto groupId = group->getId();
+  REQUIRE(dsListener.getDataAddedCount() == 1);
+
+  SECTION("rename and reparent")
+  {
+    auto child = dataStr.createGroup("Bar");
+    REQUIRE(child->rename("Baz"));
+    REQUIRE(dsListener.getDataRenamedCount() == 1);
+    REQUIRE(dataStr.setAdditionalParent(child->getId(), groupId));
+    REQUIRE(dataStr.removeParent(child->getId(), groupId));
+    REQUIRE(dsListener.getDataReparentedCount() == 2);
+  }
+  SECTION("batch")
+  {
+    {
+      DataStructure::NotificationBatch batch(dataStr);
+      for(usize i = 0; i < 100; i++)
+      {
+        DataStructure::NotificationBatch nested(dataStr);
+        dataStr.createGroup("Child " + std::to_string(i), groupId);
+      }
+      REQUIRE(group->rename("Qux"));
+      REQUIRE(dataStr.removeData(dataStr.getId(DataPath({"Qux", "Child 0"}))));
+      REQUIRE(dsListener.getDataAddedCount() == 1);
+    }
+    REQUIRE(dsListener.getDataBatchCount() == 1);
+    REQUIRE(dsListener.getDataAddedCount() == 101);
+    REQUIRE(dsListener.getDataRenamedCount() == 1);
+    REQUIRE(dsListener.getDataRemovedCount() == 1);
+
+    // A single message is sent as is
+    {
+      DataStructure::NotificationBatch batch(dataStr);
+      dataStr.createGroup("Bar");
+    }
+    REQUIRE(dsListener.getDataBatchCount() == 1);
+    REQUIRE(dsListener.getDataAddedCount() == 102);
+  }
+  SECTION("async")
+  {
+    dataStr.setAsyncNotifications(true);
+    REQUIRE(dataStr.getAsyncNotifications());
+    for(usize i = 0; i < 1000; i++)
+    {
+      dataStr.createGroup("Child " + std::to_string(i), groupId);
+    }
+    {
+      DataStructure::NotificationBatch batch(dataStr);
+      REQUIRE(dataStr.removeData(groupId));
+    }
+    dataStr.flushNotifications();
+    REQUIRE(dsListener.getDataAddedCount() == 1001);
+    REQUIRE(dsListener.getDataRemovedCount() == 1001);
+
+    dataStr.createGroup("Bar");
+    dataStr.setAsyncNotifications(false);
+    REQUIRE(dsListener.getDataAddedCount() == 1002);
+    dataStr.createGroup("Baz");
+    REQUIRE(dsListener.getDataAddedCount() == 1003);
+  }
+  SECTION("destroyed by an observer")
+  {
+    // The observer owns a DataStructure and destroys it on the delivery thread
+    class OwningObserver : public AbstractDataStructureObserver
+    {
+    public:
+      void onNotify(DataStructure*, const std::shared_ptr<AbstractDataStructureMessage>&) override
+      {
+        owned.reset();
+        destroyed = true;
+      }
+
+      std::unique_ptr<DataStructure> owned = std::make_unique<DataStructure>();
+      std::atomic<bool> destroyed = false;
+    };
+    OwningObserver observer;
+    observer.owned->addObserver(&observer);
+    observer.owned->setAsyncNotifications(true);
+    observer.owned->createGroup("Foo");
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while(!observer.destroyed && std::chrono::steady_clock::now() < deadline)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    REQUIRE(observer.destroyed);
+  }
+}
+
 TEST_CASE("DataStructureCopyTest")
 {
   DataStructure dataStr;
@@ -221,6 +404,310 @@ TEST_CASE("DataStructureCopyTest")
   REQUIRE(dataStrCopy.getData(newId2));
 }
 
+TEST_CASE("ObjectTableTest")
+{
+  DataStructure dataStr;
+  auto group = dataStr.createGroup("Foo");
+  auto child = dataStr.createGroup("Bar", group->getId());
+  const auto groupId = group->getId();
+  const auto childId = child->getId();
+  REQUIRE(dataStr.size() == 2);
+  REQUIRE(groupId < childId);
+
+  SECTION("stale ids")
+  {
+    REQUIRE(dataStr.removeData(childId));
+    REQUIRE(dataStr.getData(childId) == nullptr);
+    REQUIRE(dataStr.size() == 1);
+
+    // The freed slot is reused under a new ID
+    auto replacement = dataStr.createGroup("Bar", groupId);
+    REQUIRE(ObjectTable::SlotOf(replacement->getId()) == ObjectTable::SlotOf(childId));
+    REQUIRE(replacement->getId() != childId);
+    REQUIRE(dataStr.getData(childId) == nullptr);
+    REQUIRE(dataStr.getData(replacement->getId()) == replacement);
+    REQUIRE(!dataStr.setAdditionalParent(childId, groupId));
+  }
+  SECTION("copies")
+  {
+    DataStructure dataStrCopy(dataStr);
+    REQUIRE(dataStrCopy.size() == 2);
+    auto group1 = dataStr.createGroup("Group 1");
+    auto group2 = dataStrCopy.createGroup("Group 2");
+    REQUIRE(group1->getId() != group2->getId());
+    REQUIRE(dataStrCopy.getData(group1->getId()) == nullptr);
+    REQUIRE(dataStr.getData(group2->getId()) == nullptr);
+  }
+  SECTION("concurrent reservation")
+  {
+    ObjectTable table;
+    const usize count = 10000;
+    std::vector<ObjectTable::IdType> ids(count);
+    ThreadPool pool(4);
+    pool.run(count, [&table, &ids](usize index) { ids[index] = table.reserve(); });
+
+    std::vector<u32> slots(count);
+    std::transform(ids.begin(), ids.end(), slots.begin(), ObjectTable::SlotOf);
+    std::sort(ids.begin(), ids.end());
+    std::sort(slots.begin(), slots.end());
+    REQUIRE(std::adjacent_find(ids.begin(), ids.end()) == ids.end());
+    REQUIRE(std::adjacent_find(slots.begin(), slots.end()) == slots.end());
+    REQUIRE(slots.back() == count - 1);
+
+    // Reserved slots do not resolve until an object is inserted
+    REQUIRE(table.size() == 0);
+    REQUIRE(table.find(ids.front()) == nullptr);
+    std::atomic<usize> emptySlots = 0;
+    pool.run(count, [&table, &ids, &emptySlots](usize index) { emptySlots += table.release(ids[index], nullptr) ? 0 : 1; });
+    REQUIRE(emptySlots == count);
+    REQUIRE(ObjectTable::SlotOf(table.reserve()) < count);
+  }
+}
+
+TEST_CASE("SharedRecursiveMutexTest")
+{
+  SharedRecursiveMutex mutex;
+  SECTION("exclusive")
+  {
+    std::unique_lock<SharedRecursiveMutex> lock(mutex);
+    REQUIRE(mutex.isLockedByCaller());
+    {
+      // Writers may lock again and read
+      std::unique_lock<SharedRecursiveMutex> nested(mutex);
+      std::shared_lock<SharedRecursiveMutex> reader(mutex);
+    }
+    REQUIRE(mutex.isLockedByCaller());
+    bool locked = true;
+    std::thread other([&mutex, &locked]() { locked = mutex.try_lock_shared(); });
+    other.join();
+    REQUIRE(!locked);
+    lock.unlock();
+    REQUIRE(!mutex.isLockedByCaller());
+  }
+  SECTION("shared")
+  {
+    std::shared_lock<SharedRecursiveMutex> lock(mutex);
+    std::shared_lock<SharedRecursiveMutex> nested(mutex);
+    REQUIRE_THROWS_AS(mutex.lock(), std::runtime_error);
+    bool locked = false;
+    std::thread other([&mutex, &locked]() {
+      locked = mutex.try_lock_shared();
+      if(locked)
+      {
+        mutex.unlock_shared();
+      }
+    });
+    other.join();
+    REQUIRE(locked);
+    nested.unlock();
+    lock.unlock();
+    REQUIRE(mutex.try_lock());
+    mutex.unlock();
+  }
+}
+
+TEST_CASE("DataStructureAccessTest")
+{
+  DataStructure dataStr;
+  const auto id1 = dataStr.createGroup("Group 1")->getId();
+  const auto id2 = dataStr.createGroup("Group 2")->getId();
+
+  SECTION("declarations")
+  {
+    auto reader = dataStr.acquireAccess({id1, id2}, {});
+    REQUIRE(dataStr.isAccessed(id1));
+    REQUIRE(dataStr.tryAcquireAccess({id1}, {}));
+    REQUIRE(!dataStr.tryAcquireAccess({}, {id2}));
+
+    // IDs that are also written are only written
+    reader.release();
+    reader = dataStr.acquireAccess({id1}, {id2, id2, id1});
+    REQUIRE(reader.getReadIds().empty());
+    REQUIRE(reader.getWriteIds().size() == 2);
+    REQUIRE(!dataStr.tryAcquireAccess({id1}, {}));
+
+    reader.release();
+    REQUIRE(!reader.isValid());
+    REQUIRE(!dataStr.isAccessed(id1));
+    REQUIRE(dataStr.tryAcquireAccess({}, {id1, id2}));
+  }
+  SECTION("waiting")
+  {
+    std::atomic<bool> writing = false;
+    std::atomic<bool> overlapped = false;
+    std::vector<std::thread> threads;
+    for(usize i = 0; i < 4; i++)
+    {
+      threads.emplace_back([&dataStr, &writing, &overlapped, id1, id2]() {
+        for(usize j = 0; j < 100; j++)
+        {
+          auto token = dataStr.acquireAccess({id2}, {id1});
+          overlapped = overlapped || writing.exchange(true);
+          writing = false;
+        }
+      });
+    }
+    for(auto& thread : threads)
+    {
+      thread.join();
+    }
+    REQUIRE(!overlapped);
+    REQUIRE(!dataStr.isAccessed(id1));
+  }
+}
+
+TEST_CASE("DataStructureConcurrencyTest")
+{
+  DataStructure dataStr;
+  const usize threadCount = 4;
+  const usize groupCount = 500;
+  std::vector<DataObject::IdType> parentIds;
+  for(usize i = 0; i < threadCount; i++)
+  {
+    parentIds.push_back(dataStr.createGroup("Parent " + std::to_string(i))->getId());
+  }
+
+  // Each thread builds and queries its own subtree while the others change theirs
+  std::vector<std::vector<DataObject::IdType>> childIds(threadCount);
+  std::vector<usize> failures(threadCount, 0);
+  std::vector<std::thread> threads;
+  for(usize i = 0; i < threadCount; i++)
+  {
+    threads.emplace_back([&, i]() {
+      const std::string parentName = "Parent " + std::to_string(i);
+      for(usize j = 0; j < groupCount; j++)
+      {
+        const std::string name = "Child " + std::to_string(j);
+        DataGroup* child = dataStr.createGroup(name, parentIds[i]);
+        if(child == nullptr || dataStr.getData(DataPath({parentName, name})) != child || dataStr.getData(child->getId()) != child)
+        {
+          failures[i]++;
+          continue;
+        }
+        childIds[i].push_back(child->getId());
+        // Remove every other child again
+        if(j % 2 == 1 && !dataStr.removeData(child->getId()))
+        {
+          failures[i]++;
+        }
+      }
+    });
+  }
+  for(auto& thread : threads)
+  {
+    thread.join();
+  }
+
+  REQUIRE(std::all_of(failures.begin(), failures.end(), [](usize count) { return count == 0; }));
+  REQUIRE(dataStr.size() == threadCount * (1 + groupCount / 2));
+  std::vector<DataObject::IdType> ids;
+  for(usize i = 0; i < threadCount; i++)
+  {
+    for(usize j = 0; j < groupCount; j++)
+    {
+      REQUIRE((dataStr.getData(childIds[i][j]) != nullptr) == (j % 2 == 0));
+    }
+    ids.insert(ids.end(), childIds[i].begin(), childIds[i].end());
+  }
+  std::sort(ids.begin(), ids.end());
+  REQUIRE(std::adjacent_find(ids.begin(), ids.end()) == ids.end());
+}
+
+TEST_CASE("DataArrayCopyOnWriteTest")
+{
+  DataStructure dataStr;
+  auto group = dataStr.createGroup("Group");
+  auto written = dataStr.createDataArray<int32_t>("Written", new DataStore<int32_t>(1, 4), group->getId());
+  auto untouched = dataStr.createDataArray<int32_t>("Untouched", new DataStore<int32_t>(1, 4), group->getId());
+  written->getDataStore()->fill(1);
+  untouched->getDataStore()->fill(2);
+
+  DataStructure dataStrCopy(dataStr);
+  auto writtenCopy = dynamic_cast<Int32Array*>(dataStrCopy.getData(written->getId()));
+  auto untouchedCopy = dynamic_cast<Int32Array*>(dataStrCopy.getData(untouched->getId()));
+  REQUIRE(writtenCopy != nullptr);
+  REQUIRE(untouchedCopy != nullptr);
+  REQUIRE(writtenCopy != written);
+
+  // Buffers are shared until the first write
+  const auto& constWrittenCopy = *writtenCopy;
+  REQUIRE(writtenCopy->isDataStoreShared());
+  REQUIRE(constWrittenCopy.getDataStore() == static_cast<const Int32Array*>(written)->getDataStore());
+  REQUIRE(constWrittenCopy[0] == 1);
+
+  (*writtenCopy)[0] = 10;
+  REQUIRE(!writtenCopy->isDataStoreShared());
+  REQUIRE(!written->isDataStoreShared());
+  REQUIRE((*writtenCopy)[0] == 10);
+  REQUIRE((*written)[0] == 1);
+
+  // Arrays that were never written keep sharing their buffer
+  REQUIRE(untouchedCopy->isDataStoreShared());
+  REQUIRE(static_cast<const Int32Array*>(untouchedCopy)->getDataStore() == static_cast<const Int32Array*>(untouched)->getDataStore());
+
+  // Writing to the original detaches it from the copy as well
+  (*untouched)[1] = 20;
+  REQUIRE((*untouched)[1] == 20);
+  REQUIRE(static_cast<const Int32Array*>(untouchedCopy)->at(1) == 2);
+
+  // Explicitly shared stores are not copied on write
+  auto alias = dataStr.createDataArray<int32_t>("Alias", new DataStore<int32_t>(1, 1), group->getId());
+  alias->setDataStore(written->getDataStorePtr());
+  (*alias)[2] = 30;
+  REQUIRE((*written)[2] == 30);
+
+  // Concurrent writers through the same array detach it exactly once
+  DataStructure concurrentCopy(dataStr);
+  auto concurrentArray = dynamic_cast<Int32Array*>(concurrentCopy.getData(untouched->getId()));
+  REQUIRE(concurrentArray->isDataStoreShared());
+  std::vector<std::thread> writers;
+  for(size_t i = 0; i < 4; i++)
+  {
+    writers.emplace_back([concurrentArray, i]() { (*concurrentArray)[i] = static_cast<int32_t>(100 + i); });
+  }
+  for(auto& writer : writers)
+  {
+    writer.join();
+  }
+  REQUIRE(!concurrentArray->isDataStoreShared());
+  for(size_t i = 0; i < 4; i++)
+  {
+    REQUIRE(static_cast<const Int32Array*>(concurrentArray)->at(i) == static_cast<int32_t>(100 + i));
+  }
+  REQUIRE(static_cast<const Int32Array*>(untouched)->at(0) == 2);
+}
+
+TEST_CASE("DataArrayVersionTest")
+{
+  DataStructure dataStr;
+  auto group = dataStr.createGroup("Group");
+  auto array = dataStr.createDataArray<int32_t>("Array", new DataStore<int32_t>(1, 4), group->getId());
+  const auto& constArray = *array;
+
+  // Reads keep the version, writable access changes it
+  const uint64_t version = array->getVersion();
+  REQUIRE(constArray[0] == 0);
+  REQUIRE(constArray.getDataStore()->getValue(1) == 0);
+  REQUIRE(array->getVersion() == version);
+  (*array)[0] = 1;
+  const uint64_t writtenVersion = array->getVersion();
+  REQUIRE(writtenVersion != version);
+  REQUIRE(array->getVersion() == writtenVersion);
+
+  // Replaced and copied stores never reuse a version
+  array->setDataStore(new DataStore<int32_t>(1, 4));
+  REQUIRE(array->getVersion() != writtenVersion);
+  std::unique_ptr<IDataStore<int32_t>> storeCopy(constArray.getDataStore()->deepCopy());
+  REQUIRE(storeCopy->getVersion() != array->getVersion());
+
+  // Writes through a retained pointer are announced with markModified()
+  int32_t* values = array->data();
+  const uint64_t pointerVersion = array->getVersion();
+  values[0] = 2;
+  array->getDataStore()->markModified();
+  REQUIRE(array->getVersion() != pointerVersion);
+}
+
 TEST_CASE("DataStoreTest")
 {
   const size_t tupleSize = 3;
@@ -264,6 +751,811 @@ TEST_CASE("DataStoreTest")
       REQUIRE(value == x++);
     }
   }
+  // contiguous access
+  {
+    REQUIRE(store.isContiguous());
+    REQUIRE(store.data() != nullptr);
+    auto span = store.span();
+    REQUIRE(span.size() == store.getSize());
+    for(size_t i = 0; i < span.size(); i++)
+    {
+      span[i] = static_cast<int32_t>(i * 2);
+    }
+    const IDataStore<int32_t>& baseStore = store;
+    auto iter = baseStore.begin();
+    REQUIRE(*(iter + 3) == 6);
+    REQUIRE(iter[4] == 8);
+    REQUIRE(baseStore.end() - baseStore.begin() == static_cast<int64_t>(store.getSize()));
+
+    EmptyDataStore<int32_t> emptyStore(tupleSize, tupleCount);
+    REQUIRE(!emptyStore.isContiguous());
+    REQUIRE(emptyStore.data() == nullptr);
+    REQUIRE(emptyStore.span().empty());
+  }
+  // reserve / append
+  {
+    DataStore<int32_t> appendStore(tupleSize, 0);
+    appendStore.reserveTuples(4);
+    REQUIRE(appendStore.getTupleCount() == 0);
+    REQUIRE(appendStore.getTupleCapacity() >= 4);
+
+    size_t reallocations = 0;
+    const int32_t* previousData = appendStore.data();
+    for(int32_t i = 0; i < 1000; i++)
+    {
+      const int32_t tuple[tupleSize] = {i, i + 1, i + 2};
+      appendStore.appendTuples(tuple, 1);
+      if(appendStore.data() != previousData)
+      {
+        reallocations++;
+        previousData = appendStore.data();
+      }
+    }
+    REQUIRE(appendStore.getTupleCount() == 1000);
+    REQUIRE(appendStore.getTupleCapacity() >= 1000);
+    REQUIRE(reallocations < 20);
+    REQUIRE(appendStore[999 * tupleSize + 2] == 1001);
+
+    appendStore.resizeTuples(10);
+    REQUIRE(appendStore.getTupleCapacity() >= 1000);
+    appendStore.shrinkToFit();
+    REQUIRE(appendStore.getTupleCapacity() == 10);
+
+    ChunkedDataStore<int32_t> chunkedStore(tupleSize, 2, 4, 2);
+    const int32_t values[tupleSize * 2] = {1, 2, 3, 4, 5, 6};
+    chunkedStore.appendTuples(values, 2);
+    REQUIRE(chunkedStore.getTupleCount() == 4);
+    REQUIRE(chunkedStore.getValue(2 * tupleSize) == 1);
+    REQUIRE(chunkedStore.getValue(4 * tupleSize - 1) == 6);
+  }
+}
+
+TEST_CASE("DataStoreAllocationTest")
+{
+  const size_t tupleSize = 3;
+  const size_t tupleCount = 100000;
+
+  std::vector<AllocationOptions> allOptions(4);
+  allOptions[1].alignment = 4096;
+  allOptions[2].hugePages = AllocationOptions::HugePages::Transparent;
+  allOptions[2].numaPolicy = AllocationOptions::NumaPolicy::Interleave;
+  allOptions[3].hugePages = AllocationOptions::HugePages::Explicit;
+
+  for(const auto& options : allOptions)
+  {
+    DataStore<double> store(tupleSize, tupleCount, options);
+    REQUIRE(store.getAllocationOptions() == options);
+    REQUIRE(reinterpret_cast<uintptr_t>(store.data()) % options.alignment == 0);
+    REQUIRE(std::all_of(store.begin(), store.end(), [](double value) { return value == 0.0; }));
+
+    store.fill(2.5);
+    const double tuple[tupleSize] = {2.5, 2.5, 2.5};
+    store.appendTuples(tuple, 1);
+    REQUIRE(store.getTupleCount() == tupleCount + 1);
+    REQUIRE(store.getValue(store.getSize() - 1) == 2.5);
+
+    std::unique_ptr<IDataStore<double>> copy(store.deepCopy());
+    auto typedCopy = dynamic_cast<DataStore<double>*>(copy.get());
+    REQUIRE(typedCopy != nullptr);
+    REQUIRE(typedCopy->getAllocationOptions() == options);
+    REQUIRE(typedCopy->getValue(tupleCount / 2) == 2.5);
+  }
+
+  AllocationOptions invalid;
+  invalid.alignment = 48;
+  REQUIRE_THROWS(DataStore<double>(tupleSize, tupleCount, invalid));
+
+  std::vector<uint16_t> values(300000);
+  BulkCopy::FillValues<uint16_t>(values.data(), values.size(), 7, 0);
+  REQUIRE(std::all_of(values.begin(), values.end(), [](uint16_t value) { return value == 7; }));
+}
+
+TEST_CASE("FileDataStoreTest")
+{
+  const size_t tupleSize = 3;
+  const size_t tupleCount = 10;
+
+  SECTION("scratch store")
+  {
+    FileDataStore<int32_t> store(tupleSize, tupleCount);
+    REQUIRE(store.isScratch());
+    REQUIRE(store.isContiguous());
+    REQUIRE(store.getSize() == (tupleSize * tupleCount));
+    for(size_t i = 0; i < store.getSize(); i++)
+    {
+      REQUIRE(store[i] == 0);
+      store[i] = static_cast<int32_t>(i);
+    }
+
+    store.resizeTuples(tupleCount * 2);
+    REQUIRE(store.getTupleCount() == tupleCount * 2);
+    REQUIRE(store[tupleSize * tupleCount - 1] == static_cast<int32_t>(tupleSize * tupleCount - 1));
+    REQUIRE(store[tupleSize * tupleCount] == 0);
+
+    // A failed resize leaves the store mapped at its previous size
+    REQUIRE_THROWS(store.resizeTuples(std::numeric_limits<size_t>::max() / 16 / tupleSize));
+    REQUIRE(store.getTupleCount() == tupleCount * 2);
+    REQUIRE(store.data() != nullptr);
+    REQUIRE(store[7] == 7);
+
+    std::unique_ptr<IDataStore<int32_t>> copy(store.deepCopy());
+    store.fill(-1);
+    REQUIRE(copy->getSize() == store.getSize());
+    REQUIRE(copy->getValue(5) == 5);
+    REQUIRE(store.getValue(5) == -1);
+  }
+  SECTION("persistent store")
+  {
+    const auto path = std::filesystem::temp_directory_path() / "complex_FileDataStoreTest.bin";
+    {
+      std::unique_ptr<FileDataStore<float>> store(FileDataStore<float>::OpenPersistent(path, tupleSize, tupleCount));
+      REQUIRE(!store->isScratch());
+      store->setValue(7, 2.5f);
+      store->flush();
+    }
+    REQUIRE(std::filesystem::exists(path));
+    {
+      std::unique_ptr<FileDataStore<float>> store(FileDataStore<float>::OpenPersistent(path, tupleSize, tupleCount));
+      REQUIRE(store->getValue(7) == 2.5f);
+    }
+    std::filesystem::remove(path);
+  }
+  SECTION("create array action")
+  {
+    DataStructure dataStr;
+    dataStr.createGroup("Group");
+    const std::vector<usize> dims = {tupleSize, tupleCount};
+
+    CreateArrayAction inMemoryAction(NumericType::i32, dims, DataPath({"Group", "InMemory"}), CreateArrayAction::StoreType::Auto, 1024);
+    REQUIRE(inMemoryAction.apply(dataStr, IDataAction::Mode::Execute).valid());
+    auto inMemoryArray = dynamic_cast<Int32Array*>(dataStr.getData(DataPath({"Group", "InMemory"})));
+    REQUIRE(inMemoryArray != nullptr);
+    REQUIRE(dynamic_cast<DataStore<int32_t>*>(inMemoryArray->getDataStore()) != nullptr);
+
+    CreateArrayAction thresholdAction(NumericType::i32, dims, DataPath({"Group", "Threshold"}), CreateArrayAction::StoreType::Auto, 64);
+    REQUIRE(thresholdAction.apply(dataStr, IDataAction::Mode::Execute).valid());
+    auto thresholdArray = dynamic_cast<Int32Array*>(dataStr.getData(DataPath({"Group", "Threshold"})));
+    REQUIRE(thresholdArray != nullptr);
+    REQUIRE(dynamic_cast<FileDataStore<int32_t>*>(thresholdArray->getDataStore()) != nullptr);
+
+    CreateArrayAction fileAction(NumericType::f32, dims, DataPath({"Group", "File"}), CreateArrayAction::StoreType::FileMapped);
+    REQUIRE(fileAction.apply(dataStr, IDataAction::Mode::Execute).valid());
+    auto fileArray = dynamic_cast<FloatArray*>(dataStr.getData(DataPath({"Group", "File"})));
+    REQUIRE(fileArray != nullptr);
+    REQUIRE(dynamic_cast<FileDataStore<float>*>(fileArray->getDataStore()) != nullptr);
+  }
+}
+
+TEST_CASE("ChunkedDataStoreTest")
+{
+  const size_t tupleSize = 2;
+  const size_t tupleCount = 25;
+  const size_t tuplesPerChunk = 4;
+  const size_t maxResidentChunks = 2;
+
+  SECTION("spilling store")
+  {
+    ChunkedDataStore<int32_t> store(tupleSize, tupleCount, tuplesPerChunk, maxResidentChunks, std::filesystem::temp_directory_path());
+    REQUIRE(store.canSpill());
+    REQUIRE(!store.isContiguous());
+    REQUIRE(store.getChunkCount() == 7);
+    REQUIRE(store.getResidentChunkCount() == 0);
+    for(size_t i = 0; i < store.getSize(); i++)
+    {
+      REQUIRE(store.getValue(i) == 0);
+      store[i] = static_cast<int32_t>(i);
+      REQUIRE(store.getResidentChunkCount() <= maxResidentChunks);
+    }
+    for(size_t i = 0; i < store.getSize(); i++)
+    {
+      REQUIRE(store.getValue(i) == static_cast<int32_t>(i));
+    }
+
+    store.resizeTuples(tupleCount - 3);
+    store.resizeTuples(tupleCount + 10);
+    REQUIRE(store.getChunkCount() == 9);
+    REQUIRE(store.getValue((tupleCount - 3) * tupleSize - 1) == static_cast<int32_t>((tupleCount - 3) * tupleSize - 1));
+    REQUIRE(store.getValue((tupleCount - 3) * tupleSize) == 0);
+    REQUIRE(store.getValue(store.getSize() - 1) == 0);
+
+    std::unique_ptr<IDataStore<int32_t>> copy(store.deepCopy());
+    store.fill(-1);
+    REQUIRE(copy->getValue(5) == 5);
+    REQUIRE(store.getValue(5) == -1);
+    store.fill(0);
+    REQUIRE(store.getResidentChunkCount() == 0);
+    REQUIRE(store.getValue(5) == 0);
+  }
+  SECTION("in-memory store")
+  {
+    ChunkedDataStore<float> store(tupleSize, tupleCount, tuplesPerChunk, maxResidentChunks);
+    REQUIRE(!store.canSpill());
+    for(size_t i = 0; i < store.getSize(); i++)
+    {
+      REQUIRE(store.getValue(i) == 0.0f);
+    }
+    REQUIRE(store.getResidentChunkCount() == maxResidentChunks);
+    for(size_t i = 0; i < store.getSize(); i++)
+    {
+      store.setValue(i, static_cast<float>(i));
+    }
+    REQUIRE(store.getResidentChunkCount() == store.getChunkCount());
+    for(size_t i = 0; i < store.getSize(); i++)
+    {
+      REQUIRE(store.getValue(i) == static_cast<float>(i));
+    }
+  }
+  SECTION("concurrent readers")
+  {
+    ChunkedDataStore<int32_t> store(tupleSize, tupleCount, tuplesPerChunk, maxResidentChunks, std::filesystem::temp_directory_path());
+    for(size_t i = 0; i < store.getSize(); i++)
+    {
+      store.setValue(i, static_cast<int32_t>(i));
+    }
+    std::atomic<size_t> mismatches = 0;
+    std::vector<std::thread> readers;
+    for(size_t t = 0; t < 4; t++)
+    {
+      readers.emplace_back([&store, &mismatches, t]() {
+        for(size_t pass = 0; pass < 50; pass++)
+        {
+          for(size_t i = 0; i < store.getSize(); i++)
+          {
+            const size_t index = (i + t * 7) % store.getSize();
+            if(store.getValue(index) != static_cast<int32_t>(index))
+            {
+              mismatches++;
+            }
+          }
+        }
+      });
+    }
+    for(auto& reader : readers)
+    {
+      reader.join();
+    }
+    REQUIRE(mismatches == 0);
+    REQUIRE(store.getResidentChunkCount() <= maxResidentChunks);
+  }
+  SECTION("data array")
+  {
+    DataStructure dataStr;
+    auto dataArr = dataStr.createDataArray<int32_t>("array", new DataStore<int32_t>(tupleSize, tupleCount));
+    dataArr->setDataStore(new ChunkedDataStore<int32_t>(tupleSize, tupleCount, tuplesPerChunk, maxResidentChunks, std::filesystem::temp_directory_path()));
+    int32_t x = 0;
+    for(auto& value : *dataArr)
+    {
+      value = x++;
+    }
+    x = 0;
+    for(const auto& value : *dataArr)
+    {
+      REQUIRE(value == x++);
+    }
+  }
+}
+
+TEST_CASE("BulkCopyTest")
+{
+  const size_t tupleSize = 3;
+  const size_t tupleCount = 1000;
+
+  DataStore<int32_t> store(tupleSize, tupleCount);
+  for(size_t i = 0; i < store.getSize(); i++)
+  {
+    store[i] = static_cast<int32_t>(i);
+  }
+
+  SECTION("deep copy")
+  {
+    std::unique_ptr<IDataStore<int32_t>> copy(store.deepCopy());
+    REQUIRE(copy->getSize() == store.getSize());
+    REQUIRE(copy->data() != store.data());
+    REQUIRE(std::equal(store.begin(), store.end(), copy->data()));
+  }
+  SECTION("parallel copy")
+  {
+    // Small slices put several boundaries inside the buffer, one of them away from a cache line
+    std::vector<int32_t> destination(store.getSize() + 1, -1);
+    BulkCopy::CopyValues(store.data(), destination.data() + 1, store.getSize() - 1, 0, 1000);
+    REQUIRE(destination[0] == -1);
+    REQUIRE(std::equal(store.begin(), store.end() - 1, destination.begin() + 1));
+    REQUIRE(destination[store.getSize()] == -1);
+  }
+  SECTION("slices")
+  {
+    const usize count = 10007;
+    const usize granularity = 64;
+    std::vector<int32_t> visits(count, 0);
+    std::mutex slicesMutex;
+    std::vector<std::pair<usize, usize>> slices;
+    BulkCopy::ForEachSlice(count, 100, granularity, [&](usize begin, usize end) {
+      std::lock_guard<std::mutex> lock(slicesMutex);
+      slices.emplace_back(begin, end);
+      for(usize i = begin; i < end; i++)
+      {
+        visits[i]++;
+      }
+    });
+    REQUIRE(std::all_of(visits.begin(), visits.end(), [](int32_t visitCount) { return visitCount == 1; }));
+    REQUIRE(slices.size() <= ThreadPool::Global().getThreadCount());
+    for(const auto& [begin, end] : slices)
+    {
+      REQUIRE(begin % granularity == 0);
+      REQUIRE((end == count || end % granularity == 0));
+      REQUIRE((end == count || end - begin >= 100));
+    }
+  }
+  SECTION("store to store")
+  {
+    ChunkedDataStore<int32_t> chunked(tupleSize, tupleCount, 64, 2);
+    BulkCopy::CopyStore<int32_t>(store, chunked);
+    DataStore<int32_t> roundTrip(tupleSize, tupleCount);
+    BulkCopy::CopyStore<int32_t>(chunked, roundTrip);
+    REQUIRE(std::equal(store.begin(), store.end(), roundTrip.begin()));
+  }
+}
+
+TEST_CASE("BulkCopyBenchmark", "[.benchmark]")
+{
+  using Clock = std::chrono::steady_clock;
+  const size_t valueCount = size_t(512) * 1024 * 1024 / sizeof(float);
+
+  DataStore<float> store(1, valueCount);
+  store.fill(1.0f);
+
+  // The baseline allocates and copies a raw buffer, which is the least work any deep copy has to do
+  auto start = Clock::now();
+  std::unique_ptr<float[]> reference(new float[valueCount]);
+  std::memcpy(reference.get(), store.data(), valueCount * sizeof(float));
+  const std::chrono::duration<double> memcpyTime = Clock::now() - start;
+
+  start = Clock::now();
+  std::unique_ptr<IDataStore<float>> copy(store.deepCopy());
+  const std::chrono::duration<double> deepCopyTime = Clock::now() - start;
+
+  const double gigabytes = static_cast<double>(valueCount * sizeof(float)) / (1024.0 * 1024.0 * 1024.0);
+  WARN("memcpy: " << gigabytes / memcpyTime.count() << " GB/s, deepCopy: " << gigabytes / deepCopyTime.count() << " GB/s");
+  WARN("deepCopy / memcpy time: " << deepCopyTime.count() / memcpyTime.count());
+  REQUIRE(copy->getValue(valueCount - 1) == 1.0f);
+}
+
+TEST_CASE("ThreadPoolTest")
+{
+  ThreadPool pool(4);
+  REQUIRE(pool.getThreadCount() == 4);
+
+  SECTION("run")
+  {
+    std::vector<int32_t> visits(1000, 0);
+    pool.run(visits.size(), [&visits](usize index) { visits[index]++; });
+    REQUIRE(std::all_of(visits.begin(), visits.end(), [](int32_t count) { return count == 1; }));
+  }
+  SECTION("parallel for")
+  {
+    std::vector<int32_t> values(10000, 0);
+    // Catch2 assertions are not thread-safe, so slices are checked on this thread
+    std::atomic<usize> misalignedSlices = 0;
+    pool.parallelFor(values.size(), 100, 16, [&values, &pool, &misalignedSlices](usize begin, usize end) {
+      if(begin % 16 != 0)
+      {
+        misalignedSlices++;
+      }
+      // Nested batches run on the calling thread
+      pool.run(end - begin, [&values, begin](usize index) { values[begin + index]++; });
+    });
+    REQUIRE(misalignedSlices == 0);
+    REQUIRE(std::all_of(values.begin(), values.end(), [](int32_t count) { return count == 1; }));
+  }
+  SECTION("exceptions")
+  {
+    REQUIRE_THROWS_AS(pool.run(100,
+                               [](usize index) {
+                                 if(index == 50)
+                                 {
+                                   throw std::runtime_error("Task failed");
+                                 }
+                               }),
+                      std::runtime_error);
+    std::atomic<usize> count = 0;
+    pool.run(100, [&count](usize) { count++; });
+    REQUIRE(count == 100);
+  }
+  SECTION("concurrent batches")
+  {
+    // The first batch only finishes early if the second one runs while it is still in progress
+    std::atomic<bool> firstStarted = false;
+    std::atomic<bool> secondStarted = false;
+    std::atomic<bool> sawSecond = true;
+    std::thread first([&]() {
+      pool.run(2, [&](usize) {
+        firstStarted = true;
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while(!secondStarted && std::chrono::steady_clock::now() < deadline)
+        {
+          std::this_thread::yield();
+        }
+        if(!secondStarted)
+        {
+          sawSecond = false;
+        }
+      });
+    });
+    while(!firstStarted)
+    {
+      std::this_thread::yield();
+    }
+    pool.run(2, [&](usize) { secondStarted = true; });
+    first.join();
+    REQUIRE(sawSecond);
+  }
+  SECTION("shutdown")
+  {
+    pool.shutdown();
+    REQUIRE(pool.getThreadCount() == 1);
+    std::vector<int32_t> visits(100, 0);
+    pool.run(visits.size(), [&visits](usize index) { visits[index]++; });
+    REQUIRE(std::all_of(visits.begin(), visits.end(), [](int32_t count) { return count == 1; }));
+  }
+}
+
+TEST_CASE("ParallelAlgorithmsTest")
+{
+  const size_t tupleSize = 3;
+  const size_t tupleCount = 500000;
+
+  DataStore<int32_t> store(tupleSize, tupleCount);
+  for(size_t i = 0; i < store.getSize(); i++)
+  {
+    store[i] = static_cast<int32_t>(i % 1000) - 500;
+  }
+
+  SECTION("fill")
+  {
+    ParallelAlgorithms::Fill<int32_t>(store, 7);
+    REQUIRE(std::all_of(store.begin(), store.end(), [](int32_t value) { return value == 7; }));
+
+    ChunkedDataStore<int32_t> chunked(tupleSize, 100, 16, 2);
+    ParallelAlgorithms::Fill<int32_t>(chunked, 3);
+    REQUIRE(std::all_of(chunked.begin(), chunked.end(), [](int32_t value) { return value == 3; }));
+  }
+  SECTION("transform")
+  {
+    DataStore<float> halves(tupleSize, tupleCount);
+    ParallelAlgorithms::Transform<int32_t, float>(store, halves, [](int32_t value) { return value * 0.5f; });
+    REQUIRE(halves[1001] == 0.5f * store[1001]);
+
+    ParallelAlgorithms::Transform<int32_t>(store, [](int32_t value) { return value * 2; });
+    REQUIRE(store[0] == -1000);
+    REQUIRE(store[999] == 998);
+  }
+  SECTION("reductions")
+  {
+    REQUIRE(ParallelAlgorithms::Min<int32_t>(store) == -500);
+    REQUIRE(ParallelAlgorithms::Max<int32_t>(store) == 499);
+    // Each block of 1000 values sums to -500
+    REQUIRE(ParallelAlgorithms::Sum<int32_t>(store) == -500 * static_cast<int64_t>(store.getSize() / 1000));
+    REQUIRE(ParallelAlgorithms::CountIf<int32_t>(store, [](int32_t value) { return value < 0; }) == store.getSize() / 2);
+
+    const auto histogram = ParallelAlgorithms::Histogram<int32_t>(store, 4, -500, 499);
+    REQUIRE(histogram.size() == 4);
+    REQUIRE(std::accumulate(histogram.begin(), histogram.end(), u64{0}) == store.getSize());
+    REQUIRE(histogram[0] == store.getSize() / 4);
+    REQUIRE_THROWS(ParallelAlgorithms::Histogram<int32_t>(store, 0, 0, 1));
+  }
+  SECTION("non-contiguous stores")
+  {
+    PlanarDataStore<int32_t> planar(store);
+    REQUIRE(ParallelAlgorithms::Sum<int32_t>(planar) == ParallelAlgorithms::Sum<int32_t>(store));
+
+    CompressedDataStore<int32_t> compressed(store);
+    REQUIRE(ParallelAlgorithms::MinMax<int32_t>(compressed) == std::make_pair(-500, 499));
+
+    DataStore<int32_t> empty(tupleSize, 0);
+    REQUIRE(ParallelAlgorithms::Max<int32_t>(empty) == std::numeric_limits<int32_t>::lowest());
+  }
+  SECTION("data arrays")
+  {
+    DataStructure dataStr;
+    auto* array = dataStr.createDataArray<int32_t>("Array", new DataStore<int32_t>(tupleSize, tupleCount));
+    ParallelAlgorithms::Fill(*array, -1);
+    REQUIRE(ParallelAlgorithms::Sum(*array) == -static_cast<int64_t>(array->getSize()));
+
+    auto* copy = dataStr.createDataArray<int32_t>("Copy", new DataStore<int32_t>(tupleSize, tupleCount));
+    ParallelAlgorithms::Copy(*array, *copy);
+    REQUIRE(ParallelAlgorithms::CountIf(*copy, [](int32_t value) { return value == -1; }) == copy->getSize());
+  }
+}
+
+TEST_CASE("CompressedDataStoreTest")
+{
+  const size_t tupleSize = 1;
+  const size_t tupleCount = 10000;
+  const size_t tuplesPerBlock = 1024;
+  const size_t maxHotBlocks = 2;
+
+  SECTION("block codec")
+  {
+    std::mt19937 generator(42);
+    std::vector<uint8_t> random(5000);
+    for(auto& value : random)
+    {
+      value = static_cast<uint8_t>(generator());
+    }
+    std::vector<uint8_t> output(random.size());
+    auto compressed = BlockCodec::Compress(random.data(), random.size(), 1);
+    REQUIRE(compressed.size() <= random.size() + 1);
+    BlockCodec::Decompress(compressed.data(), compressed.size(), output.data(), output.size(), 1);
+    REQUIRE(output == random);
+
+    std::vector<int32_t> ids(4000);
+    for(size_t i = 0; i < ids.size(); i++)
+    {
+      ids[i] = static_cast<int32_t>(i / 100);
+    }
+    std::vector<int32_t> idsOutput(ids.size());
+    compressed = BlockCodec::Compress(ids.data(), ids.size() * sizeof(int32_t), sizeof(int32_t));
+    REQUIRE(compressed.size() < ids.size());
+    BlockCodec::Decompress(compressed.data(), compressed.size(), idsOutput.data(), idsOutput.size() * sizeof(int32_t), sizeof(int32_t));
+    REQUIRE(idsOutput == ids);
+
+    compressed.resize(compressed.size() / 2);
+    REQUIRE_THROWS(BlockCodec::Decompress(compressed.data(), compressed.size(), idsOutput.data(), idsOutput.size() * sizeof(int32_t), sizeof(int32_t)));
+  }
+  SECTION("compress existing store")
+  {
+    DataStore<int32_t> featureIds(tupleSize, tupleCount);
+    for(size_t i = 0; i < featureIds.getSize(); i++)
+    {
+      featureIds[i] = static_cast<int32_t>(i / 250);
+    }
+    CompressedDataStore<int32_t> store(featureIds, tuplesPerBlock, maxHotBlocks);
+    REQUIRE(store.getBlockCount() == 10);
+    REQUIRE(store.getCompressedByteCount() * 10 < featureIds.getSize() * sizeof(int32_t));
+    for(size_t i = 0; i < store.getSize(); i++)
+    {
+      REQUIRE(store.getValue(i) == featureIds[i]);
+      REQUIRE(store.getHotBlockCount() <= maxHotBlocks);
+    }
+
+    store[5] = -5;
+    store[store.getSize() - 1] = -1;
+    std::unique_ptr<IDataStore<int32_t>> copy(store.deepCopy());
+    store.compact();
+    REQUIRE(store.getHotBlockCount() == 0);
+    REQUIRE(store.getValue(5) == -5);
+    REQUIRE(store.getValue(6) == 0);
+    REQUIRE(copy->getValue(5) == -5);
+    REQUIRE(copy->getValue(copy->getSize() - 1) == -1);
+
+    store.resizeTuples(tupleCount - 10);
+    store.resizeTuples(tupleCount);
+    REQUIRE(store.getValue(tupleCount - 11) == featureIds[tupleCount - 11]);
+    REQUIRE(store.getValue(tupleCount - 10) == 0);
+  }
+  SECTION("fill")
+  {
+    CompressedDataStore<uint8_t> store(tupleSize, tupleCount, tuplesPerBlock, maxHotBlocks);
+    REQUIRE(store.getCompressedByteCount() == 0);
+    store.fill(3);
+    REQUIRE(store.getCompressedByteCount() < 1000);
+    REQUIRE(store.getValue(0) == 3);
+    REQUIRE(store.getValue(tupleCount - 1) == 3);
+    store.fill(0);
+    REQUIRE(store.getCompressedByteCount() == 0);
+    REQUIRE(store.getValue(tupleCount / 2) == 0);
+  }
+  SECTION("concurrent readers")
+  {
+    DataStore<int32_t> featureIds(tupleSize, tupleCount);
+    for(size_t i = 0; i < featureIds.getSize(); i++)
+    {
+      featureIds[i] = static_cast<int32_t>(i / 250);
+    }
+    CompressedDataStore<int32_t> store(featureIds, tuplesPerBlock, maxHotBlocks);
+    std::atomic<size_t> mismatches = 0;
+    std::vector<std::thread> readers;
+    for(size_t t = 0; t < 4; t++)
+    {
+      readers.emplace_back([&store, &featureIds, &mismatches, t]() {
+        for(size_t i = 0; i < store.getSize(); i++)
+        {
+          const size_t index = (i + t * tuplesPerBlock) % store.getSize();
+          if(store.getValue(index) != featureIds[index])
+          {
+            mismatches++;
+          }
+        }
+      });
+    }
+    for(auto& reader : readers)
+    {
+      reader.join();
+    }
+    REQUIRE(mismatches == 0);
+    REQUIRE(store.getHotBlockCount() <= maxHotBlocks);
+  }
+  SECTION("data array")
+  {
+    DataStructure dataStr;
+    auto mask = dataStr.createDataArray<uint8_t>("Mask", new DataStore<uint8_t>(tupleSize, tupleCount));
+    mask->getDataStore()->fill(1);
+    mask->setDataStore(new CompressedDataStore<uint8_t>(*mask->getDataStore(), tuplesPerBlock, maxHotBlocks));
+    REQUIRE(dynamic_cast<CompressedDataStore<uint8_t>*>(mask->getDataStore()) != nullptr);
+    size_t count = 0;
+    for(const auto& value : *mask)
+    {
+      count += value;
+    }
+    REQUIRE(count == tupleCount);
+  }
+}
+
+TEST_CASE("PlanarDataStoreTest")
+{
+  const size_t tupleSize = 3;
+  const size_t tupleCount = 10;
+
+  DataStore<int32_t> interleaved(tupleSize, tupleCount);
+  for(size_t i = 0; i < interleaved.getSize(); i++)
+  {
+    interleaved[i] = static_cast<int32_t>(i);
+  }
+
+  SECTION("planar layout")
+  {
+    PlanarDataStore<int32_t> store(interleaved);
+    REQUIRE(!store.isContiguous());
+    for(size_t i = 0; i < store.getSize(); i++)
+    {
+      REQUIRE(store[i] == interleaved[i]);
+    }
+    for(size_t component = 0; component < tupleSize; component++)
+    {
+      auto plane = store.componentSpan(component);
+      REQUIRE(plane.size() == tupleCount);
+      REQUIRE(plane.data() == store.componentData(0) + component * tupleCount);
+      for(size_t tuple = 0; tuple < tupleCount; tuple++)
+      {
+        REQUIRE(plane[tuple] == static_cast<int32_t>(tuple * tupleSize + component));
+      }
+    }
+    REQUIRE(interleaved.componentSpan(0).empty());
+
+    store.resizeTuples(tupleCount + 2);
+    REQUIRE(store.getValue((tupleCount - 1) * tupleSize + 2) == static_cast<int32_t>((tupleCount - 1) * tupleSize + 2));
+    REQUIRE(store.getValue(tupleCount * tupleSize + 1) == 0);
+    store.resizeTuples(tupleCount - 2);
+    REQUIRE(store.componentSpan(1)[tupleCount - 3] == static_cast<int32_t>((tupleCount - 3) * tupleSize + 1));
+
+    std::unique_ptr<IDataStore<int32_t>> copy(store.deepCopy());
+    store.fill(-1);
+    REQUIRE(copy->getValue(4) == 4);
+  }
+  SECTION("component views")
+  {
+    DataStructure dataStr;
+    auto vertices = dataStr.createDataArray<float>("Vertices", new PlanarDataStore<float>(tupleSize, tupleCount));
+    auto interleavedVertices = dataStr.createDataArray<float>("InterleavedVertices", new DataStore<float>(tupleSize, tupleCount));
+    for(size_t i = 0; i < vertices->getSize(); i++)
+    {
+      (*vertices)[i] = static_cast<float>(i);
+      (*interleavedVertices)[i] = static_cast<float>(i);
+    }
+
+    auto yView = dataStr.createDataArray<float>("Y", new ComponentDataStore<float>(vertices->getDataStorePtr().lock(), 1));
+    auto yStridedView = dataStr.createDataArray<float>("YStrided", new ComponentDataStore<float>(interleavedVertices->getDataStorePtr().lock(), 1));
+    REQUIRE(yView->getTupleCount() == tupleCount);
+    REQUIRE(yView->getTupleSize() == 1);
+    REQUIRE(yView->isContiguous());
+    REQUIRE(yView->data() == vertices->componentSpan(1).data());
+    REQUIRE(!yStridedView->isContiguous());
+    for(size_t tuple = 0; tuple < tupleCount; tuple++)
+    {
+      REQUIRE((*yView)[tuple] == static_cast<float>(tuple * tupleSize + 1));
+      REQUIRE((*yStridedView)[tuple] == static_cast<float>(tuple * tupleSize + 1));
+    }
+
+    yView->getDataStore()->fill(0.0f);
+    yStridedView->getDataStore()->fill(0.0f);
+    REQUIRE((*vertices)[1] == 0.0f);
+    REQUIRE((*vertices)[2] == 2.0f);
+    REQUIRE((*interleavedVertices)[4] == 0.0f);
+    REQUIRE((*interleavedVertices)[5] == 5.0f);
+    REQUIRE_THROWS(yView->getDataStore()->resizeTuples(1));
+
+    // Viewed stores and views are copied immediately so writes through either cannot reach a copy
+    DataStructure dataStrCopy(dataStr);
+    auto verticesCopy = dynamic_cast<FloatArray*>(dataStrCopy.getData(vertices->getId()));
+    auto yViewCopy = dynamic_cast<FloatArray*>(dataStrCopy.getData(yView->getId()));
+    REQUIRE(verticesCopy != nullptr);
+    REQUIRE(yViewCopy != nullptr);
+    REQUIRE(!verticesCopy->isDataStoreShared());
+    (*yView)[3] = -3.0f;
+    (*vertices)[4 * tupleSize + 1] = -4.0f;
+    REQUIRE((*vertices)[3 * tupleSize + 1] == -3.0f);
+    REQUIRE(static_cast<const FloatArray*>(verticesCopy)->at(3 * tupleSize + 1) == 0.0f);
+    REQUIRE(static_cast<const FloatArray*>(yViewCopy)->at(4) == 0.0f);
+    (*verticesCopy)[5 * tupleSize + 1] = -5.0f;
+    REQUIRE(static_cast<const FloatArray*>(yView)->at(5) == 0.0f);
+  }
+}
+
+TEST_CASE("DynamicListArrayTest")
+{
+  DataStructure dataStr;
+  auto* dynamicList = dataStr.createDynamicList<int32_t, int32_t>("Links");
+  REQUIRE(dynamicList->size() == 0);
+
+  const std::vector<int32_t> linkCounts = {2, 0, 3};
+  dynamicList->allocateLists(linkCounts);
+  REQUIRE(dynamicList->size() == 3);
+  REQUIRE(dynamicList->getTotalNumberOfElements() == 5);
+  REQUIRE(dynamicList->getNumberOfElements(1) == 0);
+  // Lists are stored back to back
+  REQUIRE(dynamicList->getElementListPointer(2) == dynamicList->getElementListPointer(0) + 2);
+
+  dynamicList->insertCellReference(0, 0, 10);
+  dynamicList->insertCellReference(0, 1, 11);
+  const std::vector<int32_t> lastList = {20, 21, 22};
+  REQUIRE(dynamicList->setElementList(2, 3, lastList.data()));
+  REQUIRE(dynamicList->getElementListPointer(0)[1] == 11);
+  REQUIRE(dynamicList->getElementListPointer(2)[2] == 22);
+
+  SECTION("resize list")
+  {
+    const std::vector<int32_t> middleList = {30, 31};
+    REQUIRE(dynamicList->setElementList(1, 2, middleList.data()));
+    REQUIRE(dynamicList->getTotalNumberOfElements() == 7);
+    REQUIRE(dynamicList->getElementList(1).cells[1] == 31);
+    const auto& constList = *dynamicList;
+    const auto list = constList.getElementList(1);
+    REQUIRE(list.ncells == 2);
+    REQUIRE(list.cells[0] == 30);
+    REQUIRE(dynamicList->getNumberOfElements(2) == 3);
+    REQUIRE(dynamicList->getElementListPointer(2)[0] == 20);
+    REQUIRE_FALSE(dynamicList->setElementList(3, 2, middleList.data()));
+  }
+  SECTION("deep copy")
+  {
+    std::unique_ptr<DataObject> copyObject(dynamicList->deepCopy());
+    auto* copy = dynamic_cast<Int32Int32DynamicListArray*>(copyObject.get());
+    REQUIRE(copy != nullptr);
+    REQUIRE(copy->getElementListPointer(0) != dynamicList->getElementListPointer(0));
+    REQUIRE(std::equal(dynamicList->getElementListPointer(0), dynamicList->getElementListPointer(0) + 5, copy->getElementListPointer(0)));
+
+    Int32Int32DynamicListArray moved(std::move(*copy));
+    REQUIRE(moved.size() == 3);
+    REQUIRE(copy->size() == 0);
+  }
+  SECTION("deserialize")
+  {
+    std::vector<uint8_t> buffer;
+    for(size_t i = 0; i < dynamicList->size(); i++)
+    {
+      const int32_t count = dynamicList->getNumberOfElements(i);
+      const auto* countBytes = reinterpret_cast<const uint8_t*>(&count);
+      const auto* listBytes = reinterpret_cast<const uint8_t*>(dynamicList->getElementListPointer(i));
+      buffer.insert(buffer.end(), countBytes, countBytes + sizeof(count));
+      buffer.insert(buffer.end(), listBytes, listBytes + count * sizeof(int32_t));
+    }
+    auto* loaded = dataStr.createDynamicList<int32_t, int32_t>("Loaded");
+    loaded->deserializeLinks(buffer, dynamicList->size());
+    REQUIRE(loaded->getNumberOfElements(2) == 3);
+    REQUIRE(loaded->getElementListPointer(2)[1] == 21);
+    REQUIRE(loaded->getElementListPointer(0)[0] == 10);
+
+    // Truncated buffers and negative lengths are rejected without touching the lists
+    std::vector<uint8_t> truncated(buffer.begin(), buffer.end() - 1);
+    REQUIRE_THROWS(loaded->deserializeLinks(truncated, dynamicList->size()));
+    REQUIRE_THROWS(loaded->deserializeLinks(buffer, dynamicList->size() + 1));
+    const int32_t negativeCount = -1;
+    std::vector<uint8_t> negative(sizeof(negativeCount));
+    std::memcpy(negative.data(), &negativeCount, sizeof(negativeCount));
+    REQUIRE_THROWS(loaded->deserializeLinks(negative, 1));
+    REQUIRE(loaded->size() == 3);
+    REQUIRE(loaded->getElementListPointer(2)[2] == 22);
+  }
 }
 
 TEST_CASE("DataArrayTest")
@@ -308,6 +1600,23 @@ TEST_CASE("DataArrayTest")
         REQUIRE(value == x++);
       }
     }
+    SECTION("test contiguous access")
+    {
+      REQUIRE(dataArr->isContiguous());
+      REQUIRE(dataArr->data() == store->data());
+      int32_t* data = dataArr->data();
+      for(size_t i = 0; i < dataArr->getSize(); i++)
+      {
+        data[i] = static_cast<int32_t>(i) + 10;
+      }
+      const auto& constArr = *dataArr;
+      auto span = constArr.span();
+      REQUIRE(span.size() == dataArr->getSize());
+      for(size_t i = 0; i < span.size(); i++)
+      {
+        REQUIRE(span[i] == constArr[i]);
+      }
+    }
   }
 }
 
@@ -331,3 +1640,190 @@ TEST_CASE("ScalarDataTest")
   (*scalar) = newValue2;
   REQUIRE(scalar->getValue() == newValue2);
 }
+
+TEST_CASE("DataStructureSnapshotTest")
+{
+  const auto path = std::filesystem::temp_directory_path() / "complex_DataStructureSnapshotTest.snap";
+  SECTION("round trip")
+  {
+    {
+      DataStructure dataStr;
+      auto root = dataStr.createGroup("Root");
+      auto other = dataStr.createGroup("Other");
+      auto child = dataStr.createGroup("Child", root->getId());
+      REQUIRE(dataStr.setAdditionalParent(child->getId(), other->getId()));
+
+      auto values = dataStr.createDataArray<float>("Values", new DataStore<float>(3, 1000), child->getId());
+      for(size_t i = 0; i < values->getSize(); i++)
+      {
+        (*values)[i] = static_cast<float>(i) * 0.5f;
+      }
+      values->getMetadata()->setData("Units", std::string("mm"));
+      values->getMetadata()->setData("Scale", 2.5);
+      auto planar = dataStr.createDataArray<int32_t>("Planar", new PlanarDataStore<int32_t>(2, 5), root->getId());
+      for(size_t i = 0; i < planar->getSize(); i++)
+      {
+        (*planar)[i] = static_cast<int32_t>(i) * 3;
+      }
+      dataStr.createScalar<uint64_t>("Count", 42, root->getId());
+      auto links = dataStr.createDynamicList<uint16_t, uint64_t>("Links", root->getId());
+      links->allocateLists(std::vector<uint16_t>{2, 0, 1});
+      links->insertCellReference(0, 0, 7);
+      links->insertCellReference(0, 1, 8);
+      links->insertCellReference(2, 0, 9);
+
+      DataStructureSnapshot::Write(dataStr, path);
+    }
+
+    DataStructure loaded = DataStructureSnapshot::Read(path);
+    REQUIRE(loaded.size() == 7);
+    const DataObject* child = loaded.getData(DataPath({"Root", "Child"}));
+    REQUIRE(child != nullptr);
+    REQUIRE(child->getParents().size() == 2);
+    REQUIRE(loaded.getData(DataPath({"Other", "Child", "Values"})) != nullptr);
+
+    // Array values are mapped from the snapshot rather than read
+    auto values = dynamic_cast<DataArray<float>*>(loaded.getData(DataPath({"Root", "Child", "Values"})));
+    REQUIRE(values != nullptr);
+    REQUIRE(values->getTupleSize() == 3);
+    REQUIRE(values->getTupleCount() == 1000);
+    auto store = dynamic_cast<FileDataStore<float>*>(values->getDataStore());
+    REQUIRE(store != nullptr);
+    REQUIRE(store->isView());
+    REQUIRE((*values)[2999] == 1499.5f);
+    REQUIRE(std::any_cast<std::string>(values->getMetadata()->getData("Units")) == "mm");
+    REQUIRE(std::any_cast<double>(values->getMetadata()->getData("Scale")) == 2.5);
+
+    auto planar = dynamic_cast<DataArray<int32_t>*>(loaded.getData(DataPath({"Root", "Planar"})));
+    REQUIRE(planar != nullptr);
+    REQUIRE(planar->getTupleSize() == 2);
+    REQUIRE((*planar)[9] == 27);
+    auto count = dynamic_cast<ScalarData<uint64_t>*>(loaded.getData(DataPath({"Root", "Count"})));
+    REQUIRE(count != nullptr);
+    REQUIRE(count->getValue() == 42);
+    auto links = dynamic_cast<DynamicListArray<uint16_t, uint64_t>*>(loaded.getData(DataPath({"Root", "Links"})));
+    REQUIRE(links != nullptr);
+    REQUIRE(links->size() == 3);
+    REQUIRE(links->getNumberOfElements(0) == 2);
+    REQUIRE(links->getNumberOfElements(1) == 0);
+    REQUIRE(links->getElementListPointer(0)[1] == 8);
+    REQUIRE(links->getElementListPointer(2)[0] == 9);
+
+    // Changes stay in memory and never reach the snapshot
+    (*values)[0] = -1.0f;
+    {
+      DataStructure reloaded = DataStructureSnapshot::Read(path);
+      auto reloadedValues = dynamic_cast<DataArray<float>*>(reloaded.getData(DataPath({"Root", "Child", "Values"})));
+      REQUIRE((*reloadedValues)[0] == 0.0f);
+    }
+    store->resizeTuples(1001);
+    REQUIRE(!store->isView());
+    REQUIRE(store->getValue(0) == -1.0f);
+    REQUIRE(store->getValue(2999) == 1499.5f);
+  }
+  SECTION("dynamic list types")
+  {
+    {
+      DataStructure dataStr;
+      auto int32Links = dataStr.createDynamicList<int32_t, int32_t>("Int32Links");
+      int32Links->allocateLists(std::vector<int32_t>{1, 3});
+      int32Links->insertCellReference(0, 0, -5);
+      int32Links->insertCellReference(1, 2, 70000);
+      auto int64Links = dataStr.createDynamicList<uint16_t, int64_t>("Int64Links");
+      int64Links->allocateLists(std::vector<uint16_t>{0, 2});
+      int64Links->insertCellReference(1, 1, -(int64_t(1) << 40));
+      DataStructureSnapshot::Write(dataStr, path);
+    }
+
+    DataStructure loaded = DataStructureSnapshot::Read(path);
+    REQUIRE(loaded.size() == 2);
+    auto int32Links = dynamic_cast<Int32Int32DynamicListArray*>(loaded.getData(DataPath({"Int32Links"})));
+    REQUIRE(int32Links != nullptr);
+    REQUIRE(int32Links->size() == 2);
+    REQUIRE(int32Links->getNumberOfElements(1) == 3);
+    REQUIRE(int32Links->getElementListPointer(0)[0] == -5);
+    REQUIRE(int32Links->getElementListPointer(1)[2] == 70000);
+    auto int64Links = dynamic_cast<UInt16Int64DynamicListArray*>(loaded.getData(DataPath({"Int64Links"})));
+    REQUIRE(int64Links != nullptr);
+    REQUIRE(int64Links->getNumberOfElements(0) == 0);
+    REQUIRE(int64Links->getElementListPointer(1)[1] == -(int64_t(1) << 40));
+
+    // Lists of other types cannot be stored
+    DataStructure unsupported;
+    unsupported.createDynamicList<uint8_t, uint8_t>("Links");
+    REQUIRE_THROWS_AS(DataStructureSnapshot::Write(unsupported, path), std::runtime_error);
+  }
+  SECTION("saving over the loaded file")
+  {
+    const size_t numValues = 100000;
+    {
+      DataStructure dataStr;
+      auto values = dataStr.createDataArray<float>("Values", new DataStore<float>(1, numValues));
+      std::iota(values->begin(), values->end(), 0.0f);
+      DataStructureSnapshot::Write(dataStr, path);
+    }
+
+    // The loaded values map the file that is replaced
+    DataStructure loaded = DataStructureSnapshot::Read(path);
+    auto values = dynamic_cast<DataArray<float>*>(loaded.getData(DataPath({"Values"})));
+    REQUIRE(values != nullptr);
+    (*values)[0] = -1.0f;
+    DataStructureSnapshot::Write(loaded, path);
+    REQUIRE((*values)[0] == -1.0f);
+    REQUIRE((*values)[numValues - 1] == static_cast<float>(numValues - 1));
+
+    DataStructure reloaded = DataStructureSnapshot::Read(path);
+    auto reloadedValues = dynamic_cast<DataArray<float>*>(reloaded.getData(DataPath({"Values"})));
+    REQUIRE(reloadedValues != nullptr);
+    REQUIRE((*reloadedValues)[0] == -1.0f);
+    REQUIRE((*reloadedValues)[numValues - 1] == static_cast<float>(numValues - 1));
+
+    // No temporary file is left behind
+    for(const auto& entry : std::filesystem::directory_iterator(path.parent_path()))
+    {
+      const std::string name = entry.path().filename().string();
+      REQUIRE_FALSE((name.rfind(path.filename().string() + ".", 0) == 0 && entry.path().extension() == ".tmp"));
+    }
+  }
+  SECTION("invalid files")
+  {
+    REQUIRE_THROWS_AS(DataStructureSnapshot::Read(path), std::runtime_error);
+    {
+      std::ofstream file(path, std::ios::binary);
+      file << "This is not a snapshot of a DataStructure, only some text that is long enough to hold a header.";
+    }
+    REQUIRE_THROWS_AS(DataStructureSnapshot::Read(path), std::runtime_error);
+
+    DataStructure dataStr;
+    dataStr.createDataArray<double>("Values", new DataStore<double>(1, 10000));
+    DataStructureSnapshot::Write(dataStr, path);
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) / 2);
+    REQUIRE_THROWS_AS(DataStructureSnapshot::Read(path), std::runtime_error);
+  }
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("DataPathLookupBenchmark", "[.benchmark]")
+{
+  using Clock = std::chrono::steady_clock;
+  const size_t groupCount = 20000;
+
+  DataStructure dataStr;
+  std::vector<DataPath> paths;
+  for(size_t i = 0; i < groupCount; i++)
+  {
+    auto group = dataStr.createGroup("Group " + std::to_string(i));
+    dataStr.createGroup("Child", group->getId());
+    paths.push_back(DataPath({"Group " + std::to_string(i), "Child"}));
+  }
+
+  const auto start = Clock::now();
+  size_t found = 0;
+  for(const DataPath& path : paths)
+  {
+    found += (dataStr.getData(path) != nullptr) ? 1 : 0;
+  }
+  const std::chrono::duration<double> lookupTime = Clock::now() - start;
+  WARN(groupCount << " path lookups among " << dataStr.size() << " objects: " << lookupTime.count() * 1.0e9 / static_cast<double>(groupCount) << " ns per lookup");
+  REQUIRE(found == groupCount);
+}
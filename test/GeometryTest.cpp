@@ -1,14 +1,32 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <random>
+#include <set>
+#include <thread>
+
 #include <catch2/catch.hpp>
 
+#include "complex/DataStructure/ComponentDataStore.hpp"
+#include "complex/DataStructure/DataGroup.hpp"
 #include "complex/DataStructure/DataStructure.hpp"
+#include "complex/DataStructure/Geometry/BoundingVolumeHierarchy.hpp"
 #include "complex/DataStructure/Geometry/EdgeGeom.hpp"
+#include "complex/DataStructure/Geometry/HalfEdgeTopology.hpp"
 #include "complex/DataStructure/Geometry/HexahedralGeom.hpp"
 #include "complex/DataStructure/Geometry/ImageGeom.hpp"
 #include "complex/DataStructure/Geometry/QuadGeom.hpp"
 #include "complex/DataStructure/Geometry/RectGridGeom.hpp"
+#include "complex/DataStructure/Geometry/SpatialIndex.hpp"
 #include "complex/DataStructure/Geometry/TetrahedralGeom.hpp"
 #include "complex/DataStructure/Geometry/TriangleGeom.hpp"
 #include "complex/DataStructure/Geometry/VertexGeom.hpp"
+#include "complex/DataStructure/PlanarDataStore.hpp"
+#include "complex/DataStructure/Snapshot/DataStructureSnapshot.hpp"
+#include "complex/Utilities/GeometryHelpers.hpp"
+#include "complex/Utilities/Math/GeometryMath.hpp"
 
 using namespace complex;
 
@@ -306,3 +324,1289 @@ TEST_CASE("VertexGeomTest")
     REQUIRE(geom->getGeometryTypeAsString() == "VertexGeom");
   }
 }
+
+TEST_CASE("DerivedCacheTest")
+{
+  DataStructure ds;
+  SECTION("triangle geometry")
+  {
+    // Two triangles sharing the edge (1, 2)
+    auto geom = createGeom<TriangleGeom>(ds);
+    auto vertices = ds.createDataArray<float>("Vertices", new DataStore<float>(3, 4), geom->getId());
+    auto triangles = ds.createDataArray<uint64_t>("Triangles", new DataStore<uint64_t>(3, 2), geom->getId());
+    const std::vector<float> coords = {0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f};
+    const std::vector<uint64_t> triangleVerts = {0, 1, 2, 2, 1, 3};
+    std::copy(coords.begin(), coords.end(), vertices->begin());
+    std::copy(triangleVerts.begin(), triangleVerts.end(), triangles->begin());
+    geom->setVertices(vertices);
+    geom->setTriangles(triangles);
+    const TriangleGeom* constGeom = geom;
+
+    // Derived objects are computed on first use and then reused
+    const FloatArray* centroids = constGeom->getElementCentroids();
+    REQUIRE(centroids != nullptr);
+    REQUIRE(centroids->at(0) == Approx(1.0f / 3.0f));
+    const auto centroidsId = centroids->getId();
+    REQUIRE(constGeom->getElementCentroids()->getId() == centroidsId);
+    const AbstractGeometry::ElementDynamicList* neighbors = constGeom->getElementNeighbors();
+    REQUIRE(neighbors != nullptr);
+    REQUIRE(neighbors->getNumberOfElements(0) == 1);
+    const auto neighborsId = neighbors->getId();
+    const auto containingVertId = constGeom->getElementsContainingVert()->getId();
+    auto xView = ds.createDataArray<float>("X", new ComponentDataStore<float>(vertices->getDataStorePtr().lock(), 0));
+    const size_t objectCount = ds.size();
+
+    // Moving a vertex invalidates the centroids but not the connectivity
+    (*vertices)[0] = 3.0f;
+    centroids = constGeom->getElementCentroids();
+    REQUIRE(centroids->getId() != centroidsId);
+    REQUIRE(centroids->at(0) == Approx(4.0f / 3.0f));
+    REQUIRE(constGeom->getElementNeighbors()->getId() == neighborsId);
+    REQUIRE(constGeom->getElementsContainingVert()->getId() == containingVertId);
+    REQUIRE(ds.size() == objectCount);
+
+    // Moving a vertex through a component view of the vertices does as well
+    const auto movedCentroidsId = centroids->getId();
+    (*xView)[0] = 6.0f;
+    centroids = constGeom->getElementCentroids();
+    REQUIRE(centroids->getId() != movedCentroidsId);
+    REQUIRE(centroids->at(0) == Approx(7.0f / 3.0f));
+    REQUIRE(constGeom->getElementNeighbors()->getId() == neighborsId);
+
+    // Changing the triangles invalidates the connectivity
+    (*triangles)[3] = 0;
+    (*triangles)[4] = 3;
+    (*triangles)[5] = 1;
+    REQUIRE(constGeom->getElementNeighbors()->getId() != neighborsId);
+    const AbstractGeometry::ElementDynamicList* containingVert = constGeom->getElementsContainingVert();
+    REQUIRE(containingVert->getId() != containingVertId);
+    REQUIRE(containingVert->getNumberOfElements(0) == 2);
+    REQUIRE(containingVert->getNumberOfElements(2) == 1);
+    REQUIRE(constGeom->getElementCentroids()->getId() != centroids->getId());
+    REQUIRE(ds.size() == objectCount);
+
+    geom->deleteElementCentroids();
+    REQUIRE(ds.size() == objectCount - 1);
+    REQUIRE(constGeom->getElementCentroids() != nullptr);
+  }
+  SECTION("image geometry")
+  {
+    auto geom = createGeom<ImageGeom>(ds);
+    geom->setDimensions({2, 2, 2});
+    geom->setSpacing(1.0f, 2.0f, 3.0f);
+    REQUIRE(geom->getElementSizes()->at(0) == Approx(6.0f));
+    geom->setSpacing(1.0f, 1.0f, 1.0f);
+    REQUIRE(geom->getElementSizes()->at(0) == Approx(1.0f));
+  }
+  SECTION("concurrent callers")
+  {
+    auto geom = createGeom<TriangleGeom>(ds);
+    auto vertices = ds.createDataArray<float>("Vertices", new DataStore<float>(3, 4), geom->getId());
+    auto triangles = ds.createDataArray<uint64_t>("Triangles", new DataStore<uint64_t>(3, 2), geom->getId());
+    const std::vector<uint64_t> triangleVerts = {0, 1, 2, 2, 1, 3};
+    std::copy(triangleVerts.begin(), triangleVerts.end(), triangles->begin());
+    geom->setVertices(vertices);
+    geom->setTriangles(triangles);
+    const TriangleGeom* constGeom = geom;
+    REQUIRE(constGeom->getElementNeighbors() != nullptr);
+    const size_t objectCount = ds.size();
+
+    const size_t numRounds = 16;
+    for(size_t round = 0; round < numRounds; round++)
+    {
+      // Each round changes the triangles so both threads find stale neighbors
+      std::swap((*triangles)[3], (*triangles)[4]);
+      std::array<const AbstractGeometry::ElementDynamicList*, 2> results = {nullptr, nullptr};
+      std::vector<std::thread> threads;
+      for(size_t t = 0; t < results.size(); t++)
+      {
+        threads.emplace_back([constGeom, &results, t]() { results[t] = constGeom->getElementNeighbors(); });
+      }
+      for(auto& thread : threads)
+      {
+        thread.join();
+      }
+      REQUIRE(results[0] != nullptr);
+      REQUIRE(results[0] == results[1]);
+      REQUIRE(results[0]->getNumberOfElements(0) == 1);
+      REQUIRE(ds.size() == objectCount);
+    }
+  }
+}
+
+TEST_CASE("FindElementsContainingVertTest")
+{
+  DataStructure ds;
+  auto group = ds.createGroup("Mesh");
+
+  // A strip of triangles where triangle i uses vertices i, i + 1 and i + 2
+  const size_t numTris = 100000;
+  const size_t numVerts = numTris + 2;
+  auto triangles = ds.createDataArray<uint64_t>("Triangles", new DataStore<uint64_t>(3, numTris), group->getId());
+  for(size_t i = 0; i < numTris; i++)
+  {
+    (*triangles)[i * 3] = i + 2;
+    (*triangles)[i * 3 + 1] = i;
+    (*triangles)[i * 3 + 2] = i + 1;
+  }
+  const size_t objectCount = ds.size();
+
+  auto containsVert = ds.createDynamicList<uint16_t, uint64_t>("Triangles Containing Vert", group->getId());
+  REQUIRE(GeometryHelpers::Connectivity::FindElementsContainingVert<uint16_t, uint64_t>(triangles, containsVert, numVerts) == 0);
+
+  // No scratch arrays are left in the structure
+  REQUIRE(ds.size() == objectCount + 1);
+  REQUIRE(containsVert->size() == numVerts);
+  REQUIRE(containsVert->getTotalNumberOfElements() == numTris * 3);
+  REQUIRE(containsVert->getNumberOfElements(0) == 1);
+  REQUIRE(containsVert->getNumberOfElements(1) == 2);
+  REQUIRE(containsVert->getNumberOfElements(numVerts - 1) == 1);
+  for(size_t vert = 2; vert < numTris; vert++)
+  {
+    REQUIRE(containsVert->getNumberOfElements(vert) == 3);
+    const uint64_t* list = containsVert->getElementListPointer(vert);
+    REQUIRE(list[0] == vert - 2);
+    REQUIRE(list[1] == vert - 1);
+    REQUIRE(list[2] == vert);
+  }
+
+  // Vertex ids outside of the vertex range are rejected
+  auto invalidVert = ds.createDynamicList<uint16_t, uint64_t>("Invalid Vert", group->getId());
+  REQUIRE(GeometryHelpers::Connectivity::FindElementsContainingVert<uint16_t, uint64_t>(triangles, invalidVert, numVerts - 1) < 0);
+  auto signedTriangles = ds.createDataArray<int64_t>("Signed Triangles", new DataStore<int64_t>(3, 2), group->getId());
+  const std::vector<int64_t> signedVerts = {0, 1, 2, 2, -1, 3};
+  std::copy(signedVerts.begin(), signedVerts.end(), signedTriangles->begin());
+  auto signedContainsVert = ds.createDynamicList<uint16_t, int64_t>("Signed Containing Vert", group->getId());
+  REQUIRE(GeometryHelpers::Connectivity::FindElementsContainingVert<uint16_t, int64_t>(signedTriangles, signedContainsVert, 4) < 0);
+
+  // A vertex used by more elements than uint16_t can count is rejected
+  const size_t numEdges = 70000;
+  auto edges = ds.createDataArray<uint64_t>("Edges", new DataStore<uint64_t>(2, numEdges), group->getId());
+  for(size_t i = 0; i < numEdges; i++)
+  {
+    (*edges)[i * 2] = 0;
+    (*edges)[i * 2 + 1] = i + 1;
+  }
+  auto edgesContainingVert = ds.createDynamicList<uint16_t, uint64_t>("Edges Containing Vert", group->getId());
+  REQUIRE(GeometryHelpers::Connectivity::FindElementsContainingVert<uint16_t, uint64_t>(edges, edgesContainingVert, numEdges + 1) < 0);
+  auto wideEdgesContainingVert = ds.createDynamicList<uint32_t, uint64_t>("Wide Edges Containing Vert", group->getId());
+  REQUIRE(GeometryHelpers::Connectivity::FindElementsContainingVert<uint32_t, uint64_t>(edges, wideEdgesContainingVert, numEdges + 1) == 0);
+  REQUIRE(wideEdgesContainingVert->getNumberOfElements(0) == numEdges);
+
+  // Geometries report the failure and keep no partial list
+  auto geom = createGeom<TriangleGeom>(ds);
+  auto geomVertices = ds.createDataArray<float>("Vertices", new DataStore<float>(3, 3), geom->getId());
+  auto geomTriangles = ds.createDataArray<uint64_t>("Triangles", new DataStore<uint64_t>(3, 1), geom->getId());
+  const std::vector<uint64_t> geomVerts = {0, 1, 5};
+  std::copy(geomVerts.begin(), geomVerts.end(), geomTriangles->begin());
+  geom->setVertices(geomVertices);
+  geom->setTriangles(geomTriangles);
+  const size_t geomObjectCount = ds.size();
+  REQUIRE(geom->findElementsContainingVert() < 0);
+  REQUIRE(geom->findElementNeighbors() < 0);
+  const TriangleGeom* constGeom = geom;
+  REQUIRE(constGeom->getElementsContainingVert() == nullptr);
+  REQUIRE(ds.size() == geomObjectCount);
+}
+
+TEST_CASE("FindElementNeighborsTest")
+{
+  DataStructure ds;
+  auto group = ds.createGroup("Mesh");
+
+  SECTION("triangles")
+  {
+    // A strip of triangles where triangle i shares an edge with triangles i - 1 and i + 1
+    const size_t numTris = 50000;
+    auto triangles = ds.createDataArray<uint64_t>("Triangles", new DataStore<uint64_t>(3, numTris + 1), group->getId());
+    for(size_t i = 0; i < numTris; i++)
+    {
+      (*triangles)[i * 3] = i + 2;
+      (*triangles)[i * 3 + 1] = i;
+      (*triangles)[i * 3 + 2] = i + 1;
+    }
+    // Duplicate the first triangle with a different winding
+    (*triangles)[numTris * 3] = 1;
+    (*triangles)[numTris * 3 + 1] = 0;
+    (*triangles)[numTris * 3 + 2] = 2;
+
+    auto containsVert = ds.createDynamicList<uint16_t, uint64_t>("Triangles Containing Vert", group->getId());
+    GeometryHelpers::Connectivity::FindElementsContainingVert<uint16_t, uint64_t>(triangles, containsVert, numTris + 2);
+    auto neighbors = ds.createDynamicList<uint16_t, uint64_t>("Triangle Neighbors", group->getId());
+    REQUIRE(GeometryHelpers::Connectivity::FindElementNeighbors<uint16_t, uint64_t>(triangles, containsVert, neighbors, AbstractGeometry::Type::Triangle) == 0);
+
+    REQUIRE(neighbors->size() == numTris + 1);
+    // The duplicate shares all three edges with the first triangle but is listed once
+    REQUIRE(neighbors->getNumberOfElements(numTris) == 2);
+    REQUIRE(neighbors->getElementListPointer(numTris)[0] == 0);
+    REQUIRE(neighbors->getElementListPointer(numTris)[1] == 1);
+    REQUIRE(neighbors->getNumberOfElements(0) == 2);
+    REQUIRE(neighbors->getElementListPointer(0)[1] == numTris);
+    for(size_t i = 2; i < numTris - 1; i++)
+    {
+      REQUIRE(neighbors->getNumberOfElements(i) == 2);
+      REQUIRE(neighbors->getElementListPointer(i)[0] == i - 1);
+      REQUIRE(neighbors->getElementListPointer(i)[1] == i + 1);
+    }
+    REQUIRE(neighbors->getNumberOfElements(numTris - 1) == 1);
+
+    REQUIRE(GeometryHelpers::Connectivity::FindElementNeighbors<uint16_t, uint64_t>(triangles, containsVert, neighbors, AbstractGeometry::Type::Image) == -1);
+    REQUIRE(GeometryHelpers::Connectivity::FindElementNeighbors<uint16_t, uint64_t>(triangles, containsVert, neighbors, AbstractGeometry::Type::Quad) == -1);
+
+    // A vertex id past the end of the per-vertex lists is rejected instead of indexing out of range
+    auto shortContainsVert = ds.createDynamicList<uint16_t, uint64_t>("Short Triangles Containing Vert", group->getId());
+    const std::vector<uint16_t> fewerCounts(numTris + 1, 0);
+    shortContainsVert->allocateLists(fewerCounts);
+    REQUIRE(GeometryHelpers::Connectivity::FindElementNeighbors<uint16_t, uint64_t>(triangles, shortContainsVert, neighbors, AbstractGeometry::Type::Triangle) == -1);
+  }
+  SECTION("hexahedra")
+  {
+    // Three hexahedra stacked along z share their top and bottom faces
+    auto hexas = ds.createDataArray<uint64_t>("Hexahedra", new DataStore<uint64_t>(8, 3), group->getId());
+    for(size_t h = 0; h < 3; h++)
+    {
+      for(size_t v = 0; v < 8; v++)
+      {
+        (*hexas)[h * 8 + v] = h * 4 + v;
+      }
+    }
+    auto containsVert = ds.createDynamicList<uint16_t, uint64_t>("Hexahedra Containing Vert", group->getId());
+    GeometryHelpers::Connectivity::FindElementsContainingVert<uint16_t, uint64_t>(hexas, containsVert, 16);
+    auto neighbors = ds.createDynamicList<uint16_t, uint64_t>("Hexahedral Neighbors", group->getId());
+    REQUIRE(GeometryHelpers::Connectivity::FindElementNeighbors<uint16_t, uint64_t>(hexas, containsVert, neighbors, AbstractGeometry::Type::Hexahedral) == 0);
+
+    REQUIRE(neighbors->getNumberOfElements(0) == 1);
+    REQUIRE(neighbors->getElementListPointer(0)[0] == 1);
+    REQUIRE(neighbors->getNumberOfElements(1) == 2);
+    REQUIRE(neighbors->getElementListPointer(1)[0] == 0);
+    REQUIRE(neighbors->getElementListPointer(1)[1] == 2);
+    REQUIRE(neighbors->getNumberOfElements(2) == 1);
+  }
+}
+
+TEST_CASE("FindUniqueFacetsTest")
+{
+  DataStructure ds;
+  auto group = ds.createGroup("Mesh");
+
+  SECTION("two tetrahedra")
+  {
+    // The tetrahedra share the face (1, 2, 3)
+    auto tets = ds.createDataArray<uint64_t>("Tetrahedra", new DataStore<uint64_t>(4, 2), group->getId());
+    const std::vector<uint64_t> tetVerts = {0, 1, 2, 3, 3, 2, 1, 4};
+    std::copy(tetVerts.begin(), tetVerts.end(), tets->begin());
+
+    auto edges = ds.createDataArray<uint64_t>("Edges", new DataStore<uint64_t>(2, 0), group->getId());
+    GeometryHelpers::Connectivity::FindTetEdges(tets, edges);
+    REQUIRE(edges->getTupleCount() == 9);
+    REQUIRE((*edges)[0] == 0);
+    REQUIRE((*edges)[1] == 1);
+    GeometryHelpers::Connectivity::FindUnsharedTetEdges(tets, edges);
+    REQUIRE(edges->getTupleCount() == 6);
+
+    auto faces = ds.createDataArray<uint64_t>("Faces", new DataStore<uint64_t>(3, 0), group->getId());
+    std::vector<uint32_t> occurrenceCounts;
+    GeometryHelpers::Connectivity::FindUniqueFacets(tets, *GeometryHelpers::Connectivity::GetElementFacets(AbstractGeometry::Type::Tetrahedral), faces,
+                                                    GeometryHelpers::Connectivity::FacetSelection::All, &occurrenceCounts);
+    REQUIRE(faces->getTupleCount() == 7);
+    REQUIRE(occurrenceCounts.size() == 7);
+    // Faces are sorted, so (1, 2, 3) follows the three faces using vertex 0
+    REQUIRE((*faces)[9] == 1);
+    REQUIRE((*faces)[10] == 2);
+    REQUIRE((*faces)[11] == 3);
+    REQUIRE(occurrenceCounts[3] == 2);
+    REQUIRE(GeometryHelpers::Connectivity::FindUnsharedTetFaces(tets, faces) == 0);
+    REQUIRE(faces->getTupleCount() == 6);
+
+    // Mismatched element lists and negative vertex ids are reported without touching the output
+    REQUIRE(GeometryHelpers::Connectivity::FindHexFaces(tets, faces) == -1);
+    auto signedTets = ds.createDataArray<int64_t>("Signed Tetrahedra", new DataStore<int64_t>(4, 2), group->getId());
+    const std::vector<int64_t> signedTetVerts = {0, 1, 2, 3, 3, 2, 1, -4};
+    std::copy(signedTetVerts.begin(), signedTetVerts.end(), signedTets->begin());
+    auto signedEdges = ds.createDataArray<int64_t>("Signed Edges", new DataStore<int64_t>(2, 1), group->getId());
+    REQUIRE(GeometryHelpers::Connectivity::FindTetEdges(signedTets, signedEdges) == -1);
+    REQUIRE(signedEdges->getTupleCount() == 1);
+    REQUIRE(faces->getTupleCount() == 6);
+  }
+  SECTION("random tetrahedra")
+  {
+    const size_t numTets = 20000;
+    std::mt19937_64 generator(42);
+    std::uniform_int_distribution<uint64_t> distribution(0, 2000);
+    auto tets = ds.createDataArray<uint64_t>("Tetrahedra", new DataStore<uint64_t>(4, numTets), group->getId());
+    for(auto& vert : *tets)
+    {
+      vert = distribution(generator);
+    }
+
+    std::map<std::array<uint64_t, 3>, size_t> referenceFaces;
+    for(size_t t = 0; t < numTets; t++)
+    {
+      const size_t offset = t * 4;
+      const std::array<std::array<size_t, 3>, 4> localFaces = {{{0, 1, 2}, {1, 2, 3}, {0, 2, 3}, {0, 1, 3}}};
+      for(const auto& localFace : localFaces)
+      {
+        std::array<uint64_t, 3> face = {(*tets)[offset + localFace[0]], (*tets)[offset + localFace[1]], (*tets)[offset + localFace[2]]};
+        std::sort(face.begin(), face.end());
+        referenceFaces[face]++;
+      }
+    }
+
+    auto faces = ds.createDataArray<uint64_t>("Faces", new DataStore<uint64_t>(3, 0), group->getId());
+    GeometryHelpers::Connectivity::FindUnsharedTetFaces(tets, faces);
+    size_t index = 0;
+    for(const auto& [face, count] : referenceFaces)
+    {
+      if(count == 1)
+      {
+        REQUIRE(index < faces->getTupleCount());
+        REQUIRE((*faces)[index * 3] == face[0]);
+        REQUIRE((*faces)[index * 3 + 1] == face[1]);
+        REQUIRE((*faces)[index * 3 + 2] == face[2]);
+        index++;
+      }
+    }
+    REQUIRE(index == faces->getTupleCount());
+  }
+  SECTION("triangles")
+  {
+    auto triangles = ds.createDataArray<uint64_t>("Triangles", new DataStore<uint64_t>(3, 2), group->getId());
+    const std::vector<uint64_t> triVerts = {0, 1, 2, 2, 1, 3};
+    std::copy(triVerts.begin(), triVerts.end(), triangles->begin());
+
+    auto edges = ds.createDataArray<uint64_t>("Edges", new DataStore<uint64_t>(2, 0), group->getId());
+    GeometryHelpers::Connectivity::Find2DElementEdges(triangles, edges);
+    REQUIRE(edges->getTupleCount() == 5);
+    GeometryHelpers::Connectivity::Find2DUnsharedEdges(triangles, edges);
+    REQUIRE(edges->getTupleCount() == 4);
+    REQUIRE(std::find(edges->begin(), edges->end(), 3) != edges->end());
+  }
+}
+
+TEST_CASE("HalfEdgeTopologyTest")
+{
+  DataStructure ds;
+  auto group = ds.createGroup("Mesh");
+  auto topology = ds.createHalfEdgeTopology("Topology", group->getId());
+  REQUIRE(topology != nullptr);
+  REQUIRE(topology->getNumberOfEdges() == 0);
+
+  SECTION("two triangles")
+  {
+    // The triangles share the edge (1, 2)
+    auto triangles = ds.createDataArray<uint64_t>("Triangles", new DataStore<uint64_t>(3, 2), group->getId());
+    const std::vector<uint64_t> triangleVerts = {0, 1, 2, 2, 1, 3};
+    std::copy(triangleVerts.begin(), triangleVerts.end(), triangles->begin());
+    topology->build(*triangles, 4);
+
+    REQUIRE(topology->getNumberOfHalfEdges() == 6);
+    REQUIRE(topology->getNumberOfEdges() == 5);
+    REQUIRE(topology->getNumberOfBoundaryEdges() == 4);
+    REQUIRE(topology->getOrigin(1) == 1);
+    REQUIRE(topology->getDestination(1) == 2);
+    REQUIRE(topology->getNext(2) == 0);
+    REQUIRE(topology->getPrevious(3) == 5);
+    REQUIRE(topology->getTwin(1) == 3);
+    REQUIRE(topology->getTwin(3) == 1);
+    REQUIRE(topology->getTwin(0) == HalfEdgeTopology::k_InvalidIndex);
+    REQUIRE(topology->getEdge(1) == topology->getEdge(3));
+    REQUIRE(topology->getEdgeVertices(topology->getEdge(3)) == std::array<uint64_t, 2>{1, 2});
+    REQUIRE(topology->getEdgeFaceCount(topology->getEdge(1)) == 2);
+    REQUIRE(topology->getFaceNeighbor(0, 1) == 1);
+    REQUIRE(topology->getFaceNeighbor(1, 0) == 0);
+    REQUIRE(topology->getFaceNeighbor(0, 0) == HalfEdgeTopology::k_InvalidIndex);
+    REQUIRE(topology->getOutgoingHalfEdges(1).size() == 2);
+
+    std::vector<uint64_t> ring;
+    topology->getVertexRing(1, ring);
+    REQUIRE(ring == std::vector<uint64_t>{0, 2, 3});
+    topology->getVertexRing(3, ring);
+    REQUIRE(ring == std::vector<uint64_t>{1, 2});
+    REQUIRE(topology->isManifold());
+
+    auto edges = ds.createDataArray<uint64_t>("Edges", new DataStore<uint64_t>(2, 0), group->getId());
+    topology->copyEdges(*edges, true);
+    REQUIRE(edges->getTupleCount() == 4);
+    REQUIRE((*edges)[0] == 0);
+    REQUIRE((*edges)[1] == 1);
+    REQUIRE((*edges)[6] == 2);
+    REQUIRE((*edges)[7] == 3);
+  }
+  SECTION("non-manifold meshes")
+  {
+    // Three triangles share the edge (0, 1)
+    auto triangles = ds.createDataArray<uint64_t>("Triangles", new DataStore<uint64_t>(3, 3), group->getId());
+    const std::vector<uint64_t> fanVerts = {0, 1, 2, 1, 0, 3, 0, 1, 4};
+    std::copy(fanVerts.begin(), fanVerts.end(), triangles->begin());
+    topology->build(*triangles, 5);
+    REQUIRE(topology->getEdgeFaceCount(topology->getEdge(0)) == 3);
+    REQUIRE_FALSE(topology->isManifoldEdge(topology->getEdge(0)));
+    REQUIRE(topology->getTwin(0) == HalfEdgeTopology::k_InvalidIndex);
+    REQUIRE_FALSE(topology->isManifoldVertex(0));
+    REQUIRE(topology->isManifoldVertex(2));
+    REQUIRE_FALSE(topology->isManifold());
+
+    // Two triangles only touch at vertex 0
+    const std::vector<uint64_t> bowtieVerts = {0, 1, 2, 0, 3, 4};
+    triangles->getDataStore()->resizeTuples(2);
+    std::copy(bowtieVerts.begin(), bowtieVerts.end(), triangles->begin());
+    topology->build(*triangles, 5);
+    REQUIRE(topology->getNumberOfBoundaryEdges() == 6);
+    REQUIRE_FALSE(topology->isManifoldVertex(0));
+    REQUIRE(topology->isManifoldVertex(1));
+    REQUIRE_FALSE(topology->isManifold());
+
+    REQUIRE_THROWS(topology->build(*triangles, 4));
+  }
+  SECTION("quad geometry")
+  {
+    // Two quads side by side on a 3 x 2 grid of vertices
+    auto geom = createGeom<QuadGeom>(ds);
+    auto vertices = ds.createDataArray<float>("Vertices", new DataStore<float>(3, 6), geom->getId());
+    auto quads = ds.createDataArray<uint64_t>("Quads", new DataStore<uint64_t>(4, 2), geom->getId());
+    const std::vector<uint64_t> quadVerts = {0, 1, 4, 3, 1, 2, 5, 4};
+    std::copy(quadVerts.begin(), quadVerts.end(), quads->begin());
+    geom->setVertices(vertices);
+    geom->setQuads(quads);
+    REQUIRE_FALSE(geom->hasHalfEdgeTopology());
+    REQUIRE(geom->findHalfEdgeTopology() > 0);
+    REQUIRE(geom->hasHalfEdgeTopology());
+
+    const HalfEdgeTopology* quadTopology = geom->getHalfEdgeTopology();
+    REQUIRE(quadTopology != nullptr);
+    REQUIRE(quadTopology->getFaceSize() == 4);
+    REQUIRE(quadTopology->getNumberOfEdges() == 7);
+    REQUIRE(quadTopology->getNumberOfBoundaryEdges() == 6);
+    REQUIRE(quadTopology->getFaceNeighbor(0, 1) == 1);
+    REQUIRE(quadTopology->isManifold());
+    std::vector<uint64_t> ring;
+    quadTopology->getVertexRing(4, ring);
+    REQUIRE(ring == std::vector<uint64_t>{1, 3, 5});
+
+    REQUIRE(geom->findEdges() > 0);
+    REQUIRE(geom->getNumberOfEdges() == 7);
+    REQUIRE(geom->findUnsharedEdges() > 0);
+    REQUIRE(geom->getUnsharedEdges()->getTupleCount() == 6);
+
+    geom->deleteHalfEdgeTopology();
+    REQUIRE_FALSE(geom->hasHalfEdgeTopology());
+  }
+  SECTION("invalid faces")
+  {
+    // The second triangle refers to a vertex the geometry does not have
+    auto geom = createGeom<TriangleGeom>(ds);
+    auto vertices = ds.createDataArray<float>("Vertices", new DataStore<float>(3, 4), geom->getId());
+    auto triangles = ds.createDataArray<uint64_t>("Triangles", new DataStore<uint64_t>(3, 2), geom->getId());
+    const std::vector<uint64_t> triVerts = {0, 1, 2, 1, 3, 7};
+    std::copy(triVerts.begin(), triVerts.end(), triangles->begin());
+    geom->setVertices(vertices);
+    geom->setTriangles(triangles);
+
+    REQUIRE(geom->findHalfEdgeTopology() < 0);
+    REQUIRE_FALSE(geom->hasHalfEdgeTopology());
+    REQUIRE_FALSE(geom->contains("Half-Edge Topology"));
+    const TriangleGeom* constGeom = geom;
+    REQUIRE(constGeom->getHalfEdgeTopology() == nullptr);
+    REQUIRE_FALSE(geom->contains("Half-Edge Topology"));
+  }
+  SECTION("random triangles")
+  {
+    const size_t numTriangles = 50000;
+    const size_t numVerts = 5000;
+    std::mt19937_64 generator(42);
+    std::uniform_int_distribution<uint64_t> distribution(0, numVerts - 1);
+    auto triangles = ds.createDataArray<uint64_t>("Triangles", new DataStore<uint64_t>(3, numTriangles), group->getId());
+    for(auto& vert : *triangles)
+    {
+      vert = distribution(generator);
+    }
+    topology->build(*triangles, numVerts);
+
+    for(uint64_t halfEdge = 0; halfEdge < topology->getNumberOfHalfEdges(); halfEdge++)
+    {
+      const uint64_t twin = topology->getTwin(halfEdge);
+      if(twin != HalfEdgeTopology::k_InvalidIndex)
+      {
+        REQUIRE(topology->getTwin(twin) == halfEdge);
+        REQUIRE(topology->getEdge(twin) == topology->getEdge(halfEdge));
+      }
+    }
+
+    auto referenceEdges = ds.createDataArray<uint64_t>("Reference Edges", new DataStore<uint64_t>(2, 0), group->getId());
+    auto edges = ds.createDataArray<uint64_t>("Edges", new DataStore<uint64_t>(2, 0), group->getId());
+    GeometryHelpers::Connectivity::Find2DElementEdges(triangles, referenceEdges);
+    topology->copyEdges(*edges, false);
+    REQUIRE(edges->getTupleCount() == referenceEdges->getTupleCount());
+    REQUIRE(std::equal(edges->begin(), edges->end(), referenceEdges->begin()));
+
+    GeometryHelpers::Connectivity::Find2DUnsharedEdges(triangles, referenceEdges);
+    topology->copyEdges(*edges, true);
+    REQUIRE(edges->getTupleCount() == referenceEdges->getTupleCount());
+    REQUIRE(std::equal(edges->begin(), edges->end(), referenceEdges->begin()));
+  }
+}
+
+namespace
+{
+/**
+ * @brief Fills vertices with an n x n x n lattice with spacing (1, 2, 3)
+ * sheared along x, which keeps every cell volume at 6, and fills hexas with
+ * its (n - 1)^3 cells.
+ */
+void createShearedLattice(size_t n, DataArray<float>& vertices, DataArray<uint64_t>& hexas)
+{
+  for(size_t z = 0; z < n; z++)
+  {
+    for(size_t y = 0; y < n; y++)
+    {
+      for(size_t x = 0; x < n; x++)
+      {
+        const size_t vert = (z * n + y) * n + x;
+        vertices[3 * vert] = static_cast<float>(x) + 0.5f * static_cast<float>(y);
+        vertices[3 * vert + 1] = 2.0f * static_cast<float>(y);
+        vertices[3 * vert + 2] = 3.0f * static_cast<float>(z);
+      }
+    }
+  }
+  const size_t cells = n - 1;
+  for(size_t z = 0; z < cells; z++)
+  {
+    for(size_t y = 0; y < cells; y++)
+    {
+      for(size_t x = 0; x < cells; x++)
+      {
+        const size_t hex = (z * cells + y) * cells + x;
+        const uint64_t base = (z * n + y) * n + x;
+        const std::array<uint64_t, 8> corners = {base, base + 1, base + n + 1, base + n, base + n * n, base + n * n + 1, base + n * n + n + 1, base + n * n + n};
+        std::copy(corners.begin(), corners.end(), hexas.begin() + 8 * hex);
+      }
+    }
+  }
+}
+} // namespace
+
+TEST_CASE("ElementKernelsTest")
+{
+  DataStructure ds;
+  auto group = ds.createGroup("Mesh");
+
+  // 27000 cells so the kernels run in several slices with partial batches
+  const size_t n = 31;
+  const size_t numHexas = (n - 1) * (n - 1) * (n - 1);
+  auto vertices = ds.createDataArray<float>("Vertices", new DataStore<float>(3, n * n * n), group->getId());
+  auto hexas = ds.createDataArray<uint64_t>("Hexas", new DataStore<uint64_t>(8, numHexas), group->getId());
+  createShearedLattice(n, *vertices, *hexas);
+
+  SECTION("hexahedra")
+  {
+    auto volumes = ds.createDataArray<float>("Volumes", new DataStore<float>(1, numHexas), group->getId());
+    GeometryHelpers::Topology::FindHexVolumes(hexas, vertices, volumes);
+    REQUIRE(std::all_of(volumes->begin(), volumes->end(), [](float volume) { return volume == Approx(6.0f); }));
+
+    // Planar outputs are written component by component
+    auto centroids = ds.createDataArray<float>("Centroids", new PlanarDataStore<float>(3, numHexas), group->getId());
+    GeometryHelpers::Topology::FindElementCentroids(hexas, vertices, centroids);
+    for(size_t hex = 0; hex < numHexas; hex++)
+    {
+      for(size_t dim = 0; dim < 3; dim++)
+      {
+        float sum = 0.0f;
+        for(size_t k = 0; k < 8; k++)
+        {
+          sum += vertices->at(3 * hexas->at(8 * hex + k) + dim);
+        }
+        REQUIRE(centroids->at(3 * hex + dim) == Approx(sum / 8.0f));
+      }
+    }
+  }
+  SECTION("tetrahedra")
+  {
+    // The corner tet (0, 1, 3, 4) of every cell has a sixth of its volume
+    auto tets = ds.createDataArray<uint64_t>("Tets", new DataStore<uint64_t>(4, numHexas), group->getId());
+    for(size_t hex = 0; hex < numHexas; hex++)
+    {
+      (*tets)[4 * hex] = hexas->at(8 * hex);
+      (*tets)[4 * hex + 1] = hexas->at(8 * hex + 1);
+      (*tets)[4 * hex + 2] = hexas->at(8 * hex + 3);
+      (*tets)[4 * hex + 3] = hexas->at(8 * hex + 4);
+    }
+    auto geom = createGeom<TetrahedralGeom>(ds);
+    geom->setVertices(vertices);
+    geom->setTetrahedra(tets);
+    const FloatArray* volumes = geom->getElementSizes();
+    REQUIRE(volumes->getTupleCount() == numHexas);
+    REQUIRE(std::all_of(volumes->begin(), volumes->end(), [](float volume) { return volume == Approx(1.0f); }));
+    const FloatArray* centroids = geom->getElementCentroids();
+    REQUIRE(centroids->at(0) == Approx(0.375f));
+    REQUIRE(centroids->at(1) == Approx(0.5f));
+    REQUIRE(centroids->at(2) == Approx(0.75f));
+  }
+  SECTION("quads and triangles")
+  {
+    // The bottom faces of the cells, tilted out of the xy plane
+    const size_t numQuads = (n - 1) * (n - 1);
+    auto quads = ds.createDataArray<uint64_t>("Quads", new DataStore<uint64_t>(4, numQuads), group->getId());
+    auto triangles = ds.createDataArray<uint64_t>("Triangles", new DataStore<uint64_t>(3, 2 * numQuads), group->getId());
+    for(size_t quad = 0; quad < numQuads; quad++)
+    {
+      std::copy(hexas->begin() + 8 * quad, hexas->begin() + 8 * quad + 4, quads->begin() + 4 * quad);
+      const std::array<uint64_t, 6> triangleVerts = {hexas->at(8 * quad), hexas->at(8 * quad + 1), hexas->at(8 * quad + 2), hexas->at(8 * quad), hexas->at(8 * quad + 2), hexas->at(8 * quad + 3)};
+      std::copy(triangleVerts.begin(), triangleVerts.end(), triangles->begin() + 6 * quad);
+    }
+    for(size_t vert = 0; vert < n * n; vert++)
+    {
+      // Rotating about the x axis keeps the areas
+      const float y = vertices->at(3 * vert + 1);
+      (*vertices)[3 * vert + 1] = 0.6f * y;
+      (*vertices)[3 * vert + 2] = 0.8f * y;
+    }
+
+    auto quadGeom = createGeom<QuadGeom>(ds);
+    quadGeom->setVertices(vertices);
+    quadGeom->setQuads(quads);
+    const FloatArray* quadAreas = quadGeom->getElementSizes();
+    REQUIRE(quadAreas->getTupleCount() == numQuads);
+    REQUIRE(std::all_of(quadAreas->begin(), quadAreas->end(), [](float area) { return area == Approx(2.0f); }));
+
+    auto triangleGeom = createGeom<TriangleGeom>(ds);
+    triangleGeom->setVertices(vertices);
+    triangleGeom->setTriangles(triangles);
+    const FloatArray* triangleAreas = triangleGeom->getElementSizes();
+    REQUIRE(triangleAreas->getTupleCount() == 2 * numQuads);
+    REQUIRE(std::all_of(triangleAreas->begin(), triangleAreas->end(), [](float area) { return area == Approx(1.0f); }));
+  }
+  SECTION("unsupported element sizes")
+  {
+    auto areas = ds.createDataArray<float>("Areas", new DataStore<float>(1, numHexas), group->getId());
+    REQUIRE_THROWS(GeometryHelpers::Topology::Find2DElementAreas(hexas, vertices, areas));
+  }
+}
+
+TEST_CASE("ElementKernelsBenchmark", "[.benchmark]")
+{
+  using Clock = std::chrono::steady_clock;
+  DataStructure ds;
+  auto group = ds.createGroup("Mesh");
+
+  const size_t n = 129;
+  const size_t numHexas = (n - 1) * (n - 1) * (n - 1);
+  auto vertices = ds.createDataArray<float>("Vertices", new DataStore<float>(3, n * n * n), group->getId());
+  auto hexas = ds.createDataArray<uint64_t>("Hexas", new DataStore<uint64_t>(8, numHexas), group->getId());
+  createShearedLattice(n, *vertices, *hexas);
+  auto volumes = ds.createDataArray<float>("Volumes", new DataStore<float>(1, numHexas), group->getId());
+  auto centroids = ds.createDataArray<float>("Centroids", new DataStore<float>(3, numHexas), group->getId());
+
+  auto start = Clock::now();
+  GeometryHelpers::Topology::FindHexVolumes(hexas, vertices, volumes);
+  const std::chrono::duration<double> volumeTime = Clock::now() - start;
+
+  start = Clock::now();
+  GeometryHelpers::Topology::FindElementCentroids(hexas, vertices, centroids);
+  const std::chrono::duration<double> centroidTime = Clock::now() - start;
+
+  const double millions = static_cast<double>(numHexas) / 1.0e6;
+  WARN("hex volumes: " << millions / volumeTime.count() << " M/s, hex centroids: " << millions / centroidTime.count() << " M/s");
+  REQUIRE(volumes->at(numHexas - 1) == Approx(6.0f));
+}
+
+TEST_CASE("GeometryMathTest")
+{
+  const Point3D<float> p0(0.0f, 0.0f, 0.0f);
+  const Point3D<float> p1(2.0f, 0.0f, 0.0f);
+  const Point3D<float> p2(0.0f, 2.0f, 0.0f);
+  const Point3D<float> p3(0.0f, 0.0f, 3.0f);
+
+  SECTION("measures")
+  {
+    REQUIRE(GeometryMath::FindDistanceBetweenPoints(p1, p2) == Approx(std::sqrt(8.0f)));
+    REQUIRE(GeometryMath::FindDistanceBetweenPoints(Point2D<float>(1.0f, 1.0f), Point2D<float>(4.0f, 5.0f)) == Approx(5.0f));
+    REQUIRE(GeometryMath::FindTriangleArea(p0, p1, p2) == Approx(2.0f));
+    REQUIRE(GeometryMath::FindTetrahedronVolume(p0, p2, p1, p3) == Approx(2.0f));
+    REQUIRE(GeometryMath::CosThetaBetweenVectors(p1, p2) == Approx(0.0f));
+    REQUIRE(GeometryMath::AngleBetweenVectors(ZXZEuler(1.0f, 0.0f, 0.0f), ZXZEuler(1.0f, 1.0f, 0.0f)) == Approx(0.785398f));
+    REQUIRE(GeometryMath::FindPlaneNormalVector(p0, p1, p2) == ZXZEuler(0.0f, 0.0f, 1.0f));
+    REQUIRE(GeometryMath::FindDistanceFromPlane(p0, p1, p2, Point3D<float>(5.0f, 5.0f, -2.0f)) == Approx(-2.0f));
+    REQUIRE(GeometryMath::FindDistanceToTriangleCentroid(p0, p1, p2, Point3D<float>(2.0f / 3.0f, 2.0f / 3.0f, 1.0f)) == Approx(1.0f));
+
+    const std::vector<float> square = {0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 0.0f, 1.0f};
+    REQUIRE(GeometryMath::FindPolygonNormal(square.data(), 4) == ZXZEuler(0.0f, 0.0f, -1.0f));
+  }
+  SECTION("containment")
+  {
+    const BoundingBox<float> box(Point3D<float>(0.0f, 0.0f, 0.0f), Point3D<float>(1.0f, 1.0f, 1.0f));
+    REQUIRE(GeometryMath::IsPointInBox(Point3D<float>(1.0f, 0.5f, 0.0f), box));
+    REQUIRE_FALSE(GeometryMath::IsPointInBox(Point3D<float>(1.5f, 0.5f, 0.5f), box));
+    REQUIRE(GeometryMath::IsPointInTriangle3D(p0, p1, p2, Point3D<float>(0.5f, 0.5f, 4.0f)));
+    REQUIRE(GeometryMath::IsPointInTriangle3D(p0, p1, p2, Point3D<float>(1.0f, 1.0f, 0.0f)));
+    REQUIRE_FALSE(GeometryMath::IsPointInTriangle3D(p0, p1, p2, Point3D<float>(1.5f, 1.0f, 0.0f)));
+    REQUIRE(GeometryMath::IsPointInTriangle2D(Point2D<float>(0.0f, 0.0f), Point2D<float>(0.0f, 2.0f), Point2D<float>(2.0f, 0.0f), Point2D<float>(0.5f, 0.5f)));
+    REQUIRE_FALSE(GeometryMath::IsPointInTriangle2D(Point2D<float>(0.0f, 0.0f), Point2D<float>(0.0f, 2.0f), Point2D<float>(2.0f, 0.0f), Point2D<float>(-0.5f, 0.5f)));
+  }
+  SECTION("rays")
+  {
+    const BoundingBox<float> box(Point3D<float>(1.0f, -1.0f, -1.0f), Point3D<float>(3.0f, 1.0f, 1.0f));
+    const Ray<float> ray(Point3D<float>(0.0f, 0.0f, 0.0f), ZXZEuler(2.0f, 0.0f, 0.0f), 2.0f);
+    REQUIRE(ray.getEndPoint() == Point3D<float>(2.0f, 0.0f, 0.0f));
+    REQUIRE(GeometryMath::DoesRayIntersectBox(ray, box));
+    REQUIRE(GeometryMath::GetLengthOfRayInBox(ray, box) == Approx(1.0f));
+    REQUIRE_FALSE(GeometryMath::DoesRayIntersectBox(Ray<float>(Point3D<float>(0.0f, 2.0f, 0.0f), ZXZEuler(1.0f, 0.0f, 0.0f), 10.0f), box));
+    REQUIRE_FALSE(GeometryMath::DoesRayIntersectBox(Ray<float>(Point3D<float>(0.0f, 0.0f, 0.0f), ZXZEuler(1.0f, 0.0f, 0.0f), 0.5f), box));
+
+    // Rays lying in a face of the box are parallel to that slab with their origin on its plane
+    const Ray<float> faceRay(Point3D<float>(0.0f, 1.0f, 0.0f), ZXZEuler(1.0f, 0.0f, 0.0f), 10.0f);
+    REQUIRE(GeometryMath::DoesRayIntersectBox(faceRay, box));
+    REQUIRE(GeometryMath::GetLengthOfRayInBox(faceRay, box) == Approx(2.0f));
+    const Ray<float> edgeRay(Point3D<float>(0.0f, -1.0f, 1.0f), ZXZEuler(1.0f, 0.0f, 0.0f), 2.0f);
+    REQUIRE(GeometryMath::DoesRayIntersectBox(edgeRay, box));
+    REQUIRE(GeometryMath::GetLengthOfRayInBox(edgeRay, box) == Approx(1.0f));
+    const std::array<float, 2> faceOriginX = {0.0f, 0.0f};
+    const std::array<float, 2> faceOriginY = {1.0f, -1.0f};
+    const std::array<float, 2> faceOriginZ = {0.0f, 1.0f};
+    const std::array<float, 2> faceDirX = {1.0f, 1.0f};
+    const std::array<float, 2> faceDirYZ = {0.0f, 0.0f};
+    const std::array<float, 2> faceLengths = {10.0f, 2.0f};
+    const GeometryMath::RayArrays<float> faceRays = {faceOriginX.data(), faceOriginY.data(), faceOriginZ.data(), faceDirX.data(), faceDirYZ.data(), faceDirYZ.data(), faceLengths.data(), 2};
+    std::array<uint8_t, 2> faceHits = {0, 0};
+    GeometryMath::DoesRayIntersectBox(faceRays, box, faceHits.data());
+    REQUIRE(faceHits[0] == 1);
+    REQUIRE(faceHits[1] == 1);
+
+    std::vector<Point3D<float>> intersections;
+    REQUIRE(GeometryMath::FindRayIntersectionsWithSphere(Ray<float>(Point3D<float>(-5.0f, 0.0f, 0.0f), ZXZEuler(1.0f, 0.0f, 0.0f), 10.0f), Point3D<float>(0.0f, 0.0f, 0.0f), 1.0f, intersections) == 2);
+    REQUIRE(intersections[0][0] == Approx(-1.0f));
+    REQUIRE(intersections[1][0] == Approx(1.0f));
+    REQUIRE(GeometryMath::FindRayIntersectionsWithSphere(Ray<float>(Point3D<float>(0.0f, 0.0f, 0.0f), ZXZEuler(1.0f, 0.0f, 0.0f), 10.0f), Point3D<float>(0.0f, 0.0f, 0.0f), 1.0f, intersections) == 1);
+
+    const Ray<float> down(Point3D<float>(0.5f, 0.5f, 1.0f), ZXZEuler(0.0f, 0.0f, -1.0f), 2.0f);
+    REQUIRE(GeometryMath::RayIntersectsTriangle(down, p0, p1, p2, intersections) == 1);
+    REQUIRE(intersections[0][2] == Approx(0.0f));
+    REQUIRE(GeometryMath::RayCrossesTriangle(down, p0, p1, p2));
+    REQUIRE(GeometryMath::RayIntersectsPlane(down, p0, p1, p2));
+    const Ray<float> touching(Point3D<float>(0.5f, 0.5f, 1.0f), ZXZEuler(0.0f, 0.0f, -1.0f), 1.0f);
+    REQUIRE(GeometryMath::RayIntersectsTriangle(touching, p0, p1, p2, intersections) == 1);
+    REQUIRE_FALSE(GeometryMath::RayCrossesTriangle(touching, p0, p1, p2));
+    const Ray<float> tooShort(Point3D<float>(0.5f, 0.5f, 1.0f), ZXZEuler(0.0f, 0.0f, -1.0f), 0.5f);
+    REQUIRE(GeometryMath::RayIntersectsTriangle(tooShort, p0, p1, p2, intersections) == 0);
+    REQUIRE_FALSE(GeometryMath::RayIntersectsPlane(tooShort, p0, p1, p2));
+
+    const Ray<float> random = GeometryMath::GenerateRandomRay(3.0f);
+    REQUIRE(GeometryMath::FindDistanceBetweenPoints(random.getOrigin(), random.getEndPoint()) == Approx(3.0f));
+  }
+  SECTION("batches match the scalar versions")
+  {
+    const size_t count = 1000;
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<float> coordinates(-2.0f, 2.0f);
+    std::vector<float> x(count), y(count), z(count), dirX(count), dirY(count), dirZ(count), lengths(count);
+    for(size_t i = 0; i < count; i++)
+    {
+      x[i] = coordinates(generator);
+      y[i] = coordinates(generator);
+      z[i] = coordinates(generator);
+      const Ray<float> ray = GeometryMath::GenerateRandomRay(1.0f);
+      dirX[i] = ray.getEndPoint()[0];
+      dirY[i] = ray.getEndPoint()[1];
+      dirZ[i] = ray.getEndPoint()[2];
+      lengths[i] = 4.0f;
+    }
+    // Include axis aligned rays, whose inverse directions are infinite
+    dirX[0] = 0.0f;
+    dirY[0] = 0.0f;
+    dirZ[0] = -1.0f;
+    const GeometryMath::PointArrays<float> points = {x.data(), y.data(), z.data(), count};
+    const GeometryMath::RayArrays<float> rays = {x.data(), y.data(), z.data(), dirX.data(), dirY.data(), dirZ.data(), lengths.data(), count};
+    const BoundingBox<float> box(Point3D<float>(-1.0f, -1.0f, -1.0f), Point3D<float>(1.0f, 0.5f, 1.0f));
+
+    std::vector<float> distances(count);
+    std::vector<uint8_t> inBox(count), inTriangle(count), hitsBox(count);
+    std::vector<float> triangleDistances(count);
+    GeometryMath::FindDistanceBetweenPoints(points, p1, distances.data());
+    GeometryMath::IsPointInBox(points, box, inBox.data());
+    GeometryMath::IsPointInTriangle3D(p0, p1, p2, points, inTriangle.data());
+    GeometryMath::DoesRayIntersectBox(rays, box, hitsBox.data());
+    GeometryMath::RayIntersectsTriangle(rays, p0, p1, p2, triangleDistances.data());
+
+    std::vector<Point3D<float>> intersections;
+    size_t numTriangleHits = 0;
+    for(size_t i = 0; i < count; i++)
+    {
+      const Point3D<float> point(x[i], y[i], z[i]);
+      const Ray<float> ray(point, ZXZEuler(dirX[i], dirY[i], dirZ[i]), lengths[i]);
+      REQUIRE(distances[i] == Approx(GeometryMath::FindDistanceBetweenPoints(point, p1)));
+      REQUIRE(static_cast<bool>(inBox[i]) == GeometryMath::IsPointInBox(point, box));
+      REQUIRE(static_cast<bool>(inTriangle[i]) == GeometryMath::IsPointInTriangle3D(p0, p1, p2, point));
+      REQUIRE(static_cast<bool>(hitsBox[i]) == GeometryMath::DoesRayIntersectBox(ray, box));
+      REQUIRE((triangleDistances[i] >= 0.0f) == (GeometryMath::RayIntersectsTriangle(ray, p0, p1, p2, intersections) == 1));
+      numTriangleHits += (triangleDistances[i] >= 0.0f) ? 1 : 0;
+    }
+    REQUIRE(numTriangleHits > 0);
+    REQUIRE(std::count(hitsBox.begin(), hitsBox.end(), 1) > 0);
+  }
+}
+
+namespace
+{
+/**
+ * @brief Fills vertices and triangles with the surface of the box from min
+ * to max, each side split into divisions x divisions squares of two
+ * triangles.
+ */
+void createBoxSurface(float min, float max, size_t divisions, std::vector<float>& vertices, std::vector<uint64_t>& triangles)
+{
+  const float step = (max - min) / static_cast<float>(divisions);
+  for(size_t axis = 0; axis < 3; axis++)
+  {
+    for(float side : {min, max})
+    {
+      const uint64_t base = vertices.size() / 3;
+      for(size_t j = 0; j <= divisions; j++)
+      {
+        for(size_t i = 0; i <= divisions; i++)
+        {
+          std::array<float, 3> point = {};
+          point[axis] = side;
+          point[(axis + 1) % 3] = min + step * static_cast<float>(i);
+          point[(axis + 2) % 3] = min + step * static_cast<float>(j);
+          vertices.insert(vertices.end(), point.begin(), point.end());
+        }
+      }
+      for(size_t j = 0; j < divisions; j++)
+      {
+        for(size_t i = 0; i < divisions; i++)
+        {
+          const uint64_t corner = base + j * (divisions + 1) + i;
+          const uint64_t above = corner + divisions + 1;
+          triangles.insert(triangles.end(), {corner, corner + 1, above + 1, corner, above + 1, above});
+        }
+      }
+    }
+  }
+}
+} // namespace
+
+TEST_CASE("BoundingVolumeHierarchyTest")
+{
+  DataStructure ds;
+  auto group = ds.createGroup("Mesh");
+  auto hierarchy = ds.createBoundingVolumeHierarchy("Hierarchy", group->getId());
+  REQUIRE(hierarchy != nullptr);
+  REQUIRE(hierarchy->intersectRay(Ray<float>(Point3D<float>(0.0f, 0.0f, 0.0f), ZXZEuler(1.0f, 0.0f, 0.0f), 1.0f)).face == BoundingVolumeHierarchy::k_InvalidIndex);
+
+  SECTION("queries match brute force")
+  {
+    // Enough random triangles to split the upper levels with parallel binning
+    const size_t numTriangles = 70000;
+    std::mt19937 generator(11);
+    std::uniform_real_distribution<float> centers(0.0f, 10.0f);
+    std::uniform_real_distribution<float> offsets(-0.2f, 0.2f);
+    auto vertices = ds.createDataArray<float>("Vertices", new DataStore<float>(3, 3 * numTriangles), group->getId());
+    auto triangles = ds.createDataArray<uint64_t>("Triangles", new DataStore<uint64_t>(3, numTriangles), group->getId());
+    for(size_t face = 0; face < numTriangles; face++)
+    {
+      const std::array<float, 3> center = {centers(generator), centers(generator), centers(generator)};
+      for(size_t k = 0; k < 3; k++)
+      {
+        for(size_t i = 0; i < 3; i++)
+        {
+          (*vertices)[9 * face + 3 * k + i] = center[i] + offsets(generator);
+        }
+        (*triangles)[3 * face + k] = 3 * face + k;
+      }
+    }
+    hierarchy->build(*triangles, *vertices);
+    REQUIRE(hierarchy->getNumberOfFaces() == numTriangles);
+    REQUIRE(hierarchy->getNumberOfNodes() > 1);
+    REQUIRE(hierarchy->getBounds().isValid());
+
+    auto corner = [&](size_t face, size_t k) { return Point3D<float>(vertices->at(9 * face + 3 * k), vertices->at(9 * face + 3 * k + 1), vertices->at(9 * face + 3 * k + 2)); };
+
+    const size_t numQueries = 64;
+    std::vector<float> x(numQueries), y(numQueries), z(numQueries), dirX(numQueries), dirY(numQueries), dirZ(numQueries), lengths(numQueries, 8.0f);
+    for(size_t q = 0; q < numQueries; q++)
+    {
+      x[q] = centers(generator);
+      y[q] = centers(generator);
+      z[q] = centers(generator);
+      const Point3D<float> dir = GeometryMath::GenerateRandomRay(1.0f).getEndPoint();
+      dirX[q] = dir[0];
+      dirY[q] = dir[1];
+      dirZ[q] = dir[2];
+    }
+    std::vector<BoundingVolumeHierarchy::RayHit> hits(numQueries);
+    std::vector<BoundingVolumeHierarchy::ClosestPoint> closest(numQueries);
+    hierarchy->intersectRay(GeometryMath::RayArrays<float>{x.data(), y.data(), z.data(), dirX.data(), dirY.data(), dirZ.data(), lengths.data(), numQueries}, hits.data());
+    hierarchy->findClosestPoint(GeometryMath::PointArrays<float>{x.data(), y.data(), z.data(), numQueries}, closest.data());
+
+    std::vector<Point3D<float>> intersections;
+    for(size_t q = 0; q < numQueries; q++)
+    {
+      const Point3D<float> origin(x[q], y[q], z[q]);
+      const Ray<float> ray(origin, ZXZEuler(dirX[q], dirY[q], dirZ[q]), lengths[q]);
+      float nearestHit = std::numeric_limits<float>::infinity();
+      size_t numHits = 0;
+      float nearestPoint = std::numeric_limits<float>::infinity();
+      for(size_t face = 0; face < numTriangles; face++)
+      {
+        if(GeometryMath::RayIntersectsTriangle(ray, corner(face, 0), corner(face, 1), corner(face, 2), intersections) == 1)
+        {
+          nearestHit = std::min(nearestHit, GeometryMath::FindDistanceBetweenPoints(origin, intersections[0]));
+          numHits++;
+        }
+      }
+      // Closest points are checked against the vertices, which bound the distance to the mesh from above
+      for(size_t vert = 0; vert < 3 * numTriangles; vert++)
+      {
+        nearestPoint = std::min(nearestPoint, GeometryMath::FindDistanceBetweenPoints(origin, corner(vert / 3, vert % 3)));
+      }
+
+      REQUIRE(hierarchy->countRayIntersections(ray) == numHits);
+      if(numHits == 0)
+      {
+        REQUIRE(hits[q].face == BoundingVolumeHierarchy::k_InvalidIndex);
+      }
+      else
+      {
+        REQUIRE(hits[q].face != BoundingVolumeHierarchy::k_InvalidIndex);
+        REQUIRE(hits[q].distance == Approx(nearestHit).margin(1.0e-4));
+        REQUIRE(hierarchy->intersectRay(ray).distance == Approx(hits[q].distance));
+      }
+
+      const BoundingVolumeHierarchy::ClosestPoint& result = closest[q];
+      REQUIRE(result.face != BoundingVolumeHierarchy::k_InvalidIndex);
+      REQUIRE(result.distance <= nearestPoint);
+      const Point3D<float> point(result.point[0], result.point[1], result.point[2]);
+      REQUIRE(GeometryMath::FindDistanceBetweenPoints(origin, point) == Approx(result.distance));
+      REQUIRE(std::abs(GeometryMath::FindDistanceFromPlane(corner(result.face, 0), corner(result.face, 1), corner(result.face, 2), point)) < 1.0e-4f);
+      for(size_t face = 0; face < numTriangles; face += 97)
+      {
+        // No sampled face has a corner closer than the closest point
+        REQUIRE(result.distance <= GeometryMath::FindDistanceBetweenPoints(origin, corner(face, 0)) + 1.0e-5f);
+      }
+    }
+    REQUIRE(hierarchy->findClosestPoint(Point3D<float>(50.0f, 50.0f, 50.0f), 1.0f).face == BoundingVolumeHierarchy::k_InvalidIndex);
+  }
+  SECTION("nearly coincident centroids")
+  {
+    // Centroids a few denormals apart would overflow the bin scale
+    const size_t numTriangles = 32;
+    auto vertices = ds.createDataArray<float>("Vertices", new DataStore<float>(3, 3 * numTriangles), group->getId());
+    auto triangles = ds.createDataArray<uint64_t>("Triangles", new DataStore<uint64_t>(3, numTriangles), group->getId());
+    const std::array<float, 9> corners = {0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f};
+    for(size_t face = 0; face < numTriangles; face++)
+    {
+      for(size_t i = 0; i < 9; i++)
+      {
+        (*vertices)[9 * face + i] = corners[i];
+      }
+      for(size_t k = 0; k < 3; k++)
+      {
+        (*vertices)[9 * face + 3 * k] = static_cast<float>(face) * std::numeric_limits<float>::denorm_min();
+        (*triangles)[3 * face + k] = 3 * face + k;
+      }
+    }
+    hierarchy->build(*triangles, *vertices);
+    REQUIRE(hierarchy->getNumberOfFaces() == numTriangles);
+    REQUIRE(hierarchy->getNumberOfNodes() > 1);
+    const BoundingVolumeHierarchy::RayHit hit = hierarchy->intersectRay(Ray<float>(Point3D<float>(1.0f, 0.25f, 0.25f), ZXZEuler(-1.0f, 0.0f, 0.0f), 2.0f));
+    REQUIRE(hit.face != BoundingVolumeHierarchy::k_InvalidIndex);
+    REQUIRE(hit.distance == Approx(1.0f));
+  }
+  SECTION("voxelizing a closed mesh")
+  {
+    std::vector<float> coords;
+    std::vector<uint64_t> faces;
+    createBoxSurface(0.1f, 0.9f, 8, coords, faces);
+    auto vertices = ds.createDataArray<float>("Vertices", new DataStore<float>(3, coords.size() / 3), group->getId());
+    auto triangles = ds.createDataArray<uint64_t>("Triangles", new DataStore<uint64_t>(3, faces.size() / 3), group->getId());
+    std::copy(coords.begin(), coords.end(), vertices->begin());
+    std::copy(faces.begin(), faces.end(), triangles->begin());
+    hierarchy->build(*triangles, *vertices);
+
+    // Cell centers of a 20^3 image covering the unit cube
+    const size_t dims = 20;
+    std::vector<float> x, y, z;
+    for(size_t k = 0; k < dims; k++)
+    {
+      for(size_t j = 0; j < dims; j++)
+      {
+        for(size_t i = 0; i < dims; i++)
+        {
+          x.push_back((static_cast<float>(i) + 0.5f) / static_cast<float>(dims));
+          y.push_back((static_cast<float>(j) + 0.5f) / static_cast<float>(dims));
+          z.push_back((static_cast<float>(k) + 0.5f) / static_cast<float>(dims));
+        }
+      }
+    }
+    std::vector<uint8_t> inside(x.size());
+    hierarchy->isInside(GeometryMath::PointArrays<float>{x.data(), y.data(), z.data(), x.size()}, inside.data());
+    for(size_t cell = 0; cell < x.size(); cell++)
+    {
+      const bool expected = x[cell] > 0.1f && x[cell] < 0.9f && y[cell] > 0.1f && y[cell] < 0.9f && z[cell] > 0.1f && z[cell] < 0.9f;
+      REQUIRE(static_cast<bool>(inside[cell]) == expected);
+    }
+    REQUIRE(hierarchy->isInside(Point3D<float>(0.5f, 0.5f, 0.5f)));
+    REQUIRE_FALSE(hierarchy->isInside(Point3D<float>(2.0f, 0.5f, 0.5f)));
+  }
+  SECTION("triangle geometry")
+  {
+    std::vector<float> coords;
+    std::vector<uint64_t> faces;
+    createBoxSurface(0.0f, 1.0f, 2, coords, faces);
+    auto geom = createGeom<TriangleGeom>(ds);
+    auto vertices = ds.createDataArray<float>("Vertices", new DataStore<float>(3, coords.size() / 3), geom->getId());
+    auto triangles = ds.createDataArray<uint64_t>("Triangles", new DataStore<uint64_t>(3, faces.size() / 3), geom->getId());
+    std::copy(coords.begin(), coords.end(), vertices->begin());
+    std::copy(faces.begin(), faces.end(), triangles->begin());
+    geom->setVertices(vertices);
+    geom->setTriangles(triangles);
+    const TriangleGeom* constGeom = geom;
+
+    const BoundingVolumeHierarchy* geomHierarchy = constGeom->getBoundingVolumeHierarchy();
+    REQUIRE(geomHierarchy != nullptr);
+    REQUIRE(geomHierarchy->getNumberOfFaces() == faces.size() / 3);
+    const auto hierarchyId = geomHierarchy->getId();
+    REQUIRE(constGeom->getBoundingVolumeHierarchy()->getId() == hierarchyId);
+    REQUIRE(geomHierarchy->intersectRay(Ray<float>(Point3D<float>(0.5f, 0.5f, -1.0f), ZXZEuler(0.0f, 0.0f, 1.0f), 5.0f)).distance == Approx(1.0f));
+
+    // Moving the vertices rebuilds the hierarchy
+    for(size_t i = 2; i < coords.size(); i += 3)
+    {
+      (*vertices)[i] += 1.0f;
+    }
+    geomHierarchy = constGeom->getBoundingVolumeHierarchy();
+    REQUIRE(geomHierarchy->getId() != hierarchyId);
+    REQUIRE(geomHierarchy->intersectRay(Ray<float>(Point3D<float>(0.5f, 0.5f, -1.0f), ZXZEuler(0.0f, 0.0f, 1.0f), 5.0f)).distance == Approx(2.0f));
+    geom->deleteBoundingVolumeHierarchy();
+    REQUIRE(constGeom->getBoundingVolumeHierarchy() != nullptr);
+  }
+}
+
+TEST_CASE("SpatialIndexTest")
+{
+  DataStructure ds;
+  auto group = ds.createGroup("Group");
+
+  // Enough points for the parallel build paths, on a coarse lattice so some
+  // distances tie and the vertex id order is exercised
+  const size_t numPoints = 40000;
+  std::mt19937 generator(5);
+  std::uniform_int_distribution<int> lattice(0, 400);
+  auto vertices = ds.createDataArray<float>("Vertices", new DataStore<float>(3, numPoints), group->getId());
+  for(size_t i = 0; i < 3 * numPoints; i++)
+  {
+    (*vertices)[i] = 0.025f * static_cast<float>(lattice(generator));
+  }
+
+  std::uniform_real_distribution<float> queryCoords(-1.0f, 11.0f);
+  const size_t numQueries = 48;
+  std::vector<float> x(numQueries), y(numQueries), z(numQueries);
+  for(size_t q = 0; q < numQueries; q++)
+  {
+    x[q] = queryCoords(generator);
+    y[q] = queryCoords(generator);
+    z[q] = queryCoords(generator);
+  }
+  x[0] = (*vertices)[0];
+  y[0] = (*vertices)[1];
+  z[0] = (*vertices)[2];
+  const GeometryMath::PointArrays<float> queries{x.data(), y.data(), z.data(), numQueries};
+
+  // Every vertex sorted by distance to the query and then by id
+  auto bruteForce = [&](size_t q) {
+    std::vector<std::pair<float, uint64_t>> sorted(numPoints);
+    for(size_t vert = 0; vert < numPoints; vert++)
+    {
+      const float dx = vertices->at(3 * vert) - x[q];
+      const float dy = vertices->at(3 * vert + 1) - y[q];
+      const float dz = vertices->at(3 * vert + 2) - z[q];
+      sorted[vert] = {dx * dx + dy * dy + dz * dz, vert};
+    }
+    std::sort(sorted.begin(), sorted.end());
+    return sorted;
+  };
+
+  const size_t k = 10;
+  const float radius = 0.3f;
+  auto checkQueries = [&](const SpatialIndex& index) {
+    std::vector<SpatialIndex::Neighbor> batchNeighbors(numQueries * k);
+    index.findNearestNeighbors(queries, k, batchNeighbors.data());
+    std::vector<usize> offsets;
+    std::vector<SpatialIndex::Neighbor> batchWithin;
+    index.findWithinRadius(queries, radius, offsets, batchWithin);
+    REQUIRE(offsets.size() == numQueries + 1);
+
+    std::vector<SpatialIndex::Neighbor> neighbors;
+    for(size_t q = 0; q < numQueries; q++)
+    {
+      const auto expected = bruteForce(q);
+      const Point3D<float> point(x[q], y[q], z[q]);
+      index.findNearestNeighbors(point, k, neighbors);
+      REQUIRE(neighbors.size() == k);
+      for(size_t i = 0; i < k; i++)
+      {
+        REQUIRE(neighbors[i].vertex == expected[i].second);
+        REQUIRE(neighbors[i].distance == Approx(std::sqrt(expected[i].first)));
+        REQUIRE(batchNeighbors[q * k + i].vertex == expected[i].second);
+      }
+      REQUIRE(index.findNearestNeighbor(point).vertex == expected[0].second);
+
+      index.findWithinRadius(point, radius, neighbors);
+      size_t numWithin = 0;
+      while(numWithin < numPoints && expected[numWithin].first <= radius * radius)
+      {
+        numWithin++;
+      }
+      REQUIRE(neighbors.size() == numWithin);
+      REQUIRE(offsets[q + 1] - offsets[q] == numWithin);
+      for(size_t i = 0; i < numWithin; i++)
+      {
+        REQUIRE(neighbors[i].vertex == expected[i].second);
+        REQUIRE(batchWithin[offsets[q] + i].vertex == expected[i].second);
+      }
+    }
+  };
+
+  SECTION("queries match brute force")
+  {
+    for(const SpatialIndex::Type type : {SpatialIndex::Type::KdTree, SpatialIndex::Type::UniformGrid})
+    {
+      auto index = ds.createSpatialIndex("Index", group->getId());
+      index->build(*vertices, type);
+      REQUIRE(index->getType() == type);
+      REQUIRE(index->getNumberOfPoints() == numPoints);
+      REQUIRE(index->getBounds().isValid());
+      checkQueries(*index);
+
+      // Nudge a few vertices: the tree refits and the grid updates in place
+      // or rebins, depending on whether a vertex left its cell
+      for(size_t vert = 0; vert < numPoints; vert += 200)
+      {
+        (*vertices)[3 * vert] += 0.01f;
+      }
+      REQUIRE(index->update(*vertices) == numPoints / 200);
+      REQUIRE(index->update(*vertices) == 0);
+      checkQueries(*index);
+
+      // Move every vertex, which rebuilds the index
+      for(size_t i = 0; i < 3 * numPoints; i++)
+      {
+        (*vertices)[i] = 10.0f - (*vertices)[i];
+      }
+      REQUIRE(index->update(*vertices) == numPoints);
+      checkQueries(*index);
+      ds.removeData(index->getId());
+    }
+  }
+  SECTION("empty index")
+  {
+    auto index = ds.createSpatialIndex("Empty", group->getId());
+    auto empty = ds.createDataArray<float>("Empty Vertices", new DataStore<float>(3, 0), group->getId());
+    index->build(*empty, SpatialIndex::Type::UniformGrid);
+    REQUIRE(index->findNearestNeighbor(Point3D<float>(0.0f, 0.0f, 0.0f)).vertex == SpatialIndex::k_InvalidIndex);
+    std::vector<SpatialIndex::Neighbor> neighbors;
+    index->findWithinRadius(Point3D<float>(0.0f, 0.0f, 0.0f), 1.0f, neighbors);
+    REQUIRE(neighbors.empty());
+  }
+  SECTION("vertex geometry")
+  {
+    auto geom = createGeom<VertexGeom>(ds);
+    auto geomVertices = ds.createDataArray<float>("Vertices", new DataStore<float>(3, 4), geom->getId());
+    const std::vector<float> coords = {0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f};
+    std::copy(coords.begin(), coords.end(), geomVertices->begin());
+    geom->setVertices(geomVertices);
+    const VertexGeom* constGeom = geom;
+
+    const SpatialIndex* geomIndex = constGeom->getSpatialIndex();
+    REQUIRE(geomIndex != nullptr);
+    REQUIRE(geomIndex->getType() == SpatialIndex::Type::KdTree);
+    const auto indexId = geomIndex->getId();
+    REQUIRE(constGeom->getSpatialIndex()->getId() == indexId);
+    REQUIRE(geomIndex->findNearestNeighbor(Point3D<float>(0.9f, 0.2f, 0.0f)).vertex == 1);
+
+    // Moving a vertex updates the same index
+    (*geomVertices)[3] = -1.0f;
+    geomIndex = constGeom->getSpatialIndex();
+    REQUIRE(geomIndex->getId() == indexId);
+    REQUIRE(geomIndex->findNearestNeighbor(Point3D<float>(0.9f, 0.2f, 0.0f)).vertex == 0);
+
+    // Another layout replaces the index
+    geom->setSpatialIndexType(SpatialIndex::Type::UniformGrid);
+    geomIndex = constGeom->getSpatialIndex();
+    REQUIRE(geomIndex->getType() == SpatialIndex::Type::UniformGrid);
+    REQUIRE(geomIndex->getId() != indexId);
+    REQUIRE(geomIndex->findNearestNeighbor(Point3D<float>(-0.8f, 0.1f, 0.0f)).vertex == 1);
+    geom->deleteSpatialIndex();
+    REQUIRE(constGeom->getSpatialIndex() != nullptr);
+  }
+  SECTION("concurrent callers")
+  {
+    auto geom = createGeom<VertexGeom>(ds);
+    geom->setVertices(vertices);
+    const VertexGeom* constGeom = geom;
+    const size_t numRounds = 8;
+    for(size_t round = 0; round < numRounds; round++)
+    {
+      // Each round changes the vertices so both threads find a stale index
+      (*vertices)[3 * round] += 1.0f;
+      std::array<const SpatialIndex*, 2> results = {nullptr, nullptr};
+      std::vector<std::thread> threads;
+      for(size_t t = 0; t < results.size(); t++)
+      {
+        threads.emplace_back([constGeom, &results, t]() { results[t] = constGeom->getSpatialIndex(); });
+      }
+      for(auto& thread : threads)
+      {
+        thread.join();
+      }
+      REQUIRE(results[0] != nullptr);
+      REQUIRE(results[0] == results[1]);
+      REQUIRE(results[0]->findNearestNeighbor(Point3D<float>(vertices->at(3 * round), vertices->at(3 * round + 1), vertices->at(3 * round + 2))).distance == 0.0f);
+    }
+  }
+}
+
+TEST_CASE("GeometrySnapshotTest")
+{
+  const auto path = std::filesystem::temp_directory_path() / "complex_GeometrySnapshotTest.snap";
+  {
+    DataStructure ds;
+    auto geom = dynamic_cast<TriangleGeom*>(ds.createGeometry<TriangleGeom>("Triangles"));
+    auto vertices = ds.createDataArray<float>("Vertices", new DataStore<float>(3, 4), geom->getId());
+    auto triangles = ds.createDataArray<uint64_t>("Triangles", new DataStore<uint64_t>(3, 2), geom->getId());
+    const std::vector<float> coords = {0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f};
+    const std::vector<uint64_t> triangleVerts = {0, 1, 2, 2, 1, 3};
+    std::copy(coords.begin(), coords.end(), vertices->begin());
+    std::copy(triangleVerts.begin(), triangleVerts.end(), triangles->begin());
+    geom->setVertices(vertices);
+    geom->setTriangles(triangles);
+    geom->setTimeValue(4.0f);
+    const TriangleGeom* constGeom = geom;
+    REQUIRE(constGeom->getElementCentroids() != nullptr);
+    REQUIRE(constGeom->getElementNeighbors() != nullptr);
+
+    auto image = dynamic_cast<ImageGeom*>(ds.createGeometry<ImageGeom>("Image"));
+    image->setDimensions({2, 3, 4});
+    image->setSpacing(1.0f, 2.0f, 3.0f);
+    image->setOrigin(-1.0f, 0.0f, 1.0f);
+    DataStructureSnapshot::Write(ds, path);
+  }
+
+  // Derived objects are not stored and are computed again when needed
+  DataStructure ds = DataStructureSnapshot::Read(path);
+  REQUIRE(ds.size() == 4);
+  auto geom = dynamic_cast<TriangleGeom*>(ds.getData(DataPath({"Triangles"})));
+  REQUIRE(geom != nullptr);
+  REQUIRE(geom->getVertices() == ds.getData(DataPath({"Triangles", "Vertices"})));
+  REQUIRE(geom->getTriangles() == ds.getData(DataPath({"Triangles", "Triangles"})));
+  REQUIRE(geom->getTimeValue() == 4.0f);
+  const TriangleGeom* constGeom = geom;
+  REQUIRE(constGeom->getElementCentroids()->at(0) == Approx(1.0f / 3.0f));
+  REQUIRE(constGeom->getElementNeighbors()->getNumberOfElements(0) == 1);
+
+  auto image = dynamic_cast<ImageGeom*>(ds.getData(DataPath({"Image"})));
+  REQUIRE(image != nullptr);
+  REQUIRE(image->getDimensions() == SizeVec3(2, 3, 4));
+  REQUIRE(image->getSpacing() == FloatVec3(1.0f, 2.0f, 3.0f));
+  REQUIRE(image->getOrigin() == FloatVec3(-1.0f, 0.0f, 1.0f));
+  std::filesystem::remove(path);
+}